@@ -1,13 +1,23 @@
 #include "AppMain.hpp"
+#include "AppShaders.hpp"
 #include "utils/tiny_obj_loader.h"
 #include <iostream>
 #include <fstream>
 #include <cassert>
 #include <array>
 #include <cmath>
+#include <cstring>
+#include <algorithm>
+
+// base.frag.glsl specialization constants (VkBool32)
+const uint32_t SPEC_BASE_USE_TEXTURE = 0;
+const uint32_t SPEC_BASE_USE_VERTEX_COLOR = 1;
+
+// bindless.frag.glsl push constants (slots of bindless table)
+struct CBindlessConstants { uint32_t mTextureIndex; uint32_t mSamplerIndex; };
 
 // vertex structure
-struct CUSTOMVERTEX { FLOAT X, Y, Z, W; FLOAT R, G, B, A; FLOAT U, V; };
+struct CUSTOMVERTEX { float X, Y, Z, W; float R, G, B, A; float U, V; };
 
 // vertex array
 CUSTOMVERTEX vertices[] = {
@@ -20,36 +30,19 @@ CUSTOMVERTEX vertices[] = {
 // index array
 uint16_t indexes[] = { 0, 1, 2, 2, 1, 3 };
 
-// FillCommandBuffer
-void FillCommandBuffer(
-	VkCommandBuffer commandBuffer, VkPipeline graphicsPipeline, VkPipelineLayout pipelineLayout, VkDescriptorSet descriptorSet,
-	VkRenderPass renderPass, VkFramebuffer framebuffer, VkExtent2D extent2D,
-	VkBuffer vertexBufferPos, VkBuffer vertexBufferNorm, VkBuffer vertexBufferTexCoords, VkBuffer indexBuffer, uint32_t size)
+// RecordDraws (draws [drawBegin, drawEnd) of the model, used inline and from secondary command buffers,
+// bindlessDescriptorSet is bound once and draws select texture by push constants,
+// with instanceRing draws are instances and each batch of range is one instanced draw,
+// with drawList whole list is one indirect submission and range is ignored,
+// with culling visible instances are drawn by indirect commands of compute pass and range is ignored too,
+// with renderQueue range is of sorted packets, which bind their own pipeline, material and buffers)
+void RecordDraws(
+	VkCommandBuffer commandBuffer, VkPipeline graphicsPipeline, VkPipelineLayout pipelineLayout, VkDescriptorSet descriptorSet, VkExtent2D extent2D,
+	VkBuffer vertexBufferPos, VkBuffer indexBuffer, uint32_t uniformOffset, uint32_t drawBegin, uint32_t drawEnd,
+	VkDescriptorSet bindlessDescriptorSet, const CBindlessConstants& bindlessConstants, const VulkanHelpers::VulkanInstanceRingInfo* instanceRing,
+	const VulkanHelpers::VulkanDrawListInfo* drawList, const VulkanHelpers::VulkanCullingInfo* culling,
+	const VulkanHelpers::VulkanRenderQueueInfo* renderQueue)
 {
-	// VkCommandBufferBeginInfo
-	VkCommandBufferBeginInfo commandBufferBeginInfo = {};
-	commandBufferBeginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
-	commandBufferBeginInfo.pNext = VK_NULL_HANDLE;
-	commandBufferBeginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
-	commandBufferBeginInfo.pInheritanceInfo = nullptr; // Optional
-	VK_CHECK(vkBeginCommandBuffer(commandBuffer, &commandBufferBeginInfo));
-
-	// VkClearValue
-	VkClearValue clearColors[2];
-	clearColors[0].color = { 0.0f, 0.125f, 0.3f, 1.0f };
-	clearColors[1].depthStencil.depth = 1.0f;
-	clearColors[1].depthStencil.stencil = 0;
-
-	// VkRenderPassBeginInfo
-	VkRenderPassBeginInfo renderPassBeginInfo = {};
-	renderPassBeginInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
-	renderPassBeginInfo.renderPass = renderPass;
-	renderPassBeginInfo.framebuffer = framebuffer;
-	renderPassBeginInfo.renderArea.offset = { 0, 0 };
-	renderPassBeginInfo.renderArea.extent = extent2D;
-	renderPassBeginInfo.clearValueCount = 2;
-	renderPassBeginInfo.pClearValues = clearColors;
-
 	// VkViewport - viewport
 	VkViewport viewport{};
 	viewport.x = 0.0f;
@@ -71,25 +64,139 @@ void FillCommandBuffer(
 
 	//VkBuffer buffers[] = { vertexBufferPos, vertexBufferNorm, vertexBufferTexCoords };
 
-	// GO RENDER
-	vkCmdBeginRenderPass(commandBuffer, &renderPassBeginInfo, VK_SUBPASS_CONTENTS_INLINE);
+	// dynamic state and bindings are not inherited by secondary command buffers
 	vkCmdSetViewport(commandBuffer, 0, 1, &viewport);
 	vkCmdSetScissor(commandBuffer, 0, 1, &scissor);
-	
+
+	// sorted packets (bindless table is shared by layouts of their pipelines)
+	if (renderQueue) {
+		if (bindlessDescriptorSet)
+			vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipelineLayout, 1, 1, &bindlessDescriptorSet, 0, VK_NULL_HANDLE);
+		renderQueue->Record(commandBuffer, drawBegin, drawEnd);
+		return;
+	}
+
 	vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, graphicsPipeline);
-	vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipelineLayout, 0, 1, &descriptorSet, 0, VK_NULL_HANDLE);
+	vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipelineLayout, 0, 1, &descriptorSet, 1, &uniformOffset);
+	if (bindlessDescriptorSet)
+		vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipelineLayout, 1, 1, &bindlessDescriptorSet, 0, VK_NULL_HANDLE);
 	//vkCmdBindVertexBuffers(commandBuffer, 0, 3, buffers, offsets);
 	vkCmdBindVertexBuffers(commandBuffer, 0, 1, &vertexBufferPos, offsets);
 	vkCmdBindIndexBuffer(commandBuffer, indexBuffer, 0, VK_INDEX_TYPE_UINT16);
-	vkCmdDrawIndexed(commandBuffer, 6, 1, 0, 0, 0);
+
+	// culled instances (command per LOD)
+	if (culling) {
+		if (bindlessDescriptorSet)
+			vkCmdPushConstants(commandBuffer, pipelineLayout, VK_SHADER_STAGE_FRAGMENT_BIT, 0, sizeof(bindlessConstants), &bindlessConstants);
+		culling->Draw(commandBuffer, 1);
+		return;
+	}
+
+	// indirect (draws share push constants, batches of instanceRing are commands of list)
+	if (drawList) {
+		if (instanceRing)
+			instanceRing->Bind(commandBuffer, 1);
+		if (bindlessDescriptorSet)
+			vkCmdPushConstants(commandBuffer, pipelineLayout, VK_SHADER_STAGE_FRAGMENT_BIT, 0, sizeof(bindlessConstants), &bindlessConstants);
+		drawList->Draw(commandBuffer);
+		return;
+	}
+
+	// instanced (batches are clipped to draw range, so ranges of threads do not overlap)
+	if (instanceRing) {
+		instanceRing->Bind(commandBuffer, 1);
+		for (const auto& batch : instanceRing->mBatches) {
+			uint32_t instanceBegin = std::max(batch.mFirstInstance, drawBegin);
+			uint32_t instanceEnd = std::min(batch.mFirstInstance + batch.mInstanceCount, drawEnd);
+			if (instanceBegin >= instanceEnd)
+				continue;
+			if (bindlessDescriptorSet)
+				vkCmdPushConstants(commandBuffer, pipelineLayout, VK_SHADER_STAGE_FRAGMENT_BIT, 0, sizeof(bindlessConstants), &bindlessConstants);
+			vkCmdDrawIndexed(commandBuffer, 6, instanceEnd - instanceBegin, 0, 0, instanceBegin);
+		}
+		return;
+	}
+
+	for (uint32_t i = drawBegin; i < drawEnd; i++) {
+		if (bindlessDescriptorSet)
+			vkCmdPushConstants(commandBuffer, pipelineLayout, VK_SHADER_STAGE_FRAGMENT_BIT, 0, sizeof(bindlessConstants), &bindlessConstants);
+		vkCmdDrawIndexed(commandBuffer, 6, 1, 0, 0, 0);
+	}
 	//vkCmdDraw(commandBuffer, size, 1, 0, 0);
-	
+}
+
+// FillCommandBuffer (draws are recorded inline when secondaryCommandBuffers is empty)
+void FillCommandBuffer(
+	VkCommandBuffer commandBuffer, VkPipeline graphicsPipeline, VkPipelineLayout pipelineLayout, VkDescriptorSet descriptorSet,
+	VkRenderPass renderPass, VkFramebuffer framebuffer, VkExtent2D extent2D,
+	VkBuffer vertexBufferPos, VkBuffer vertexBufferNorm, VkBuffer vertexBufferTexCoords, VkBuffer indexBuffer, uint32_t size,
+	uint32_t uniformOffset, VkCommandBufferUsageFlags usageFlags, uint32_t drawCount, const std::vector<VkCommandBuffer>& secondaryCommandBuffers,
+	VulkanHelpers::VulkanProfilerInfo& profilerInfo, uint32_t profilerSlot,
+	VkDescriptorSet bindlessDescriptorSet, const CBindlessConstants& bindlessConstants, const VulkanHelpers::VulkanInstanceRingInfo* instanceRing,
+	const VulkanHelpers::VulkanDrawListInfo* drawList, const VulkanHelpers::VulkanCullingInfo* culling,
+	const VulkanHelpers::VulkanRenderQueueInfo* renderQueue)
+{
+	// VkCommandBufferBeginInfo
+	VkCommandBufferBeginInfo commandBufferBeginInfo = {};
+	commandBufferBeginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+	commandBufferBeginInfo.pNext = VK_NULL_HANDLE;
+	commandBufferBeginInfo.flags = usageFlags;
+	commandBufferBeginInfo.pInheritanceInfo = nullptr; // Optional
+	VK_CHECK(vkBeginCommandBuffer(commandBuffer, &commandBufferBeginInfo));
+
+	// timestamp queries of slot are reset before render pass
+	profilerInfo.ResetGpuSlot(commandBuffer, profilerSlot);
+
+	// compute pass culls instances before render pass reads them
+	if (culling) {
+		uint32_t cullingScope = profilerInfo.BeginGpuScope(commandBuffer, profilerSlot, "Culling");
+		culling->Record(commandBuffer);
+		profilerInfo.EndGpuScope(commandBuffer, profilerSlot, cullingScope);
+	}
+
+	// VkClearValue
+	VkClearValue clearColors[2];
+	clearColors[0].color = { 0.0f, 0.125f, 0.3f, 1.0f };
+	clearColors[1].depthStencil.depth = 1.0f;
+	clearColors[1].depthStencil.stencil = 0;
+
+	// VkRenderPassBeginInfo
+	VkRenderPassBeginInfo renderPassBeginInfo = {};
+	renderPassBeginInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
+	renderPassBeginInfo.renderPass = renderPass;
+	renderPassBeginInfo.framebuffer = framebuffer;
+	renderPassBeginInfo.renderArea.offset = { 0, 0 };
+	renderPassBeginInfo.renderArea.extent = extent2D;
+	renderPassBeginInfo.clearValueCount = 2;
+	renderPassBeginInfo.pClearValues = clearColors;
+
+	// GO RENDER
+	uint32_t renderPassScope = profilerInfo.BeginGpuScope(commandBuffer, profilerSlot, "RenderPass");
+	if (secondaryCommandBuffers.empty()) {
+		vkCmdBeginRenderPass(commandBuffer, &renderPassBeginInfo, VK_SUBPASS_CONTENTS_INLINE);
+		RecordDraws(commandBuffer, graphicsPipeline, pipelineLayout, descriptorSet, extent2D, vertexBufferPos, indexBuffer, uniformOffset, 0, drawCount,
+			bindlessDescriptorSet, bindlessConstants, instanceRing, drawList, culling, renderQueue);
+	}
+	else {
+		vkCmdBeginRenderPass(commandBuffer, &renderPassBeginInfo, VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS);
+		vkCmdExecuteCommands(commandBuffer, (uint32_t)secondaryCommandBuffers.size(), secondaryCommandBuffers.data());
+	}
 	vkCmdEndRenderPass(commandBuffer);
+	profilerInfo.EndGpuScope(commandBuffer, profilerSlot, renderPassScope);
 
 	// vkEndCommandBuffer
 	VK_CHECK(vkEndCommandBuffer(commandBuffer));
 }
 
+// GetCopyTransform (copy of model in grid of side * side cells, scaled to size of one cell)
+static DirectX::XMMATRIX GetCopyTransform(uint32_t index, uint32_t side)
+{
+	float scale = 1.0f / side;
+	float x = ((index % side) * 2.0f + 1.0f) * scale - 1.0f;
+	float y = ((index / side) * 2.0f + 1.0f) * scale - 1.0f;
+	return DirectX::XMMatrixScaling(scale, scale, 1.0f) * DirectX::XMMatrixTranslation(x, y, 0.0f);
+}
+
 // loadModelObjFromFile
 bool CAppMain::loadModelObjFromFile(const char * fileName, const char * baseDir)
 {
@@ -155,78 +262,423 @@ bool CAppMain::loadModelObjFromFile(const char * fileName, const char * baseDir)
 	return true;
 }
 
+#ifdef _WIN32
 // Created SL-160225
 void CAppMain::Init(const HWND hWnd)
 {
-	// enabledInstanceLayerNames
-	std::vector<const char *> enabledInstanceLayerNames{
-		"VK_LAYER_LUNARG_standard_validation"
-	};
+	// whole initialization is profiled
+	double initBeginTime = mProfilerInfo.GetTime();
 
-	// enabledInstanceExtensionNames
-	std::vector<const char *> enabledInstanceExtensionNames{
-		VK_EXT_DEBUG_REPORT_EXTENSION_NAME,
-		VK_KHR_WIN32_SURFACE_EXTENSION_NAME,
-		VK_KHR_SURFACE_EXTENSION_NAME,
-	};
+	// instance with surface extensions
+	InitInstance({ VK_KHR_WIN32_SURFACE_EXTENSION_NAME, VK_KHR_SURFACE_EXTENSION_NAME });
+
+	mSurface = VulkanHelpers::CreateSurface(mInstanceInfo.mInstance, hWnd);
+	assert(mSurface);
 
 	// extensions
 	std::vector<const char *> enabledDeviceExtensionNames{
 		VK_KHR_SWAPCHAIN_EXTENSION_NAME
 	};
 
-	// VkPhysicalDeviceFeatures
-	VkPhysicalDeviceFeatures physicalDeviceFeatures{};
-	physicalDeviceFeatures.samplerAnisotropy = VK_TRUE;
+	// present wait is optional (frame pacing falls back to limiter and fences)
+	mPresentWaitFeatures.Query(mInstanceInfo.mPhysicalDeviceGPU, enabledDeviceExtensionNames);
+	// draw count from buffer is optional (multi draw or single indirect draws without it)
+	if (mIndirectDraws)
+		mDrawIndirectFeatures.Query(mInstanceInfo.mPhysicalDeviceGPU, enabledDeviceExtensionNames);
+	// descriptor indexing is optional (bindless mode falls back to material descriptor set)
+	if (mBindless)
+		mDescriptorIndexingFeatures.Query(mInstanceInfo.mPhysicalDeviceGPU, enabledDeviceExtensionNames);
+	InitDevice(enabledDeviceExtensionNames, mDescriptorIndexingFeatures.GetDeviceCreateInfoNext(mPresentWaitFeatures.GetDeviceCreateInfoNext()));
+
+	mSwapchainInfo.mDesiredImageCount = mSwapchainImageCount;
+	mSwapchainInfo.mDesiredPresentMode = mPresentMode;
+	mSwapchainInfo.mPresentIdEnabled = mPresentWaitFeatures.mSupported;
+	mSwapchainInfo.Initialize(mDeviceInfo, mSurface);
+	assert(mSwapchainInfo.mSwapchain);
+	mRenderTarget = &mSwapchainInfo;
+
+	mFramePacingInfo.Initialize(mDeviceInfo);
+	mFramePacingInfo.mMaxFramesAhead = mMaxFramesAhead;
+	SetFrameRateLimit(mFrameRateLimit);
+
+	InitScene();
+	mProfilerInfo.AddCpuScope("Init", initBeginTime, mProfilerInfo.GetTime());
+}
+#endif
+
+// InitHeadless
+void CAppMain::InitHeadless(uint32_t width, uint32_t height, bool readbackEnabled)
+{
+	// whole initialization is profiled
+	double initBeginTime = mProfilerInfo.GetTime();
+
+	// no surface and swapchain extensions, any device (lavapipe too)
+	InitInstance({});
+	// no shader edits in headless runs
+	mShaderHotReload = false;
+	std::vector<const char *> enabledDeviceExtensionNames{};
+	if (mIndirectDraws)
+		mDrawIndirectFeatures.Query(mInstanceInfo.mPhysicalDeviceGPU, enabledDeviceExtensionNames);
+	if (mBindless)
+		mDescriptorIndexingFeatures.Query(mInstanceInfo.mPhysicalDeviceGPU, enabledDeviceExtensionNames);
+	InitDevice(enabledDeviceExtensionNames, mDescriptorIndexingFeatures.GetDeviceCreateInfoNext(nullptr));
+
+	// ring of offscreen images replaces swapchain
+	mOffscreenInfo.Initialize(mDeviceInfo, width, height, mSwapchainImageCount, readbackEnabled);
+	mRenderTarget = &mOffscreenInfo;
+
+	InitScene();
+	mProfilerInfo.AddCpuScope("Init", initBeginTime, mProfilerInfo.GetTime());
+}
+
+// InitInstance
+void CAppMain::InitInstance(const std::vector<const char *>& surfaceExtensionNames)
+{
+	// enabledInstanceLayerNames (skipped when not installed)
+	std::vector<const char *> enabledInstanceLayerNames{
+		"VK_LAYER_LUNARG_standard_validation"
+	};
+
+	// enabledInstanceExtensionNames
+	std::vector<const char *> enabledInstanceExtensionNames{
+		VK_EXT_DEBUG_REPORT_EXTENSION_NAME
+	};
+	enabledInstanceExtensionNames.insert(enabledInstanceExtensionNames.end(), surfaceExtensionNames.begin(), surfaceExtensionNames.end());
 
 	mInstanceInfo.Initialize("Vulkan app", VK_MAKE_VERSION(1, 0, 1), "Vulkan Engine", VK_MAKE_VERSION(1, 0, 1), enabledInstanceLayerNames, enabledInstanceExtensionNames, VK_API_VERSION_1_1);
 	assert(mInstanceInfo.mInstance);
+	assert(mInstanceInfo.mPhysicalDeviceGPU);
+}
 
-	mSurface = VulkanHelpers::CreateSurface(mInstanceInfo.mInstance, hWnd);
-	assert(mSurface);
+// InitDevice
+void CAppMain::InitDevice(std::vector<const char *>& enabledDeviceExtensionNames, const void* pNextFeatures)
+{
+	// VkPhysicalDeviceFeatures (only supported ones)
+	VkPhysicalDeviceFeatures supportedFeatures{};
+	vkGetPhysicalDeviceFeatures(mInstanceInfo.mPhysicalDeviceGPU, &supportedFeatures);
+	VkPhysicalDeviceFeatures physicalDeviceFeatures{};
+	physicalDeviceFeatures.samplerAnisotropy = supportedFeatures.samplerAnisotropy;
+	physicalDeviceFeatures.shaderSampledImageArrayDynamicIndexing = mDescriptorIndexingFeatures.mSupported ? VK_TRUE : VK_FALSE;
+	mDrawIndirectFeatures.EnableFeatures(physicalDeviceFeatures);
 
-	mDeviceInfo.Initialize(mInstanceInfo.mPhysicalDeviceGPU, mSurface, physicalDeviceFeatures, enabledDeviceExtensionNames);
+	mDeviceInfo.Initialize(mInstanceInfo.mPhysicalDeviceGPU, mSurface, physicalDeviceFeatures, enabledDeviceExtensionNames, pNextFeatures);
 	assert(mDeviceInfo.mDevice);
 
-	mSwapchainInfo.Initialize(mDeviceInfo, mSurface);
-	assert(mSwapchainInfo.mSwapchain);
+	// pipeline cache from previous runs (other device or driver data is dropped)
+	mPipelineCacheInfo.mSaveInterval = mPipelineCacheSaveInterval;
+	mPipelineCacheInfo.Initialize(mDeviceInfo, mPipelineCacheFileName);
+	mDeviceInfo.mPipelineCacheInfo = &mPipelineCacheInfo;
+}
+
+// InitScene
+void CAppMain::InitScene()
+{
+	assert(mRenderTarget);
 
-	mPipelineInfo.Initialize(mDeviceInfo, mSwapchainInfo.mRenderPass, "shaders/base.vert.spv", "shaders/base.frag.spv");
+	// profiler slots match uniform slots (frames in flight or cached render target images), uploads are profiled too
+	mProfilerInfo.Initialize(mDeviceInfo, std::max(mFramesInFlight, mRenderTarget->GetImageCount()));
+	mDeviceInfo.mProfilerInfo = &mProfilerInfo;
+
+	// shader modules (embedded or override files)
+	mShaderModuleCacheInfo.Initialize(mDeviceInfo, mShaderOverrideDirectory);
+	const AppShaders::CShaderBlob* shaderBlobVS = AppShaders::FindShader("base.vert.spv");
+	const AppShaders::CShaderBlob* shaderBlobFS = AppShaders::FindShader("base.frag.spv");
+	assert(shaderBlobVS && shaderBlobFS);
+	VkShaderModule shaderModuleVS = mShaderModuleCacheInfo.GetShaderModule(shaderBlobVS->mName, shaderBlobVS->mCode, shaderBlobVS->mSize);
+	VkShaderModule shaderModuleFS = mShaderModuleCacheInfo.GetShaderModule(shaderBlobFS->mName, shaderBlobFS->mCode, shaderBlobFS->mSize);
+	if (mShaderModuleCacheInfo.mOverrideCount)
+		std::cout << mShaderModuleCacheInfo.mOverrideCount << " shaders loaded from " << mShaderOverrideDirectory << std::endl;
+
+	// shader sources watched for hot reload
+	if (mShaderHotReload) {
+		mShaderCompilerInfo.Initialize(mShaderCompilerPath, mShaderCacheDirectory, 1);
+		mShaderCompilerInfo.Watch(mInstancing ? "shaders/instanced.vert.glsl" : "shaders/base.vert.glsl", {});
+		mShaderCompilerInfo.Watch(mDescriptorIndexingFeatures.mSupported ? "shaders/bindless.frag.glsl" : "shaders/base.frag.glsl", {});
+	}
+
+	// pipeline creation time (cold - empty cache, warm - loaded cache)
+	double pipelineBeginTime = mProfilerInfo.GetTime();
+	mPipelineInfo.Initialize(mDeviceInfo, mRenderTarget->mRenderPass, shaderModuleVS, shaderModuleFS);
+	mProfilerInfo.AddCpuScope("PipelineCreate", pipelineBeginTime, mProfilerInfo.GetTime());
+	std::cout << "pipelines created in " << (mProfilerInfo.GetTime() - pipelineBeginTime) / 1000.0 << " ms, "
+		<< (mPipelineCacheInfo.mLoaded ? "warm" : "cold") << " cache (" << mPipelineCacheInfo.mLoadedSize << " bytes loaded)" << std::endl;
 	assert(mPipelineInfo.mDescriptorSetLayout);
 	assert(mPipelineInfo.mPipelineLayout);
 	assert(mPipelineInfo.mPipeline);
 
-	mCommandBuffer = mDeviceInfo.AllocateCommandBuffer(VK_COMMAND_BUFFER_LEVEL_PRIMARY);
-	assert(mCommandBuffer);
+	// model material is compiled in background, base pipeline is its fallback
+	mPipelineStateCacheInfo.Initialize(mDeviceInfo, mPipelineCompileThreadCount);
+	mModelPipelineState = mPipelineInfo.mPipelineState;
+	mModelPipelineLayout = mPipelineInfo.mPipelineLayout;
+	mModelPipeline = mPipelineInfo.mPipeline;
+	mModelShaderNameVS = shaderBlobVS->mName;
+	mModelShaderNameFS = shaderBlobFS->mName;
+
+	// bindless mode and instancing (layout or vertex input differ from base pipeline, so their fallback is compiled now)
+	if (mDescriptorIndexingFeatures.mSupported) {
+		mBindlessTableInfo.Initialize(mDeviceInfo, mDescriptorIndexingFeatures, mBindlessMaxTextureCount, 16, std::max(mFramesInFlight, mRenderTarget->GetImageCount()));
+		mBindlessPipelineLayout = mBindlessTableInfo.CreatePipelineLayout({ mPipelineInfo.mDescriptorSetLayout }, VK_SHADER_STAGE_FRAGMENT_BIT, sizeof(CBindlessConstants));
+		const AppShaders::CShaderBlob* shaderBlobBindlessFS = AppShaders::FindShader("bindless.frag.spv");
+		assert(shaderBlobBindlessFS);
+		mModelPipelineState.mShaderModuleFS = mShaderModuleCacheInfo.GetShaderModule(shaderBlobBindlessFS->mName, shaderBlobBindlessFS->mCode, shaderBlobBindlessFS->mSize);
+		mModelShaderNameFS = shaderBlobBindlessFS->mName;
+		mModelPipelineState.mPipelineLayout = mBindlessPipelineLayout;
+		mModelPipelineLayout = mBindlessPipelineLayout;
+		std::cout << "bindless textures: " << mBindlessTableInfo.mMaxTextureCount << " slots" << std::endl;
+	}
+	if (mInstancing) {
+		// base vertex input and instance binding 1 (locations 3-6)
+		std::vector<VkVertexInputBindingDescription> vertexBindings(mModelPipelineState.mVertexBindings, mModelPipelineState.mVertexBindings + mModelPipelineState.mVertexBindingCount);
+		std::vector<VkVertexInputAttributeDescription> vertexAttributes(mModelPipelineState.mVertexAttributes, mModelPipelineState.mVertexAttributes + mModelPipelineState.mVertexAttributeCount);
+		VkVertexInputBindingDescription instanceBinding{};
+		VulkanHelpers::VulkanInstanceRingInfo::GetVertexInputDescriptions(1, 3, instanceBinding, vertexAttributes);
+		vertexBindings.push_back(instanceBinding);
+		mModelPipelineState.SetVertexInput(vertexBindings, vertexAttributes);
+		const AppShaders::CShaderBlob* shaderBlobInstancedVS = AppShaders::FindShader("instanced.vert.spv");
+		assert(shaderBlobInstancedVS);
+		mModelPipelineState.mShaderModuleVS = mShaderModuleCacheInfo.GetShaderModule(shaderBlobInstancedVS->mName, shaderBlobInstancedVS->mCode, shaderBlobInstancedVS->mSize);
+		mModelShaderNameVS = shaderBlobInstancedVS->mName;
+	}
+	if (mDescriptorIndexingFeatures.mSupported || mInstancing)
+		mModelPipeline = mPipelineStateCacheInfo.GetPipelineSync(mModelPipelineState);
 
-	mImageAvailableSemaphore = mDeviceInfo.CreateSemaphore();
-	assert(mImageAvailableSemaphore);
+	// material variant
+	if (mAlphaBlend)
+		mModelPipelineState.SetAlphaBlend();
+	mModelPipelineState.SetSpecializationConstant(SPEC_BASE_USE_TEXTURE, (uint32_t)(mUseTexture ? VK_TRUE : VK_FALSE));
+	mModelPipelineState.SetSpecializationConstant(SPEC_BASE_USE_VERTEX_COLOR, (uint32_t)(mUseVertexColor ? VK_TRUE : VK_FALSE));
 
-	mRenderFinishedSemaphore = mDeviceInfo.CreateSemaphore();
-	assert(mRenderFinishedSemaphore);
+	mFrameRingInfo.Initialize(mDeviceInfo, mFramesInFlight);
+	assert(mFrameRingInfo.GetFramesInFlight() == mFramesInFlight);
+
+	mCommandCacheInfo.Initialize(mDeviceInfo, mRenderTarget->GetImageCount());
+
+	// worker threads for command recording (calling thread only waits)
+	mThreadPool.Initialize(mRecordThreadCount ? mRecordThreadCount : std::max(std::thread::hardware_concurrency(), 1u));
+	mParallelRecordInfo.Initialize(mDeviceInfo, mThreadPool, mFramesInFlight);
+	mRenderQueueInfo.Initialize(mThreadPool);
+	mTransformHierarchyInfo.Initialize(mThreadPool);
+	mModelNode = mTransformHierarchyInfo.AddNode(VulkanHelpers::VULKAN_TRANSFORM_INVALID, DirectX::XMMatrixIdentity());
 
 	mSampler = mDeviceInfo.CreateSampler(VK_FILTER_LINEAR, VK_SAMPLER_ADDRESS_MODE_REPEAT);
 	assert(mSampler);
 
 	// LoadImageFromFile
-	AppUtils::LoadImageFromFile(mDeviceInfo, "./textures/texture.png", mModelImage, mModelImageMemory, mModelImageView);
+	VkImageCreateInfo modelImageCreateInfo{};
+	// (alias bit keeps memory contents valid for image recreated over moved region by defragmentation)
+	AppUtils::LoadImageFromFile(mDeviceInfo, "./textures/texture.png", mModelImage, mModelImageMemory, mModelImageView, modelImageCreateInfo, VK_IMAGE_CREATE_ALIAS_BIT);
 	//AppUtils::LoadMeshesFromObjFile(mDeviceInfo, "./textures/texture.png", mModelImage, mModelImageMemory, mModelImageView);
 
 	// loadModelObjFromFile("./models/tea.obj", "./models");
 	mDeviceInfo.CreateBuffer(vertices, sizeof(vertices), VK_BUFFER_USAGE_VERTEX_BUFFER_BIT, mModelVertexBufferPos, mModelVertexMemoryPos);
 	mDeviceInfo.CreateBuffer(indexes, sizeof(indexes), VK_BUFFER_USAGE_INDEX_BUFFER_BIT, mModelIndexBuffer, mModelIndexMemory);
-	mDeviceInfo.CreateBuffer(&mWVP, sizeof(mWVP), VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT, mModelUniformMVP, mModelUniformMemoryMVP);
 
-	// bind data
-	// mPipelineInfo.BindImageView(0, mModelImageView, mSampler);
-	mPipelineInfo.BindImageView(0, mModelImageView, mSampler);
-	mPipelineInfo.BindUnifromBuffer(1, mModelUniformMVP);
+	// defragmentation (16 MB or 64 allocations per frame)
+	mDefragmentationInfo.Initialize(mDeviceInfo, 16 * 1024 * 1024, 64);
+
+	// uniform, instance and indirect rings (cached command buffers bake slot of their swapchain image, so there must be a slot per image too)
+	InitFrameSlots(std::max(mFramesInFlight, mRenderTarget->GetImageCount()));
+	if (mCullingInfo.mOutputBuffer)
+		std::cout << "gpu culling: " << (mCullingInfo.mSubgroupCompaction ? "subgroup" : "atomic") << " compaction" << std::endl;
+	// CPU culling of instances otherwise (main thread dispatches ranges to workers, bounds of copies do not change)
+	else if (mInstancing && mCpuCulling) {
+		mFrustumCullingInfo.Initialize(mThreadPool);
+		mFrustumCullingInfo.Resize(mDrawCount);
+		DirectX::XMFLOAT3 localMin{}, localMax{};
+		VulkanHelpers::VulkanBounds::GetLocalBounds(vertices, (uint32_t)(sizeof(vertices) / sizeof(vertices[0])), sizeof(vertices[0]), localMin, localMax);
+		uint32_t side = (uint32_t)std::ceil(std::sqrt((float)mDrawCount));
+		for (uint32_t i = 0; i < mDrawCount; i++) {
+			VulkanHelpers::VulkanBounds bounds{};
+			bounds.SetTransformed(localMin, localMax, GetCopyTransform(i, side));
+			mFrustumCullingInfo.SetBounds(i, bounds);
+		}
+		std::cout << "cpu culling: " << (mFrustumCullingInfo.mAvx2 ? "AVX2" : "scalar") << std::endl;
+	}
+
+	// bind data (material sets are allocated from growable pools and cached by resources)
+	mDescriptorCacheInfo.Initialize(mDeviceInfo, mFramesInFlight);
+	mDescriptorCacheInfo.RegisterLayout(mPipelineInfo.mDescriptorSetLayout, mPipelineInfo.GetDescriptorSetLayoutBindings());
+	UpdateModelDescriptorSet();
+	if (mDescriptorIndexingFeatures.mSupported) {
+		mModelTextureIndex = mBindlessTableInfo.RegisterTexture(mModelImageView);
+		mModelSamplerIndex = mBindlessTableInfo.RegisterSampler(mSampler);
+		assert(mModelTextureIndex != VulkanHelpers::VULKAN_BINDLESS_INVALID_INDEX);
+		assert(mModelSamplerIndex != VulkanHelpers::VULKAN_BINDLESS_INVALID_INDEX);
+	}
+
+	// defragmentation (moved handles and rewritten descriptors invalidate cached command buffers)
+	mDefragmentationInfo.RegisterBuffer(mModelVertexBufferPos, mModelVertexMemoryPos, sizeof(vertices), VK_BUFFER_USAGE_VERTEX_BUFFER_BIT, [this]() {
+		mCommandCacheInfo.Invalidate();
+	});
+	mDefragmentationInfo.RegisterBuffer(mModelIndexBuffer, mModelIndexMemory, sizeof(indexes), VK_BUFFER_USAGE_INDEX_BUFFER_BIT, [this]() {
+		mCommandCacheInfo.Invalidate();
+	});
+	mDefragmentationInfo.RegisterImage(mModelImage, mModelImageView, mModelImageMemory, modelImageCreateInfo,
+		VK_FORMAT_R8G8B8A8_UNORM, VK_IMAGE_ASPECT_COLOR_BIT, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, [this]() {
+		UpdateModelDescriptorSet();
+		// moved image gets new slot, frames in flight still read old one
+		if (mDescriptorIndexingFeatures.mSupported) {
+			mBindlessTableInfo.UnregisterTexture(mModelTextureIndex);
+			mModelTextureIndex = mBindlessTableInfo.RegisterTexture(mModelImageView);
+		}
+		mCommandCacheInfo.Invalidate();
+	});
+}
+
+// InitFrameSlots (rings with slot per frame in flight or cached render target image, uniform buffer is rewritten every frame, so it is not defragmented)
+void CAppMain::InitFrameSlots(uint32_t slotCount)
+{
+	// uniform buffer slots (dynamic offsets must be aligned)
+	VkDeviceSize uniformAlignment = mDeviceInfo.mDeviceProperties.limits.minUniformBufferOffsetAlignment;
+	mModelUniformSlotSize = (sizeof(mWVP) + uniformAlignment - 1) / uniformAlignment * uniformAlignment;
+	mModelUniformSlotCount = slotCount;
+	mDeviceInfo.CreateBuffer(mModelUniformSlotSize * mModelUniformSlotCount, VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT, VulkanHelpers::VULKAN_MEMORY_ACCESS_DYNAMIC, mModelUniformMVP, mModelUniformMemoryMVP);
+
+	// instances (slots match uniform slots)
+	if (mInstancing)
+		mInstanceRingInfo.Initialize(mDeviceInfo, std::max(mDrawCount, 1u), mModelUniformSlotCount);
+	// GPU culling of instances (slots match uniform slots, one LOD of quad, instances smaller than pixel are culled)
+	if (mInstancing && mGpuCulling) {
+		const AppShaders::CShaderBlob* shaderBlobCull = AppShaders::FindShader("cull.comp.spv");
+		const AppShaders::CShaderBlob* shaderBlobCullSubgroup = AppShaders::FindShader("cull_subgroup.comp.spv");
+		assert(shaderBlobCull && shaderBlobCullSubgroup);
+		VulkanHelpers::VulkanCullLod cullLod{};
+		cullLod.mIndexCount = 6;
+		cullLod.mMinScreenSize = 1.0f / mRenderTarget->mViewportHeight;
+		mCullingInfo.Initialize(mDeviceInfo,
+			mShaderModuleCacheInfo.GetShaderModule(shaderBlobCull->mName, shaderBlobCull->mCode, shaderBlobCull->mSize),
+			mShaderModuleCacheInfo.GetShaderModule(shaderBlobCullSubgroup->mName, shaderBlobCullSubgroup->mCode, shaderBlobCullSubgroup->mSize),
+			&cullLod, 1, std::max(mDrawCount, 1u), mModelUniformSlotCount);
+	}
+	// indirect draw list (slots match uniform slots, batches of instances need non zero first instance)
+	if (mIndirectDraws && !mCullingInfo.mOutputBuffer && (!mInstancing || mDeviceInfo.mEnabledFeatures.drawIndirectFirstInstance))
+		mDrawListInfo.Initialize(mDeviceInfo, std::max(mDrawCount, 1u), mModelUniformSlotCount);
+}
+
+// DeInitFrameSlots (slots must not be in use by GPU)
+void CAppMain::DeInitFrameSlots()
+{
+	vmaDestroyBuffer(mDeviceInfo.mAllocator, mModelUniformMVP, mModelUniformMemoryMVP);
+	mModelUniformMVP = VK_NULL_HANDLE;
+	mModelUniformMemoryMVP = VK_NULL_HANDLE;
+	mModelUniformSlotCount = 0;
+	mInstanceRingInfo.DeInitialize();
+	mDrawListInfo.DeInitialize();
+	mCullingInfo.DeInitialize();
+}
+
+// UpdateModelDescriptorSet (new set for moved resources, set with old handles is evicted and freed after frames in flight)
+void CAppMain::UpdateModelDescriptorSet()
+{
+	if (mModelDescriptorSet) {
+		mDescriptorCacheInfo.Evict(mModelDescriptorSet);
+		mRenderQueueInfo.UnregisterMaterial(mModelDescriptorSet);
+	}
+	const VulkanHelpers::VulkanDescriptorData descriptorData[] = {
+		VulkanHelpers::VulkanDescriptorData::Image(mModelImageView, mSampler),           // binding 0 - texture
+		VulkanHelpers::VulkanDescriptorData::Buffer(mModelUniformMVP, 0, sizeof(mWVP)),  // binding 1 - dynamic buffer
+	};
+	mModelDescriptorSet = mDescriptorCacheInfo.GetDescriptorSet(mPipelineInfo.mDescriptorSetLayout, descriptorData, (uint32_t)(sizeof(descriptorData) / sizeof(descriptorData[0])));
+	assert(mModelDescriptorSet);
+}
+
+// UpdateInstances (copies of model in grid, scaled to size of one model, culled on GPU when culling is initialized,
+// otherwise only copies visible by CPU culling are written)
+void CAppMain::UpdateInstances(uint32_t slot)
+{
+	// bounding sphere of quad
+	const float sphere[4] = { 0.0f, 0.0f, 0.0f, 1.41421356f };
+	const bool culling = mCullingInfo.mOutputBuffer != VK_NULL_HANDLE;
+	const bool cpuCulling = !culling && mFrustumCullingInfo.GetObjectCount();
+
+	// visible copies (batch sizes baked by cached command buffers change with their count)
+	uint32_t instanceCount = mDrawCount;
+	if (cpuCulling) {
+		VulkanHelpers::VulkanCpuScope scope(mProfilerInfo, "Culling");
+		uint32_t lastVisibleCount = mFrustumCullingInfo.GetVisibleCount();
+		mFrustumCullingInfo.Cull(mWVP);
+		instanceCount = mFrustumCullingInfo.GetVisibleCount();
+		if ((instanceCount != lastVisibleCount) && !mDrawListInfo.mBuffer)
+			mCommandCacheInfo.Invalidate();
+	}
+
+	uint32_t side = (uint32_t)std::ceil(std::sqrt((float)mDrawCount));
+	if (culling)
+		mCullingInfo.Begin(slot);
+	else
+		mInstanceRingInfo.Begin(slot);
+	for (uint32_t k = 0; k < instanceCount; k++) {
+		// VulkanInstanceData
+		uint32_t i = cpuCulling ? mFrustumCullingInfo.GetVisibleIndices()[k] : k;
+		VulkanHelpers::VulkanInstanceData instance{};
+		instance.SetTransform(GetCopyTransform(i, side));
+		instance.mParams[0] = instance.mParams[1] = instance.mParams[2] = instance.mParams[3] = 1.0f;
+		// all copies share mesh and material, so they are one batch
+		if (culling)
+			mCullingInfo.Add(instance, sphere);
+		else
+			mInstanceRingInfo.Add(VulkanHelpers::VulkanInstanceBatchKey{}, instance);
+	}
+	if (culling)
+		mCullingInfo.End(mWVP, mProjScale);
+	else
+		mInstanceRingInfo.End();
+}
+
+// UpdateDrawList (command per instance batch or per copy of model)
+void CAppMain::UpdateDrawList(uint32_t slot)
+{
+	mDrawListInfo.Begin(slot);
+	if (mInstancing) {
+		for (const auto& batch : mInstanceRingInfo.mBatches)
+			mDrawListInfo.Add(6, batch.mInstanceCount, 0, 0, batch.mFirstInstance);
+	}
+	else {
+		for (uint32_t i = 0; i < mDrawCount; i++)
+			mDrawListInfo.Add(6, 1, 0, 0, 0);
+	}
+	mDrawListInfo.End();
+}
+
+// UpdateRenderQueue (packet per copy of model, blended copies are in pass after opaque one and sorted back to front)
+void CAppMain::UpdateRenderQueue(uint32_t uniformOffset)
+{
+	// bindless pipeline reads texture and sampler slots from push constants
+	CBindlessConstants bindlessConstants{ mModelTextureIndex, mModelSamplerIndex };
+	bool bindless = mBindlessTableInfo.mDescriptorSet != VK_NULL_HANDLE;
+	uint32_t pipelineId = mRenderQueueInfo.RegisterPipeline(mModelPipeline, mModelPipelineLayout,
+		bindless ? VK_SHADER_STAGE_FRAGMENT_BIT : 0, bindless ? sizeof(bindlessConstants) : 0);
+	uint32_t materialId = mRenderQueueInfo.RegisterMaterial(mModelDescriptorSet);
+
+	// copies share transform, so clip w of model origin is view depth of all
+	uint32_t depthBucket = VulkanHelpers::VulkanSortKey::QuantizeDepth(DirectX::XMVectorGetW(mWVP.r[3]));
+	uint64_t key = VulkanHelpers::VulkanSortKey::Make(mAlphaBlend ? 1 : 0, pipelineId, materialId, depthBucket, mAlphaBlend);
+
+	// VulkanDrawPayload
+	VulkanHelpers::VulkanDrawPayload payload{};
+	payload.mVertexBuffer = mModelVertexBufferPos;
+	payload.mIndexBuffer = mModelIndexBuffer;
+	payload.mIndexType = VK_INDEX_TYPE_UINT16;
+	payload.mIndexCount = 6;
+	payload.mUniformOffset = uniformOffset;
+	memcpy(payload.mConstants, &bindlessConstants, sizeof(bindlessConstants));
+
+	mRenderQueueInfo.Clear();
+	for (uint32_t i = 0; i < mDrawCount; i++)
+		mRenderQueueInfo.Add(key, payload);
+	mRenderQueueInfo.Sort();
 }
 
 // Created SL-160225
 void CAppMain::Destroy()
 {
-	vmaDestroyBuffer(mDeviceInfo.mAllocator, mModelUniformMVP, mModelUniformMemoryMVP);
+	mFrameRingInfo.WaitIdle();
+	mDefragmentationInfo.DeInitialize();
+	mFramePacingInfo.DeInitialize();
+	mDeviceInfo.mProfilerInfo = nullptr;
+	mProfilerInfo.DeInitialize();
+	DeInitFrameSlots();
+	mFrustumCullingInfo.DeInitialize();
 	vkDestroyImageView(mDeviceInfo.mDevice, mModelImageView, VK_NULL_HANDLE);
 	vmaDestroyImage(mDeviceInfo.mAllocator, mModelImage, mModelImageMemory);
 	vmaDestroyBuffer(mDeviceInfo.mAllocator, mModelIndexBuffer, mModelIndexMemory);
@@ -235,11 +687,26 @@ void CAppMain::Destroy()
 	vmaDestroyBuffer(mDeviceInfo.mAllocator, mModelVertexBufferPos, mModelVertexMemoryPos);
 	
 	vkDestroySampler(mDeviceInfo.mDevice, mSampler, VK_NULL_HANDLE);
-	vkDestroySemaphore(mDeviceInfo.mDevice, mRenderFinishedSemaphore, VK_NULL_HANDLE);
-	vkDestroySemaphore(mDeviceInfo.mDevice, mImageAvailableSemaphore, VK_NULL_HANDLE);
+	mParallelRecordInfo.DeInitialize();
+	mRenderQueueInfo.DeInitialize();
+	mTransformHierarchyInfo.DeInitialize();
+	mThreadPool.DeInitialize();
+	mCommandCacheInfo.DeInitialize();
+	mFrameRingInfo.DeInitialize();
+	mShaderCompilerInfo.DeInitialize();
+	mPipelineStateCacheInfo.DeInitialize();
+	mDescriptorCacheInfo.DeInitialize();
+	if (mBindlessPipelineLayout)
+		vkDestroyPipelineLayout(mDeviceInfo.mDevice, mBindlessPipelineLayout, VK_NULL_HANDLE);
+	mBindlessPipelineLayout = VK_NULL_HANDLE;
+	mBindlessTableInfo.DeInitialize();
 	mPipelineInfo.DeInitialize();
-	mSwapchainInfo.DeInitialize();
-	vkDestroySurfaceKHR(mInstanceInfo.mInstance, mSurface, VK_NULL_HANDLE);
+	mShaderModuleCacheInfo.DeInitialize();
+	mDeviceInfo.mPipelineCacheInfo = nullptr;
+	mPipelineCacheInfo.DeInitialize();
+	mRenderTarget->DeInitialize();
+	if (mSurface)
+		vkDestroySurfaceKHR(mInstanceInfo.mInstance, mSurface, VK_NULL_HANDLE);
 	mDeviceInfo.DeInitialize();
 	mInstanceInfo.DeInitialize();
 }
@@ -247,66 +714,319 @@ void CAppMain::Destroy()
 // Created SL-160225
 void CAppMain::Render()
 {
-	// begin frame
-	VkFramebuffer framebuffer = mSwapchainInfo.BeginFrame(mImageAvailableSemaphore);
+	// frame timing (GPU results of older frames are collected when their slot is reused)
+	mProfilerInfo.BeginFrame(mFrameRingInfo.mFrameNumber);
+	uint64_t frameNumber = mFrameRingInfo.mFrameNumber;
+
+	// frame pacing (present wait and frame rate limit)
+	{
+		VulkanHelpers::VulkanCpuScope scope(mProfilerInfo, "Pacing");
+		if (mRenderTarget == &mSwapchainInfo)
+			mFramePacingInfo.WaitForFrame(mSwapchainInfo);
+	}
+
+	// begin frame (waits only for the frame being reused)
+	double acquireBeginTime = mProfilerInfo.GetTime();
+	VulkanHelpers::VulkanFrameInfo& frame = mFrameRingInfo.BeginFrame();
+	VkFramebuffer framebuffer = VK_NULL_HANDLE;
+	VkResult acquireResult = mRenderTarget->BeginFrame(frame.mImageAvailableSemaphore, framebuffer);
+
+	// out of date swapchain has no image, frame is skipped (frame fence stays signaled, ring does not advance)
+	if (acquireResult == VK_ERROR_OUT_OF_DATE_KHR) {
+		RecreateRenderTarget();
+		mProfilerInfo.EndFrame();
+		return;
+	}
 
 	// VkExtent2D
 	VkExtent2D extend2d;
-	extend2d.height = mSwapchainInfo.mViewportHeight;
-	extend2d.width = mSwapchainInfo.mViewportWidth;
+	extend2d.height = mRenderTarget->mViewportHeight;
+	extend2d.width = mRenderTarget->mViewportWidth;
+
+	// previous frame rendered to this image must be finished (its command buffer and uniform slot are reused)
+	uint32_t imageIndex = mRenderTarget->mCurrentFramebufferIndex;
+	mFrameRingInfo.WaitImage(imageIndex, mRenderTarget->GetImageCount());
+	mProfilerInfo.AddCpuScope("Acquire", acquireBeginTime, mProfilerInfo.GetTime());
+
+	// update MVP uniform buffer slot (persistently mapped, no staging)
+	uint32_t uniformSlot = mUseCommandCache ? imageIndex : mFrameRingInfo.mFrameIndex;
+	uint32_t uniformOffset = (uint32_t)(mModelUniformSlotSize * uniformSlot);
+	mDeviceInfo.WriteBuffer(&mWVP, uniformOffset, sizeof(mWVP), mModelUniformMVP, mModelUniformMemoryMVP);
+
+	// instances of slot (same slot as uniforms, finished by GPU now), culled instances are drawn from culling outputs
+	const VulkanHelpers::VulkanInstanceRingInfo* instanceRing = nullptr;
+	const VulkanHelpers::VulkanCullingInfo* culling = mCullingInfo.mOutputBuffer ? &mCullingInfo : nullptr;
+	if (mInstancing) {
+		VulkanHelpers::VulkanCpuScope scope(mProfilerInfo, "Instances");
+		UpdateInstances(uniformSlot);
+		instanceRing = culling ? nullptr : &mInstanceRingInfo;
+	}
+
+	// indirect commands of slot (one submission, instance batches are written above)
+	const VulkanHelpers::VulkanDrawListInfo* drawList = nullptr;
+	if (mDrawListInfo.mBuffer) {
+		VulkanHelpers::VulkanCpuScope scope(mProfilerInfo, "DrawList");
+		UpdateDrawList(uniformSlot);
+		drawList = &mDrawListInfo;
+	}
+
+	// timestamps of slot are from its previous submit, which is finished now
+	mProfilerInfo.CollectGpuSlot(uniformSlot);
+
+	// model pipeline (previous one until compiled, cached command buffers baked the old one, frames in flight keep it)
+	ApplyShaderReloads();
+	VkPipeline modelPipeline = mPipelineStateCacheInfo.GetPipeline(mModelPipelineState, mModelPipeline);
+	if (modelPipeline != mModelPipeline) {
+		mRenderQueueInfo.UnregisterPipeline(mModelPipeline);
+		mPipelineStateCacheInfo.RetirePipeline(mModelPipeline, mFrameRingInfo.mDeletionQueue, mFrameRingInfo.mFrameNumber);
+		mModelPipeline = modelPipeline;
+		mCommandCacheInfo.Invalidate();
+	}
 
-	// update MVP uniform buffer
-	mDeviceInfo.WriteBuffer(&mWVP, sizeof(mWVP), mModelUniformMVP, mModelUniformMemoryMVP);
+	// bindless table (slots unregistered by older frames are reused)
+	VkDescriptorSet bindlessDescriptorSet = mBindlessTableInfo.mDescriptorSet;
+	CBindlessConstants bindlessConstants{ mModelTextureIndex, mModelSamplerIndex };
+	if (bindlessDescriptorSet)
+		mBindlessTableInfo.NextFrame();
+	// material sets evicted by older frames are freed
+	mDescriptorCacheInfo.NextFrame();
 
-	// refill command buffer (RENDER CURRENT FRAME TO CURRENT FRAME BUFFER)
-	FillCommandBuffer(mCommandBuffer, mPipelineInfo.mPipeline, mPipelineInfo.mPipelineLayout, mPipelineInfo.mDescriptorSet,
-		mSwapchainInfo.mRenderPass, framebuffer, extend2d, 
-		mModelVertexBufferPos, mModelVertexBufferNorm, mModelVertexBufferTexCoord, mModelIndexBuffer, mVertexCount);
+	// sorted packets of separate draws (only when they are recorded, cached command buffers baked their packets)
+	const VulkanHelpers::VulkanRenderQueueInfo* renderQueue = nullptr;
+	if (mRenderQueue && !mInstancing && !drawList) {
+		if (!mUseCommandCache || !mCommandCacheInfo.IsValid(imageIndex)) {
+			VulkanHelpers::VulkanCpuScope scope(mProfilerInfo, "RenderQueue");
+			UpdateRenderQueue(uniformOffset);
+		}
+		renderQueue = &mRenderQueueInfo;
+	}
+
+	// cached command buffer of this image is re-recorded only when generation changed
+	double recordBeginTime = mProfilerInfo.GetTime();
+	VkCommandBuffer commandBuffer = frame.mCommandBuffer;
+	if (mUseCommandCache) {
+		commandBuffer = mCommandCacheInfo.GetCommandBuffer(imageIndex);
+		if (!mCommandCacheInfo.IsValid(imageIndex)) {
+			FillCommandBuffer(commandBuffer, mModelPipeline, mModelPipelineLayout, mModelDescriptorSet,
+				mRenderTarget->mRenderPass, framebuffer, extend2d,
+				mModelVertexBufferPos, mModelVertexBufferNorm, mModelVertexBufferTexCoord, mModelIndexBuffer, mVertexCount,
+				uniformOffset, 0, mDrawCount, {}, mProfilerInfo, uniformSlot, bindlessDescriptorSet, bindlessConstants, instanceRing, drawList, culling, renderQueue);
+			mCommandCacheInfo.MarkRecorded(imageIndex);
+		}
+	}
+	else {
+		// record draw ranges on worker threads (draw list and culled instances are one range)
+		const std::vector<VkCommandBuffer>& secondaryCommandBuffers = mParallelRecordInfo.Record(
+			mFrameRingInfo.mFrameIndex, mRenderTarget->mRenderPass, 0, framebuffer, (drawList || culling) ? 1 : mDrawCount,
+			[&](VkCommandBuffer secondaryCommandBuffer, uint32_t drawBegin, uint32_t drawEnd) {
+			VulkanHelpers::VulkanCpuScope scope(mProfilerInfo, "RecordDraws");
+			RecordDraws(secondaryCommandBuffer, mModelPipeline, mModelPipelineLayout, mModelDescriptorSet, extend2d,
+				mModelVertexBufferPos, mModelIndexBuffer, uniformOffset, drawBegin, drawEnd, bindlessDescriptorSet, bindlessConstants, instanceRing, drawList, culling, renderQueue);
+		});
+
+		// refill command buffer (RENDER CURRENT FRAME TO CURRENT FRAME BUFFER)
+		FillCommandBuffer(commandBuffer, mModelPipeline, mModelPipelineLayout, mModelDescriptorSet,
+			mRenderTarget->mRenderPass, framebuffer, extend2d,
+			mModelVertexBufferPos, mModelVertexBufferNorm, mModelVertexBufferTexCoord, mModelIndexBuffer, mVertexCount,
+			uniformOffset, VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT, mDrawCount, secondaryCommandBuffers, mProfilerInfo, uniformSlot,
+			bindlessDescriptorSet, bindlessConstants, instanceRing, drawList, culling, renderQueue);
+	}
+	mProfilerInfo.AddCpuScope("Record", recordBeginTime, mProfilerInfo.GetTime());
 
 	// submit render command buffer
-	VulkanHelpers::QueueSubmit(mDeviceInfo.mQueueGraphics, mCommandBuffer, mImageAvailableSemaphore, mRenderFinishedSemaphore);
+	{
+		VulkanHelpers::VulkanCpuScope scope(mProfilerInfo, "Submit");
+		mFrameRingInfo.EndFrame(mDeviceInfo.mQueueGraphics, VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT, commandBuffer);
+		mProfilerInfo.SubmitGpuSlot(uniformSlot, frameNumber);
+	}
 
 	// end frame
-	mSwapchainInfo.EndFrame(mRenderFinishedSemaphore);
+	{
+		VulkanHelpers::VulkanCpuScope scope(mProfilerInfo, "Present");
+		VkResult presentResult = mRenderTarget->EndFrame(frame.mRenderFinishedSemaphore);
+		if ((acquireResult == VK_SUBOPTIMAL_KHR) || (presentResult == VK_SUBOPTIMAL_KHR) || (presentResult == VK_ERROR_OUT_OF_DATE_KHR))
+			RecreateRenderTarget();
+	}
+
+	// bounded defragmentation pass (copies follow submitted frames on graphics queue, old handles are retired)
+	if (!mDefragmentationInfo.IsIdle()) {
+		VulkanHelpers::VulkanCpuScope scope(mProfilerInfo, "Defragmentation");
+		mDefragmentationInfo.Update(mFrameRingInfo.mDeletionQueue, mFrameRingInfo.mFrameNumber);
+	}
+	mProfilerInfo.EndFrame();
 }
 
 // Created SL-160225
 void CAppMain::Update(float deltaTime)
 {
+	VulkanHelpers::VulkanCpuScope scope(mProfilerInfo, "Update");
+
+	// periodic pipeline cache save (only when pipelines were added)
+	mPipelineCacheInfo.Update();
+
+	// changed shader sources are queued for compilation
+	if (mShaderHotReload)
+		mShaderCompilerInfo.Update();
+
 	static float time = 0.0f;
 	static uint32_t frames = 0;
 	time += deltaTime;
 	frames++;
 	if (time >= 1.0f) {
 		std::cout << "frames " << frames << " in " << time << " seconds" << std::endl;
+		if (mUseCommandCache)
+			std::cout << "command buffers recorded: " << mCommandCacheInfo.mRecordCount << std::endl;
+		else
+			std::cout << "recorded " << mDrawCount << " draws on " << mThreadPool.GetThreadCount() << " threads in "
+				<< mParallelRecordInfo.mLastRecordTime << " ms" << std::endl;
+		if (mRenderQueueInfo.GetCount())
+			std::cout << "render queue: " << mRenderQueueInfo.GetCount() << " packets sorted in " << mRenderQueueInfo.mLastSortTime
+				<< " ms (" << mRenderQueueInfo.mLastSortPasses << " passes)" << std::endl;
+		if (mTransformHierarchyInfo.mLastUpdatedCount)
+			std::cout << "transforms: " << mTransformHierarchyInfo.mLastUpdatedCount << " of " << mTransformHierarchyInfo.GetNodeCount()
+				<< " updated in " << mTransformHierarchyInfo.mLastUpdateTime << " ms" << std::endl;
+		if (mFrustumCullingInfo.GetObjectCount())
+			std::cout << "cpu culling: " << mFrustumCullingInfo.GetVisibleCount() << " of " << mFrustumCullingInfo.GetObjectCount()
+				<< " visible in " << mFrustumCullingInfo.mLastCullTime << " ms" << std::endl;
+		if (mRenderTarget == &mSwapchainInfo)
+			std::cout << "pacing: " << mSwapchainInfo.GetImageCount() << " images, present mode " << mSwapchainInfo.GetPresentMode()
+				<< ", present wait " << mFramePacingInfo.mLastPresentWaitTime << " ms, limiter wait "
+				<< mFramePacingInfo.mLastLimiterWaitTime << " ms" << std::endl;
+		VulkanHelpers::VulkanProfileStats cpuStats = mProfilerInfo.GetFrameStats(false);
+		VulkanHelpers::VulkanProfileStats gpuStats = mProfilerInfo.GetFrameStats(true);
+		std::cout << "cpu frame ms: p50 " << cpuStats.mP50 << ", p95 " << cpuStats.mP95 << ", p99 " << cpuStats.mP99 << ", max " << cpuStats.mMax << std::endl;
+		if (gpuStats.mCount)
+			std::cout << "gpu frame ms: p50 " << gpuStats.mP50 << ", p95 " << gpuStats.mP95 << ", p99 " << gpuStats.mP99 << ", max " << gpuStats.mMax << std::endl;
+		VulkanHelpers::VulkanPipelineStateCacheStats pipelineStats = mPipelineStateCacheInfo.GetStats();
+		std::cout << "pipelines: " << pipelineStats.mCompiledCount << " compiled (max " << pipelineStats.mMaxCompileTime << " ms), " << pipelineStats.mFailedCount << " failed, "
+			<< mPipelineStateCacheInfo.GetPendingCount() << " pending, " << pipelineStats.mMissCount << " fallback frames" << std::endl;
+		std::cout << "pipeline variants: " << mModelShaderNameVS << " " << mPipelineStateCacheInfo.GetVariantCount(mModelPipelineState.mShaderModuleVS)
+			<< ", " << mModelShaderNameFS << " " << mPipelineStateCacheInfo.GetVariantCount(mModelPipelineState.mShaderModuleFS) << std::endl;
+		if (mDefragmentationInfo.mStats.mPassCount)
+			std::cout << "defragmentation: " << mDefragmentationInfo.mStats.mAllocationsMoved << " moved, "
+				<< mDefragmentationInfo.mStats.mBytesFreed << " bytes freed, "
+				<< mDefragmentationInfo.mStats.mLastPassTime << " ms last pass, "
+				<< mDefragmentationInfo.mStats.mMaxPassTime << " ms max pass" << std::endl;
 		time = 0.0f;
 		frames = 0;
 	}
 
-	// mat world
+	// mat world (local of model node, world matrices of changed subtrees are propagated)
 	static float angle = 0.0f;
 	DirectX::XMMATRIX matRotate = DirectX::XMMatrixRotationZ(angle += deltaTime);
 	DirectX::XMMATRIX matScale = DirectX::XMMatrixScaling(1.0f, 1.0f, 1.0f);
 	DirectX::XMMATRIX matTranslate = DirectX::XMMatrixTranslation(0.0f, 0.0f, 0.0f);
-	DirectX::XMMATRIX matWorld = matRotate * matScale * matTranslate;
+	mTransformHierarchyInfo.SetLocal(mModelNode, matRotate * matScale * matTranslate);
+	mTransformHierarchyInfo.Update();
 
-	// mat view
-	DirectX::XMMATRIX matView = DirectX::XMMatrixLookAtRH(
-		DirectX::XMVectorSet(0.0f, 0.0f, 10.0f, 1.0f), // the camera position
-		DirectX::XMVectorSet(0.0f, 0.0f, 0.0f, 1.0f),  // the look-at position
-		DirectX::XMVectorSet(0.0f, 1.0f, 0.0f, 1.0f)   // the up direction
-	);
-
-	// mat projection
-	DirectX::XMMATRIX matProj = DirectX::XMMatrixPerspectiveFovRH(DirectX::XMConvertToRadians(45.0f), (FLOAT)mSwapchainInfo.mViewportWidth / mSwapchainInfo.mViewportHeight, 1.0f, 1000.0f);
+	// mat view and projection (only when camera or viewport changed)
+	if (mCameraChanged || (mCameraViewportWidth != mRenderTarget->mViewportWidth) || (mCameraViewportHeight != mRenderTarget->mViewportHeight)) {
+		DirectX::XMMATRIX matView = DirectX::XMMatrixLookAtRH(
+			DirectX::XMVectorSet(mCameraPosition.x, mCameraPosition.y, mCameraPosition.z, 1.0f), // the camera position
+			DirectX::XMVectorSet(mCameraTarget.x, mCameraTarget.y, mCameraTarget.z, 1.0f),       // the look-at position
+			DirectX::XMVectorSet(mCameraUp.x, mCameraUp.y, mCameraUp.z, 1.0f)                    // the up direction
+		);
+		DirectX::XMMATRIX matProj = DirectX::XMMatrixPerspectiveFovRH(DirectX::XMConvertToRadians(mCameraFov), (float)mRenderTarget->mViewportWidth / mRenderTarget->mViewportHeight, mCameraNear, mCameraFar);
+		mViewProj = matView * matProj;
+		// projection scale gives projected sizes for LOD selection
+		mProjScale = DirectX::XMVectorGetY(matProj.r[1]);
+		mCameraViewportWidth = mRenderTarget->mViewportWidth;
+		mCameraViewportHeight = mRenderTarget->mViewportHeight;
+		mCameraChanged = false;
+	}
 
 	// WorldViewProjection
-	mWVP = matWorld * matView * matProj;
+	mWVP = mTransformHierarchyInfo.GetWorld(mModelNode) * mViewProj;
 }
 
 // Created SL-160225
-void CAppMain::SetViewportSize(WORD viewportWidth, WORD viewportHeight)
+void CAppMain::SetViewportSize(uint32_t viewportWidth, uint32_t viewportHeight)
 {
-	VK_CHECK(vkQueueWaitIdle(mDeviceInfo.mQueuePresent));
-	mSwapchainInfo.ReInitialize(mDeviceInfo, mSurface);
+	// minimized window has no surface extent
+	if ((viewportWidth == 0) || (viewportHeight == 0))
+		return;
+
+	// swapchain must match new surface extent, offscreen images are resized to given size
+	mOffscreenInfo.mDesiredWidth = viewportWidth;
+	mOffscreenInfo.mDesiredHeight = viewportHeight;
+	RecreateRenderTarget();
 };
+
+// RecreateRenderTarget
+void CAppMain::RecreateRenderTarget()
+{
+	// old swapchain resources are retired, frames in flight keep rendering (submitted defragmentation pass must end before new allocations)
+	mDefragmentationInfo.Finish();
+	mRenderTarget->Recreate(mFrameRingInfo.mDeletionQueue, mFrameRingInfo.mFrameNumber);
+
+	// more images than slots (cached command buffers bake slot of their image), rings and GPU profiler slots are reallocated
+	uint32_t imageCount = mRenderTarget->GetImageCount();
+	if (imageCount > mModelUniformSlotCount) {
+		mFrameRingInfo.WaitIdle();
+		DeInitFrameSlots();
+		InitFrameSlots(imageCount);
+		mProfilerInfo.ResizeGpuSlots(imageCount);
+		mBindlessTableInfo.SetFrameCount(imageCount);
+		UpdateModelDescriptorSet();
+	}
+
+	// framebuffers changed, cached command buffers must be recorded again
+	mCommandCacheInfo.Resize(imageCount);
+	mCommandCacheInfo.Invalidate();
+}
+
+// SetPresentMode
+void CAppMain::SetPresentMode(VkPresentModeKHR presentMode)
+{
+	// unsupported modes fall back to FIFO
+	mPresentMode = presentMode;
+	mSwapchainInfo.mDesiredPresentMode = presentMode;
+	if (mRenderTarget == &mSwapchainInfo)
+		RecreateRenderTarget();
+}
+
+// ApplyShaderReloads
+void CAppMain::ApplyShaderReloads()
+{
+	// recompiled shaders replace modules of model state at frame boundary, frames in flight keep old pipeline
+	for (const auto& result : mShaderCompilerInfo.TakeResults()) {
+		if (!result.mSuccess) {
+			std::cout << "shader reload failed: " << result.mSourceFileName << std::endl << result.mLog << std::endl;
+			continue;
+		}
+		VkShaderModule shaderModule = mShaderModuleCacheInfo.GetShaderModule(result.mCode.data(), result.mCode.size() * sizeof(uint32_t));
+		if (result.mStage == VK_SHADER_STAGE_VERTEX_BIT) {
+			mModelPipelineState.mShaderModuleVS = shaderModule;
+			mModelShaderNameVS = result.mSourceFileName;
+		}
+		else if (result.mStage == VK_SHADER_STAGE_FRAGMENT_BIT) {
+			mModelPipelineState.mShaderModuleFS = shaderModule;
+			mModelShaderNameFS = result.mSourceFileName;
+		}
+		std::cout << "shader reloaded: " << result.mSourceFileName << (result.mCacheHit ? " (cached)" : "") << std::endl;
+	}
+}
+
+// ReadFrame
+bool CAppMain::ReadFrame(std::vector<uint8_t>& pixels, uint32_t& width, uint32_t& height)
+{
+	// only offscreen images with readback can be read
+	if (mRenderTarget != &mOffscreenInfo)
+		return false;
+	width = mOffscreenInfo.mViewportWidth;
+	height = mOffscreenInfo.mViewportHeight;
+	return mOffscreenInfo.ReadImage(mOffscreenInfo.mCurrentFramebufferIndex, pixels);
+}
+
+// ExportProfile
+bool CAppMain::ExportProfile(const char* fileName) const
+{
+	return mProfilerInfo.ExportChromeTrace(fileName);
+}
+
+// SetFrameRateLimit
+void CAppMain::SetFrameRateLimit(double frameRateLimit)
+{
+	mFrameRateLimit = frameRateLimit;
+	mFramePacingInfo.mTargetFrameTime = (frameRateLimit > 0.0) ? 1.0 / frameRateLimit : 0.0;
+}
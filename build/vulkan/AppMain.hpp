@@ -2,6 +2,25 @@
 
 #include <DirectXMath.h>
 #include "AppUtils.hpp"
+#include "vkutils/VulkanDefragmentation.hpp"
+#include "vkutils/VulkanFrameRing.hpp"
+#include "vkutils/VulkanCommandCache.hpp"
+#include "vkutils/VulkanParallelRecord.hpp"
+#include "vkutils/VulkanFramePacing.hpp"
+#include "vkutils/VulkanProfiler.hpp"
+#include "vkutils/VulkanOffscreen.hpp"
+#include "vkutils/VulkanPipelineCache.hpp"
+#include "vkutils/VulkanPipelineStateCache.hpp"
+#include "vkutils/VulkanShaderModuleCache.hpp"
+#include "vkutils/VulkanShaderCompiler.hpp"
+#include "vkutils/VulkanDescriptors.hpp"
+#include "vkutils/VulkanBindless.hpp"
+#include "vkutils/VulkanInstancing.hpp"
+#include "vkutils/VulkanDrawList.hpp"
+#include "vkutils/VulkanCulling.hpp"
+#include "vkutils/VulkanFrustumCulling.hpp"
+#include "vkutils/VulkanRenderQueue.hpp"
+#include "vkutils/VulkanTransformHierarchy.hpp"
 
 // created SL-160225
 class CAppMain
@@ -11,22 +30,101 @@ private:
 	VulkanHelpers::VulkanInstanceInfo  mInstanceInfo;
 	VulkanHelpers::VulkanDeviceInfo    mDeviceInfo;
 	VulkanHelpers::VulkanSwapchainInfo mSwapchainInfo;
+	VulkanHelpers::VulkanOffscreenInfo mOffscreenInfo;
 	VulkanHelpers::VulkanPipelineInfo  mPipelineInfo;
+	VulkanHelpers::VulkanDefragmentationInfo mDefragmentationInfo;
+	VulkanHelpers::VulkanFrameRingInfo mFrameRingInfo;
+	VulkanHelpers::VulkanCommandCacheInfo mCommandCacheInfo;
+	VulkanHelpers::VulkanParallelRecordInfo mParallelRecordInfo;
+	VulkanHelpers::VulkanFramePacingInfo mFramePacingInfo;
+	VulkanHelpers::VulkanPresentWaitFeatures mPresentWaitFeatures;
+	VulkanHelpers::VulkanProfilerInfo mProfilerInfo;
+	VulkanHelpers::VulkanPipelineCacheInfo mPipelineCacheInfo;
+	VulkanHelpers::VulkanPipelineStateCacheInfo mPipelineStateCacheInfo;
+	VulkanHelpers::VulkanShaderModuleCacheInfo mShaderModuleCacheInfo;
+	VulkanHelpers::VulkanShaderCompilerInfo mShaderCompilerInfo;
+	VulkanHelpers::VulkanDescriptorCacheInfo mDescriptorCacheInfo;
+	VulkanHelpers::VulkanDescriptorIndexingFeatures mDescriptorIndexingFeatures;
+	VulkanHelpers::VulkanBindlessTableInfo mBindlessTableInfo;
+	VulkanHelpers::VulkanInstanceRingInfo mInstanceRingInfo;
+	VulkanHelpers::VulkanDrawIndirectFeatures mDrawIndirectFeatures;
+	VulkanHelpers::VulkanDrawListInfo mDrawListInfo;
+	VulkanHelpers::VulkanCullingInfo mCullingInfo;
+	VulkanHelpers::VulkanFrustumCullingInfo mFrustumCullingInfo;
+	VulkanHelpers::VulkanRenderQueueInfo mRenderQueueInfo;
+	VulkanHelpers::VulkanTransformHierarchyInfo mTransformHierarchyInfo;
+
+	// frames are rendered to swapchain or offscreen images (headless)
+	VulkanHelpers::VulkanRenderTargetInfo* mRenderTarget = nullptr;
+
+	// command recording workers
+	CThreadPool mThreadPool;
+
+	// frames CPU can record ahead of GPU (2 or 3)
+	uint32_t mFramesInFlight = 2;
+
+	// frame pacing: swapchain (or offscreen) images, present mode (FIFO, MAILBOX or IMMEDIATE),
+	// frame rate limit (0 - unlimited) and presents CPU can be ahead of display (needs VK_KHR_present_wait)
+	uint32_t         mSwapchainImageCount = 3;
+	VkPresentModeKHR mPresentMode = VK_PRESENT_MODE_MAILBOX_KHR;
+	double           mFrameRateLimit = 0.0;
+	uint32_t         mMaxFramesAhead = 1;
+
+	// pipeline cache file (loaded at device init, saved on exit and every mPipelineCacheSaveInterval seconds when changed)
+	const char* mPipelineCacheFileName = "pipeline_cache.bin";
+	double      mPipelineCacheSaveInterval = 30.0;
+
+	// shaders are embedded, .spv files of this directory override them (edited shaders without rebuild)
+	const char* mShaderOverrideDirectory = "shaders/override/";
+
+	// shader hot reload (saved GLSL sources are compiled in background, SPIR-V is cached by content),
+	// windowed app only, headless runs keep it off (no compiler processes during measured frames)
+	bool        mShaderHotReload = true;
+#ifdef _WIN32
+	const char* mShaderCompilerPath = "shaders/glslangValidator.exe";
+#else
+	// Vulkan SDK or distribution package on PATH
+	const char* mShaderCompilerPath = "glslangValidator";
+#endif
+	const char* mShaderCacheDirectory = "shaders/cache/";
+
+	// pipeline compilation threads (0 - pipelines are compiled when first drawn, frame hitches)
+	uint32_t mPipelineCompileThreadCount = 1;
+
+	// bindless textures (needs VK_EXT_descriptor_indexing, otherwise material descriptor set is used)
+	bool     mBindless = true;
+	uint32_t mBindlessMaxTextureCount = 4096;
+
+	// reuse recorded command buffer per swapchain image (static scene, only uniforms change)
+	bool mUseCommandCache = true;
+
+	// draws per frame and recording threads (0 - one per core), used when command cache is off
+	uint32_t mDrawCount = 1;
+	// copies of model are instances of one draw call (per instance transforms), otherwise mDrawCount draw calls
+	bool     mInstancing = true;
+	// draws are indirect commands of persistently mapped buffer, submitted by one call (count from buffer when supported)
+	bool     mIndirectDraws = true;
+	// instances are culled against frustum by compute pass, which writes their indirect commands (instancing only)
+	bool     mGpuCulling = true;
+	// otherwise instances are culled against frustum on CPU (SIMD ranges on thread pool workers, dispatched from UpdateInstances on main thread) before they are written
+	bool     mCpuCulling = true;
+	// separate draws are packets sorted by key (pass, pipeline, material, depth), recorded with binds only on state changes
+	bool     mRenderQueue = true;
+	uint32_t mRecordThreadCount = 0;
 
 	// vulkan handlers
 	VkSurfaceKHR          mSurface = VK_NULL_HANDLE;
-	VkCommandBuffer       mCommandBuffer = VK_NULL_HANDLE;
-	VkSemaphore           mImageAvailableSemaphore = VK_NULL_HANDLE;
-	VkSemaphore           mRenderFinishedSemaphore = VK_NULL_HANDLE;
 
 	// texture
 	VkImage          mModelImage = VK_NULL_HANDLE;
 	VmaAllocation    mModelImageMemory = VK_NULL_HANDLE;
 	VkImageView      mModelImageView = VK_NULL_HANDLE;
 	VkSampler        mSampler = VK_NULL_HANDLE;
-	// uniforms
+	// uniforms (one aligned slot per frame in flight or cached render target image)
 	VkBuffer         mModelUniformMVP = VK_NULL_HANDLE;
 	VmaAllocation    mModelUniformMemoryMVP = VK_NULL_HANDLE;
+	VkDeviceSize     mModelUniformSlotSize = 0;
+	uint32_t         mModelUniformSlotCount = 0;
 	// vertex
 	VkBuffer         mModelVertexBufferPos = VK_NULL_HANDLE;
 	VkBuffer         mModelVertexBufferNorm = VK_NULL_HANDLE;
@@ -39,21 +137,76 @@ private:
 	VmaAllocation    mModelIndexMemory = VK_NULL_HANDLE;
 	// vertex count
 	uint32_t         mVertexCount = 0;
+	// material (variant of base pipeline by blend state and specialization constants, previous pipeline draws until it is compiled)
+	bool                               mAlphaBlend = false;
+	bool                               mUseTexture = true;
+	bool                               mUseVertexColor = false;
+	VulkanHelpers::VulkanPipelineState mModelPipelineState{};
+	VkPipeline                         mModelPipeline = VK_NULL_HANDLE;
+	// shaders of model state (embedded blob or reloaded source, variant report)
+	std::string                        mModelShaderNameVS{};
+	std::string                        mModelShaderNameFS{};
+	// material resources (cached set, same texture and buffer share it)
+	VkDescriptorSet                    mModelDescriptorSet = VK_NULL_HANDLE;
+	// bindless mode (texture and sampler are slots of table, pipeline layout has bindless set and push constants)
+	VkPipelineLayout                   mBindlessPipelineLayout = VK_NULL_HANDLE;
+	VkPipelineLayout                   mModelPipelineLayout = VK_NULL_HANDLE;
+	uint32_t                           mModelTextureIndex = VulkanHelpers::VULKAN_BINDLESS_INVALID_INDEX;
+	uint32_t                           mModelSamplerIndex = VulkanHelpers::VULKAN_BINDLESS_INVALID_INDEX;
 
-	// scene variables
+	// scene variables (model is root node of transform hierarchy)
 	DirectX::XMMATRIX mWVP;
+	float             mProjScale = 1.0f;
+	uint32_t          mModelNode = VulkanHelpers::VULKAN_TRANSFORM_INVALID;
+
+	// camera (view and projection are recomputed when mCameraChanged is set or viewport size changes)
+	DirectX::XMFLOAT3 mCameraPosition = DirectX::XMFLOAT3(0.0f, 0.0f, 10.0f);
+	DirectX::XMFLOAT3 mCameraTarget = DirectX::XMFLOAT3(0.0f, 0.0f, 0.0f);
+	DirectX::XMFLOAT3 mCameraUp = DirectX::XMFLOAT3(0.0f, 1.0f, 0.0f);
+	float             mCameraFov = 45.0f; // degrees
+	float             mCameraNear = 1.0f;
+	float             mCameraFar = 1000.0f;
+	bool              mCameraChanged = true;
+	DirectX::XMMATRIX mViewProj;                // cached view * projection
+	uint32_t          mCameraViewportWidth = 0;
+	uint32_t          mCameraViewportHeight = 0;
 private:
 	bool loadModelObjFromFile(const char * fileName, const char * baseDir);
+	void InitInstance(const std::vector<const char *>& surfaceExtensionNames);
+	void InitDevice(std::vector<const char *>& enabledDeviceExtensionNames, const void* pNextFeatures);
+	void InitScene();
+	void InitFrameSlots(uint32_t slotCount);
+	void DeInitFrameSlots();
+	void RecreateRenderTarget();
+	void ApplyShaderReloads();
+	void UpdateModelDescriptorSet();
+	void UpdateInstances(uint32_t slot);
+	void UpdateDrawList(uint32_t slot);
+	void UpdateRenderQueue(uint32_t uniformOffset);
 public:
 	CAppMain() {};
 	virtual ~CAppMain() {};
 
 	// main functions
+#ifdef _WIN32
 	void Init(const HWND hWnd);
+#endif
+	// InitHeadless (no surface and swapchain, frames are rendered to ring of offscreen images)
+	void InitHeadless(uint32_t width, uint32_t height, bool readbackEnabled);
 	void Destroy();
 	void Render();
 	void Update(float deltaTime);
 
+	// frame pacing functions (can be changed at runtime)
+	void SetPresentMode(VkPresentModeKHR presentMode);
+	void SetFrameRateLimit(double frameRateLimit);
+
+	// profiling functions
+	bool ExportProfile(const char* fileName) const;
+
+	// ReadFrame (headless with readback: pixels of last rendered frame, 4 bytes per pixel BGRA)
+	bool ReadFrame(std::vector<uint8_t>& pixels, uint32_t& width, uint32_t& height);
+
 	// SetViewportSize
-	void SetViewportSize(WORD viewportWidth, WORD viewportHeight);
+	void SetViewportSize(uint32_t viewportWidth, uint32_t viewportHeight);
 };
\ No newline at end of file
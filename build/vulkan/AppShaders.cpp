@@ -0,0 +1,31 @@
+#include "AppShaders.hpp"
+#include <cstring>
+
+// generated by shaders/EmbedShaders.cmake at pre-build (alignas(16) constexpr uint32_t arrays, word aligned as vkCreateShaderModule requires)
+#include "shaders/base.vert.spv.h"
+#include "shaders/base.frag.spv.h"
+#include "shaders/instanced.vert.spv.h"
+#include "shaders/bindless.frag.spv.h"
+#include "shaders/cull.comp.spv.h"
+#include "shaders/cull_subgroup.comp.spv.h"
+
+namespace AppShaders {
+	// embedded shaders
+	static const CShaderBlob SHADER_BLOBS[] = {
+		{ "base.vert.spv", SHADER_BASE_VERT, sizeof(SHADER_BASE_VERT) },
+		{ "base.frag.spv", SHADER_BASE_FRAG, sizeof(SHADER_BASE_FRAG) },
+		{ "bindless.frag.spv", SHADER_BINDLESS_FRAG, sizeof(SHADER_BINDLESS_FRAG) },
+		{ "cull.comp.spv", SHADER_CULL_COMP, sizeof(SHADER_CULL_COMP) },
+		{ "cull_subgroup.comp.spv", SHADER_CULL_SUBGROUP_COMP, sizeof(SHADER_CULL_SUBGROUP_COMP) },
+		{ "instanced.vert.spv", SHADER_INSTANCED_VERT, sizeof(SHADER_INSTANCED_VERT) },
+	};
+
+	// FindShader
+	const CShaderBlob* FindShader(const char* name)
+	{
+		for (const auto& shaderBlob : SHADER_BLOBS)
+			if (strcmp(shaderBlob.mName, name) == 0)
+				return &shaderBlob;
+		return nullptr;
+	}
+}
@@ -0,0 +1,17 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+
+namespace AppShaders {
+	// CShaderBlob (SPIR-V embedded at build time by shaders/EmbedShaders.cmake, name matches .spv file name)
+	struct CShaderBlob
+	{
+		const char*     mName;
+		const uint32_t* mCode;
+		size_t          mSize; // bytes
+	};
+
+	// FindShader (nullptr - shader is not embedded)
+	const CShaderBlob* FindShader(const char* name);
+}
@@ -3,26 +3,100 @@
 #include "utils/tiny_obj_loader.h"
 
 #include <iostream>
+#include <cassert>
+#include <algorithm>
+
+// GenerateMipChain (box filter, appends mips 1..N after mip 0 of one RGBA8 layer)
+static void GenerateMipChain(const unsigned char* data, uint32_t width, uint32_t height, uint32_t mipLevels, std::vector<unsigned char>& mipChain)
+{
+	// copy mip 0
+	mipChain.insert(mipChain.end(), data, data + (size_t)width * height * 4);
+
+	// each next level is filtered from previous one
+	for (uint32_t mipLevel = 1; mipLevel < mipLevels; mipLevel++)
+	{
+		uint32_t srcWidth = std::max(width >> (mipLevel - 1), 1u);
+		uint32_t srcHeight = std::max(height >> (mipLevel - 1), 1u);
+		uint32_t dstWidth = std::max(width >> mipLevel, 1u);
+		uint32_t dstHeight = std::max(height >> mipLevel, 1u);
+		size_t srcOffset = mipChain.size() - (size_t)srcWidth * srcHeight * 4;
+		mipChain.resize(mipChain.size() + (size_t)dstWidth * dstHeight * 4);
+		const unsigned char* src = mipChain.data() + srcOffset;
+		unsigned char* dst = mipChain.data() + srcOffset + (size_t)srcWidth * srcHeight * 4;
+		for (uint32_t y = 0; y < dstHeight; y++)
+			for (uint32_t x = 0; x < dstWidth; x++)
+			{
+				uint32_t x0 = std::min(x * 2, srcWidth - 1), x1 = std::min(x * 2 + 1, srcWidth - 1);
+				uint32_t y0 = std::min(y * 2, srcHeight - 1), y1 = std::min(y * 2 + 1, srcHeight - 1);
+				for (uint32_t c = 0; c < 4; c++)
+					dst[(y * dstWidth + x) * 4 + c] = (unsigned char)((
+						src[(y0 * srcWidth + x0) * 4 + c] + src[(y0 * srcWidth + x1) * 4 + c] +
+						src[(y1 * srcWidth + x0) * 4 + c] + src[(y1 * srcWidth + x1) * 4 + c] + 2) / 4);
+			}
+	}
+}
 
 // LoadImageFromFile
-bool AppUtils::LoadImageFromFile(VulkanHelpers::VulkanDeviceInfo& deviceInfo, const char* fileName, VkImage& image, VmaAllocation& allocation, VkImageView& imageView)
+bool AppUtils::LoadImageFromFile(VulkanHelpers::VulkanDeviceInfo& deviceInfo, const char* fileName, VkImage& image, VmaAllocation& allocation, VkImageView& imageView, VkImageCreateInfo& imageCreateInfo, VkImageCreateFlags createFlags)
 {
-	// load image data
-	int x, y, n;
-	unsigned char *data = stbi_load(fileName, &x, &y, &n, 4);
-	assert(data);
+	return LoadImageArrayFromFiles(deviceInfo, { fileName }, false, image, allocation, imageView, imageCreateInfo, createFlags);
+}
+
+// LoadImageArrayFromFiles
+bool AppUtils::LoadImageArrayFromFiles(VulkanHelpers::VulkanDeviceInfo& deviceInfo, const std::vector<const char*>& fileNames, bool cube, VkImage& image, VmaAllocation& allocation, VkImageView& imageView, VkImageCreateInfo& imageCreateInfo, VkImageCreateFlags createFlags)
+{
+	// check layers count
+	assert(fileNames.size());
+	assert(!cube || (fileNames.size() % 6 == 0));
+
+	// load all layers with full mip chain (all layers must have same size)
+	int width = 0, height = 0;
+	uint32_t mipLevels = 0;
+	std::vector<unsigned char> imageData{};
+	for (const char* fileName : fileNames)
+	{
+		// load image data
+		int x, y, n;
+		unsigned char *data = stbi_load(fileName, &x, &y, &n, 4);
+		if (!data)
+			return false;
+
+		// first layer defines image size
+		if (mipLevels == 0) {
+			width = x;
+			height = y;
+			mipLevels = VulkanHelpers::GetMipLevelsCount(width, height);
+			imageData.reserve((size_t)VulkanHelpers::GetImageDataSize(width, height, mipLevels, (uint32_t)fileNames.size(), VK_FORMAT_R8G8B8A8_SNORM));
+		}
+		assert((x == width) && (y == height));
+
+		// generate mips
+		GenerateMipChain(data, width, height, mipLevels, imageData);
+
+		// free image data
+		stbi_image_free(data);
+	}
+
+	// image parameters
+	uint32_t arrayLayers = (uint32_t)fileNames.size();
+	VkImageCreateFlags flags = createFlags | (cube ? VK_IMAGE_CREATE_CUBE_COMPATIBLE_BIT : 0);
+	VkImageViewType viewType = VK_IMAGE_VIEW_TYPE_2D;
+	if (cube)
+		viewType = arrayLayers > 6 ? VK_IMAGE_VIEW_TYPE_CUBE_ARRAY : VK_IMAGE_VIEW_TYPE_CUBE;
+	else if (arrayLayers > 1)
+		viewType = VK_IMAGE_VIEW_TYPE_2D_ARRAY;
 
-	// create image
-	deviceInfo.CreateImage(data, x, y, VK_FORMAT_R8G8B8A8_SNORM, VK_IMAGE_USAGE_SAMPLED_BIT, image, allocation);
+	// create image (all mips and layers are uploaded by one copy)
+	deviceInfo.CreateImage(imageData.data(), width, height, mipLevels, arrayLayers, VK_FORMAT_R8G8B8A8_SNORM, VK_IMAGE_USAGE_SAMPLED_BIT, flags, image, allocation);
 	assert(image);
 	assert(allocation);
 
 	// create image view
-	imageView = deviceInfo.CreateImageView(image, VK_FORMAT_R8G8B8A8_UNORM, VK_IMAGE_ASPECT_COLOR_BIT);
+	imageView = deviceInfo.CreateImageView(image, viewType, VK_FORMAT_R8G8B8A8_UNORM, VK_IMAGE_ASPECT_COLOR_BIT, mipLevels, arrayLayers);
 	assert(imageView);
 
-	// free image data
-	stbi_image_free(data);
+	// store image parameters
+	imageCreateInfo = VulkanHelpers::InitImageCreateInfo(width, height, mipLevels, arrayLayers, VK_FORMAT_R8G8B8A8_SNORM, VK_IMAGE_USAGE_SAMPLED_BIT, flags);
 	return true;
 }
 
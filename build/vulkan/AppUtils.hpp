@@ -3,8 +3,12 @@
 #include "vkutils/vkmesh.hpp"
 
 namespace AppUtils {
-	// LoadTextureFromFile (this function ALWAYS create VK_FORMAT_R8G8B8A8_SNORM texture)
-	bool LoadImageFromFile(VulkanHelpers::VulkanDeviceInfo& deviceInfo, const char* fileName, VkImage& image, VmaAllocation& allocation, VkImageView& imageView);
+	// LoadTextureFromFile (this function ALWAYS create VK_FORMAT_R8G8B8A8_SNORM texture with full mip chain, imageCreateInfo receives parameters of created image,
+	// createFlags are added to image flags, VK_IMAGE_CREATE_ALIAS_BIT for images registered for defragmentation)
+	bool LoadImageFromFile(VulkanHelpers::VulkanDeviceInfo& deviceInfo, const char* fileName, VkImage& image, VmaAllocation& allocation, VkImageView& imageView, VkImageCreateInfo& imageCreateInfo, VkImageCreateFlags createFlags = 0);
+
+	// LoadImageArrayFromFiles (one layer per file with generated mip chain, cube == true makes cube map array from groups of 6 faces +X,-X,+Y,-Y,+Z,-Z)
+	bool LoadImageArrayFromFiles(VulkanHelpers::VulkanDeviceInfo& deviceInfo, const std::vector<const char*>& fileNames, bool cube, VkImage& image, VmaAllocation& allocation, VkImageView& imageView, VkImageCreateInfo& imageCreateInfo, VkImageCreateFlags createFlags = 0);
 
 	// LoadMeshesFromObjFile (this function ALWAYS create VK_FORMAT_R8G8B8A8_SNORM texture)
 	bool LoadMeshesFromObjFile(VulkanHelpers::VulkanDeviceInfo& deviceInfo, const char* filePath, const char* baseDir, std::vector<VulkanMeshObj *>& meshes);
@@ -25,6 +25,20 @@ LRESULT CALLBACK WndProc(HWND hWnd, UINT message, WPARAM wParam, LPARAM lParam)
 	case WM_KEYDOWN:
 		if (wParam == VK_ESCAPE)
 			PostQuitMessage(0);
+		// frame pacing: F1 - FIFO, F2 - MAILBOX, F3 - IMMEDIATE, F4 - 60 fps limit, F5 - unlimited
+		if (wParam == VK_F1)
+			appMain.SetPresentMode(VK_PRESENT_MODE_FIFO_KHR);
+		if (wParam == VK_F2)
+			appMain.SetPresentMode(VK_PRESENT_MODE_MAILBOX_KHR);
+		if (wParam == VK_F3)
+			appMain.SetPresentMode(VK_PRESENT_MODE_IMMEDIATE_KHR);
+		if (wParam == VK_F4)
+			appMain.SetFrameRateLimit(60.0);
+		if (wParam == VK_F5)
+			appMain.SetFrameRateLimit(0.0);
+		// profiling: F6 - export Chrome trace
+		if (wParam == VK_F6)
+			appMain.ExportProfile("profile.json");
 		break;
 	case WM_CLOSE:
 		PostQuitMessage(0);
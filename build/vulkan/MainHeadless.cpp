@@ -0,0 +1,69 @@
+#include <string>
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include "AppMain.hpp"
+
+// headless entry point for machines without display (any Vulkan device, lavapipe too)
+// usage: vulkan_headless [frames] [width] [height] [output.ppm]
+
+// WriteImagePPM (BGRA pixels to binary PPM)
+static bool WriteImagePPM(const char* fileName, const std::vector<uint8_t>& pixels, uint32_t width, uint32_t height)
+{
+	std::ofstream file(fileName, std::ios::out | std::ios::binary | std::ios::trunc);
+	if (!file.is_open())
+		return false;
+	file << "P6\n" << width << " " << height << "\n255\n";
+	for (size_t i = 0; i < (size_t)width * height; i++)
+	{
+		const uint8_t* pixel = &pixels[i * 4];
+		char rgb[3] = { (char)pixel[2], (char)pixel[1], (char)pixel[0] };
+		file.write(rgb, 3);
+	}
+	return file.good();
+}
+
+// main
+int main(int argc, char* argv[])
+{
+	// arguments
+	uint32_t frameCount = (argc > 1) ? (uint32_t)std::stoul(argv[1]) : 100;
+	uint32_t width = (argc > 2) ? (uint32_t)std::stoul(argv[2]) : 1280;
+	uint32_t height = (argc > 3) ? (uint32_t)std::stoul(argv[3]) : 720;
+	const char* outputFileName = (argc > 4) ? argv[4] : nullptr;
+
+	// application main class
+	CAppMain appMain;
+	appMain.InitHeadless(width, height, outputFileName != nullptr);
+
+	// get time stamps
+	auto prevTimePoint = std::chrono::high_resolution_clock::now();
+	auto nextTimePoint = std::chrono::high_resolution_clock::now();
+
+	// main loop
+	for (uint32_t i = 0; i < frameCount; i++)
+	{
+		// get current time stamps
+		prevTimePoint = nextTimePoint;
+		nextTimePoint = std::chrono::high_resolution_clock::now();
+		float delta = std::chrono::duration_cast<std::chrono::duration<float>>(nextTimePoint - prevTimePoint).count();
+
+		appMain.Update(delta);
+		appMain.Render();
+	}
+
+	// read back last frame
+	int result = 0;
+	if (outputFileName)
+	{
+		std::vector<uint8_t> pixels;
+		if (!appMain.ReadFrame(pixels, width, height) || !WriteImagePPM(outputFileName, pixels, width, height))
+		{
+			std::cerr << "failed to write " << outputFileName << std::endl;
+			result = 1;
+		}
+	}
+
+	appMain.Destroy();
+	return result;
+}
@@ -0,0 +1,55 @@
+# EmbedShaders.cmake
+# compiles GLSL sources of shaders directory to SPIR-V and writes C++ headers with embedded code,
+# script mode, so MSBuild pre-build events and CMake custom commands run same steps on every platform:
+#   cmake -DGLSLANG=<glslangValidator> -DSOURCE_DIR=<shaders> -DOUTPUT_DIR=<output> -P EmbedShaders.cmake
+# outputs are written only when their source changed (name.spv and name.spv.h with alignas(16) constexpr array)
+
+if(NOT GLSLANG OR NOT SOURCE_DIR OR NOT OUTPUT_DIR)
+	message(FATAL_ERROR "EmbedShaders.cmake: GLSLANG, SOURCE_DIR and OUTPUT_DIR must be set")
+endif()
+file(MAKE_DIRECTORY "${OUTPUT_DIR}")
+
+# EmbedShader (output name, array name, source, extra glslangValidator arguments)
+function(EmbedShader name arrayName source)
+	set(sourcePath "${SOURCE_DIR}/${source}")
+	set(spvPath "${OUTPUT_DIR}/${name}")
+	set(headerPath "${OUTPUT_DIR}/${name}.h")
+	if(EXISTS "${headerPath}" AND NOT "${sourcePath}" IS_NEWER_THAN "${headerPath}")
+		return()
+	endif()
+
+	# compile to temporary file (projects building in parallel never see partial outputs)
+	string(RANDOM LENGTH 8 suffix)
+	execute_process(
+		COMMAND "${GLSLANG}" -V ${ARGN} "${sourcePath}" -o "${spvPath}.${suffix}.tmp"
+		RESULT_VARIABLE result
+		OUTPUT_VARIABLE log
+		ERROR_VARIABLE log)
+	if(NOT result EQUAL 0)
+		file(REMOVE "${spvPath}.${suffix}.tmp")
+		message(FATAL_ERROR "EmbedShaders.cmake: ${source} failed to compile\n${log}")
+	endif()
+
+	# little endian words of SPIR-V, 8 per line
+	file(READ "${spvPath}.${suffix}.tmp" hex HEX)
+	string(REGEX REPLACE "(..)(..)(..)(..)" "0x\\4\\3\\2\\1, " words "${hex}")
+	set(word "0x[0-9a-f]+, ")
+	string(REGEX REPLACE "(${word}${word}${word}${word}${word}${word}${word}${word})" "\\1\n\t" words "${words}")
+	string(REGEX REPLACE " \n" "\n" words "${words}")
+	string(REGEX REPLACE "[ \t\n]+$" "" words "${words}")
+	file(WRITE "${headerPath}.${suffix}.tmp"
+		"// generated by EmbedShaders.cmake from ${source}, do not edit\n"
+		"#pragma once\n\n"
+		"alignas(16) constexpr uint32_t ${arrayName}[] = {\n\t${words}\n};\n")
+	file(RENAME "${spvPath}.${suffix}.tmp" "${spvPath}")
+	file(RENAME "${headerPath}.${suffix}.tmp" "${headerPath}")
+	message(STATUS "EmbedShaders.cmake: ${source} -> ${name}")
+endfunction()
+
+# shaders of AppShaders.cpp
+EmbedShader(base.vert.spv SHADER_BASE_VERT base.vert.glsl)
+EmbedShader(instanced.vert.spv SHADER_INSTANCED_VERT instanced.vert.glsl)
+EmbedShader(base.frag.spv SHADER_BASE_FRAG base.frag.glsl)
+EmbedShader(bindless.frag.spv SHADER_BINDLESS_FRAG bindless.frag.glsl)
+EmbedShader(cull.comp.spv SHADER_CULL_COMP cull.comp.glsl)
+EmbedShader(cull_subgroup.comp.spv SHADER_CULL_SUBGROUP_COMP cull.comp.glsl --target-env vulkan1.1 -DCULL_SUBGROUP)
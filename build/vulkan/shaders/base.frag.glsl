@@ -8,11 +8,18 @@ layout(location = 1) in vec2 vTexCoords;
 // uniforms
 layout(binding = 0) uniform sampler2D texSampler;
 
+// specialization constants (pipeline variants, see SPEC_BASE_* in AppMain.cpp)
+layout(constant_id = 0) const bool cUseTexture = true;
+layout(constant_id = 1) const bool cUseVertexColor = false;
+
 // outputs
 layout(location = 0) out vec4 fragColor;
 
 // main
 void main()
 {	
-	fragColor = texture(texSampler, vTexCoords);
+	// branches on constants are removed when pipeline is created
+	fragColor = cUseTexture ? texture(texSampler, vTexCoords) : vec4(1.0);
+	if (cUseVertexColor)
+		fragColor *= vColor;
 }
@@ -0,0 +1,33 @@
+#version 450
+#extension GL_ARB_separate_shader_objects : enable
+#extension GL_EXT_nonuniform_qualifier : enable
+
+// inputs
+layout(location = 0) in vec4 vColor;
+layout(location = 1) in vec2 vTexCoords;
+
+// uniforms (bindless table, see VulkanBindlessTableInfo)
+layout(set = 1, binding = 0) uniform texture2D uTextures[];
+layout(set = 1, binding = 1) uniform sampler uSamplers[];
+
+// push constants (slots of draw, see CBindlessConstants in AppMain.cpp)
+layout(push_constant) uniform constants {
+	uint uTextureIndex;
+	uint uSamplerIndex;
+} material;
+
+// specialization constants (pipeline variants, see SPEC_BASE_* in AppMain.cpp)
+layout(constant_id = 0) const bool cUseTexture = true;
+layout(constant_id = 1) const bool cUseVertexColor = false;
+
+// outputs
+layout(location = 0) out vec4 fragColor;
+
+// main
+void main()
+{
+	// indices are same for whole draw (dynamically uniform)
+	fragColor = cUseTexture ? texture(sampler2D(uTextures[material.uTextureIndex], uSamplers[material.uSamplerIndex]), vTexCoords) : vec4(1.0);
+	if (cUseVertexColor)
+		fragColor *= vColor;
+}
@@ -1,3 +0,0 @@
-del *.spv
-glslangValidator.exe -V base.vert.glsl -o base.vert.spv
-glslangValidator.exe -V base.frag.glsl -o base.frag.spv
\ No newline at end of file
@@ -0,0 +1,113 @@
+#version 450
+#extension GL_ARB_separate_shader_objects : enable
+#ifdef CULL_SUBGROUP
+#extension GL_KHR_shader_subgroup_basic : require
+#extension GL_KHR_shader_subgroup_ballot : require
+#endif
+
+// frustum and LOD culling of instances (VulkanCullingInfo), visible instances are compacted into region of their LOD
+// and counted by instanceCount of LOD indirect command, CULL_SUBGROUP variant does one atomic per subgroup and LOD
+// (same tests as VulkanCullingInfo::CullInstance, which validates results)
+
+layout(local_size_x = 64) in;
+
+// VulkanInstanceData
+struct Instance {
+	vec4 transform[3];
+	vec4 params;
+};
+
+// VulkanCullInstance
+struct CullInput {
+	Instance instance;
+	vec4     sphere;
+};
+
+// VkDrawIndexedIndirectCommand
+struct DrawCommand {
+	uint indexCount;
+	uint instanceCount;
+	uint firstIndex;
+	int  vertexOffset;
+	uint firstInstance;
+};
+
+// VulkanCullParams
+layout(std140, binding = 0) uniform buffer0 {
+	vec4  uPlanes[6];
+	vec4  uClipW;
+	vec4  uLodSizes;
+	float uProjScale;
+	uint  uInstanceCount;
+	uint  uLodCount;
+	uint  uMaxInstanceCount;
+} params;
+
+// instances of slot, compacted instances and LOD commands
+layout(std430, binding = 1) readonly buffer buffer1 {
+	CullInput inputs[];
+};
+layout(std430, binding = 2) writeonly buffer buffer2 {
+	Instance outputs[];
+};
+layout(std430, binding = 3) buffer buffer3 {
+	DrawCommand commands[];
+};
+
+// culled instance
+const uint INVISIBLE = 0xFFFFFFFF;
+
+// SelectLod (LOD of instance or INVISIBLE)
+uint SelectLod(CullInput cullInput)
+{
+	// world space sphere (radius scaled by longest axis)
+	vec4 center = vec4(cullInput.sphere.xyz, 1.0);
+	vec3 position = vec3(dot(cullInput.instance.transform[0], center), dot(cullInput.instance.transform[1], center), dot(cullInput.instance.transform[2], center));
+	vec3 axisX = vec3(cullInput.instance.transform[0].x, cullInput.instance.transform[1].x, cullInput.instance.transform[2].x);
+	vec3 axisY = vec3(cullInput.instance.transform[0].y, cullInput.instance.transform[1].y, cullInput.instance.transform[2].y);
+	vec3 axisZ = vec3(cullInput.instance.transform[0].z, cullInput.instance.transform[1].z, cullInput.instance.transform[2].z);
+	float radius = cullInput.sphere.w * sqrt(max(dot(axisX, axisX), max(dot(axisY, axisY), dot(axisZ, axisZ))));
+
+	// frustum
+	for (uint i = 0; i < 6; i++)
+		if (dot(params.uPlanes[i].xyz, position) + params.uPlanes[i].w < -radius)
+			return INVISIBLE;
+
+	// projected size (fraction of viewport height), first LOD it is large enough for
+	float depth = max(dot(params.uClipW.xyz, position) + params.uClipW.w, 1e-6);
+	float size = radius * params.uProjScale / depth;
+	for (uint lod = 0; lod < params.uLodCount; lod++)
+		if (size >= params.uLodSizes[lod])
+			return lod;
+	return INVISIBLE;
+}
+
+// main
+void main()
+{
+	// invocations past instance count take part in subgroup operations too
+	uint index = gl_GlobalInvocationID.x;
+	uint lod = (index < params.uInstanceCount) ? SelectLod(inputs[index]) : INVISIBLE;
+
+#ifdef CULL_SUBGROUP
+	// lowest invocation reserves range for whole subgroup, others get their position by ballot
+	for (uint i = 0; i < params.uLodCount; i++) {
+		bool visible = lod == i;
+		uvec4 ballot = subgroupBallot(visible);
+		uint count = subgroupBallotBitCount(ballot);
+		if (count == 0)
+			continue;
+		uint first = 0;
+		if (subgroupElect())
+			first = atomicAdd(commands[i].instanceCount, count);
+		first = subgroupBroadcastFirst(first);
+		if (visible)
+			outputs[i * params.uMaxInstanceCount + first + subgroupBallotExclusiveBitCount(ballot)] = inputs[index].instance;
+	}
+#else
+	if (lod != INVISIBLE) {
+		uint first = atomicAdd(commands[lod].instanceCount, 1);
+		outputs[lod * params.uMaxInstanceCount + first] = inputs[index].instance;
+	}
+#endif
+}
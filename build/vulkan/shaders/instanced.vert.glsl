@@ -0,0 +1,34 @@
+#version 450
+#extension GL_ARB_separate_shader_objects : enable
+
+// attributes
+layout(location = 0) in vec4 aPosition;
+layout(location = 1) in vec4 aColor;
+layout(location = 2) in vec2 aTexCoords;
+
+// instance attributes (VulkanInstanceData, rows of transposed world matrix and parameters)
+layout(location = 3) in vec4 iTransform0;
+layout(location = 4) in vec4 iTransform1;
+layout(location = 5) in vec4 iTransform2;
+layout(location = 6) in vec4 iParams;
+
+// outputs
+layout(location = 0) out vec4 vColor;
+layout(location = 1) out vec2 vTexCoords;
+
+// uniforms
+layout(binding = 1) uniform buffer0 {
+	mat4 uWVP;
+} matrices;
+
+// main
+void main()
+{
+	// copy in to out (instance color tints vertex color)
+	vColor = aColor * iParams;
+	vTexCoords = aTexCoords;
+
+	// instance transform, then shared one
+	vec4 position = vec4(dot(iTransform0, aPosition), dot(iTransform1, aPosition), dot(iTransform2, aPosition), aPosition.w);
+	gl_Position = matrices.uWVP * position;
+}
@@ -0,0 +1,77 @@
+#include "ThreadPool.hpp"
+#include <cassert>
+
+// Initialize
+void CThreadPool::Initialize(uint32_t threadCount)
+{
+	// start workers
+	mStop = false;
+	for (uint32_t i = 0; i < threadCount; i++)
+		mThreads.emplace_back(&CThreadPool::WorkerMain, this, i);
+}
+
+// DeInitialize
+void CThreadPool::DeInitialize()
+{
+	// stop workers
+	{
+		std::lock_guard<std::mutex> lock(mMutex);
+		mStop = true;
+	}
+	mTaskCondition.notify_all();
+	for (auto& thread : mThreads)
+		thread.join();
+	mThreads.clear();
+}
+
+// Dispatch
+void CThreadPool::Dispatch(uint32_t taskCount, std::function<void(uint32_t taskIndex, uint32_t threadIndex)> task)
+{
+	// nothing to do
+	if (taskCount == 0)
+		return;
+
+	// no workers, run on calling thread
+	if (mThreads.empty()) {
+		for (uint32_t i = 0; i < taskCount; i++)
+			task(i, 0);
+		return;
+	}
+
+	// publish tasks
+	std::unique_lock<std::mutex> lock(mMutex);
+	assert(mTaskCount == 0); // one dispatch at a time
+	mTask = task;
+	mTaskCount = taskCount;
+	mNextTask = 0;
+	mDoneCount = 0;
+	mTaskCondition.notify_all();
+
+	// wait all tasks
+	mDoneCondition.wait(lock, [this]() { return mDoneCount == mTaskCount; });
+	mTaskCount = 0;
+	mTask = nullptr;
+}
+
+// WorkerMain
+void CThreadPool::WorkerMain(uint32_t threadIndex)
+{
+	std::unique_lock<std::mutex> lock(mMutex);
+	for (;;)
+	{
+		// wait for task or stop
+		mTaskCondition.wait(lock, [this]() { return mStop || (mNextTask < mTaskCount); });
+		if (mStop)
+			return;
+
+		// run task outside of lock
+		uint32_t taskIndex = mNextTask++;
+		lock.unlock();
+		mTask(taskIndex, threadIndex);
+		lock.lock();
+
+		// last task wakes dispatcher
+		if (++mDoneCount == mTaskCount)
+			mDoneCondition.notify_one();
+	}
+}
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+
+// CThreadPool
+// fixed set of worker threads, each worker has stable index (use it to pick per-thread resources)
+class CThreadPool
+{
+private:
+	// workers
+	std::vector<std::thread> mThreads{};
+
+	// current dispatch
+	std::mutex              mMutex{};
+	std::condition_variable mTaskCondition{};
+	std::condition_variable mDoneCondition{};
+	std::function<void(uint32_t taskIndex, uint32_t threadIndex)> mTask{};
+	uint32_t mTaskCount = 0;
+	uint32_t mNextTask = 0;
+	uint32_t mDoneCount = 0;
+	bool     mStop = false;
+
+	// worker thread function
+	void WorkerMain(uint32_t threadIndex);
+public:
+	// Init/DeInit functions (threadCount == 0 - tasks run on calling thread)
+	void Initialize(uint32_t threadCount);
+	void DeInitialize();
+
+	// get functions (at least one, calling thread counts as worker 0 when pool is empty)
+	uint32_t GetThreadCount() const { return mThreads.empty() ? 1 : (uint32_t)mThreads.size(); }
+
+	// Dispatch runs task(taskIndex, threadIndex) for every taskIndex and returns when all are done
+	void Dispatch(uint32_t taskCount, std::function<void(uint32_t taskIndex, uint32_t threadIndex)> task);
+};
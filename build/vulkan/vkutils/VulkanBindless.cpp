@@ -0,0 +1,285 @@
+#include "VulkanBindless.hpp"
+#include <cassert>
+#include <cstring>
+#include <algorithm>
+
+// VulkanHelpers
+namespace VulkanHelpers {
+	//////////////////////////////////////////////////////////////////////////
+	// VulkanDescriptorIndexingFeatures
+	//////////////////////////////////////////////////////////////////////////
+
+	// Query
+	void VulkanDescriptorIndexingFeatures::Query(VkPhysicalDevice physicalDevice, std::vector<const char*>& enabledExtensionNames)
+	{
+		mSupported = false;
+
+		// get device extension properties
+		uint32_t extensionPropertiesCount = 0;
+		vkEnumerateDeviceExtensionProperties(physicalDevice, VK_NULL_HANDLE, &extensionPropertiesCount, nullptr);
+		std::vector<VkExtensionProperties> extensionProperties(extensionPropertiesCount);
+		vkEnumerateDeviceExtensionProperties(physicalDevice, VK_NULL_HANDLE, &extensionPropertiesCount, extensionProperties.data());
+
+		// extension is needed (VK_KHR_maintenance3 it depends on is core in Vulkan 1.1)
+		bool descriptorIndexingSupported = false;
+		for (const auto& properties : extensionProperties)
+			descriptorIndexingSupported |= strcmp(properties.extensionName, VK_EXT_DESCRIPTOR_INDEXING_EXTENSION_NAME) == 0;
+		if (!descriptorIndexingSupported)
+			return;
+
+		// VkPhysicalDeviceDescriptorIndexingFeaturesEXT (supported)
+		VkPhysicalDeviceDescriptorIndexingFeaturesEXT supportedFeatures{};
+		supportedFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_INDEXING_FEATURES_EXT;
+		supportedFeatures.pNext = VK_NULL_HANDLE;
+
+		// VkPhysicalDeviceFeatures2
+		VkPhysicalDeviceFeatures2 physicalDeviceFeatures2{};
+		physicalDeviceFeatures2.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+		physicalDeviceFeatures2.pNext = &supportedFeatures;
+		vkGetPhysicalDeviceFeatures2(physicalDevice, &physicalDeviceFeatures2);
+
+		// VkPhysicalDeviceDescriptorIndexingPropertiesEXT
+		mProperties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_INDEXING_PROPERTIES_EXT;
+		mProperties.pNext = VK_NULL_HANDLE;
+
+		// VkPhysicalDeviceProperties2
+		VkPhysicalDeviceProperties2 physicalDeviceProperties2{};
+		physicalDeviceProperties2.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2;
+		physicalDeviceProperties2.pNext = &mProperties;
+		vkGetPhysicalDeviceProperties2(physicalDevice, &physicalDeviceProperties2);
+
+		// runtime arrays of sampled images and samplers, partially bound, written while bound
+		mSupported =
+			physicalDeviceFeatures2.features.shaderSampledImageArrayDynamicIndexing &&
+			supportedFeatures.runtimeDescriptorArray &&
+			supportedFeatures.descriptorBindingPartiallyBound &&
+			supportedFeatures.descriptorBindingSampledImageUpdateAfterBind &&
+			supportedFeatures.descriptorBindingUpdateUnusedWhilePending;
+		if (!mSupported)
+			return;
+
+		// VkPhysicalDeviceDescriptorIndexingFeaturesEXT (enabled)
+		mFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_INDEXING_FEATURES_EXT;
+		mFeatures.pNext = VK_NULL_HANDLE;
+		mFeatures.runtimeDescriptorArray = VK_TRUE;
+		mFeatures.descriptorBindingPartiallyBound = VK_TRUE;
+		mFeatures.descriptorBindingSampledImageUpdateAfterBind = VK_TRUE;
+		mFeatures.descriptorBindingUpdateUnusedWhilePending = VK_TRUE;
+		mFeatures.shaderSampledImageArrayNonUniformIndexing = supportedFeatures.shaderSampledImageArrayNonUniformIndexing;
+
+		// enable extension
+		enabledExtensionNames.push_back(VK_EXT_DESCRIPTOR_INDEXING_EXTENSION_NAME);
+	}
+
+	// GetDeviceCreateInfoNext
+	const void* VulkanDescriptorIndexingFeatures::GetDeviceCreateInfoNext(const void* pNext)
+	{
+		if (!mSupported)
+			return pNext;
+		mFeatures.pNext = const_cast<void*>(pNext);
+		return &mFeatures;
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+	// VulkanBindlessTableInfo
+	//////////////////////////////////////////////////////////////////////////
+
+	// Initialize
+	void VulkanBindlessTableInfo::Initialize(VulkanDeviceInfo& deviceInfo, const VulkanDescriptorIndexingFeatures& features, uint32_t maxTextureCount, uint32_t maxSamplerCount, uint32_t frameCount)
+	{
+		// store parameters
+		mDeviceInfo = &deviceInfo;
+		assert(mDeviceInfo->mDevice);
+		assert(features.mSupported);
+		mFrameCount = frameCount;
+		mFrameNumber = 0;
+		mTextureSlotCount = 0;
+		mSamplerCount = 0;
+
+		// clamp array sizes to update-after-bind limits
+		const VkPhysicalDeviceDescriptorIndexingPropertiesEXT& properties = features.mProperties;
+		mMaxTextureCount = std::min(maxTextureCount, std::min(properties.maxPerStageDescriptorUpdateAfterBindSampledImages, properties.maxDescriptorSetUpdateAfterBindSampledImages));
+		mMaxSamplerCount = std::min(maxSamplerCount, std::min(properties.maxPerStageDescriptorUpdateAfterBindSamplers, properties.maxDescriptorSetUpdateAfterBindSamplers));
+		assert(mMaxTextureCount && mMaxSamplerCount);
+
+		// VkDescriptorSetLayoutBinding
+		VkDescriptorSetLayoutBinding descriptorSetLayoutBindings[] = {
+			{ VULKAN_BINDLESS_BINDING_TEXTURES, VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE, mMaxTextureCount, VK_SHADER_STAGE_FRAGMENT_BIT, VK_NULL_HANDLE },
+			{ VULKAN_BINDLESS_BINDING_SAMPLERS, VK_DESCRIPTOR_TYPE_SAMPLER      , mMaxSamplerCount, VK_SHADER_STAGE_FRAGMENT_BIT, VK_NULL_HANDLE },
+		};
+
+		// VkDescriptorBindingFlagsEXT (unregistered slots are never written, registering writes while set is bound)
+		const VkDescriptorBindingFlagsEXT descriptorBindingFlag =
+			VK_DESCRIPTOR_BINDING_PARTIALLY_BOUND_BIT_EXT | VK_DESCRIPTOR_BINDING_UPDATE_AFTER_BIND_BIT_EXT | VK_DESCRIPTOR_BINDING_UPDATE_UNUSED_WHILE_PENDING_BIT_EXT;
+		VkDescriptorBindingFlagsEXT descriptorBindingFlags[] = { descriptorBindingFlag, descriptorBindingFlag };
+
+		// VkDescriptorSetLayoutBindingFlagsCreateInfoEXT
+		VkDescriptorSetLayoutBindingFlagsCreateInfoEXT descriptorSetLayoutBindingFlagsCreateInfo{};
+		descriptorSetLayoutBindingFlagsCreateInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_BINDING_FLAGS_CREATE_INFO_EXT;
+		descriptorSetLayoutBindingFlagsCreateInfo.pNext = VK_NULL_HANDLE;
+		descriptorSetLayoutBindingFlagsCreateInfo.bindingCount = 2;
+		descriptorSetLayoutBindingFlagsCreateInfo.pBindingFlags = descriptorBindingFlags;
+
+		// VkDescriptorSetLayoutCreateInfo
+		VkDescriptorSetLayoutCreateInfo descriptorSetLayoutCreateInfo{};
+		descriptorSetLayoutCreateInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+		descriptorSetLayoutCreateInfo.pNext = &descriptorSetLayoutBindingFlagsCreateInfo;
+		descriptorSetLayoutCreateInfo.flags = VK_DESCRIPTOR_SET_LAYOUT_CREATE_UPDATE_AFTER_BIND_POOL_BIT_EXT;
+		descriptorSetLayoutCreateInfo.bindingCount = 2;
+		descriptorSetLayoutCreateInfo.pBindings = descriptorSetLayoutBindings;
+
+		// vkCreateDescriptorSetLayout
+		VK_CHECK(vkCreateDescriptorSetLayout(mDeviceInfo->mDevice, &descriptorSetLayoutCreateInfo, VK_NULL_HANDLE, &mDescriptorSetLayout));
+
+		//////////////////////////////////////////////////////////////////////////
+
+		// VkDescriptorPoolSize
+		VkDescriptorPoolSize descriptorPoolSizes[] = {
+			{ VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE, mMaxTextureCount },
+			{ VK_DESCRIPTOR_TYPE_SAMPLER      , mMaxSamplerCount },
+		};
+
+		// VkDescriptorPoolCreateInfo
+		VkDescriptorPoolCreateInfo descriptorPoolCreateInfo{};
+		descriptorPoolCreateInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+		descriptorPoolCreateInfo.pNext = VK_NULL_HANDLE;
+		descriptorPoolCreateInfo.flags = VK_DESCRIPTOR_POOL_CREATE_UPDATE_AFTER_BIND_BIT_EXT;
+		descriptorPoolCreateInfo.maxSets = 1;
+		descriptorPoolCreateInfo.poolSizeCount = 2;
+		descriptorPoolCreateInfo.pPoolSizes = descriptorPoolSizes;
+
+		// vkCreateDescriptorPool
+		VK_CHECK(vkCreateDescriptorPool(mDeviceInfo->mDevice, &descriptorPoolCreateInfo, VK_NULL_HANDLE, &mDescriptorPool));
+
+		// VkDescriptorSetAllocateInfo
+		VkDescriptorSetAllocateInfo descriptorSetAllocateInfo{};
+		descriptorSetAllocateInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+		descriptorSetAllocateInfo.pNext = VK_NULL_HANDLE;
+		descriptorSetAllocateInfo.descriptorPool = mDescriptorPool;
+		descriptorSetAllocateInfo.descriptorSetCount = 1;
+		descriptorSetAllocateInfo.pSetLayouts = &mDescriptorSetLayout;
+
+		// vkAllocateDescriptorSets
+		VK_CHECK(vkAllocateDescriptorSets(mDeviceInfo->mDevice, &descriptorSetAllocateInfo, &mDescriptorSet));
+	}
+
+	// DeInitialize
+	void VulkanBindlessTableInfo::DeInitialize()
+	{
+		if (mDescriptorPool)
+			vkDestroyDescriptorPool(mDeviceInfo->mDevice, mDescriptorPool, VK_NULL_HANDLE);
+		if (mDescriptorSetLayout)
+			vkDestroyDescriptorSetLayout(mDeviceInfo->mDevice, mDescriptorSetLayout, VK_NULL_HANDLE);
+		mDescriptorPool = VK_NULL_HANDLE;
+		mDescriptorSetLayout = VK_NULL_HANDLE;
+		mDescriptorSet = VK_NULL_HANDLE;
+		mFreeTextureSlots.clear();
+		mRetiredTextureSlots.clear();
+		mTextureSlotCount = 0;
+		mSamplerCount = 0;
+	}
+
+	// WriteDescriptor
+	void VulkanBindlessTableInfo::WriteDescriptor(uint32_t binding, uint32_t index, VkImageView imageView, VkSampler sampler)
+	{
+		// VkDescriptorImageInfo
+		VkDescriptorImageInfo descriptorImageInfo{};
+		descriptorImageInfo.sampler = sampler;
+		descriptorImageInfo.imageView = imageView;
+		descriptorImageInfo.imageLayout = imageView ? VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL : VK_IMAGE_LAYOUT_UNDEFINED;
+
+		// VkWriteDescriptorSet
+		VkWriteDescriptorSet writeDescriptorSet{};
+		writeDescriptorSet.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+		writeDescriptorSet.pNext = VK_NULL_HANDLE;
+		writeDescriptorSet.dstSet = mDescriptorSet;
+		writeDescriptorSet.dstBinding = binding;
+		writeDescriptorSet.dstArrayElement = index;
+		writeDescriptorSet.descriptorCount = 1;
+		writeDescriptorSet.descriptorType = (binding == VULKAN_BINDLESS_BINDING_TEXTURES) ? VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE : VK_DESCRIPTOR_TYPE_SAMPLER;
+		writeDescriptorSet.pImageInfo = &descriptorImageInfo;
+		writeDescriptorSet.pBufferInfo = VK_NULL_HANDLE;
+		writeDescriptorSet.pTexelBufferView = VK_NULL_HANDLE;
+
+		// vkUpdateDescriptorSets
+		vkUpdateDescriptorSets(mDeviceInfo->mDevice, 1, &writeDescriptorSet, 0, VK_NULL_HANDLE);
+	}
+
+	// RegisterTexture
+	uint32_t VulkanBindlessTableInfo::RegisterTexture(VkImageView imageView)
+	{
+		assert(imageView);
+
+		// free slot, then new one
+		uint32_t index = VULKAN_BINDLESS_INVALID_INDEX;
+		if (!mFreeTextureSlots.empty()) {
+			index = mFreeTextureSlots.back();
+			mFreeTextureSlots.pop_back();
+		}
+		else if (mTextureSlotCount < mMaxTextureCount)
+			index = mTextureSlotCount++;
+		else
+			return VULKAN_BINDLESS_INVALID_INDEX;
+
+		// slot is not used by any pending command buffer
+		WriteDescriptor(VULKAN_BINDLESS_BINDING_TEXTURES, index, imageView, VK_NULL_HANDLE);
+		return index;
+	}
+
+	// RegisterSampler
+	uint32_t VulkanBindlessTableInfo::RegisterSampler(VkSampler sampler)
+	{
+		assert(sampler);
+		if (mSamplerCount >= mMaxSamplerCount)
+			return VULKAN_BINDLESS_INVALID_INDEX;
+		WriteDescriptor(VULKAN_BINDLESS_BINDING_SAMPLERS, mSamplerCount, VK_NULL_HANDLE, sampler);
+		return mSamplerCount++;
+	}
+
+	// UnregisterTexture
+	void VulkanBindlessTableInfo::UnregisterTexture(uint32_t index)
+	{
+		assert(index < mTextureSlotCount);
+		mRetiredTextureSlots.push_back({ mFrameNumber, index });
+	}
+
+	// NextFrame
+	void VulkanBindlessTableInfo::NextFrame()
+	{
+		// slots retired mFrameCount frames ago are not referenced by frames in flight
+		mFrameNumber++;
+		while (!mRetiredTextureSlots.empty() && (mRetiredTextureSlots.front().first + mFrameCount < mFrameNumber)) {
+			mFreeTextureSlots.push_back(mRetiredTextureSlots.front().second);
+			mRetiredTextureSlots.pop_front();
+		}
+	}
+
+	// CreatePipelineLayout
+	VkPipelineLayout VulkanBindlessTableInfo::CreatePipelineLayout(const std::vector<VkDescriptorSetLayout>& setLayouts, VkShaderStageFlags pushConstantStages, uint32_t pushConstantSize) const
+	{
+		// bindless set is last one
+		std::vector<VkDescriptorSetLayout> descriptorSetLayouts = setLayouts;
+		descriptorSetLayouts.push_back(mDescriptorSetLayout);
+
+		// VkPushConstantRange
+		VkPushConstantRange pushConstantRange{};
+		pushConstantRange.stageFlags = pushConstantStages;
+		pushConstantRange.offset = 0;
+		pushConstantRange.size = pushConstantSize;
+
+		// VkPipelineLayoutCreateInfo
+		VkPipelineLayoutCreateInfo pipelineLayoutInfo{};
+		pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+		pipelineLayoutInfo.pNext = VK_NULL_HANDLE;
+		pipelineLayoutInfo.flags = 0;
+		pipelineLayoutInfo.setLayoutCount = (uint32_t)descriptorSetLayouts.size();
+		pipelineLayoutInfo.pSetLayouts = descriptorSetLayouts.data();
+		pipelineLayoutInfo.pushConstantRangeCount = pushConstantSize ? 1 : 0;
+		pipelineLayoutInfo.pPushConstantRanges = pushConstantSize ? &pushConstantRange : VK_NULL_HANDLE;
+
+		// vkCreatePipelineLayout
+		VkPipelineLayout pipelineLayout = VK_NULL_HANDLE;
+		VK_CHECK(vkCreatePipelineLayout(mDeviceInfo->mDevice, &pipelineLayoutInfo, VK_NULL_HANDLE, &pipelineLayout));
+		return pipelineLayout;
+	}
+}
@@ -0,0 +1,80 @@
+#pragma once
+
+#include "VulkanHelpers.hpp"
+#include <deque>
+
+// VulkanHelpers
+namespace VulkanHelpers
+{
+	// bindings of bindless descriptor set (texture2D and sampler arrays indexed from shaders)
+	const uint32_t VULKAN_BINDLESS_BINDING_TEXTURES = 0;
+	const uint32_t VULKAN_BINDLESS_BINDING_SAMPLERS = 1;
+	// index returned when table is full
+	const uint32_t VULKAN_BINDLESS_INVALID_INDEX = 0xFFFFFFFF;
+
+	// VulkanDescriptorIndexingFeatures
+	// VK_EXT_descriptor_indexing support query for bindless tables (chain to VkDeviceCreateInfo, do not copy after Query)
+	struct VulkanDescriptorIndexingFeatures
+	{
+		VkPhysicalDeviceDescriptorIndexingFeaturesEXT   mFeatures{};   // only features bindless table needs are enabled
+		VkPhysicalDeviceDescriptorIndexingPropertiesEXT mProperties{};
+		bool                                            mSupported = false;
+
+		// Query (adds extension name when extension and features are supported,
+		// VkPhysicalDeviceFeatures::shaderSampledImageArrayDynamicIndexing must be enabled too)
+		void Query(VkPhysicalDevice physicalDevice, std::vector<const char*>& enabledExtensionNames);
+		// GetDeviceCreateInfoNext (pNext - other feature structures, chained after these)
+		const void* GetDeviceCreateInfoNext(const void* pNext);
+	};
+
+	// VulkanBindlessTableInfo
+	// one partially bound, update-after-bind descriptor set with arrays of sampled images and samplers,
+	// resources are registered into slots and shaders index them (push constants or instance data), so set is bound once per command buffer
+	struct VulkanBindlessTableInfo
+	{
+	private:
+		// base handles
+		VulkanDeviceInfo* mDeviceInfo = nullptr;
+
+		// texture slots (free slots are reused last in first out, unregistered ones after frames in flight)
+		std::vector<uint32_t>                       mFreeTextureSlots{};
+		std::deque<std::pair<uint64_t, uint32_t>>   mRetiredTextureSlots{}; // frame number, slot
+		uint32_t                                    mTextureSlotCount = 0;  // slots ever used
+		uint32_t                                    mSamplerCount = 0;
+		uint32_t                                    mFrameCount = 0;
+		uint64_t                                    mFrameNumber = 0;
+
+		// WriteDescriptor (slot is not used by pending command buffers)
+		void WriteDescriptor(uint32_t binding, uint32_t index, VkImageView imageView, VkSampler sampler);
+	public:
+		// base handles (own)
+		VkDescriptorSetLayout mDescriptorSetLayout = VK_NULL_HANDLE;
+		VkDescriptorPool      mDescriptorPool = VK_NULL_HANDLE;
+		VkDescriptorSet       mDescriptorSet = VK_NULL_HANDLE;
+
+		// array sizes (requested counts clamped to device limits)
+		uint32_t mMaxTextureCount = 0;
+		uint32_t mMaxSamplerCount = 0;
+
+		// Init/DeInit functions (frameCount - frames in flight, unregistered slots are reused after them)
+		void Initialize(VulkanDeviceInfo& deviceInfo, const VulkanDescriptorIndexingFeatures& features, uint32_t maxTextureCount, uint32_t maxSamplerCount, uint32_t frameCount);
+		void DeInitialize();
+
+		// register functions (return slot index or VULKAN_BINDLESS_INVALID_INDEX)
+		uint32_t RegisterTexture(VkImageView imageView);
+		uint32_t RegisterSampler(VkSampler sampler);
+		// UnregisterTexture (slot stays valid for frames in flight, image view must live as long)
+		void UnregisterTexture(uint32_t index);
+
+		// NextFrame (once per frame, releases retired slots)
+		void NextFrame();
+		// SetFrameCount (frames retired slots wait for, render target got more images)
+		void SetFrameCount(uint32_t frameCount) { mFrameCount = frameCount; }
+
+		// CreatePipelineLayout (setLayouts are followed by bindless set, caller owns layout)
+		VkPipelineLayout CreatePipelineLayout(const std::vector<VkDescriptorSetLayout>& setLayouts, VkShaderStageFlags pushConstantStages, uint32_t pushConstantSize) const;
+
+		// get functions
+		uint32_t GetTextureCount() const { return mTextureSlotCount - (uint32_t)(mFreeTextureSlots.size() + mRetiredTextureSlots.size()); }
+	};
+}
@@ -0,0 +1,72 @@
+#include "VulkanCommandCache.hpp"
+#include <cassert>
+
+// VulkanHelpers
+namespace VulkanHelpers {
+	//////////////////////////////////////////////////////////////////////////
+	// VulkanCommandCacheInfo
+	//////////////////////////////////////////////////////////////////////////
+
+	// Initialize
+	void VulkanCommandCacheInfo::Initialize(VulkanDeviceInfo& deviceInfo, uint32_t imageCount)
+	{
+		// store parameters
+		mDeviceInfo = &deviceInfo;
+		assert(mDeviceInfo->mDevice);
+
+		// VkCommandPoolCreateInfo (command buffers are reset one by one)
+		VkCommandPoolCreateInfo commandPoolCreateInfo{};
+		commandPoolCreateInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+		commandPoolCreateInfo.pNext = VK_NULL_HANDLE;
+		commandPoolCreateInfo.flags = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT;
+		commandPoolCreateInfo.queueFamilyIndex = mDeviceInfo->mQueueFamilyIndexGraphics;
+		VK_CHECK(vkCreateCommandPool(mDeviceInfo->mDevice, &commandPoolCreateInfo, VK_NULL_HANDLE, &mCommandPool));
+		assert(mCommandPool);
+
+		// allocate command buffers
+		Resize(imageCount);
+	}
+
+	// DeInitialize
+	void VulkanCommandCacheInfo::DeInitialize()
+	{
+		vkDestroyCommandPool(mDeviceInfo->mDevice, mCommandPool, VK_NULL_HANDLE);
+		mCommandPool = VK_NULL_HANDLE;
+		mCommandBuffers.clear();
+		mRecordedGenerations.clear();
+	}
+
+	// Resize
+	void VulkanCommandCacheInfo::Resize(uint32_t imageCount)
+	{
+		assert(imageCount);
+
+		// only grow, command buffers of frames in flight can't be freed here
+		uint32_t oldImageCount = (uint32_t)mCommandBuffers.size();
+		if (imageCount > oldImageCount)
+		{
+			// VkCommandBufferAllocateInfo
+			VkCommandBufferAllocateInfo commandBufferAllocateInfo{};
+			commandBufferAllocateInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+			commandBufferAllocateInfo.pNext = VK_NULL_HANDLE;
+			commandBufferAllocateInfo.commandPool = mCommandPool;
+			commandBufferAllocateInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+			commandBufferAllocateInfo.commandBufferCount = imageCount - oldImageCount;
+
+			// vkAllocateCommandBuffers
+			mCommandBuffers.resize(imageCount);
+			VK_CHECK(vkAllocateCommandBuffers(mDeviceInfo->mDevice, &commandBufferAllocateInfo, mCommandBuffers.data() + oldImageCount));
+		}
+
+		// everything must be recorded again
+		mRecordedGenerations.assign(mCommandBuffers.size(), 0);
+	}
+
+	// MarkRecorded
+	void VulkanCommandCacheInfo::MarkRecorded(uint32_t imageIndex)
+	{
+		assert(imageIndex < mRecordedGenerations.size());
+		mRecordedGenerations[imageIndex] = mGeneration;
+		mRecordCount++;
+	}
+}
@@ -0,0 +1,42 @@
+#pragma once
+
+#include "VulkanHelpers.hpp"
+
+// VulkanHelpers
+namespace VulkanHelpers
+{
+	// VulkanCommandCacheInfo
+	// one reusable primary command buffer per swapchain image, re-recorded only when generation changes
+	struct VulkanCommandCacheInfo
+	{
+	private:
+		// base handles
+		VulkanDeviceInfo* mDeviceInfo = nullptr;
+
+		// command buffers (own)
+		VkCommandPool                mCommandPool = VK_NULL_HANDLE;
+		std::vector<VkCommandBuffer> mCommandBuffers{};
+
+		// generation each command buffer was recorded with (0 - never recorded)
+		std::vector<uint64_t> mRecordedGenerations{};
+	public:
+		// current generation (bump when scene structure, pipelines, descriptors or swapchain change)
+		uint64_t mGeneration = 1;
+
+		// statistics
+		uint64_t mRecordCount = 0;
+
+		// Init/DeInit functions
+		void Initialize(VulkanDeviceInfo& deviceInfo, uint32_t imageCount);
+		void DeInitialize();
+		// Resize (swapchain recreated, grows only and invalidates all)
+		void Resize(uint32_t imageCount);
+
+		// cache functions
+		void Invalidate() { mGeneration++; }
+		bool IsValid(uint32_t imageIndex) const { return mRecordedGenerations[imageIndex] == mGeneration; }
+		VkCommandBuffer GetCommandBuffer(uint32_t imageIndex) const { return mCommandBuffers[imageIndex]; }
+		// MarkRecorded (call when command buffer of image was recorded for current generation)
+		void MarkRecorded(uint32_t imageIndex);
+	};
+}
@@ -0,0 +1,404 @@
+#include "VulkanCulling.hpp"
+#include "VulkanPipelineCache.hpp"
+#include <cassert>
+#include <cstring>
+#include <cmath>
+#include <algorithm>
+
+// VulkanHelpers
+namespace VulkanHelpers {
+	//////////////////////////////////////////////////////////////////////////
+	// VulkanCullParams
+	//////////////////////////////////////////////////////////////////////////
+
+	// SetViewProjection
+	void VulkanCullParams::SetViewProjection(const DirectX::XMMATRIX& viewProj, float projScale)
+	{
+		// frustum planes (same as CPU culling)
+		VulkanFrustum frustum{};
+		frustum.SetViewProjection(viewProj);
+		memcpy(mPlanes, frustum.mPlanes, sizeof(mPlanes));
+
+		// clip = position * viewProj, so clip w is dot product with column 3
+		DirectX::XMFLOAT4X4 matrix{};
+		DirectX::XMStoreFloat4x4(&matrix, viewProj);
+		for (uint32_t k = 0; k < 4; k++)
+			mClipW[k] = matrix.m[k][3];
+		mProjScale = projScale;
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+	// VulkanCullingInfo
+	//////////////////////////////////////////////////////////////////////////
+
+	// Initialize
+	void VulkanCullingInfo::Initialize(VulkanDeviceInfo& deviceInfo, VkShaderModule shaderModule, VkShaderModule shaderModuleSubgroup,
+		const VulkanCullLod* lods, uint32_t lodCount, uint32_t maxInstanceCount, uint32_t slotCount)
+	{
+		// store parameters
+		mDeviceInfo = &deviceInfo;
+		assert(mDeviceInfo->mDevice);
+		assert(shaderModule);
+		assert(lods && (lodCount > 0) && (lodCount <= VULKAN_CULL_MAX_LODS));
+		assert(maxInstanceCount > 0);
+		assert(slotCount > 0);
+		std::copy(lods, lods + lodCount, mLods);
+		mLodCount = lodCount;
+		mMaxInstanceCount = maxInstanceCount;
+		mSlotCount = slotCount;
+		mSlot = 0;
+		mInstances.reserve(mMaxInstanceCount);
+
+		// ballot compaction (one atomic per subgroup and LOD)
+		mSubgroupCompaction = shaderModuleSubgroup && IsSubgroupCompactionSupported(*mDeviceInfo);
+
+		// slots (dynamic offsets must be aligned), params slot ends with dispatch size
+		const VkPhysicalDeviceLimits& limits = mDeviceInfo->mDeviceProperties.limits;
+		VkDeviceSize inputAlignment = limits.minStorageBufferOffsetAlignment;
+		VkDeviceSize paramsAlignment = limits.minUniformBufferOffsetAlignment;
+		mInputSlotSize = (mMaxInstanceCount * sizeof(VulkanCullInstance) + inputAlignment - 1) / inputAlignment * inputAlignment;
+		mParamsSlotSize = (sizeof(VulkanCullParams) + sizeof(VkDispatchIndirectCommand) + paramsAlignment - 1) / paramsAlignment * paramsAlignment;
+
+		// persistently mapped rings, GPU only outputs (transfer source for readback)
+		mDeviceInfo->CreateBuffer(GetInputOffset(mSlotCount), VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, VULKAN_MEMORY_ACCESS_DYNAMIC, mInputBuffer, mInputMemory);
+		mDeviceInfo->CreateBuffer(GetParamsOffset(mSlotCount), VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT, VULKAN_MEMORY_ACCESS_DYNAMIC, mParamsBuffer, mParamsMemory);
+		mDeviceInfo->CreateBuffer(GetOutputOffset(mLodCount), VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VULKAN_MEMORY_ACCESS_STATIC, mOutputBuffer, mOutputMemory);
+		mDeviceInfo->CreateBuffer(mLodCount * sizeof(VkDrawIndexedIndirectCommand), VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VULKAN_MEMORY_ACCESS_STATIC, mIndirectBuffer, mIndirectMemory);
+		assert(mInputBuffer && mParamsBuffer && mOutputBuffer && mIndirectBuffer);
+
+		// commands are reset to these every frame (LOD regions are addressed by first instance when it is enabled, by binding offset otherwise)
+		for (uint32_t i = 0; i < mLodCount; i++) {
+			// VkDrawIndexedIndirectCommand
+			VkDrawIndexedIndirectCommand command{};
+			command.indexCount = mLods[i].mIndexCount;
+			command.instanceCount = 0;
+			command.firstIndex = mLods[i].mFirstIndex;
+			command.vertexOffset = mLods[i].mVertexOffset;
+			command.firstInstance = mDeviceInfo->mEnabledFeatures.drawIndirectFirstInstance ? i * mMaxInstanceCount : 0;
+			mCommandTemplates.push_back(command);
+		}
+
+		//////////////////////////////////////////////////////////////////////////
+
+		// VkDescriptorSetLayoutBinding (params and input slots are dynamic offsets)
+		VkDescriptorSetLayoutBinding descriptorSetLayoutBindings[] = {
+			{ 0, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC, 1, VK_SHADER_STAGE_COMPUTE_BIT, VK_NULL_HANDLE },
+			{ 1, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC, 1, VK_SHADER_STAGE_COMPUTE_BIT, VK_NULL_HANDLE },
+			{ 2, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER        , 1, VK_SHADER_STAGE_COMPUTE_BIT, VK_NULL_HANDLE },
+			{ 3, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER        , 1, VK_SHADER_STAGE_COMPUTE_BIT, VK_NULL_HANDLE },
+		};
+
+		// VkDescriptorSetLayoutCreateInfo
+		VkDescriptorSetLayoutCreateInfo descriptorSetLayoutCreateInfo{};
+		descriptorSetLayoutCreateInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+		descriptorSetLayoutCreateInfo.pNext = VK_NULL_HANDLE;
+		descriptorSetLayoutCreateInfo.flags = 0;
+		descriptorSetLayoutCreateInfo.bindingCount = 4;
+		descriptorSetLayoutCreateInfo.pBindings = descriptorSetLayoutBindings;
+
+		// vkCreateDescriptorSetLayout
+		VK_CHECK(vkCreateDescriptorSetLayout(mDeviceInfo->mDevice, &descriptorSetLayoutCreateInfo, VK_NULL_HANDLE, &mDescriptorSetLayout));
+
+		// VkDescriptorPoolSize
+		VkDescriptorPoolSize descriptorPoolSizes[] = {
+			{ VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC, 1 },
+			{ VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC, 1 },
+			{ VK_DESCRIPTOR_TYPE_STORAGE_BUFFER        , 2 },
+		};
+
+		// VkDescriptorPoolCreateInfo
+		VkDescriptorPoolCreateInfo descriptorPoolCreateInfo{};
+		descriptorPoolCreateInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+		descriptorPoolCreateInfo.pNext = VK_NULL_HANDLE;
+		descriptorPoolCreateInfo.flags = 0;
+		descriptorPoolCreateInfo.maxSets = 1;
+		descriptorPoolCreateInfo.poolSizeCount = 3;
+		descriptorPoolCreateInfo.pPoolSizes = descriptorPoolSizes;
+
+		// vkCreateDescriptorPool
+		VK_CHECK(vkCreateDescriptorPool(mDeviceInfo->mDevice, &descriptorPoolCreateInfo, VK_NULL_HANDLE, &mDescriptorPool));
+
+		// VkDescriptorSetAllocateInfo
+		VkDescriptorSetAllocateInfo descriptorSetAllocateInfo{};
+		descriptorSetAllocateInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+		descriptorSetAllocateInfo.pNext = VK_NULL_HANDLE;
+		descriptorSetAllocateInfo.descriptorPool = mDescriptorPool;
+		descriptorSetAllocateInfo.descriptorSetCount = 1;
+		descriptorSetAllocateInfo.pSetLayouts = &mDescriptorSetLayout;
+
+		// vkAllocateDescriptorSets
+		VK_CHECK(vkAllocateDescriptorSets(mDeviceInfo->mDevice, &descriptorSetAllocateInfo, &mDescriptorSet));
+
+		// VkDescriptorBufferInfo (ranges of one slot)
+		VkDescriptorBufferInfo descriptorBufferInfos[] = {
+			{ mParamsBuffer, 0, sizeof(VulkanCullParams) },
+			{ mInputBuffer, 0, mMaxInstanceCount * sizeof(VulkanCullInstance) },
+			{ mOutputBuffer, 0, VK_WHOLE_SIZE },
+			{ mIndirectBuffer, 0, VK_WHOLE_SIZE },
+		};
+
+		// VkWriteDescriptorSet
+		VkWriteDescriptorSet writeDescriptorSets[4]{};
+		for (uint32_t i = 0; i < 4; i++) {
+			writeDescriptorSets[i].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+			writeDescriptorSets[i].pNext = VK_NULL_HANDLE;
+			writeDescriptorSets[i].dstSet = mDescriptorSet;
+			writeDescriptorSets[i].dstBinding = i;
+			writeDescriptorSets[i].dstArrayElement = 0;
+			writeDescriptorSets[i].descriptorCount = 1;
+			writeDescriptorSets[i].descriptorType = descriptorSetLayoutBindings[i].descriptorType;
+			writeDescriptorSets[i].pBufferInfo = &descriptorBufferInfos[i];
+		}
+		vkUpdateDescriptorSets(mDeviceInfo->mDevice, 4, writeDescriptorSets, 0, VK_NULL_HANDLE);
+
+		//////////////////////////////////////////////////////////////////////////
+
+		// VkPipelineLayoutCreateInfo
+		VkPipelineLayoutCreateInfo pipelineLayoutInfo{};
+		pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+		pipelineLayoutInfo.pNext = VK_NULL_HANDLE;
+		pipelineLayoutInfo.flags = 0;
+		pipelineLayoutInfo.setLayoutCount = 1;
+		pipelineLayoutInfo.pSetLayouts = &mDescriptorSetLayout;
+		pipelineLayoutInfo.pushConstantRangeCount = 0;
+		pipelineLayoutInfo.pPushConstantRanges = VK_NULL_HANDLE;
+
+		// vkCreatePipelineLayout
+		VK_CHECK(vkCreatePipelineLayout(mDeviceInfo->mDevice, &pipelineLayoutInfo, VK_NULL_HANDLE, &mPipelineLayout));
+
+		// VkPipelineShaderStageCreateInfo
+		VkPipelineShaderStageCreateInfo shaderStageCreateInfo{};
+		shaderStageCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+		shaderStageCreateInfo.pNext = VK_NULL_HANDLE;
+		shaderStageCreateInfo.flags = 0;
+		shaderStageCreateInfo.stage = VK_SHADER_STAGE_COMPUTE_BIT;
+		shaderStageCreateInfo.module = mSubgroupCompaction ? shaderModuleSubgroup : shaderModule;
+		shaderStageCreateInfo.pName = "main";
+		shaderStageCreateInfo.pSpecializationInfo = VK_NULL_HANDLE;
+
+		// VkComputePipelineCreateInfo
+		VkComputePipelineCreateInfo computePipelineCreateInfo{};
+		computePipelineCreateInfo.sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
+		computePipelineCreateInfo.pNext = VK_NULL_HANDLE;
+		computePipelineCreateInfo.flags = 0;
+		computePipelineCreateInfo.stage = shaderStageCreateInfo;
+		computePipelineCreateInfo.layout = mPipelineLayout;
+		computePipelineCreateInfo.basePipelineHandle = VK_NULL_HANDLE;
+		computePipelineCreateInfo.basePipelineIndex = -1;
+
+		// vkCreateComputePipelines (with device pipeline cache if any, new pipeline makes cache dirty)
+		VkPipelineCache pipelineCache = mDeviceInfo->mPipelineCacheInfo ? mDeviceInfo->mPipelineCacheInfo->mPipelineCache : VK_NULL_HANDLE;
+		VK_CHECK(vkCreateComputePipelines(mDeviceInfo->mDevice, pipelineCache, 1, &computePipelineCreateInfo, VK_NULL_HANDLE, &mPipeline));
+		assert(mPipeline);
+		if (mDeviceInfo->mPipelineCacheInfo)
+			mDeviceInfo->mPipelineCacheInfo->MarkDirty();
+	}
+
+	// DeInitialize
+	void VulkanCullingInfo::DeInitialize()
+	{
+		if (mPipeline)
+			vkDestroyPipeline(mDeviceInfo->mDevice, mPipeline, VK_NULL_HANDLE);
+		if (mPipelineLayout)
+			vkDestroyPipelineLayout(mDeviceInfo->mDevice, mPipelineLayout, VK_NULL_HANDLE);
+		if (mDescriptorPool)
+			vkDestroyDescriptorPool(mDeviceInfo->mDevice, mDescriptorPool, VK_NULL_HANDLE);
+		if (mDescriptorSetLayout)
+			vkDestroyDescriptorSetLayout(mDeviceInfo->mDevice, mDescriptorSetLayout, VK_NULL_HANDLE);
+		mPipeline = VK_NULL_HANDLE;
+		mPipelineLayout = VK_NULL_HANDLE;
+		mDescriptorPool = VK_NULL_HANDLE;
+		mDescriptorSetLayout = VK_NULL_HANDLE;
+		mDescriptorSet = VK_NULL_HANDLE;
+
+		// buffers
+		if (mInputBuffer)
+			vmaDestroyBuffer(mDeviceInfo->mAllocator, mInputBuffer, mInputMemory);
+		if (mParamsBuffer)
+			vmaDestroyBuffer(mDeviceInfo->mAllocator, mParamsBuffer, mParamsMemory);
+		if (mOutputBuffer)
+			vmaDestroyBuffer(mDeviceInfo->mAllocator, mOutputBuffer, mOutputMemory);
+		if (mIndirectBuffer)
+			vmaDestroyBuffer(mDeviceInfo->mAllocator, mIndirectBuffer, mIndirectMemory);
+		mInputBuffer = VK_NULL_HANDLE;
+		mInputMemory = VK_NULL_HANDLE;
+		mParamsBuffer = VK_NULL_HANDLE;
+		mParamsMemory = VK_NULL_HANDLE;
+		mOutputBuffer = VK_NULL_HANDLE;
+		mOutputMemory = VK_NULL_HANDLE;
+		mIndirectBuffer = VK_NULL_HANDLE;
+		mIndirectMemory = VK_NULL_HANDLE;
+		mInstances.clear();
+		mCommandTemplates.clear();
+		mLodCount = 0;
+	}
+
+	// Begin
+	void VulkanCullingInfo::Begin(uint32_t slot)
+	{
+		assert(slot < mSlotCount);
+		mSlot = slot;
+		mInstances.clear();
+	}
+
+	// Add
+	void VulkanCullingInfo::Add(const VulkanInstanceData& instance, const float sphere[4])
+	{
+		// VulkanCullInstance
+		VulkanCullInstance cullInstance{};
+		cullInstance.mInstance = instance;
+		memcpy(cullInstance.mSphere, sphere, sizeof(cullInstance.mSphere));
+		mInstances.push_back(cullInstance);
+	}
+
+	// End
+	void VulkanCullingInfo::End(const DirectX::XMMATRIX& viewProj, float projScale)
+	{
+		// VulkanCullParams
+		mParams.SetViewProjection(viewProj, projScale);
+		for (uint32_t i = 0; i < VULKAN_CULL_MAX_LODS; i++)
+			mParams.mLodSizes[i] = (i < mLodCount) ? mLods[i].mMinScreenSize : 0.0f;
+		mParams.mInstanceCount = std::min((uint32_t)mInstances.size(), mMaxInstanceCount);
+		mParams.mLodCount = mLodCount;
+		mParams.mMaxInstanceCount = mMaxInstanceCount;
+
+		// VkDispatchIndirectCommand (one invocation per instance)
+		VkDispatchIndirectCommand dispatchCommand{};
+		dispatchCommand.x = (mParams.mInstanceCount + VULKAN_CULL_GROUP_SIZE - 1) / VULKAN_CULL_GROUP_SIZE;
+		dispatchCommand.y = 1;
+		dispatchCommand.z = 1;
+
+		// write slot
+		if (mParams.mInstanceCount)
+			mDeviceInfo->WriteBuffer(mInstances.data(), GetInputOffset(mSlot), mParams.mInstanceCount * sizeof(VulkanCullInstance), mInputBuffer, mInputMemory);
+		mDeviceInfo->WriteBuffer(&mParams, GetParamsOffset(mSlot), sizeof(mParams), mParamsBuffer, mParamsMemory);
+		mDeviceInfo->WriteBuffer(&dispatchCommand, GetParamsOffset(mSlot) + sizeof(mParams), sizeof(dispatchCommand), mParamsBuffer, mParamsMemory);
+	}
+
+	// Record
+	void VulkanCullingInfo::Record(VkCommandBuffer commandBuffer) const
+	{
+		// outputs of previous frame are not read anymore (write after read needs execution dependency only)
+		vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT | VK_PIPELINE_STAGE_VERTEX_INPUT_BIT,
+			VK_PIPELINE_STAGE_TRANSFER_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0, 0, VK_NULL_HANDLE, 0, VK_NULL_HANDLE, 0, VK_NULL_HANDLE);
+
+		// reset instance counts of LOD commands
+		vkCmdUpdateBuffer(commandBuffer, mIndirectBuffer, 0, mCommandTemplates.size() * sizeof(VkDrawIndexedIndirectCommand), mCommandTemplates.data());
+
+		// VkBufferMemoryBarrier (reset commands are counted by atomics)
+		VkBufferMemoryBarrier bufferMemoryBarrier{};
+		bufferMemoryBarrier.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+		bufferMemoryBarrier.pNext = VK_NULL_HANDLE;
+		bufferMemoryBarrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+		bufferMemoryBarrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+		bufferMemoryBarrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+		bufferMemoryBarrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+		bufferMemoryBarrier.buffer = mIndirectBuffer;
+		bufferMemoryBarrier.offset = 0;
+		bufferMemoryBarrier.size = VK_WHOLE_SIZE;
+		vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0, 0, VK_NULL_HANDLE, 1, &bufferMemoryBarrier, 0, VK_NULL_HANDLE);
+
+		// cull instances of slot (group count is read from slot too)
+		uint32_t dynamicOffsets[] = { (uint32_t)GetParamsOffset(mSlot), (uint32_t)GetInputOffset(mSlot) };
+		vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, mPipeline);
+		vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, mPipelineLayout, 0, 1, &mDescriptorSet, 2, dynamicOffsets);
+		vkCmdDispatchIndirect(commandBuffer, mParamsBuffer, GetParamsOffset(mSlot) + sizeof(VulkanCullParams));
+
+		// VkMemoryBarrier (compacted instances and counts are read by draws)
+		VkMemoryBarrier memoryBarrier{};
+		memoryBarrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+		memoryBarrier.pNext = VK_NULL_HANDLE;
+		memoryBarrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+		memoryBarrier.dstAccessMask = VK_ACCESS_INDIRECT_COMMAND_READ_BIT | VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT;
+		vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT | VK_PIPELINE_STAGE_VERTEX_INPUT_BIT,
+			0, 1, &memoryBarrier, 0, VK_NULL_HANDLE, 0, VK_NULL_HANDLE);
+	}
+
+	// Draw
+	void VulkanCullingInfo::Draw(VkCommandBuffer commandBuffer, uint32_t binding) const
+	{
+		const uint32_t stride = sizeof(VkDrawIndexedIndirectCommand);
+
+		// LOD regions are addressed by first instance of commands
+		if (mDeviceInfo->mEnabledFeatures.drawIndirectFirstInstance) {
+			VkDeviceSize offset = 0;
+			vkCmdBindVertexBuffers(commandBuffer, binding, 1, &mOutputBuffer, &offset);
+			if (mDeviceInfo->mEnabledFeatures.multiDrawIndirect)
+				vkCmdDrawIndexedIndirect(commandBuffer, mIndirectBuffer, 0, mLodCount, stride);
+			else
+				for (uint32_t i = 0; i < mLodCount; i++)
+					vkCmdDrawIndexedIndirect(commandBuffer, mIndirectBuffer, i * stride, 1, stride);
+			return;
+		}
+
+		// LOD regions are bound one by one
+		for (uint32_t i = 0; i < mLodCount; i++) {
+			VkDeviceSize offset = GetOutputOffset(i);
+			vkCmdBindVertexBuffers(commandBuffer, binding, 1, &mOutputBuffer, &offset);
+			vkCmdDrawIndexedIndirect(commandBuffer, mIndirectBuffer, i * stride, 1, stride);
+		}
+	}
+
+	// IsSubgroupCompactionSupported
+	bool VulkanCullingInfo::IsSubgroupCompactionSupported(const VulkanDeviceInfo& deviceInfo)
+	{
+		// subgroup properties are core in Vulkan 1.1
+		if (deviceInfo.mDeviceProperties.apiVersion < VK_API_VERSION_1_1)
+			return false;
+
+		// VkPhysicalDeviceSubgroupProperties
+		VkPhysicalDeviceSubgroupProperties subgroupProperties{};
+		subgroupProperties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_SUBGROUP_PROPERTIES;
+		subgroupProperties.pNext = VK_NULL_HANDLE;
+
+		// VkPhysicalDeviceProperties2
+		VkPhysicalDeviceProperties2 physicalDeviceProperties2{};
+		physicalDeviceProperties2.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2;
+		physicalDeviceProperties2.pNext = &subgroupProperties;
+		vkGetPhysicalDeviceProperties2(deviceInfo.mPhysicalDevice, &physicalDeviceProperties2);
+
+		// subgroupElect, subgroupBallot, subgroupBroadcastFirst and ballot bit counts in compute
+		const VkSubgroupFeatureFlags operations = VK_SUBGROUP_FEATURE_BASIC_BIT | VK_SUBGROUP_FEATURE_BALLOT_BIT;
+		return (subgroupProperties.supportedStages & VK_SHADER_STAGE_COMPUTE_BIT) && ((subgroupProperties.supportedOperations & operations) == operations);
+	}
+
+	// CullInstance
+	uint32_t VulkanCullingInfo::CullInstance(const VulkanCullParams& params, const VulkanCullInstance& instance)
+	{
+		// world space sphere (radius scaled by longest axis)
+		const float (&transform)[3][4] = instance.mInstance.mTransform;
+		const float* sphere = instance.mSphere;
+		float position[3];
+		for (uint32_t i = 0; i < 3; i++)
+			position[i] = transform[i][0] * sphere[0] + transform[i][1] * sphere[1] + transform[i][2] * sphere[2] + transform[i][3];
+		float axisLength = 0.0f;
+		for (uint32_t j = 0; j < 3; j++)
+			axisLength = std::max(axisLength, transform[0][j] * transform[0][j] + transform[1][j] * transform[1][j] + transform[2][j] * transform[2][j]);
+		float radius = sphere[3] * std::sqrt(axisLength);
+
+		// frustum
+		for (const auto& plane : params.mPlanes)
+			if (plane[0] * position[0] + plane[1] * position[1] + plane[2] * position[2] + plane[3] < -radius)
+				return VULKAN_CULL_INVISIBLE;
+
+		// projected size (fraction of viewport height), first LOD it is large enough for
+		float depth = std::max(params.mClipW[0] * position[0] + params.mClipW[1] * position[1] + params.mClipW[2] * position[2] + params.mClipW[3], 1e-6f);
+		float size = radius * params.mProjScale / depth;
+		for (uint32_t lod = 0; lod < params.mLodCount; lod++)
+			if (size >= params.mLodSizes[lod])
+				return lod;
+		return VULKAN_CULL_INVISIBLE;
+	}
+
+	// CullReference
+	void VulkanCullingInfo::CullReference(const VulkanCullParams& params, const VulkanCullInstance* instances, std::vector<uint32_t> lodInstances[VULKAN_CULL_MAX_LODS])
+	{
+		for (uint32_t i = 0; i < VULKAN_CULL_MAX_LODS; i++)
+			lodInstances[i].clear();
+		for (uint32_t i = 0; i < params.mInstanceCount; i++) {
+			uint32_t lod = CullInstance(params, instances[i]);
+			if (lod != VULKAN_CULL_INVISIBLE)
+				lodInstances[lod].push_back(i);
+		}
+	}
+}
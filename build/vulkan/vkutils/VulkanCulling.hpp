@@ -0,0 +1,132 @@
+#pragma once
+
+#include "VulkanHelpers.hpp"
+#include "VulkanInstancing.hpp"
+#include "VulkanFrustumCulling.hpp"
+
+// VulkanHelpers
+namespace VulkanHelpers
+{
+	// LODs of culled mesh (indirect command per LOD)
+	const uint32_t VULKAN_CULL_MAX_LODS = 4;
+	// workgroup size (local_size_x of cull.comp.glsl)
+	const uint32_t VULKAN_CULL_GROUP_SIZE = 64;
+	// LOD of culled instance
+	const uint32_t VULKAN_CULL_INVISIBLE = UINT32_MAX;
+
+	// VulkanCullInstance (input of culling, instance and its local space bounding sphere)
+	struct VulkanCullInstance
+	{
+		VulkanInstanceData mInstance;
+		float              mSphere[4]; // center xyz, radius
+	};
+
+	// VulkanCullLod (index range of LOD, LOD is drawn when projected size is at least mMinScreenSize
+	// and previous LOD was not, instances smaller than minimum of last LOD are culled)
+	struct VulkanCullLod
+	{
+		uint32_t mIndexCount = 0;
+		uint32_t mFirstIndex = 0;
+		int32_t  mVertexOffset = 0;
+		float    mMinScreenSize = 0.0f; // fraction of viewport height
+	};
+
+	// VulkanCullParams (uniform of cull.comp.glsl, std140)
+	struct VulkanCullParams
+	{
+		float    mPlanes[6][4];                   // xyz normal pointing inside, w distance
+		float    mClipW[4];                       // column 3 of view projection (clip w is view depth)
+		float    mLodSizes[VULKAN_CULL_MAX_LODS]; // mMinScreenSize of LODs
+		float    mProjScale;                      // projection[1][1]
+		uint32_t mInstanceCount;
+		uint32_t mLodCount;
+		uint32_t mMaxInstanceCount;               // size of LOD region of output
+
+		// SetViewProjection (DirectXMath row vector matrix, depth range 0..1)
+		void SetViewProjection(const DirectX::XMMATRIX& viewProj, float projScale);
+	};
+
+	// VulkanCullingInfo
+	// instances added during frame are written into ring slot, compute pass records culling against frustum and LOD selection
+	// by projected size, visible instances are compacted into LOD regions of output buffer (per instance vertex buffer)
+	// and counted by LOD indirect commands; instance count and dispatch size are read from slot, so recorded command buffers stay valid
+	struct VulkanCullingInfo
+	{
+	private:
+		// base handles
+		VulkanDeviceInfo* mDeviceInfo = nullptr;
+
+		// LODs
+		VulkanCullLod mLods[VULKAN_CULL_MAX_LODS]{};
+		uint32_t      mLodCount = 0;
+
+		// instances and params of current slot
+		std::vector<VulkanCullInstance> mInstances{};
+		VulkanCullParams                mParams{};
+
+		// ring (instances of all slots, params and dispatch size of all slots)
+		uint32_t     mMaxInstanceCount = 0; // per slot
+		uint32_t     mSlotCount = 0;
+		uint32_t     mSlot = 0;
+		VkDeviceSize mInputSlotSize = 0;  // aligned to minStorageBufferOffsetAlignment
+		VkDeviceSize mParamsSlotSize = 0; // aligned to minUniformBufferOffsetAlignment
+
+		// compute pipeline
+		VkDescriptorSetLayout mDescriptorSetLayout = VK_NULL_HANDLE;
+		VkDescriptorPool      mDescriptorPool = VK_NULL_HANDLE;
+		VkDescriptorSet       mDescriptorSet = VK_NULL_HANDLE;
+		VkPipelineLayout      mPipelineLayout = VK_NULL_HANDLE;
+		VkPipeline            mPipeline = VK_NULL_HANDLE;
+
+		// reset values of indirect commands (instance count 0)
+		std::vector<VkDrawIndexedIndirectCommand> mCommandTemplates{};
+	public:
+		// input ring (own, persistently mapped) and params ring (uniform and dispatch indirect usage)
+		VkBuffer      mInputBuffer = VK_NULL_HANDLE;
+		VmaAllocation mInputMemory = VK_NULL_HANDLE;
+		VkBuffer      mParamsBuffer = VK_NULL_HANDLE;
+		VmaAllocation mParamsMemory = VK_NULL_HANDLE;
+
+		// outputs (own, written by GPU): compacted instances (LOD regions of mMaxInstanceCount) and LOD commands
+		VkBuffer      mOutputBuffer = VK_NULL_HANDLE;
+		VmaAllocation mOutputMemory = VK_NULL_HANDLE;
+		VkBuffer      mIndirectBuffer = VK_NULL_HANDLE;
+		VmaAllocation mIndirectMemory = VK_NULL_HANDLE;
+
+		// ballot compaction is used (subgroup variant of shader)
+		bool mSubgroupCompaction = false;
+
+		// Init/DeInit functions (shaderModuleSubgroup is used when device supports subgroup ballot in compute, can be VK_NULL_HANDLE)
+		void Initialize(VulkanDeviceInfo& deviceInfo, VkShaderModule shaderModule, VkShaderModule shaderModuleSubgroup,
+			const VulkanCullLod* lods, uint32_t lodCount, uint32_t maxInstanceCount, uint32_t slotCount);
+		void DeInitialize();
+
+		// Begin (slot is not read by GPU anymore)
+		void Begin(uint32_t slot);
+		// Add instance (instances over mMaxInstanceCount are dropped by End)
+		void Add(const VulkanInstanceData& instance, const float sphere[4]);
+		// End (writes instances, params and dispatch size of slot)
+		void End(const DirectX::XMMATRIX& viewProj, float projScale);
+
+		// Record culling of current slot (outside of render pass, outputs are ready for vertex input and indirect draws after it)
+		void Record(VkCommandBuffer commandBuffer) const;
+		// Draw visible instances (pipeline with instance binding, vertex and index buffers must be bound)
+		void Draw(VkCommandBuffer commandBuffer, uint32_t binding) const;
+
+		// get functions
+		VkDeviceSize GetInputOffset(uint32_t slot) const { return (VkDeviceSize)slot * mInputSlotSize; }
+		VkDeviceSize GetParamsOffset(uint32_t slot) const { return (VkDeviceSize)slot * mParamsSlotSize; }
+		VkDeviceSize GetOutputOffset(uint32_t lod) const { return (VkDeviceSize)lod * mMaxInstanceCount * sizeof(VulkanInstanceData); }
+		uint32_t GetMaxInstanceCount() const { return mMaxInstanceCount; }
+		uint32_t GetLodCount() const { return mLodCount; }
+		const VulkanCullParams& GetParams() const { return mParams; }
+		const std::vector<VulkanCullInstance>& GetInstances() const { return mInstances; }
+
+		// IsSubgroupCompactionSupported (Vulkan 1.1 device with basic and ballot subgroup operations in compute)
+		static bool IsSubgroupCompactionSupported(const VulkanDeviceInfo& deviceInfo);
+		// CullInstance (CPU reference of cull.comp.glsl, LOD or VULKAN_CULL_INVISIBLE)
+		static uint32_t CullInstance(const VulkanCullParams& params, const VulkanCullInstance& instance);
+		// CullReference (indices of visible instances per LOD in input order)
+		static void CullReference(const VulkanCullParams& params, const VulkanCullInstance* instances, std::vector<uint32_t> lodInstances[VULKAN_CULL_MAX_LODS]);
+	};
+}
@@ -0,0 +1,322 @@
+#include "VulkanDefragmentation.hpp"
+#include <cassert>
+#include <chrono>
+#include <algorithm>
+
+// VulkanHelpers
+namespace VulkanHelpers {
+	//////////////////////////////////////////////////////////////////////////
+	// VulkanDefragmentationInfo
+	//////////////////////////////////////////////////////////////////////////
+
+	// Initialize
+	void VulkanDefragmentationInfo::Initialize(VulkanDeviceInfo& deviceInfo, VkDeviceSize maxBytesPerPass, uint32_t maxAllocationsPerPass)
+	{
+		// store parameters
+		mDeviceInfo = &deviceInfo;
+		mMaxBytesPerPass = maxBytesPerPass;
+		mMaxAllocationsPerPass = maxAllocationsPerPass;
+		assert(mDeviceInfo->mDevice);
+		assert(mMaxBytesPerPass);
+		assert(mMaxAllocationsPerPass);
+
+		// VkCommandPoolCreateInfo (graphics queue family, resources are owned by it, so copies need no ownership transfer, reset every pass)
+		VkCommandPoolCreateInfo commandPoolCreateInfo{};
+		commandPoolCreateInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+		commandPoolCreateInfo.pNext = VK_NULL_HANDLE;
+		commandPoolCreateInfo.flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT;
+		commandPoolCreateInfo.queueFamilyIndex = mDeviceInfo->mQueueFamilyIndexGraphics;
+		VK_CHECK(vkCreateCommandPool(mDeviceInfo->mDevice, &commandPoolCreateInfo, VK_NULL_HANDLE, &mCommandPool));
+		assert(mCommandPool);
+
+		// VkCommandBufferAllocateInfo
+		VkCommandBufferAllocateInfo commandBufferAllocateInfo{};
+		commandBufferAllocateInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+		commandBufferAllocateInfo.pNext = VK_NULL_HANDLE;
+		commandBufferAllocateInfo.commandPool = mCommandPool;
+		commandBufferAllocateInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+		commandBufferAllocateInfo.commandBufferCount = 1;
+		VK_CHECK(vkAllocateCommandBuffers(mDeviceInfo->mDevice, &commandBufferAllocateInfo, &mCommandBuffer));
+		assert(mCommandBuffer);
+
+		// create fence
+		mFence = mDeviceInfo->CreateFence(0);
+		assert(mFence);
+
+		// reset state
+		mStats = VulkanDefragmentationStats{};
+		mIdle = true;
+	}
+
+	// DeInitialize
+	void VulkanDefragmentationInfo::DeInitialize()
+	{
+		Finish();
+		mResources.clear();
+		mAllocations.clear();
+		vkDestroyFence(mDeviceInfo->mDevice, mFence, VK_NULL_HANDLE);
+		mFence = VK_NULL_HANDLE;
+		vkDestroyCommandPool(mDeviceInfo->mDevice, mCommandPool, VK_NULL_HANDLE);
+		mCommandPool = VK_NULL_HANDLE;
+		mCommandBuffer = VK_NULL_HANDLE;
+	}
+
+	// RegisterBuffer
+	void VulkanDefragmentationInfo::RegisterBuffer(VkBuffer& buffer, VmaAllocation allocation, VkDeviceSize size, VkBufferUsageFlags usage, std::function<void()> onMoved)
+	{
+		assert(buffer);
+		assert(allocation);
+
+		// VulkanDefragmentationResource
+		VulkanDefragmentationResource resource{};
+		resource.pBuffer = &buffer;
+		resource.mBufferCreateInfo = InitBufferCreateInfo(size, usage);
+		resource.mOnMoved = onMoved;
+
+		// add resource
+		mAllocations.push_back(allocation);
+		mResources.push_back(resource);
+		mIdle = false;
+	}
+
+	// RegisterImage
+	void VulkanDefragmentationInfo::RegisterImage(VkImage& image, VkImageView& imageView, VmaAllocation allocation, const VkImageCreateInfo& imageCreateInfo,
+		VkFormat imageViewFormat, VkImageAspectFlags aspectMask, VkImageLayout imageLayout, std::function<void()> onMoved)
+	{
+		assert(image);
+		assert(allocation);
+		// image memory can be reinterpreted only by images created with alias bit
+		assert(imageCreateInfo.flags & VK_IMAGE_CREATE_ALIAS_BIT);
+
+		// VulkanDefragmentationResource
+		VulkanDefragmentationResource resource{};
+		resource.pImage = &image;
+		resource.pImageView = &imageView;
+		resource.mImageCreateInfo = imageCreateInfo;
+		resource.mImageViewFormat = imageViewFormat;
+		resource.mImageAspectMask = aspectMask;
+		resource.mImageLayout = imageLayout;
+		resource.mOnMoved = onMoved;
+
+		// add resource
+		mAllocations.push_back(allocation);
+		mResources.push_back(resource);
+		mIdle = false;
+	}
+
+	// Unregister
+	void VulkanDefragmentationInfo::Unregister(VmaAllocation allocation)
+	{
+		// allocation is freed by caller, its memory type can be locked by submitted pass
+		Finish();
+		for (size_t i = 0; i < mAllocations.size(); i++)
+			if (mAllocations[i] == allocation) {
+				mAllocations.erase(mAllocations.begin() + i);
+				mResources.erase(mResources.begin() + i);
+				// freed range can be compacted now
+				mIdle = false;
+				return;
+			}
+	}
+
+	// RecreateResource
+	void VulkanDefragmentationInfo::RecreateResource(VulkanDefragmentationResource& resource, VmaAllocation allocation, VulkanDeletionQueue& deletionQueue, uint64_t frameNumber)
+	{
+		VkDevice device = mDeviceInfo->mDevice;
+
+		// recreate buffer at new place, data is copied by pass before later frames use it
+		if (resource.pBuffer) {
+			VkBuffer oldBuffer = *resource.pBuffer;
+			deletionQueue.Push(frameNumber, [device, oldBuffer]() {
+				vkDestroyBuffer(device, oldBuffer, VK_NULL_HANDLE);
+			});
+			VK_CHECK(vkCreateBuffer(device, &resource.mBufferCreateInfo, VK_NULL_HANDLE, resource.pBuffer));
+			assert(*resource.pBuffer);
+
+			// silence validation layer warning about missing requirements query
+			VkMemoryRequirements memoryRequirements{};
+			vkGetBufferMemoryRequirements(device, *resource.pBuffer, &memoryRequirements);
+			VK_CHECK(vmaBindBufferMemory(mDeviceInfo->mAllocator, allocation, *resource.pBuffer));
+		}
+
+		// recreate image and image view at new place, data is copied by pass before later frames use it
+		if (resource.pImage) {
+			VkImage oldImage = *resource.pImage;
+			VkImageView oldImageView = *resource.pImageView;
+			deletionQueue.Push(frameNumber, [device, oldImage, oldImageView]() {
+				vkDestroyImageView(device, oldImageView, VK_NULL_HANDLE);
+				vkDestroyImage(device, oldImage, VK_NULL_HANDLE);
+			});
+
+			// new image must keep memory contents, so it starts in preinitialized layout
+			VkImageCreateInfo imageCreateInfo = resource.mImageCreateInfo;
+			imageCreateInfo.initialLayout = VK_IMAGE_LAYOUT_PREINITIALIZED;
+			VK_CHECK(vkCreateImage(device, &imageCreateInfo, VK_NULL_HANDLE, resource.pImage));
+			assert(*resource.pImage);
+
+			// silence validation layer warning about missing requirements query
+			VkMemoryRequirements memoryRequirements{};
+			vkGetImageMemoryRequirements(device, *resource.pImage, &memoryRequirements);
+			VK_CHECK(vmaBindImageMemory(mDeviceInfo->mAllocator, allocation, *resource.pImage));
+
+			// VkImageMemoryBarrier (layout from before defragmentation is restored after copies of pass)
+			VkImageMemoryBarrier imageMemoryBarrier{};
+			imageMemoryBarrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+			imageMemoryBarrier.pNext = VK_NULL_HANDLE;
+			imageMemoryBarrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+			imageMemoryBarrier.dstAccessMask = VK_ACCESS_MEMORY_READ_BIT | VK_ACCESS_MEMORY_WRITE_BIT;
+			imageMemoryBarrier.oldLayout = VK_IMAGE_LAYOUT_PREINITIALIZED;
+			imageMemoryBarrier.newLayout = resource.mImageLayout;
+			imageMemoryBarrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+			imageMemoryBarrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+			imageMemoryBarrier.image = *resource.pImage;
+			imageMemoryBarrier.subresourceRange.aspectMask = resource.mImageAspectMask;
+			imageMemoryBarrier.subresourceRange.baseMipLevel = 0;
+			imageMemoryBarrier.subresourceRange.levelCount = VK_REMAINING_MIP_LEVELS;
+			imageMemoryBarrier.subresourceRange.baseArrayLayer = 0;
+			imageMemoryBarrier.subresourceRange.layerCount = VK_REMAINING_ARRAY_LAYERS;
+			vkCmdPipelineBarrier(mCommandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, 0, 0, nullptr, 0, nullptr, 1, &imageMemoryBarrier);
+
+			// view type follows image create info (cube, array or plain 2D)
+			VkImageViewType imageViewType = VK_IMAGE_VIEW_TYPE_2D;
+			if (imageCreateInfo.flags & VK_IMAGE_CREATE_CUBE_COMPATIBLE_BIT)
+				imageViewType = imageCreateInfo.arrayLayers > 6 ? VK_IMAGE_VIEW_TYPE_CUBE_ARRAY : VK_IMAGE_VIEW_TYPE_CUBE;
+			else if (imageCreateInfo.arrayLayers > 1)
+				imageViewType = VK_IMAGE_VIEW_TYPE_2D_ARRAY;
+
+			// recreate image view
+			*resource.pImageView = mDeviceInfo->CreateImageView(*resource.pImage, imageViewType, resource.mImageViewFormat, resource.mImageAspectMask, imageCreateInfo.mipLevels, imageCreateInfo.arrayLayers);
+			assert(*resource.pImageView);
+		}
+
+		// rewrite descriptors
+		if (resource.mOnMoved)
+			resource.mOnMoved();
+	}
+
+	// EndPass
+	bool VulkanDefragmentationInfo::EndPass(bool wait)
+	{
+		if (!mPending)
+			return true;
+
+		// copies of pass must be finished before VMA frees empty blocks and temporary buffers
+		if (wait) {
+			VK_CHECK(vkWaitForFences(mDeviceInfo->mDevice, 1, &mFence, VK_TRUE, UINT64_MAX));
+		}
+		else if (vkGetFenceStatus(mDeviceInfo->mDevice, mFence) != VK_SUCCESS)
+			return false;
+		VK_CHECK(vkResetFences(mDeviceInfo->mDevice, 1, &mFence));
+
+		// vmaDefragmentationEnd (fills freed block stats)
+		vmaDefragmentationEnd(mDeviceInfo->mAllocator, mContext);
+		mContext = VK_NULL_HANDLE;
+		mPending = false;
+
+		// update statistics
+		mStats.mAllocationsMoved += mPassStats.allocationsMoved;
+		mStats.mDeviceMemoryBlocksFreed += mPassStats.deviceMemoryBlocksFreed;
+		mStats.mBytesMoved += mPassStats.bytesMoved;
+		mStats.mBytesFreed += mPassStats.bytesFreed;
+		return true;
+	}
+
+	// Finish
+	void VulkanDefragmentationInfo::Finish()
+	{
+		EndPass(true);
+	}
+
+	// Update
+	void VulkanDefragmentationInfo::Update(VulkanDeletionQueue& deletionQueue, uint64_t frameNumber)
+	{
+		// submitted pass is polled, next pass starts after it ended
+		if (!EndPass(false))
+			return;
+
+		// nothing to do
+		if (mIdle || mAllocations.empty())
+			return;
+
+		// pass start time
+		auto passTimeBegin = std::chrono::high_resolution_clock::now();
+
+		// reset command pool from previous pass
+		VK_CHECK(vkResetCommandPool(mDeviceInfo->mDevice, mCommandPool, 0));
+
+		// VkCommandBufferBeginInfo
+		VkCommandBufferBeginInfo commandBufferBeginInfo{};
+		commandBufferBeginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+		commandBufferBeginInfo.pNext = VK_NULL_HANDLE;
+		commandBufferBeginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+		commandBufferBeginInfo.pInheritanceInfo = nullptr; // Optional
+		VK_CHECK(vkBeginCommandBuffer(mCommandBuffer, &commandBufferBeginInfo));
+
+		// VkMemoryBarrier (copies wait for work of frames submitted before pass, old places can still be read by them)
+		VkMemoryBarrier memoryBarrier{};
+		memoryBarrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+		memoryBarrier.pNext = VK_NULL_HANDLE;
+		memoryBarrier.srcAccessMask = VK_ACCESS_MEMORY_READ_BIT | VK_ACCESS_MEMORY_WRITE_BIT;
+		memoryBarrier.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT | VK_ACCESS_TRANSFER_WRITE_BIT;
+		vkCmdPipelineBarrier(mCommandBuffer, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 1, &memoryBarrier, 0, nullptr, 0, nullptr);
+
+		// VmaDefragmentationInfo2 (GPU moves only, CPU moves would overwrite memory frames in flight still read)
+		std::vector<VkBool32> allocationsChanged(mAllocations.size(), VK_FALSE);
+		VmaDefragmentationInfo2 defragmentationInfo{};
+		defragmentationInfo.flags = 0;
+		defragmentationInfo.allocationCount = (uint32_t)mAllocations.size();
+		defragmentationInfo.pAllocations = mAllocations.data();
+		defragmentationInfo.pAllocationsChanged = allocationsChanged.data();
+		defragmentationInfo.poolCount = 0;
+		defragmentationInfo.pPools = VK_NULL_HANDLE;
+		defragmentationInfo.maxCpuBytesToMove = 0;
+		defragmentationInfo.maxCpuAllocationsToMove = 0;
+		defragmentationInfo.maxGpuBytesToMove = mMaxBytesPerPass;
+		defragmentationInfo.maxGpuAllocationsToMove = mMaxAllocationsPerPass;
+		defragmentationInfo.commandBuffer = mCommandBuffer;
+
+		// vmaDefragmentationBegin (VK_NOT_READY - copies are recorded and context must be ended after they are executed)
+		mPassStats = VmaDefragmentationStats{};
+		VkResult result = vmaDefragmentationBegin(mDeviceInfo->mAllocator, &defragmentationInfo, &mPassStats, &mContext);
+		assert((result == VK_SUCCESS) || (result == VK_NOT_READY));
+
+		// failed or empty pass moved nothing, stop until resources change
+		if ((result < VK_SUCCESS) || (mPassStats.allocationsMoved == 0)) {
+			VK_CHECK(vkEndCommandBuffer(mCommandBuffer));
+			vmaDefragmentationEnd(mDeviceInfo->mAllocator, mContext);
+			mContext = VK_NULL_HANDLE;
+			mIdle = true;
+			return;
+		}
+
+		// moved allocations already point to new places, handles are recreated there and old ones retired
+		for (size_t i = 0; i < mAllocations.size(); i++)
+			if (allocationsChanged[i])
+				RecreateResource(mResources[i], mAllocations[i], deletionQueue, frameNumber);
+
+		// VkMemoryBarrier (later frames read moved data after copies)
+		memoryBarrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+		memoryBarrier.dstAccessMask = VK_ACCESS_MEMORY_READ_BIT | VK_ACCESS_MEMORY_WRITE_BIT;
+		vkCmdPipelineBarrier(mCommandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, 0, 1, &memoryBarrier, 0, nullptr, 0, nullptr);
+		VK_CHECK(vkEndCommandBuffer(mCommandBuffer));
+
+		// submit copies to graphics queue after frame, fence is polled by later updates
+		VkSubmitInfo submitInfo{};
+		submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+		submitInfo.pNext = VK_NULL_HANDLE;
+		submitInfo.commandBufferCount = 1;
+		submitInfo.pCommandBuffers = &mCommandBuffer;
+		VK_CHECK(vkQueueSubmit(mDeviceInfo->mQueueGraphics, 1, &submitInfo, mFence));
+		mPending = true;
+
+		// pass time
+		auto passTimeEnd = std::chrono::high_resolution_clock::now();
+		double passTime = std::chrono::duration_cast<std::chrono::duration<double, std::milli>>(passTimeEnd - passTimeBegin).count();
+
+		// update statistics (moved and freed totals are added when pass ends)
+		mStats.mPassCount++;
+		mStats.mLastPassTime = passTime;
+		mStats.mMaxPassTime = std::max(mStats.mMaxPassTime, passTime);
+		mStats.mTotalPassTime += passTime;
+	}
+}
@@ -0,0 +1,99 @@
+#pragma once
+
+#include "VulkanHelpers.hpp"
+#include <functional>
+
+// VulkanHelpers
+namespace VulkanHelpers
+{
+	// VulkanDefragmentationStats
+	struct VulkanDefragmentationStats
+	{
+		// totals since Initialize
+		uint64_t     mPassCount = 0;
+		uint64_t     mAllocationsMoved = 0;
+		uint64_t     mDeviceMemoryBlocksFreed = 0;
+		VkDeviceSize mBytesMoved = 0;
+		VkDeviceSize mBytesFreed = 0;
+
+		// per frame cost (milliseconds, CPU side of recording and submitting a pass, GPU copies are not waited for)
+		double mLastPassTime = 0.0;
+		double mMaxPassTime = 0.0;
+		double mTotalPassTime = 0.0;
+	};
+
+	// VulkanDefragmentationInfo
+	// incremental defragmentation of registered VMA allocations, one bounded pass per Update(),
+	// moves are GPU copies on graphics queue ordered after submitted frames by barriers, old handles are retired through deletion queue
+	struct VulkanDefragmentationInfo
+	{
+	private:
+		// VulkanDefragmentationResource
+		struct VulkanDefragmentationResource
+		{
+			// buffer resource (pBuffer != nullptr)
+			VkBuffer*          pBuffer = nullptr;
+			VkBufferCreateInfo mBufferCreateInfo{};
+
+			// image resource (pImage != nullptr)
+			VkImage*           pImage = nullptr;
+			VkImageView*       pImageView = nullptr;
+			VkImageCreateInfo  mImageCreateInfo{};
+			VkFormat           mImageViewFormat = VK_FORMAT_UNDEFINED;
+			VkImageAspectFlags mImageAspectMask = 0;
+			VkImageLayout      mImageLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+
+			// called after handles were recreated (rewrite descriptors here)
+			std::function<void()> mOnMoved{};
+		};
+
+		// base handles
+		VulkanDeviceInfo* mDeviceInfo = nullptr;
+
+		// transfer path handles (own)
+		VkCommandPool   mCommandPool = VK_NULL_HANDLE;
+		VkCommandBuffer mCommandBuffer = VK_NULL_HANDLE;
+		VkFence         mFence = VK_NULL_HANDLE;
+
+		// submitted pass (context is ended when its fence is signaled, VMA keeps moved memory types locked until then)
+		VmaDefragmentationContext mContext = VK_NULL_HANDLE;
+		VmaDefragmentationStats   mPassStats{};
+		bool                      mPending = false;
+
+		// registered resources
+		std::vector<VmaAllocation>                 mAllocations{};
+		std::vector<VulkanDefragmentationResource> mResources{};
+
+		// budget of one pass
+		VkDeviceSize mMaxBytesPerPass = 0;
+		uint32_t     mMaxAllocationsPerPass = 0;
+
+		// true when last pass moved nothing (reset by Register/Unregister)
+		bool mIdle = true;
+
+		// recreate handles of moved resource (old handles are retired, image layout transition is recorded to pass)
+		void RecreateResource(VulkanDefragmentationResource& resource, VmaAllocation allocation, VulkanDeletionQueue& deletionQueue, uint64_t frameNumber);
+		// EndPass (ends submitted pass, wait - blocks until its copies are finished)
+		bool EndPass(bool wait);
+	public:
+		// statistics
+		VulkanDefragmentationStats mStats{};
+
+		// Init/DeInit functions
+		void Initialize(VulkanDeviceInfo& deviceInfo, VkDeviceSize maxBytesPerPass, uint32_t maxAllocationsPerPass);
+		void DeInitialize();
+
+		// register functions (handles are rewritten in place when allocation moves,
+		// host must not write registered allocations after registration, moved data is copied by GPU later)
+		void RegisterBuffer(VkBuffer& buffer, VmaAllocation allocation, VkDeviceSize size, VkBufferUsageFlags usage, std::function<void()> onMoved);
+		void RegisterImage(VkImage& image, VkImageView& imageView, VmaAllocation allocation, const VkImageCreateInfo& imageCreateInfo,
+			VkFormat imageViewFormat, VkImageAspectFlags aspectMask, VkImageLayout imageLayout, std::function<void()> onMoved);
+		void Unregister(VmaAllocation allocation);
+
+		// frame processing (after frame submit, frameNumber - first frame that does not use old handles)
+		void Update(VulkanDeletionQueue& deletionQueue, uint64_t frameNumber);
+		// Finish waits for submitted pass (VMA allocations in memory types being moved block until pass is ended)
+		void Finish();
+		bool IsIdle() const { return mIdle && !mPending; }
+	};
+}
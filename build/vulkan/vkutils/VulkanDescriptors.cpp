@@ -0,0 +1,344 @@
+#include "VulkanDescriptors.hpp"
+#include <cassert>
+#include <cstring>
+#include <algorithm>
+
+// VulkanHelpers
+namespace VulkanHelpers {
+	// descriptors per set of cache pools (common material and pass layouts)
+	static const std::vector<VkDescriptorPoolSize> VULKAN_DESCRIPTORS_PER_SET = {
+		{ VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 4 },
+		{ VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE         , 2 },
+		{ VK_DESCRIPTOR_TYPE_SAMPLER               , 1 },
+		{ VK_DESCRIPTOR_TYPE_STORAGE_IMAGE         , 1 },
+		{ VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER        , 2 },
+		{ VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC, 2 },
+		{ VK_DESCRIPTOR_TYPE_STORAGE_BUFFER        , 2 },
+	};
+
+	// GetDataHash (HashBytes of layout handle and descriptors)
+	static uint64_t GetDataHash(VkDescriptorSetLayout descriptorSetLayout, const VulkanDescriptorData* data, uint32_t count)
+	{
+		uint64_t hash = HashBytes(&descriptorSetLayout, sizeof(descriptorSetLayout));
+		return HashBytes(data, count * sizeof(VulkanDescriptorData), hash);
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+	// VulkanDescriptorData
+	//////////////////////////////////////////////////////////////////////////
+
+	// Image
+	VulkanDescriptorData VulkanDescriptorData::Image(VkImageView imageView, VkSampler sampler, VkImageLayout imageLayout)
+	{
+		VulkanDescriptorData data;
+		memset(&data, 0, sizeof(data));
+		data.mImage.sampler = sampler;
+		data.mImage.imageView = imageView;
+		data.mImage.imageLayout = imageLayout;
+		return data;
+	}
+
+	// Buffer
+	VulkanDescriptorData VulkanDescriptorData::Buffer(VkBuffer buffer, VkDeviceSize offset, VkDeviceSize range)
+	{
+		VulkanDescriptorData data;
+		memset(&data, 0, sizeof(data));
+		data.mBuffer.buffer = buffer;
+		data.mBuffer.offset = offset;
+		data.mBuffer.range = range;
+		return data;
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+	// VulkanDescriptorAllocatorInfo
+	//////////////////////////////////////////////////////////////////////////
+
+	// Initialize
+	void VulkanDescriptorAllocatorInfo::Initialize(VulkanDeviceInfo& deviceInfo, const std::vector<VkDescriptorPoolSize>& descriptorsPerSet, uint32_t setsPerPool, uint32_t maxSetsPerPool, bool freeSets)
+	{
+		// store parameters
+		mDeviceInfo = &deviceInfo;
+		assert(mDeviceInfo->mDevice);
+		assert(!descriptorsPerSet.empty());
+		assert(setsPerPool > 0);
+		mDescriptorsPerSet = descriptorsPerSet;
+		mSetsPerPool = setsPerPool;
+		mMaxSetsPerPool = std::max(maxSetsPerPool, setsPerPool);
+		mFreeSets = freeSets;
+		mPoolCount = 0;
+		mAllocationCount = 0;
+	}
+
+	// DeInitialize
+	void VulkanDescriptorAllocatorInfo::DeInitialize()
+	{
+		if (mCurrentPool)
+			mUsedPools.push_back(mCurrentPool);
+		for (auto pool : mUsedPools)
+			vkDestroyDescriptorPool(mDeviceInfo->mDevice, pool, VK_NULL_HANDLE);
+		for (auto pool : mFreePools)
+			vkDestroyDescriptorPool(mDeviceInfo->mDevice, pool, VK_NULL_HANDLE);
+		mCurrentPool = VK_NULL_HANDLE;
+		mUsedPools.clear();
+		mFreePools.clear();
+	}
+
+	// CreatePool
+	VkDescriptorPool VulkanDescriptorAllocatorInfo::CreatePool()
+	{
+		// fill descriptor pool sizes
+		std::vector<VkDescriptorPoolSize> descriptorPoolSizes = mDescriptorsPerSet;
+		for (auto& descriptorPoolSize : descriptorPoolSizes)
+			descriptorPoolSize.descriptorCount *= mSetsPerPool;
+
+		// VkDescriptorPoolCreateInfo
+		VkDescriptorPoolCreateInfo descriptorPoolCreateInfo{};
+		descriptorPoolCreateInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+		descriptorPoolCreateInfo.pNext = VK_NULL_HANDLE;
+		descriptorPoolCreateInfo.flags = mFreeSets ? VK_DESCRIPTOR_POOL_CREATE_FREE_DESCRIPTOR_SET_BIT : 0;
+		descriptorPoolCreateInfo.maxSets = mSetsPerPool;
+		descriptorPoolCreateInfo.poolSizeCount = (uint32_t)descriptorPoolSizes.size();
+		descriptorPoolCreateInfo.pPoolSizes = descriptorPoolSizes.data();
+
+		// vkCreateDescriptorPool
+		VkDescriptorPool descriptorPool = VK_NULL_HANDLE;
+		VK_CHECK(vkCreateDescriptorPool(mDeviceInfo->mDevice, &descriptorPoolCreateInfo, VK_NULL_HANDLE, &descriptorPool));
+		mPoolCount++;
+
+		// next pool is bigger (few pools for many sets)
+		mSetsPerPool = std::min(mSetsPerPool * 2, mMaxSetsPerPool);
+		return descriptorPool;
+	}
+
+	// GetPool
+	VkDescriptorPool VulkanDescriptorAllocatorInfo::GetPool()
+	{
+		if (mFreePools.empty())
+			return CreatePool();
+		VkDescriptorPool descriptorPool = mFreePools.back();
+		mFreePools.pop_back();
+		return descriptorPool;
+	}
+
+	// Allocate
+	VkDescriptorSet VulkanDescriptorAllocatorInfo::Allocate(VkDescriptorSetLayout descriptorSetLayout, VkDescriptorPool* descriptorPool)
+	{
+		assert(descriptorSetLayout);
+		if (!mCurrentPool)
+			mCurrentPool = GetPool();
+
+		// VkDescriptorSetAllocateInfo
+		VkDescriptorSetAllocateInfo descriptorSetAllocateInfo{};
+		descriptorSetAllocateInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+		descriptorSetAllocateInfo.pNext = VK_NULL_HANDLE;
+		descriptorSetAllocateInfo.descriptorPool = mCurrentPool;
+		descriptorSetAllocateInfo.descriptorSetCount = 1;
+		descriptorSetAllocateInfo.pSetLayouts = &descriptorSetLayout;
+
+		// vkAllocateDescriptorSets (full pool is retired, next one is taken)
+		VkDescriptorSet descriptorSet = VK_NULL_HANDLE;
+		VkResult result = vkAllocateDescriptorSets(mDeviceInfo->mDevice, &descriptorSetAllocateInfo, &descriptorSet);
+		if ((result == VK_ERROR_OUT_OF_POOL_MEMORY) || (result == VK_ERROR_FRAGMENTED_POOL)) {
+			mUsedPools.push_back(mCurrentPool);
+			mCurrentPool = GetPool();
+			descriptorSetAllocateInfo.descriptorPool = mCurrentPool;
+			result = vkAllocateDescriptorSets(mDeviceInfo->mDevice, &descriptorSetAllocateInfo, &descriptorSet);
+		}
+		assert(result == VK_SUCCESS);
+		mAllocationCount++;
+		if (descriptorPool)
+			*descriptorPool = mCurrentPool;
+		return descriptorSet;
+	}
+
+	// Free
+	void VulkanDescriptorAllocatorInfo::Free(VkDescriptorPool descriptorPool, VkDescriptorSet descriptorSet)
+	{
+		assert(mFreeSets);
+		assert(descriptorPool);
+		VK_CHECK(vkFreeDescriptorSets(mDeviceInfo->mDevice, descriptorPool, 1, &descriptorSet));
+	}
+
+	// Reset
+	void VulkanDescriptorAllocatorInfo::Reset()
+	{
+		if (mCurrentPool)
+			mUsedPools.push_back(mCurrentPool);
+		for (auto pool : mUsedPools) {
+			VK_CHECK(vkResetDescriptorPool(mDeviceInfo->mDevice, pool, 0));
+			mFreePools.push_back(pool);
+		}
+		mCurrentPool = VK_NULL_HANDLE;
+		mUsedPools.clear();
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+	// VulkanDescriptorCacheInfo
+	//////////////////////////////////////////////////////////////////////////
+
+	// Initialize
+	void VulkanDescriptorCacheInfo::Initialize(VulkanDeviceInfo& deviceInfo, uint32_t frameCount)
+	{
+		// store parameters
+		mDeviceInfo = &deviceInfo;
+		assert(mDeviceInfo->mDevice);
+		mHitCount = 0;
+		mWriteCount = 0;
+		mFrameCount = frameCount;
+		mFrameNumber = 0;
+
+		// allocators (cached sets live long and can be evicted one by one, frame sets are many and short)
+		mAllocator.Initialize(deviceInfo, VULKAN_DESCRIPTORS_PER_SET, 64, 1024, true);
+		mFrameAllocators.resize(frameCount);
+		for (auto& frameAllocator : mFrameAllocators)
+			frameAllocator.Initialize(deviceInfo, VULKAN_DESCRIPTORS_PER_SET, 256, 4096);
+	}
+
+	// DeInitialize
+	void VulkanDescriptorCacheInfo::DeInitialize()
+	{
+		for (auto& frameAllocator : mFrameAllocators)
+			frameAllocator.DeInitialize();
+		mFrameAllocators.clear();
+		mAllocator.DeInitialize();
+		mDescriptorSets.clear();
+		mRetiredSets.clear();
+		for (auto& layout : mLayouts)
+			vkDestroyDescriptorUpdateTemplate(mDeviceInfo->mDevice, layout.second.mUpdateTemplate, VK_NULL_HANDLE);
+		mLayouts.clear();
+	}
+
+	// RegisterLayout
+	void VulkanDescriptorCacheInfo::RegisterLayout(VkDescriptorSetLayout descriptorSetLayout, const std::vector<VkDescriptorSetLayoutBinding>& bindings)
+	{
+		assert(descriptorSetLayout);
+		if (mLayouts.count(descriptorSetLayout))
+			return;
+
+		// VkDescriptorUpdateTemplateEntry (descriptors of binding are consecutive VulkanDescriptorData)
+		std::vector<VkDescriptorUpdateTemplateEntry> descriptorUpdateTemplateEntries{};
+		uint32_t descriptorCount = 0;
+		for (const auto& binding : bindings) {
+			assert(binding.descriptorType != VK_DESCRIPTOR_TYPE_UNIFORM_TEXEL_BUFFER);
+			assert(binding.descriptorType != VK_DESCRIPTOR_TYPE_STORAGE_TEXEL_BUFFER);
+			VkDescriptorUpdateTemplateEntry descriptorUpdateTemplateEntry{};
+			descriptorUpdateTemplateEntry.dstBinding = binding.binding;
+			descriptorUpdateTemplateEntry.dstArrayElement = 0;
+			descriptorUpdateTemplateEntry.descriptorCount = binding.descriptorCount;
+			descriptorUpdateTemplateEntry.descriptorType = binding.descriptorType;
+			descriptorUpdateTemplateEntry.offset = descriptorCount * sizeof(VulkanDescriptorData);
+			descriptorUpdateTemplateEntry.stride = sizeof(VulkanDescriptorData);
+			descriptorUpdateTemplateEntries.push_back(descriptorUpdateTemplateEntry);
+			descriptorCount += binding.descriptorCount;
+		}
+
+		// VkDescriptorUpdateTemplateCreateInfo
+		VkDescriptorUpdateTemplateCreateInfo descriptorUpdateTemplateCreateInfo{};
+		descriptorUpdateTemplateCreateInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_UPDATE_TEMPLATE_CREATE_INFO;
+		descriptorUpdateTemplateCreateInfo.pNext = VK_NULL_HANDLE;
+		descriptorUpdateTemplateCreateInfo.flags = 0;
+		descriptorUpdateTemplateCreateInfo.descriptorUpdateEntryCount = (uint32_t)descriptorUpdateTemplateEntries.size();
+		descriptorUpdateTemplateCreateInfo.pDescriptorUpdateEntries = descriptorUpdateTemplateEntries.data();
+		descriptorUpdateTemplateCreateInfo.templateType = VK_DESCRIPTOR_UPDATE_TEMPLATE_TYPE_DESCRIPTOR_SET;
+		descriptorUpdateTemplateCreateInfo.descriptorSetLayout = descriptorSetLayout;
+		descriptorUpdateTemplateCreateInfo.pipelineBindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS;
+		descriptorUpdateTemplateCreateInfo.pipelineLayout = VK_NULL_HANDLE;
+		descriptorUpdateTemplateCreateInfo.set = 0;
+
+		// vkCreateDescriptorUpdateTemplate
+		VulkanDescriptorLayout layout{};
+		layout.mDescriptorCount = descriptorCount;
+		VK_CHECK(vkCreateDescriptorUpdateTemplate(mDeviceInfo->mDevice, &descriptorUpdateTemplateCreateInfo, VK_NULL_HANDLE, &layout.mUpdateTemplate));
+		mLayouts[descriptorSetLayout] = layout;
+	}
+
+	// Write
+	VkDescriptorSet VulkanDescriptorCacheInfo::Write(VulkanDescriptorAllocatorInfo& allocator, VkDescriptorSetLayout descriptorSetLayout, const VulkanDescriptorData* data, uint32_t count, VkDescriptorPool* descriptorPool)
+	{
+		// layout must be registered
+		auto it = mLayouts.find(descriptorSetLayout);
+		assert(it != mLayouts.end());
+		assert(count == it->second.mDescriptorCount);
+
+		// vkUpdateDescriptorSetWithTemplate (one call for all bindings)
+		VkDescriptorSet descriptorSet = allocator.Allocate(descriptorSetLayout, descriptorPool);
+		vkUpdateDescriptorSetWithTemplate(mDeviceInfo->mDevice, descriptorSet, it->second.mUpdateTemplate, data);
+		mWriteCount++;
+		return descriptorSet;
+	}
+
+	// GetDescriptorSet
+	VkDescriptorSet VulkanDescriptorCacheInfo::GetDescriptorSet(VkDescriptorSetLayout descriptorSetLayout, const VulkanDescriptorData* data, uint32_t count)
+	{
+		assert(data || !count);
+
+		// find set with same layout and resources
+		uint64_t hash = GetDataHash(descriptorSetLayout, data, count);
+		auto range = mDescriptorSets.equal_range(hash);
+		for (auto it = range.first; it != range.second; ++it) {
+			const VulkanDescriptorSetEntry& entry = it->second;
+			if ((entry.mDescriptorSetLayout == descriptorSetLayout) && (entry.mData.size() == count) &&
+				(memcmp(entry.mData.data(), data, count * sizeof(VulkanDescriptorData)) == 0)) {
+				mHitCount++;
+				return entry.mDescriptorSet;
+			}
+		}
+
+		// VulkanDescriptorSetEntry
+		VulkanDescriptorSetEntry entry{};
+		entry.mDescriptorSetLayout = descriptorSetLayout;
+		entry.mData.assign(data, data + count);
+		entry.mDescriptorSet = Write(mAllocator, descriptorSetLayout, data, count, &entry.mDescriptorPool);
+		return mDescriptorSets.emplace(hash, std::move(entry))->second.mDescriptorSet;
+	}
+
+	// Evict
+	void VulkanDescriptorCacheInfo::Evict(VkDescriptorSet descriptorSet)
+	{
+		// handles of destroyed resources can be reused by new ones, so set must not be found again
+		for (auto it = mDescriptorSets.begin(); it != mDescriptorSets.end(); ++it) {
+			if (it->second.mDescriptorSet == descriptorSet) {
+				VulkanRetiredSet retiredSet{};
+				retiredSet.mFrameNumber = mFrameNumber;
+				retiredSet.mDescriptorPool = it->second.mDescriptorPool;
+				retiredSet.mDescriptorSet = descriptorSet;
+				mRetiredSets.push_back(retiredSet);
+				mDescriptorSets.erase(it);
+				return;
+			}
+		}
+	}
+
+	// Clear
+	void VulkanDescriptorCacheInfo::Clear()
+	{
+		mDescriptorSets.clear();
+		mRetiredSets.clear();
+		mAllocator.Reset();
+	}
+
+	// NextFrame
+	void VulkanDescriptorCacheInfo::NextFrame()
+	{
+		// sets evicted mFrameCount frames ago are not referenced by frames in flight
+		mFrameNumber++;
+		while (!mRetiredSets.empty() && (mRetiredSets.front().mFrameNumber + mFrameCount < mFrameNumber)) {
+			mAllocator.Free(mRetiredSets.front().mDescriptorPool, mRetiredSets.front().mDescriptorSet);
+			mRetiredSets.pop_front();
+		}
+	}
+
+	// AllocateFrameSet
+	VkDescriptorSet VulkanDescriptorCacheInfo::AllocateFrameSet(uint32_t frameIndex, VkDescriptorSetLayout descriptorSetLayout, const VulkanDescriptorData* data, uint32_t count)
+	{
+		assert(frameIndex < mFrameAllocators.size());
+		return Write(mFrameAllocators[frameIndex], descriptorSetLayout, data, count);
+	}
+
+	// ResetFrame
+	void VulkanDescriptorCacheInfo::ResetFrame(uint32_t frameIndex)
+	{
+		assert(frameIndex < mFrameAllocators.size());
+		mFrameAllocators[frameIndex].Reset();
+	}
+}
@@ -0,0 +1,137 @@
+#pragma once
+
+#include "VulkanHelpers.hpp"
+#include <unordered_map>
+#include <deque>
+
+// VulkanHelpers
+namespace VulkanHelpers
+{
+	// VulkanDescriptorData
+	// one descriptor as read by update templates (image or buffer info by binding type),
+	// created zeroed so sets with same resources have same bytes and hash
+	union VulkanDescriptorData
+	{
+		VkDescriptorImageInfo  mImage;
+		VkDescriptorBufferInfo mBuffer;
+
+		// create functions
+		static VulkanDescriptorData Image(VkImageView imageView, VkSampler sampler, VkImageLayout imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+		static VulkanDescriptorData Buffer(VkBuffer buffer, VkDeviceSize offset, VkDeviceSize range);
+	};
+
+	// VulkanDescriptorAllocatorInfo
+	// chain of descriptor pools, new pool (twice bigger, up to max) is added when current one is full,
+	// Reset returns all sets at once and keeps pools for reuse
+	struct VulkanDescriptorAllocatorInfo
+	{
+	private:
+		// base handles
+		VulkanDeviceInfo* mDeviceInfo = nullptr;
+
+		// pool sizes (descriptors per set, multiplied by sets of pool)
+		std::vector<VkDescriptorPoolSize> mDescriptorsPerSet{};
+		uint32_t                          mSetsPerPool = 0;
+		uint32_t                          mMaxSetsPerPool = 0;
+		bool                              mFreeSets = false;
+
+		// pools (own)
+		VkDescriptorPool              mCurrentPool = VK_NULL_HANDLE;
+		std::vector<VkDescriptorPool> mUsedPools{};
+		std::vector<VkDescriptorPool> mFreePools{};
+
+		// pool functions
+		VkDescriptorPool CreatePool();
+		VkDescriptorPool GetPool();
+	public:
+		// stats
+		uint32_t mPoolCount = 0;
+		uint64_t mAllocationCount = 0;
+
+		// Init/DeInit functions (freeSets - pools are created with free descriptor set bit, sets can be freed one by one)
+		void Initialize(VulkanDeviceInfo& deviceInfo, const std::vector<VkDescriptorPoolSize>& descriptorsPerSet, uint32_t setsPerPool, uint32_t maxSetsPerPool, bool freeSets = false);
+		void DeInitialize();
+
+		// Allocate (never fails for lack of pool space, descriptorPool receives pool of set)
+		VkDescriptorSet Allocate(VkDescriptorSetLayout descriptorSetLayout, VkDescriptorPool* descriptorPool = nullptr);
+		// Free one set (pool of set must be from Allocate, allocator created with freeSets, set must not be in use by GPU)
+		void Free(VkDescriptorPool descriptorPool, VkDescriptorSet descriptorSet);
+		// Reset (all allocated sets are freed, they must not be in use by GPU)
+		void Reset();
+	};
+
+	// VulkanDescriptorCacheInfo
+	// descriptor sets written with update templates: cached sets are found by hash of layout and resources
+	// (same resources bound again return existing set), frame sets come from per-frame allocators reset in bulk
+	struct VulkanDescriptorCacheInfo
+	{
+	private:
+		// VulkanDescriptorLayout (update template reads VulkanDescriptorData array in binding order)
+		struct VulkanDescriptorLayout
+		{
+			VkDescriptorUpdateTemplate mUpdateTemplate = VK_NULL_HANDLE;
+			uint32_t                   mDescriptorCount = 0;
+		};
+
+		// VulkanDescriptorSetEntry (data copy resolves hash collisions)
+		struct VulkanDescriptorSetEntry
+		{
+			VkDescriptorSetLayout             mDescriptorSetLayout = VK_NULL_HANDLE;
+			std::vector<VulkanDescriptorData> mData{};
+			VkDescriptorPool                  mDescriptorPool = VK_NULL_HANDLE;
+			VkDescriptorSet                   mDescriptorSet = VK_NULL_HANDLE;
+		};
+
+		// VulkanRetiredSet (evicted set, freed when frames in flight of its frame number are finished)
+		struct VulkanRetiredSet
+		{
+			uint64_t         mFrameNumber = 0;
+			VkDescriptorPool mDescriptorPool = VK_NULL_HANDLE;
+			VkDescriptorSet  mDescriptorSet = VK_NULL_HANDLE;
+		};
+
+		// base handles
+		VulkanDeviceInfo* mDeviceInfo = nullptr;
+
+		// layouts (not own) with their templates (own)
+		std::unordered_map<VkDescriptorSetLayout, VulkanDescriptorLayout> mLayouts{};
+
+		// cached sets and their allocator
+		VulkanDescriptorAllocatorInfo                                 mAllocator{};
+		std::unordered_multimap<uint64_t, VulkanDescriptorSetEntry>  mDescriptorSets{};
+		std::deque<VulkanRetiredSet>                                 mRetiredSets{};
+		uint32_t                                                     mFrameCount = 0;
+		uint64_t                                                     mFrameNumber = 0;
+
+		// frame allocators (one per frame in flight)
+		std::vector<VulkanDescriptorAllocatorInfo> mFrameAllocators{};
+
+		// Write (update template, descriptorPool receives pool of set)
+		VkDescriptorSet Write(VulkanDescriptorAllocatorInfo& allocator, VkDescriptorSetLayout descriptorSetLayout, const VulkanDescriptorData* data, uint32_t count, VkDescriptorPool* descriptorPool = nullptr);
+	public:
+		// stats
+		uint64_t mHitCount = 0;
+		uint64_t mWriteCount = 0;
+
+		// Init/DeInit functions (frameCount - frames in flight)
+		void Initialize(VulkanDeviceInfo& deviceInfo, uint32_t frameCount);
+		void DeInitialize();
+
+		// RegisterLayout creates update template of layout (bindings the layout was created with)
+		void RegisterLayout(VkDescriptorSetLayout descriptorSetLayout, const std::vector<VkDescriptorSetLayoutBinding>& bindings);
+
+		// GetDescriptorSet (cached, data has one entry per descriptor of layout in binding order)
+		VkDescriptorSet GetDescriptorSet(VkDescriptorSetLayout descriptorSetLayout, const VulkanDescriptorData* data, uint32_t count);
+		// Evict set from cache (resources of set were destroyed or moved), set stays valid for frames in flight
+		void Evict(VkDescriptorSet descriptorSet);
+		// Clear frees cached sets (after resources were destroyed or moved, sets must not be in use by GPU)
+		void Clear();
+		// NextFrame (once per frame, frees sets evicted by frames that are finished)
+		void NextFrame();
+
+		// frame sets (valid until frame allocator is reset)
+		VkDescriptorSet AllocateFrameSet(uint32_t frameIndex, VkDescriptorSetLayout descriptorSetLayout, const VulkanDescriptorData* data, uint32_t count);
+		// ResetFrame (frame of frameIndex was finished by GPU)
+		void ResetFrame(uint32_t frameIndex);
+	};
+}
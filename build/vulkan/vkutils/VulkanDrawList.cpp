@@ -0,0 +1,139 @@
+#include "VulkanDrawList.hpp"
+#include <cassert>
+#include <cstring>
+#include <algorithm>
+
+// VulkanHelpers
+namespace VulkanHelpers {
+	//////////////////////////////////////////////////////////////////////////
+	// VulkanDrawIndirectFeatures
+	//////////////////////////////////////////////////////////////////////////
+
+	// Query
+	void VulkanDrawIndirectFeatures::Query(VkPhysicalDevice physicalDevice, std::vector<const char*>& enabledExtensionNames)
+	{
+		// core features
+		VkPhysicalDeviceFeatures physicalDeviceFeatures{};
+		vkGetPhysicalDeviceFeatures(physicalDevice, &physicalDeviceFeatures);
+		mMultiDrawIndirect = physicalDeviceFeatures.multiDrawIndirect;
+		mDrawIndirectFirstInstance = physicalDeviceFeatures.drawIndirectFirstInstance;
+
+		// get device extension properties
+		uint32_t extensionPropertiesCount = 0;
+		vkEnumerateDeviceExtensionProperties(physicalDevice, VK_NULL_HANDLE, &extensionPropertiesCount, nullptr);
+		std::vector<VkExtensionProperties> extensionProperties(extensionPropertiesCount);
+		vkEnumerateDeviceExtensionProperties(physicalDevice, VK_NULL_HANDLE, &extensionPropertiesCount, extensionProperties.data());
+
+		// draw count from buffer
+		mDrawIndirectCount = false;
+		for (const auto& properties : extensionProperties)
+			mDrawIndirectCount |= strcmp(properties.extensionName, VK_KHR_DRAW_INDIRECT_COUNT_EXTENSION_NAME) == 0;
+		if (mDrawIndirectCount)
+			enabledExtensionNames.push_back(VK_KHR_DRAW_INDIRECT_COUNT_EXTENSION_NAME);
+	}
+
+	// EnableFeatures
+	void VulkanDrawIndirectFeatures::EnableFeatures(VkPhysicalDeviceFeatures& physicalDeviceFeatures) const
+	{
+		physicalDeviceFeatures.multiDrawIndirect = mMultiDrawIndirect;
+		physicalDeviceFeatures.drawIndirectFirstInstance = mDrawIndirectFirstInstance;
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+	// VulkanDrawListInfo
+	//////////////////////////////////////////////////////////////////////////
+
+	// Initialize
+	void VulkanDrawListInfo::Initialize(VulkanDeviceInfo& deviceInfo, uint32_t maxDrawCount, uint32_t slotCount)
+	{
+		// store parameters
+		mDeviceInfo = &deviceInfo;
+		assert(mDeviceInfo->mDevice);
+		assert(maxDrawCount > 0);
+		assert(slotCount > 0);
+		mMaxDrawCount = maxDrawCount;
+		mMaxDrawsPerCall = std::max(mDeviceInfo->mDeviceProperties.limits.maxDrawIndirectCount, 1u);
+		mSlotCount = slotCount;
+		mSlot = 0;
+		mDrawCount = 0;
+		mCommands.reserve(mMaxDrawCount);
+
+		// vkCmdDrawIndexedIndirectCountKHR
+		fnCmdDrawIndexedIndirectCountKHR = nullptr;
+		if (mDeviceInfo->IsExtensionEnabled(VK_KHR_DRAW_INDIRECT_COUNT_EXTENSION_NAME))
+			fnCmdDrawIndexedIndirectCountKHR = (PFN_vkCmdDrawIndexedIndirectCountKHR)vkGetDeviceProcAddr(mDeviceInfo->mDevice, "vkCmdDrawIndexedIndirectCountKHR");
+
+		// persistently mapped buffer (commands and counts of all slots)
+		mDeviceInfo->CreateBuffer(GetCountOffset(mSlotCount), VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, VULKAN_MEMORY_ACCESS_DYNAMIC, mBuffer, mMemory);
+		assert(mBuffer);
+	}
+
+	// DeInitialize
+	void VulkanDrawListInfo::DeInitialize()
+	{
+		if (mBuffer)
+			vmaDestroyBuffer(mDeviceInfo->mAllocator, mBuffer, mMemory);
+		mBuffer = VK_NULL_HANDLE;
+		mMemory = VK_NULL_HANDLE;
+		mCommands.clear();
+		fnCmdDrawIndexedIndirectCountKHR = nullptr;
+	}
+
+	// Begin
+	void VulkanDrawListInfo::Begin(uint32_t slot)
+	{
+		assert(slot < mSlotCount);
+		mSlot = slot;
+		mCommands.clear();
+	}
+
+	// Add
+	void VulkanDrawListInfo::Add(uint32_t indexCount, uint32_t instanceCount, uint32_t firstIndex, int32_t vertexOffset, uint32_t firstInstance)
+	{
+		// non zero first instance of indirect draw needs drawIndirectFirstInstance
+		assert((firstInstance == 0) || mDeviceInfo->mEnabledFeatures.drawIndirectFirstInstance);
+
+		// VkDrawIndexedIndirectCommand
+		VkDrawIndexedIndirectCommand command{};
+		command.indexCount = indexCount;
+		command.instanceCount = instanceCount;
+		command.firstIndex = firstIndex;
+		command.vertexOffset = vertexOffset;
+		command.firstInstance = firstInstance;
+		mCommands.push_back(command);
+	}
+
+	// End
+	void VulkanDrawListInfo::End()
+	{
+		// commands, then count (count is read only by vkCmdDrawIndexedIndirectCountKHR)
+		mDrawCount = std::min((uint32_t)mCommands.size(), mMaxDrawCount);
+		if (mDrawCount)
+			mDeviceInfo->WriteBuffer(mCommands.data(), GetCommandOffset(mSlot), mDrawCount * sizeof(VkDrawIndexedIndirectCommand), mBuffer, mMemory);
+		mDeviceInfo->WriteBuffer(&mDrawCount, GetCountOffset(mSlot), sizeof(mDrawCount), mBuffer, mMemory);
+	}
+
+	// Draw
+	void VulkanDrawListInfo::Draw(VkCommandBuffer commandBuffer) const
+	{
+		const uint32_t stride = sizeof(VkDrawIndexedIndirectCommand);
+		VkDeviceSize offset = GetCommandOffset(mSlot);
+
+		// one call, count from buffer (max count of call is limited by maxDrawIndirectCount)
+		if (fnCmdDrawIndexedIndirectCountKHR && (mMaxDrawCount <= mMaxDrawsPerCall)) {
+			fnCmdDrawIndexedIndirectCountKHR(commandBuffer, mBuffer, offset, mBuffer, GetCountOffset(mSlot), mMaxDrawCount, stride);
+			return;
+		}
+
+		// calls of up to maxDrawIndirectCount draws, count from last End
+		if (mDeviceInfo->mEnabledFeatures.multiDrawIndirect) {
+			for (uint32_t i = 0; i < mDrawCount; i += mMaxDrawsPerCall)
+				vkCmdDrawIndexedIndirect(commandBuffer, mBuffer, offset + i * stride, std::min(mDrawCount - i, mMaxDrawsPerCall), stride);
+			return;
+		}
+
+		// drawCount must be 0 or 1 without multiDrawIndirect
+		for (uint32_t i = 0; i < mDrawCount; i++)
+			vkCmdDrawIndexedIndirect(commandBuffer, mBuffer, offset + i * stride, 1, stride);
+	}
+}
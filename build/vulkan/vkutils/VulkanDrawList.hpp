@@ -0,0 +1,70 @@
+#pragma once
+
+#include "VulkanHelpers.hpp"
+
+// VulkanHelpers
+namespace VulkanHelpers
+{
+	// VulkanDrawIndirectFeatures
+	// indirect draw support query (multiDrawIndirect, drawIndirectFirstInstance and VK_KHR_draw_indirect_count)
+	struct VulkanDrawIndirectFeatures
+	{
+		VkBool32 mMultiDrawIndirect = VK_FALSE;
+		VkBool32 mDrawIndirectFirstInstance = VK_FALSE;
+		bool     mDrawIndirectCount = false;
+
+		// Query (adds extension name when VK_KHR_draw_indirect_count is supported)
+		void Query(VkPhysicalDevice physicalDevice, std::vector<const char*>& enabledExtensionNames);
+		// EnableFeatures (supported core features, physicalDeviceFeatures are passed to VulkanDeviceInfo::Initialize)
+		void EnableFeatures(VkPhysicalDeviceFeatures& physicalDeviceFeatures) const;
+	};
+
+	// VulkanDrawListInfo
+	// indexed draws are written as VkDrawIndexedIndirectCommand records and draw count into ring slot of persistently mapped buffer,
+	// whole list is submitted with one call: vkCmdDrawIndexedIndirectCountKHR (count is read by GPU, so recorded command buffers
+	// stay valid when it changes), vkCmdDrawIndexedIndirect with drawCount (multiDrawIndirect) or one vkCmdDrawIndexedIndirect per draw
+	struct VulkanDrawListInfo
+	{
+	private:
+		// base handles
+		VulkanDeviceInfo* mDeviceInfo = nullptr;
+
+		// VK_KHR_draw_indirect_count (nullptr - not enabled)
+		PFN_vkCmdDrawIndexedIndirectCountKHR fnCmdDrawIndexedIndirectCountKHR = nullptr;
+
+		// commands of current slot
+		std::vector<VkDrawIndexedIndirectCommand> mCommands{};
+
+		// ring (commands of all slots, then draw counts of all slots)
+		uint32_t mMaxDrawCount = 0; // per slot
+		uint32_t mMaxDrawsPerCall = 0; // maxDrawIndirectCount (1 without multiDrawIndirect)
+		uint32_t mSlotCount = 0;
+		uint32_t mSlot = 0;
+		uint32_t mDrawCount = 0;    // written by last End
+	public:
+		// buffer (own, indirect and storage usage, so GPU can write commands too)
+		VkBuffer      mBuffer = VK_NULL_HANDLE;
+		VmaAllocation mMemory = VK_NULL_HANDLE;
+
+		// Init/DeInit functions (slotCount - frames in flight or cached command buffers, maxDrawCount - per slot)
+		void Initialize(VulkanDeviceInfo& deviceInfo, uint32_t maxDrawCount, uint32_t slotCount);
+		void DeInitialize();
+
+		// Begin (slot is not read by GPU anymore)
+		void Begin(uint32_t slot);
+		// Add draw (draws over mMaxDrawCount are dropped by End)
+		void Add(uint32_t indexCount, uint32_t instanceCount, uint32_t firstIndex, int32_t vertexOffset, uint32_t firstInstance);
+		// End (writes commands and draw count of slot)
+		void End();
+
+		// Draw (all draws of current slot, pipeline, descriptor sets and vertex and index buffers must be bound)
+		void Draw(VkCommandBuffer commandBuffer) const;
+
+		// get functions
+		VkDeviceSize GetCommandOffset(uint32_t slot) const { return (VkDeviceSize)slot * mMaxDrawCount * sizeof(VkDrawIndexedIndirectCommand); }
+		VkDeviceSize GetCountOffset(uint32_t slot) const { return GetCommandOffset(mSlotCount) + (VkDeviceSize)slot * sizeof(uint32_t); }
+		uint32_t GetMaxDrawCount() const { return mMaxDrawCount; }
+		uint32_t GetDrawCount() const { return mDrawCount; }
+		bool IsDrawCountSupported() const { return fnCmdDrawIndexedIndirectCountKHR != nullptr; }
+	};
+}
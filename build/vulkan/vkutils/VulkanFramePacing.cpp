@@ -0,0 +1,129 @@
+#include "VulkanFramePacing.hpp"
+#include <cassert>
+#include <cstring>
+#include <thread>
+
+// VulkanHelpers
+namespace VulkanHelpers {
+	//////////////////////////////////////////////////////////////////////////
+	// VulkanPresentWaitFeatures
+	//////////////////////////////////////////////////////////////////////////
+
+	// Query
+	void VulkanPresentWaitFeatures::Query(VkPhysicalDevice physicalDevice, std::vector<const char*>& enabledExtensionNames)
+	{
+		mSupported = false;
+
+		// get device extension properties
+		uint32_t extensionPropertiesCount = 0;
+		vkEnumerateDeviceExtensionProperties(physicalDevice, VK_NULL_HANDLE, &extensionPropertiesCount, nullptr);
+		std::vector<VkExtensionProperties> extensionProperties(extensionPropertiesCount);
+		vkEnumerateDeviceExtensionProperties(physicalDevice, VK_NULL_HANDLE, &extensionPropertiesCount, extensionProperties.data());
+
+		// both extensions are needed
+		bool presentIdSupported = false;
+		bool presentWaitSupported = false;
+		for (const auto& properties : extensionProperties)
+		{
+			presentIdSupported |= strcmp(properties.extensionName, VK_KHR_PRESENT_ID_EXTENSION_NAME) == 0;
+			presentWaitSupported |= strcmp(properties.extensionName, VK_KHR_PRESENT_WAIT_EXTENSION_NAME) == 0;
+		}
+		if (!presentIdSupported || !presentWaitSupported)
+			return;
+
+		// VkPhysicalDevicePresentIdFeaturesKHR
+		mPresentIdFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PRESENT_ID_FEATURES_KHR;
+		mPresentIdFeatures.pNext = &mPresentWaitFeatures;
+		mPresentIdFeatures.presentId = VK_FALSE;
+
+		// VkPhysicalDevicePresentWaitFeaturesKHR
+		mPresentWaitFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PRESENT_WAIT_FEATURES_KHR;
+		mPresentWaitFeatures.pNext = VK_NULL_HANDLE;
+		mPresentWaitFeatures.presentWait = VK_FALSE;
+
+		// VkPhysicalDeviceFeatures2
+		VkPhysicalDeviceFeatures2 physicalDeviceFeatures2{};
+		physicalDeviceFeatures2.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+		physicalDeviceFeatures2.pNext = &mPresentIdFeatures;
+		vkGetPhysicalDeviceFeatures2(physicalDevice, &physicalDeviceFeatures2);
+
+		// enable extensions
+		mSupported = mPresentIdFeatures.presentId && mPresentWaitFeatures.presentWait;
+		if (mSupported)
+		{
+			enabledExtensionNames.push_back(VK_KHR_PRESENT_ID_EXTENSION_NAME);
+			enabledExtensionNames.push_back(VK_KHR_PRESENT_WAIT_EXTENSION_NAME);
+		}
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+	// VulkanFramePacingInfo
+	//////////////////////////////////////////////////////////////////////////
+
+	// Initialize
+	void VulkanFramePacingInfo::Initialize(VulkanDeviceInfo& deviceInfo)
+	{
+		// store parameters
+		mDeviceInfo = &deviceInfo;
+		assert(mDeviceInfo->mDevice);
+
+		// vkWaitForPresentKHR
+		fnWaitForPresentKHR = nullptr;
+		if (mDeviceInfo->IsExtensionEnabled(VK_KHR_PRESENT_WAIT_EXTENSION_NAME))
+			fnWaitForPresentKHR = (PFN_vkWaitForPresentKHR)vkGetDeviceProcAddr(mDeviceInfo->mDevice, "vkWaitForPresentKHR");
+
+		// limiter starts on first frame
+		mNextFrameTime = std::chrono::high_resolution_clock::time_point();
+	}
+
+	// DeInitialize
+	void VulkanFramePacingInfo::DeInitialize()
+	{
+		fnWaitForPresentKHR = nullptr;
+		mDeviceInfo = nullptr;
+	}
+
+	// WaitForFrame
+	void VulkanFramePacingInfo::WaitForFrame(const VulkanSwapchainInfo& swapchainInfo)
+	{
+		using clock = std::chrono::high_resolution_clock;
+		using milliseconds = std::chrono::duration<double, std::milli>;
+
+		// wait until present mMaxFramesAhead frames back is displayed (older swapchains can't be waited)
+		auto presentWaitTimeBegin = clock::now();
+		if (fnWaitForPresentKHR && swapchainInfo.mPresentIdEnabled && (mMaxFramesAhead > 0) && (swapchainInfo.mPresentId >= mMaxFramesAhead))
+		{
+			uint64_t presentId = swapchainInfo.mPresentId + 1 - mMaxFramesAhead;
+			if (presentId >= swapchainInfo.mFirstPresentId)
+			{
+				// VK_TIMEOUT and VK_ERROR_OUT_OF_DATE_KHR are fine here, frame goes on
+				VkResult result = fnWaitForPresentKHR(mDeviceInfo->mDevice, swapchainInfo.mSwapchain, presentId, mPresentWaitTimeout);
+				(void)result;
+			}
+		}
+		auto presentWaitTimeEnd = clock::now();
+		mLastPresentWaitTime = std::chrono::duration_cast<milliseconds>(presentWaitTimeEnd - presentWaitTimeBegin).count();
+
+		// frame rate limiter
+		mLastLimiterWaitTime = 0.0;
+		if (mTargetFrameTime <= 0.0)
+			return;
+		auto targetFrameTime = std::chrono::duration_cast<clock::duration>(std::chrono::duration<double>(mTargetFrameTime));
+		auto spinTime = std::chrono::duration_cast<clock::duration>(std::chrono::duration<double>(mSpinTime));
+
+		// restart deadline on first frame or when more than one frame behind (no catch up bursts)
+		auto now = clock::now();
+		if ((mNextFrameTime == clock::time_point()) || (now > mNextFrameTime + targetFrameTime))
+			mNextFrameTime = now;
+
+		// sleep coarse part, spin rest
+		if (now < mNextFrameTime - spinTime)
+			std::this_thread::sleep_for(mNextFrameTime - spinTime - now);
+		while (clock::now() < mNextFrameTime)
+			std::this_thread::yield();
+
+		// next deadline
+		mLastLimiterWaitTime = std::chrono::duration_cast<milliseconds>(clock::now() - now).count();
+		mNextFrameTime += targetFrameTime;
+	}
+}
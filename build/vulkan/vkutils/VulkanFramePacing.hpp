@@ -0,0 +1,59 @@
+#pragma once
+
+#include "VulkanHelpers.hpp"
+#include <chrono>
+
+// VulkanHelpers
+namespace VulkanHelpers
+{
+	// VulkanPresentWaitFeatures
+	// VK_KHR_present_id and VK_KHR_present_wait support query (chain to VkDeviceCreateInfo, do not copy after Query)
+	struct VulkanPresentWaitFeatures
+	{
+		VkPhysicalDevicePresentIdFeaturesKHR   mPresentIdFeatures{};
+		VkPhysicalDevicePresentWaitFeaturesKHR mPresentWaitFeatures{};
+		bool                                   mSupported = false;
+
+		// Query (adds extension names when both extensions and features are supported)
+		void Query(VkPhysicalDevice physicalDevice, std::vector<const char*>& enabledExtensionNames);
+		const void* GetDeviceCreateInfoNext() const { return mSupported ? &mPresentIdFeatures : nullptr; }
+	};
+
+	// VulkanFramePacingInfo
+	// keeps CPU at most mMaxFramesAhead presents ahead of display (present wait) and limits frame rate (sleep then spin)
+	struct VulkanFramePacingInfo
+	{
+	private:
+		// base handles
+		VulkanDeviceInfo* mDeviceInfo = nullptr;
+
+		// VK_KHR_present_wait (nullptr - not enabled)
+		PFN_vkWaitForPresentKHR fnWaitForPresentKHR = nullptr;
+
+		// limiter deadline of next frame
+		std::chrono::high_resolution_clock::time_point mNextFrameTime{};
+	public:
+		// frame rate limit (seconds per frame, 0 - unlimited)
+		double mTargetFrameTime = 0.0;
+		// last part of limiter wait is spun (sleep granularity is about 1-2 ms)
+		double mSpinTime = 0.002;
+		// presents CPU can be ahead of display (0 - no present wait)
+		uint32_t mMaxFramesAhead = 1;
+		// present wait timeout (nanoseconds)
+		uint64_t mPresentWaitTimeout = 100000000;
+
+		// statistics of last WaitForFrame call (milliseconds)
+		double mLastPresentWaitTime = 0.0;
+		double mLastLimiterWaitTime = 0.0;
+
+		// Init/DeInit functions
+		void Initialize(VulkanDeviceInfo& deviceInfo);
+		void DeInitialize();
+
+		// get functions
+		bool IsPresentWaitEnabled() const { return fnWaitForPresentKHR != nullptr; }
+
+		// WaitForFrame (call before frame begins)
+		void WaitForFrame(const VulkanSwapchainInfo& swapchainInfo);
+	};
+}
@@ -0,0 +1,154 @@
+#include "VulkanFrameRing.hpp"
+#include <cassert>
+
+// VulkanHelpers
+namespace VulkanHelpers {
+	//////////////////////////////////////////////////////////////////////////
+	// VulkanFrameRingInfo
+	//////////////////////////////////////////////////////////////////////////
+
+	// Initialize
+	void VulkanFrameRingInfo::Initialize(VulkanDeviceInfo& deviceInfo, uint32_t framesInFlight)
+	{
+		// store parameters
+		mDeviceInfo = &deviceInfo;
+		assert(mDeviceInfo->mDevice);
+		assert((framesInFlight >= 2) && (framesInFlight <= VULKAN_MAX_FRAMES_IN_FLIGHT));
+
+		// create frames
+		mFrames.resize(framesInFlight);
+		for (auto& frame : mFrames)
+		{
+			// VkCommandPoolCreateInfo (command buffers live one frame)
+			VkCommandPoolCreateInfo commandPoolCreateInfo{};
+			commandPoolCreateInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+			commandPoolCreateInfo.pNext = VK_NULL_HANDLE;
+			commandPoolCreateInfo.flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT;
+			commandPoolCreateInfo.queueFamilyIndex = mDeviceInfo->mQueueFamilyIndexGraphics;
+			VK_CHECK(vkCreateCommandPool(mDeviceInfo->mDevice, &commandPoolCreateInfo, VK_NULL_HANDLE, &frame.mCommandPool));
+			assert(frame.mCommandPool);
+
+			// VkCommandBufferAllocateInfo
+			VkCommandBufferAllocateInfo commandBufferAllocateInfo{};
+			commandBufferAllocateInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+			commandBufferAllocateInfo.pNext = VK_NULL_HANDLE;
+			commandBufferAllocateInfo.commandPool = frame.mCommandPool;
+			commandBufferAllocateInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+			commandBufferAllocateInfo.commandBufferCount = 1;
+			VK_CHECK(vkAllocateCommandBuffers(mDeviceInfo->mDevice, &commandBufferAllocateInfo, &frame.mCommandBuffer));
+			assert(frame.mCommandBuffer);
+
+			// create semaphores
+			frame.mImageAvailableSemaphore = mDeviceInfo->CreateSemaphore();
+			frame.mRenderFinishedSemaphore = mDeviceInfo->CreateSemaphore();
+			assert(frame.mImageAvailableSemaphore);
+			assert(frame.mRenderFinishedSemaphore);
+
+			// create fence (signaled, first use of frame must not wait)
+			frame.mFence = mDeviceInfo->CreateFence(VK_FENCE_CREATE_SIGNALED_BIT);
+			assert(frame.mFence);
+		}
+
+		// reset state
+		mFrameIndex = 0;
+		mFrameNumber = 0;
+	}
+
+	// DeInitialize
+	void VulkanFrameRingInfo::DeInitialize()
+	{
+		// frames can be still in flight
+		WaitIdle();
+
+		// destroy frames
+		for (auto& frame : mFrames)
+		{
+			vkDestroyFence(mDeviceInfo->mDevice, frame.mFence, VK_NULL_HANDLE);
+			vkDestroySemaphore(mDeviceInfo->mDevice, frame.mRenderFinishedSemaphore, VK_NULL_HANDLE);
+			vkDestroySemaphore(mDeviceInfo->mDevice, frame.mImageAvailableSemaphore, VK_NULL_HANDLE);
+			vkDestroyCommandPool(mDeviceInfo->mDevice, frame.mCommandPool, VK_NULL_HANDLE);
+		}
+		mFrames.clear();
+		mImagesInFlight.clear();
+	}
+
+	// BeginFrame
+	VulkanFrameInfo& VulkanFrameRingInfo::BeginFrame()
+	{
+		// wait for GPU to finish frame submitted framesInFlight frames ago
+		VulkanFrameInfo& frame = mFrames[mFrameIndex];
+		VK_CHECK(vkWaitForFences(mDeviceInfo->mDevice, 1, &frame.mFence, VK_TRUE, UINT64_MAX));
+
+		// frames up to the one just waited for are finished, destroy what they used
+		uint64_t framesInFlight = mFrames.size();
+		if (mFrameNumber >= framesInFlight)
+			mDeletionQueue.Flush(mFrameNumber - framesInFlight + 1);
+
+		// recycle all command buffers of this frame at once
+		VK_CHECK(vkResetCommandPool(mDeviceInfo->mDevice, frame.mCommandPool, 0));
+		return frame;
+	}
+
+	// WaitImage
+	void VulkanFrameRingInfo::WaitImage(uint32_t imageIndex, uint32_t imageCount)
+	{
+		// swapchain image count can change on recreation (keep tracking of images that stay)
+		if (mImagesInFlight.size() < imageCount)
+			mImagesInFlight.resize(imageCount, VK_NULL_HANDLE);
+		assert(imageIndex < imageCount);
+
+		// acquire can return image still used by other frame in flight
+		VulkanFrameInfo& frame = mFrames[mFrameIndex];
+		VkFence imageFence = mImagesInFlight[imageIndex];
+		if (imageFence && (imageFence != frame.mFence))
+			VK_CHECK(vkWaitForFences(mDeviceInfo->mDevice, 1, &imageFence, VK_TRUE, UINT64_MAX));
+		mImagesInFlight[imageIndex] = frame.mFence;
+	}
+
+	// EndFrame
+	void VulkanFrameRingInfo::EndFrame(VkQueue queue, VkPipelineStageFlags waitStageMask)
+	{
+		EndFrame(queue, waitStageMask, mFrames[mFrameIndex].mCommandBuffer);
+	}
+
+	// EndFrame (external command buffer)
+	void VulkanFrameRingInfo::EndFrame(VkQueue queue, VkPipelineStageFlags waitStageMask, VkCommandBuffer commandBuffer)
+	{
+		// fence is reset only when frame is really submitted
+		VulkanFrameInfo& frame = mFrames[mFrameIndex];
+		VK_CHECK(vkResetFences(mDeviceInfo->mDevice, 1, &frame.mFence));
+
+		// VkSubmitInfo
+		VkSubmitInfo submitInfo{};
+		submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+		submitInfo.pNext = VK_NULL_HANDLE;
+		submitInfo.waitSemaphoreCount = 1;
+		submitInfo.pWaitSemaphores = &frame.mImageAvailableSemaphore;
+		submitInfo.pWaitDstStageMask = &waitStageMask;
+		submitInfo.commandBufferCount = 1;
+		submitInfo.pCommandBuffers = &commandBuffer;
+		submitInfo.signalSemaphoreCount = 1;
+		submitInfo.pSignalSemaphores = &frame.mRenderFinishedSemaphore;
+		VK_CHECK(vkQueueSubmit(queue, 1, &submitInfo, frame.mFence));
+
+		// next frame
+		mFrameIndex = (mFrameIndex + 1) % (uint32_t)mFrames.size();
+		mFrameNumber++;
+	}
+
+	// WaitIdle
+	void VulkanFrameRingInfo::WaitIdle()
+	{
+		// collect fences
+		std::vector<VkFence> fences{};
+		for (const auto& frame : mFrames)
+			fences.push_back(frame.mFence);
+
+		// wait all frames
+		if (fences.size())
+			VK_CHECK(vkWaitForFences(mDeviceInfo->mDevice, (uint32_t)fences.size(), fences.data(), VK_TRUE, UINT64_MAX));
+
+		// nothing is in flight anymore
+		mDeletionQueue.FlushAll();
+	}
+}
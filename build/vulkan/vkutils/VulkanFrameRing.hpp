@@ -0,0 +1,64 @@
+#pragma once
+
+#include "VulkanHelpers.hpp"
+
+// VulkanHelpers
+namespace VulkanHelpers
+{
+	// max frames CPU can record ahead of GPU
+	const uint32_t VULKAN_MAX_FRAMES_IN_FLIGHT = 3;
+
+	// VulkanFrameInfo
+	// handles owned by one frame of the ring, reused only after its fence is signaled
+	struct VulkanFrameInfo
+	{
+		// command recording (transient pool, reset when frame is reused)
+		VkCommandPool   mCommandPool = VK_NULL_HANDLE;
+		VkCommandBuffer mCommandBuffer = VK_NULL_HANDLE;
+
+		// synchronization
+		VkSemaphore mImageAvailableSemaphore = VK_NULL_HANDLE;
+		VkSemaphore mRenderFinishedSemaphore = VK_NULL_HANDLE;
+		VkFence     mFence = VK_NULL_HANDLE;
+	};
+
+	// VulkanFrameRingInfo
+	struct VulkanFrameRingInfo
+	{
+	private:
+		// base handles
+		VulkanDeviceInfo* mDeviceInfo = nullptr;
+
+		// frames (own)
+		std::vector<VulkanFrameInfo> mFrames{};
+
+		// fence of the frame that last rendered to each swapchain image
+		std::vector<VkFence> mImagesInFlight{};
+	public:
+		// current frame index in ring and total frames count
+		uint32_t mFrameIndex = 0;
+		uint64_t mFrameNumber = 0;
+
+		// handles retired while frames are in flight (flushed as frames complete)
+		VulkanDeletionQueue mDeletionQueue{};
+
+		// Init/DeInit functions
+		void Initialize(VulkanDeviceInfo& deviceInfo, uint32_t framesInFlight);
+		void DeInitialize();
+
+		// frame processing
+		// BeginFrame waits only for the frame being reused and resets its command pool
+		VulkanFrameInfo& BeginFrame();
+		// WaitImage waits for previous frame rendered to swapchain image (needed when per-image resources are reused)
+		void WaitImage(uint32_t imageIndex, uint32_t imageCount);
+		// EndFrame submits frame command buffer (waits image available, signals render finished and fence)
+		void EndFrame(VkQueue queue, VkPipelineStageFlags waitStageMask);
+		void EndFrame(VkQueue queue, VkPipelineStageFlags waitStageMask, VkCommandBuffer commandBuffer);
+		// WaitIdle waits for all frames in flight
+		void WaitIdle();
+
+		// get functions
+		uint32_t GetFramesInFlight() const { return (uint32_t)mFrames.size(); }
+		VulkanFrameInfo& GetCurrentFrame() { return mFrames[mFrameIndex]; }
+	};
+}
@@ -0,0 +1,366 @@
+#include "VulkanFrustumCulling.hpp"
+#include <cassert>
+#include <cfloat>
+#include <cmath>
+#include <chrono>
+#include <algorithm>
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+// AVX2 functions are compiled for AVX2 without global flag, they run only when IsAvx2Supported
+#if defined(__GNUC__) && !defined(__AVX2__)
+#define VULKAN_AVX2_FUNCTION __attribute__((target("avx2")))
+#else
+#define VULKAN_AVX2_FUNCTION
+#endif
+
+// VulkanHelpers
+namespace VulkanHelpers {
+	//////////////////////////////////////////////////////////////////////////
+	// helpers
+	//////////////////////////////////////////////////////////////////////////
+
+	// VulkanCompactTable (lanes of visible objects moved to front for each movemask, and their count)
+	struct VulkanCompactTable
+	{
+		uint32_t mLanes[256][VULKAN_FRUSTUM_CULL_WIDTH];
+		uint32_t mCounts[256];
+
+		VulkanCompactTable()
+		{
+			for (uint32_t mask = 0; mask < 256; mask++) {
+				uint32_t count = 0;
+				for (uint32_t lane = 0; lane < VULKAN_FRUSTUM_CULL_WIDTH; lane++)
+					if (mask & (1u << lane))
+						mLanes[mask][count++] = lane;
+				mCounts[mask] = count;
+				for (uint32_t lane = count; lane < VULKAN_FRUSTUM_CULL_WIDTH; lane++)
+					mLanes[mask][lane] = 0;
+			}
+		}
+	};
+
+	// GetCompactTable
+	static const VulkanCompactTable& GetCompactTable()
+	{
+		static const VulkanCompactTable compactTable;
+		return compactTable;
+	}
+
+	// IsVisible (same operations in same order as CullRangeAvx2, so both paths give same results)
+	static inline bool IsVisible(const VulkanFrustum& frustum, float centerX, float centerY, float centerZ, float radius,
+		const float min[3], const float max[3])
+	{
+		for (const auto& plane : frustum.mPlanes) {
+			// sphere
+			float distance = plane[0] * centerX + plane[1] * centerY + plane[2] * centerZ + plane[3];
+			if (!(distance + radius >= 0.0f))
+				return false;
+			// AABB (corner furthest along normal)
+			float x = (plane[0] >= 0.0f) ? max[0] : min[0];
+			float y = (plane[1] >= 0.0f) ? max[1] : min[1];
+			float z = (plane[2] >= 0.0f) ? max[2] : min[2];
+			if (!(plane[0] * x + plane[1] * y + plane[2] * z + plane[3] >= 0.0f))
+				return false;
+		}
+		return true;
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+	// VulkanFrustum
+	//////////////////////////////////////////////////////////////////////////
+
+	// SetViewProjection
+	void VulkanFrustum::SetViewProjection(const DirectX::XMMATRIX& viewProj)
+	{
+		// clip = position * viewProj, so clip components are dot products with columns
+		DirectX::XMFLOAT4X4 matrix{};
+		DirectX::XMStoreFloat4x4(&matrix, viewProj);
+		auto column = [&matrix](uint32_t i, float sign, uint32_t j, float* plane) {
+			for (uint32_t k = 0; k < 4; k++)
+				plane[k] = matrix.m[k][i] + sign * matrix.m[k][j];
+		};
+
+		// left, right, bottom, top (-w <= x, y <= w), near and far (0 <= z <= w)
+		column(3, +1.0f, 0, mPlanes[0]);
+		column(3, -1.0f, 0, mPlanes[1]);
+		column(3, +1.0f, 1, mPlanes[2]);
+		column(3, -1.0f, 1, mPlanes[3]);
+		column(2, +0.0f, 0, mPlanes[4]);
+		column(3, -1.0f, 2, mPlanes[5]);
+
+		// normalized planes give distances in world units
+		for (auto& plane : mPlanes) {
+			float length = std::sqrt(plane[0] * plane[0] + plane[1] * plane[1] + plane[2] * plane[2]);
+			for (uint32_t k = 0; k < 4; k++)
+				plane[k] /= length;
+		}
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+	// VulkanBounds
+	//////////////////////////////////////////////////////////////////////////
+
+	// SetTransformed
+	void VulkanBounds::SetTransformed(const DirectX::XMFLOAT3& localMin, const DirectX::XMFLOAT3& localMax, const DirectX::XMMATRIX& transform)
+	{
+		DirectX::XMFLOAT4X4 matrix{};
+		DirectX::XMStoreFloat4x4(&matrix, transform);
+		const float center[3] = { (localMin.x + localMax.x) * 0.5f, (localMin.y + localMax.y) * 0.5f, (localMin.z + localMax.z) * 0.5f };
+		const float extent[3] = { (localMax.x - localMin.x) * 0.5f, (localMax.y - localMin.y) * 0.5f, (localMax.z - localMin.z) * 0.5f };
+
+		// world AABB (transformed center, extent of rows by absolute matrix)
+		for (uint32_t j = 0; j < 3; j++) {
+			float worldCenter = matrix.m[3][j];
+			float worldExtent = 0.0f;
+			for (uint32_t i = 0; i < 3; i++) {
+				worldCenter += center[i] * matrix.m[i][j];
+				worldExtent += extent[i] * std::fabs(matrix.m[i][j]);
+			}
+			mMin[j] = worldCenter - worldExtent;
+			mMax[j] = worldCenter + worldExtent;
+			mSphere[j] = worldCenter;
+		}
+
+		// sphere (rows are transformed axes)
+		float scale = 0.0f;
+		for (uint32_t i = 0; i < 3; i++)
+			scale = std::max(scale, matrix.m[i][0] * matrix.m[i][0] + matrix.m[i][1] * matrix.m[i][1] + matrix.m[i][2] * matrix.m[i][2]);
+		mSphere[3] = std::sqrt((extent[0] * extent[0] + extent[1] * extent[1] + extent[2] * extent[2]) * scale);
+	}
+
+	// GetLocalBounds
+	void VulkanBounds::GetLocalBounds(const void* vertices, uint32_t vertexCount, uint32_t stride, DirectX::XMFLOAT3& localMin, DirectX::XMFLOAT3& localMax)
+	{
+		assert(vertices || !vertexCount);
+		localMin = DirectX::XMFLOAT3(FLT_MAX, FLT_MAX, FLT_MAX);
+		localMax = DirectX::XMFLOAT3(-FLT_MAX, -FLT_MAX, -FLT_MAX);
+		for (uint32_t i = 0; i < vertexCount; i++) {
+			const float* position = (const float*)((const uint8_t*)vertices + (size_t)i * stride);
+			localMin = DirectX::XMFLOAT3(std::min(localMin.x, position[0]), std::min(localMin.y, position[1]), std::min(localMin.z, position[2]));
+			localMax = DirectX::XMFLOAT3(std::max(localMax.x, position[0]), std::max(localMax.y, position[1]), std::max(localMax.z, position[2]));
+		}
+
+		// no vertices, point at origin
+		if (!vertexCount) {
+			localMin = DirectX::XMFLOAT3(0.0f, 0.0f, 0.0f);
+			localMax = DirectX::XMFLOAT3(0.0f, 0.0f, 0.0f);
+		}
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+	// VulkanFrustumCullingInfo
+	//////////////////////////////////////////////////////////////////////////
+
+	// Initialize
+	void VulkanFrustumCullingInfo::Initialize(CThreadPool& threadPool)
+	{
+		mThreadPool = &threadPool;
+		mAvx2 = IsAvx2Supported();
+		GetCompactTable();
+	}
+
+	// DeInitialize
+	void VulkanFrustumCullingInfo::DeInitialize()
+	{
+		Resize(0);
+		mVisibleIndices.clear();
+		mTaskVisibleCounts.clear();
+		mVisibleCount = 0;
+		mThreadPool = nullptr;
+	}
+
+	// Resize
+	void VulkanFrustumCullingInfo::Resize(uint32_t objectCount)
+	{
+		// padded to whole vectors
+		mObjectCount = objectCount;
+		size_t paddedCount = (objectCount + VULKAN_FRUSTUM_CULL_WIDTH - 1) / VULKAN_FRUSTUM_CULL_WIDTH * VULKAN_FRUSTUM_CULL_WIDTH;
+		for (auto* stream : { &mCenterX, &mCenterY, &mCenterZ, &mMinX, &mMinY, &mMinZ, &mMaxX, &mMaxY, &mMaxZ })
+			stream->resize(paddedCount, 0.0f);
+		mRadius.resize(paddedCount, -FLT_MAX);
+
+		// shrinking leaves bounds of removed objects in padding
+		for (size_t i = objectCount; i < paddedCount; i++)
+			mRadius[i] = -FLT_MAX;
+		mVisibleCount = 0;
+	}
+
+	// SetBounds
+	void VulkanFrustumCullingInfo::SetBounds(uint32_t index, const VulkanBounds& bounds)
+	{
+		assert(index < mObjectCount);
+		mCenterX[index] = bounds.mSphere[0];
+		mCenterY[index] = bounds.mSphere[1];
+		mCenterZ[index] = bounds.mSphere[2];
+		mRadius[index] = bounds.mSphere[3];
+		mMinX[index] = bounds.mMin[0];
+		mMinY[index] = bounds.mMin[1];
+		mMinZ[index] = bounds.mMin[2];
+		mMaxX[index] = bounds.mMax[0];
+		mMaxY[index] = bounds.mMax[1];
+		mMaxZ[index] = bounds.mMax[2];
+	}
+
+	// Cull
+	void VulkanFrustumCullingInfo::Cull(const DirectX::XMMATRIX& viewProj)
+	{
+		VulkanFrustum frustum{};
+		frustum.SetViewProjection(viewProj);
+		Cull(frustum);
+	}
+
+	// Cull
+	void VulkanFrustumCullingInfo::Cull(const VulkanFrustum& frustum)
+	{
+		assert(mThreadPool);
+
+		// cull start time
+		auto cullTimeBegin = std::chrono::high_resolution_clock::now();
+
+		// split objects in ranges of whole vectors (at least one range per thread when there are enough objects)
+		uint32_t paddedCount = (uint32_t)mRadius.size();
+		uint32_t threadCount = mThreadPool->GetThreadCount();
+		uint32_t objectsPerTask = std::max(mMinObjectsPerTask, (paddedCount + threadCount - 1) / threadCount);
+		objectsPerTask = std::max((objectsPerTask + VULKAN_FRUSTUM_CULL_WIDTH - 1) / VULKAN_FRUSTUM_CULL_WIDTH * VULKAN_FRUSTUM_CULL_WIDTH, VULKAN_FRUSTUM_CULL_WIDTH);
+		uint32_t taskCount = (paddedCount + objectsPerTask - 1) / objectsPerTask;
+
+		// each range compacts into own region (vector stores may write past its last visible index)
+		size_t regionSize = objectsPerTask + VULKAN_FRUSTUM_CULL_WIDTH;
+		if (mVisibleIndices.size() < taskCount * regionSize)
+			mVisibleIndices.resize(taskCount * regionSize);
+		mTaskVisibleCounts.resize(taskCount);
+
+		// cull ranges on workers
+		auto cullRange = mAvx2 ? &CullRangeAvx2 : &CullRangeScalar;
+		mThreadPool->Dispatch(taskCount, [&](uint32_t taskIndex, uint32_t threadIndex) {
+			uint32_t objectBegin = taskIndex * objectsPerTask;
+			uint32_t objectEnd = std::min(objectBegin + objectsPerTask, paddedCount);
+			mTaskVisibleCounts[taskIndex] = cullRange(*this, frustum, objectBegin, objectEnd, mVisibleIndices.data() + taskIndex * regionSize);
+		});
+
+		// move regions together (destination is never after source)
+		mVisibleCount = 0;
+		for (uint32_t i = 0; i < taskCount; i++) {
+			const uint32_t* region = mVisibleIndices.data() + i * regionSize;
+			std::copy(region, region + mTaskVisibleCounts[i], mVisibleIndices.data() + mVisibleCount);
+			mVisibleCount += mTaskVisibleCounts[i];
+		}
+
+		// cull time
+		auto cullTimeEnd = std::chrono::high_resolution_clock::now();
+		mLastCullTime = std::chrono::duration_cast<std::chrono::duration<double, std::milli>>(cullTimeEnd - cullTimeBegin).count();
+	}
+
+	// CullRangeScalar
+	uint32_t VulkanFrustumCullingInfo::CullRangeScalar(const VulkanFrustumCullingInfo& info, const VulkanFrustum& frustum, uint32_t objectBegin, uint32_t objectEnd, uint32_t* visibleIndices)
+	{
+		uint32_t visibleCount = 0;
+		for (uint32_t i = objectBegin; i < objectEnd; i++) {
+			const float min[3] = { info.mMinX[i], info.mMinY[i], info.mMinZ[i] };
+			const float max[3] = { info.mMaxX[i], info.mMaxY[i], info.mMaxZ[i] };
+			if (IsVisible(frustum, info.mCenterX[i], info.mCenterY[i], info.mCenterZ[i], info.mRadius[i], min, max))
+				visibleIndices[visibleCount++] = i;
+		}
+		return visibleCount;
+	}
+
+	// CullRangeAvx2
+	VULKAN_AVX2_FUNCTION
+	uint32_t VulkanFrustumCullingInfo::CullRangeAvx2(const VulkanFrustumCullingInfo& info, const VulkanFrustum& frustum, uint32_t objectBegin, uint32_t objectEnd, uint32_t* visibleIndices)
+	{
+		assert((objectBegin % VULKAN_FRUSTUM_CULL_WIDTH) == 0);
+		assert((objectEnd % VULKAN_FRUSTUM_CULL_WIDTH) == 0);
+		const VulkanCompactTable& compactTable = GetCompactTable();
+
+		// planes broadcast once (corner of AABB is selected by sign of normal, which is same for all lanes)
+		__m256 planeX[6], planeY[6], planeZ[6], planeW[6];
+		bool positiveX[6], positiveY[6], positiveZ[6];
+		for (uint32_t p = 0; p < 6; p++) {
+			planeX[p] = _mm256_set1_ps(frustum.mPlanes[p][0]);
+			planeY[p] = _mm256_set1_ps(frustum.mPlanes[p][1]);
+			planeZ[p] = _mm256_set1_ps(frustum.mPlanes[p][2]);
+			planeW[p] = _mm256_set1_ps(frustum.mPlanes[p][3]);
+			positiveX[p] = frustum.mPlanes[p][0] >= 0.0f;
+			positiveY[p] = frustum.mPlanes[p][1] >= 0.0f;
+			positiveZ[p] = frustum.mPlanes[p][2] >= 0.0f;
+		}
+		const __m256 zero = _mm256_setzero_ps();
+		const __m256i lanes = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+
+		uint32_t visibleCount = 0;
+		for (uint32_t i = objectBegin; i < objectEnd; i += VULKAN_FRUSTUM_CULL_WIDTH) {
+			__m256 centerX = _mm256_loadu_ps(info.mCenterX.data() + i);
+			__m256 centerY = _mm256_loadu_ps(info.mCenterY.data() + i);
+			__m256 centerZ = _mm256_loadu_ps(info.mCenterZ.data() + i);
+			__m256 radius = _mm256_loadu_ps(info.mRadius.data() + i);
+			__m256 minX = _mm256_loadu_ps(info.mMinX.data() + i);
+			__m256 minY = _mm256_loadu_ps(info.mMinY.data() + i);
+			__m256 minZ = _mm256_loadu_ps(info.mMinZ.data() + i);
+			__m256 maxX = _mm256_loadu_ps(info.mMaxX.data() + i);
+			__m256 maxY = _mm256_loadu_ps(info.mMaxY.data() + i);
+			__m256 maxZ = _mm256_loadu_ps(info.mMaxZ.data() + i);
+
+			// visible lanes (all bits set), vectors culled by some plane skip the others
+			int mask = 0xFF;
+			__m256 visible = _mm256_castsi256_ps(_mm256_set1_epi32(-1));
+			for (uint32_t p = 0; (p < 6) && mask; p++) {
+				// sphere
+				__m256 distance = _mm256_add_ps(_mm256_add_ps(_mm256_add_ps(
+					_mm256_mul_ps(planeX[p], centerX), _mm256_mul_ps(planeY[p], centerY)), _mm256_mul_ps(planeZ[p], centerZ)), planeW[p]);
+				visible = _mm256_and_ps(visible, _mm256_cmp_ps(_mm256_add_ps(distance, radius), zero, _CMP_GE_OQ));
+				// AABB (corner furthest along normal)
+				distance = _mm256_add_ps(_mm256_add_ps(_mm256_add_ps(
+					_mm256_mul_ps(planeX[p], positiveX[p] ? maxX : minX),
+					_mm256_mul_ps(planeY[p], positiveY[p] ? maxY : minY)),
+					_mm256_mul_ps(planeZ[p], positiveZ[p] ? maxZ : minZ)), planeW[p]);
+				visible = _mm256_and_ps(visible, _mm256_cmp_ps(distance, zero, _CMP_GE_OQ));
+				mask = _mm256_movemask_ps(visible);
+			}
+			if (!mask)
+				continue;
+
+			// indices of visible lanes moved to front, whole vector is stored
+			__m256i indices = _mm256_add_epi32(_mm256_set1_epi32((int)i), lanes);
+			__m256i permutation = _mm256_loadu_si256((const __m256i*)compactTable.mLanes[mask]);
+			_mm256_storeu_si256((__m256i*)(visibleIndices + visibleCount), _mm256_permutevar8x32_epi32(indices, permutation));
+			visibleCount += compactTable.mCounts[mask];
+		}
+		return visibleCount;
+	}
+
+	// IsAvx2Supported
+	bool VulkanFrustumCullingInfo::IsAvx2Supported()
+	{
+#ifdef _MSC_VER
+		// AVX and OSXSAVE (leaf 1), YMM state enabled by OS (XCR0), AVX2 (leaf 7)
+		int cpuInfo[4]{};
+		__cpuid(cpuInfo, 0);
+		if (cpuInfo[0] < 7)
+			return false;
+		__cpuid(cpuInfo, 1);
+		if ((cpuInfo[2] & (1 << 27)) == 0 || (cpuInfo[2] & (1 << 28)) == 0)
+			return false;
+		if ((_xgetbv(0) & 0x6) != 0x6)
+			return false;
+		__cpuidex(cpuInfo, 7, 0);
+		return (cpuInfo[1] & (1 << 5)) != 0;
+#else
+		return __builtin_cpu_supports("avx2") != 0;
+#endif
+	}
+
+	// CullReference
+	void VulkanFrustumCullingInfo::CullReference(const VulkanFrustum& frustum, std::vector<uint32_t>& visibleIndices) const
+	{
+		visibleIndices.clear();
+		for (uint32_t i = 0; i < mObjectCount; i++) {
+			const float min[3] = { mMinX[i], mMinY[i], mMinZ[i] };
+			const float max[3] = { mMaxX[i], mMaxY[i], mMaxZ[i] };
+			if (IsVisible(frustum, mCenterX[i], mCenterY[i], mCenterZ[i], mRadius[i], min, max))
+				visibleIndices.push_back(i);
+		}
+	}
+}
@@ -0,0 +1,101 @@
+#pragma once
+
+#include "VulkanHelpers.hpp"
+#include <DirectXMath.h>
+#include "../utils/ThreadPool.hpp"
+
+// VulkanHelpers
+namespace VulkanHelpers
+{
+	// objects tested by one AVX2 instruction (SoA arrays are padded to multiple of it)
+	const uint32_t VULKAN_FRUSTUM_CULL_WIDTH = 8;
+
+	// VulkanFrustum (planes of view projection, xyz normal pointing inside and normalized, w distance)
+	struct VulkanFrustum
+	{
+		float mPlanes[6][4];
+
+		// SetViewProjection (DirectXMath row vector matrix, depth range 0..1)
+		void SetViewProjection(const DirectX::XMMATRIX& viewProj);
+	};
+
+	// VulkanBounds (world space bounding sphere and AABB of object)
+	struct VulkanBounds
+	{
+		float mSphere[4]; // center xyz, radius
+		float mMin[3];
+		float mMax[3];
+
+		// SetTransformed (local AABB by affine transform, sphere of local AABB with radius scaled by longest axis)
+		void SetTransformed(const DirectX::XMFLOAT3& localMin, const DirectX::XMFLOAT3& localMax, const DirectX::XMMATRIX& transform);
+
+		// GetLocalBounds (AABB of vertex positions, position is first 3 floats of vertex, stride in bytes)
+		static void GetLocalBounds(const void* vertices, uint32_t vertexCount, uint32_t stride, DirectX::XMFLOAT3& localMin, DirectX::XMFLOAT3& localMax);
+	};
+
+	// VulkanFrustumCullingInfo
+	// bounds of objects are kept in structure of arrays, Cull tests sphere and AABB of 8 objects per instruction (AVX2,
+	// scalar when CPU does not support it) against frustum planes, objects are split in ranges culled on workers
+	// and indices of visible objects are compacted into one list in object order
+	struct VulkanFrustumCullingInfo
+	{
+	private:
+		// base handles
+		CThreadPool* mThreadPool = nullptr;
+
+		// SoA bounds (padding objects have negative radius, so they are never visible)
+		uint32_t           mObjectCount = 0;
+		std::vector<float> mCenterX{};
+		std::vector<float> mCenterY{};
+		std::vector<float> mCenterZ{};
+		std::vector<float> mRadius{};
+		std::vector<float> mMinX{};
+		std::vector<float> mMinY{};
+		std::vector<float> mMinZ{};
+		std::vector<float> mMaxX{};
+		std::vector<float> mMaxY{};
+		std::vector<float> mMaxZ{};
+
+		// visible indices (range of task starts at its first object plus VULKAN_FRUSTUM_CULL_WIDTH per task,
+		// AVX2 compaction stores whole vectors), ranges are moved together after Cull
+		std::vector<uint32_t> mVisibleIndices{};
+		std::vector<uint32_t> mTaskVisibleCounts{};
+		uint32_t              mVisibleCount = 0;
+
+		// CullRange (objects [objectBegin, objectEnd), objectBegin is multiple of VULKAN_FRUSTUM_CULL_WIDTH, returns visible count)
+		static uint32_t CullRangeScalar(const VulkanFrustumCullingInfo& info, const VulkanFrustum& frustum, uint32_t objectBegin, uint32_t objectEnd, uint32_t* visibleIndices);
+		static uint32_t CullRangeAvx2(const VulkanFrustumCullingInfo& info, const VulkanFrustum& frustum, uint32_t objectBegin, uint32_t objectEnd, uint32_t* visibleIndices);
+	public:
+		// AVX2 path (false - scalar, initialized by support of CPU)
+		bool mAvx2 = false;
+
+		// objects per task (smaller ranges balance better, rounded up to multiple of VULKAN_FRUSTUM_CULL_WIDTH)
+		uint32_t mMinObjectsPerTask = 16384;
+
+		// statistics of last Cull call (milliseconds)
+		double mLastCullTime = 0.0;
+
+		// Init/DeInit functions (threadPool is shared, Cull must not overlap its other dispatches)
+		void Initialize(CThreadPool& threadPool);
+		void DeInitialize();
+
+		// Resize (new objects are not visible until their bounds are set)
+		void Resize(uint32_t objectCount);
+		// SetBounds of object
+		void SetBounds(uint32_t index, const VulkanBounds& bounds);
+
+		// Cull (visible when sphere and AABB are not completely behind any plane)
+		void Cull(const DirectX::XMMATRIX& viewProj);
+		void Cull(const VulkanFrustum& frustum);
+
+		// get functions (visible indices of last Cull in object order)
+		uint32_t GetObjectCount() const { return mObjectCount; }
+		uint32_t GetVisibleCount() const { return mVisibleCount; }
+		const uint32_t* GetVisibleIndices() const { return mVisibleIndices.data(); }
+
+		// IsAvx2Supported (CPU and OS support of 256 bit registers)
+		static bool IsAvx2Supported();
+		// CullReference (same tests object by object, indices of visible objects)
+		void CullReference(const VulkanFrustum& frustum, std::vector<uint32_t>& visibleIndices) const;
+	};
+}
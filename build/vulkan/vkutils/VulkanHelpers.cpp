@@ -1,10 +1,20 @@
 #include "VulkanHelpers.hpp"
+#include "VulkanProfiler.hpp"
+#include "VulkanPipelineCache.hpp"
 #include <iostream>
 #include <cassert>
 #include <algorithm>
 #include <fstream>
 #include <vector>
 #include <array>
+#include <cstring>
+#include <cfloat>
+#ifndef _WIN32
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
 
 // VulkanHelpers
 namespace VulkanHelpers {
@@ -23,15 +33,19 @@ namespace VulkanHelpers {
 		// VkLayerProperties
 		uint32_t layerPropertiesCount = 0;
 		VK_CHECK(vkEnumerateInstanceLayerProperties(&layerPropertiesCount, nullptr));
-		mLayerProperties.reserve(layerPropertiesCount);
+		mLayerProperties.resize(layerPropertiesCount);
 		VK_CHECK(vkEnumerateInstanceLayerProperties(&layerPropertiesCount, mLayerProperties.data()));
 
 		// VkExtensionProperties
 		uint32_t extensionsPropertiesCount = 0;
 		VK_CHECK(vkEnumerateInstanceExtensionProperties(nullptr, &extensionsPropertiesCount, nullptr));
-		mExtensionProperties.reserve(extensionsPropertiesCount);
+		mExtensionProperties.resize(extensionsPropertiesCount);
 		VK_CHECK(vkEnumerateInstanceExtensionProperties(nullptr, &extensionsPropertiesCount, mExtensionProperties.data()));
 
+		// skip layers which are not installed (validation layers on servers)
+		enabledLayerNames.erase(std::remove_if(enabledLayerNames.begin(), enabledLayerNames.end(),
+			[this](const char* layerName) { return !IsLayerSupported(layerName); }), enabledLayerNames.end());
+
 		// VkApplicationInfo
 		VkApplicationInfo applicationInfo{};
 		applicationInfo.sType = VK_STRUCTURE_TYPE_APPLICATION_INFO;
@@ -64,8 +78,14 @@ namespace VulkanHelpers {
 		mPhysicalDevices.resize(physicalDevicesCount);
 		VK_CHECK(vkEnumeratePhysicalDevices(mInstance, &physicalDevicesCount, mPhysicalDevices.data()));
 
-		// get physical device GPU
-		mPhysicalDeviceGPU = FindPhysicalDevice(VK_PHYSICAL_DEVICE_TYPE_DISCRETE_GPU);;
+		// get physical device GPU (discrete, integrated, virtual, then software rasterizers like lavapipe)
+		mPhysicalDeviceGPU = FindPhysicalDevice(VK_PHYSICAL_DEVICE_TYPE_DISCRETE_GPU);
+		if (!mPhysicalDeviceGPU)
+			mPhysicalDeviceGPU = FindPhysicalDevice(VK_PHYSICAL_DEVICE_TYPE_INTEGRATED_GPU);
+		if (!mPhysicalDeviceGPU)
+			mPhysicalDeviceGPU = FindPhysicalDevice(VK_PHYSICAL_DEVICE_TYPE_VIRTUAL_GPU);
+		if (!mPhysicalDeviceGPU)
+			mPhysicalDeviceGPU = mPhysicalDevices[0];
 
 #ifdef _DEBUG
 		// vkCreateDebugUtilsMessengerEXT and vkDestroyDebugUtilsMessengerEXT
@@ -119,7 +139,7 @@ namespace VulkanHelpers {
 			VkPhysicalDeviceProperties physicalDeviceProperties;
 			vkGetPhysicalDeviceFeatures(physicalDevice, &physicalDeviceFeatures);
 			vkGetPhysicalDeviceProperties(physicalDevice, &physicalDeviceProperties);
-			if (physicalDeviceProperties.deviceType & physicalDeviceType)
+			if (physicalDeviceProperties.deviceType == physicalDeviceType)
 			{
 				physicalDeviceFeaturesGPU = physicalDeviceFeatures;
 				physicalDevicePropertiesGPU = physicalDeviceProperties;
@@ -129,6 +149,15 @@ namespace VulkanHelpers {
 		return VK_NULL_HANDLE;
 	}
 
+	// IsLayerSupported
+	bool VulkanInstanceInfo::IsLayerSupported(const char* layerName) const
+	{
+		for (const auto& layerProperties : mLayerProperties)
+			if (strcmp(layerProperties.layerName, layerName) == 0)
+				return true;
+		return false;
+	}
+
 #if _DEBUG
 	// MyDebugReportCallback
 	VKAPI_ATTR VkBool32 VKAPI_CALL VulkanInstanceInfo::MyDebugReportCallback(
@@ -153,11 +182,14 @@ namespace VulkanHelpers {
 	// Initialize
 	void VulkanDeviceInfo::Initialize(VkPhysicalDevice physicalDevice, VkSurfaceKHR surface,
 		VkPhysicalDeviceFeatures& physicalDeviceFeatures,
-		std::vector<const char *>& enabledExtensionNames)
+		std::vector<const char *>& enabledExtensionNames,
+		const void* pNextFeatures)
 	{
 		// store parameters
 		mPhysicalDevice = physicalDevice;
 		mSurface = surface;
+		mEnabledExtensionNames.assign(enabledExtensionNames.begin(), enabledExtensionNames.end());
+		mEnabledFeatures = physicalDeviceFeatures;
 
 		// VkPhysicalDeviceMemoryProperties
 		vkGetPhysicalDeviceMemoryProperties(physicalDevice, &mDeviceMemoryProperties);
@@ -172,25 +204,36 @@ namespace VulkanHelpers {
 		mQueueFamilyProperties.resize(queueFamilyPropertiesCount);
 		vkGetPhysicalDeviceQueueFamilyProperties(physicalDevice, &queueFamilyPropertiesCount, mQueueFamilyProperties.data());
 
-		// get surface formats count
-		uint32_t formatsCount = 0;
-		vkGetPhysicalDeviceSurfaceFormatsKHR(mPhysicalDevice, mSurface, &formatsCount, nullptr);
-		assert(formatsCount);
-		// get surface formats list
-		mSurfaceFormats.resize(formatsCount);
-		vkGetPhysicalDeviceSurfaceFormatsKHR(mPhysicalDevice, mSurface, &formatsCount, mSurfaceFormats.data());
-
-		// get present modes count
-		uint32_t presentModesCount = 0;
-		vkGetPhysicalDeviceSurfacePresentModesKHR(physicalDevice, surface, &presentModesCount, nullptr);
-		assert(presentModesCount);
-		// get present modes list
-		mPresentModes.resize(presentModesCount);
-		vkGetPhysicalDeviceSurfacePresentModesKHR(physicalDevice, surface, &presentModesCount, mPresentModes.data());
+		// surface properties (headless device has no surface)
+		if (mSurface)
+		{
+			// get surface formats count
+			uint32_t formatsCount = 0;
+			vkGetPhysicalDeviceSurfaceFormatsKHR(mPhysicalDevice, mSurface, &formatsCount, nullptr);
+			assert(formatsCount);
+			// get surface formats list
+			mSurfaceFormats.resize(formatsCount);
+			vkGetPhysicalDeviceSurfaceFormatsKHR(mPhysicalDevice, mSurface, &formatsCount, mSurfaceFormats.data());
+
+			// get present modes count
+			uint32_t presentModesCount = 0;
+			vkGetPhysicalDeviceSurfacePresentModesKHR(physicalDevice, surface, &presentModesCount, nullptr);
+			assert(presentModesCount);
+			// get present modes list
+			mPresentModes.resize(presentModesCount);
+			vkGetPhysicalDeviceSurfacePresentModesKHR(physicalDevice, surface, &presentModesCount, mPresentModes.data());
+		}
+
+		// get device extension properties
+		uint32_t extensionPropertiesCount = 0;
+		vkEnumerateDeviceExtensionProperties(physicalDevice, VK_NULL_HANDLE, &extensionPropertiesCount, nullptr);
+		mExtensionProperties.resize(extensionPropertiesCount);
+		vkEnumerateDeviceExtensionProperties(physicalDevice, VK_NULL_HANDLE, &extensionPropertiesCount, mExtensionProperties.data());
 
 		// find device local memory type index
 		mMemoryDeviceLocalTypeIndex = FindMemoryHeapIndexByFlags(VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
 		mMemoryHostVisibleTypeIndex = FindMemoryHeapIndexByFlags(VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+		mMemoryArchitecture = FindMemoryArchitecture();
 
 		// get graphics, queue and transfer queue family property index
 		mQueueFamilyIndexCompute = FindQueueFamilyIndexByFlags(VK_QUEUE_COMPUTE_BIT);
@@ -224,7 +267,7 @@ namespace VulkanHelpers {
 		// VkDeviceCreateInfo
 		VkDeviceCreateInfo deviceCreateInfo{};
 		deviceCreateInfo.sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO;
-		deviceCreateInfo.pNext = VK_NULL_HANDLE;
+		deviceCreateInfo.pNext = pNextFeatures;
 		deviceCreateInfo.flags = 0;
 		deviceCreateInfo.queueCreateInfoCount = (uint32_t)deviceQueueCreateInfos.size();
 		deviceCreateInfo.pQueueCreateInfos = deviceQueueCreateInfos.data();
@@ -258,7 +301,7 @@ namespace VulkanHelpers {
 		VkCommandPoolCreateInfo commandPoolCreateInfo{};
 		commandPoolCreateInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
 		commandPoolCreateInfo.pNext = VK_NULL_HANDLE;
-		commandPoolCreateInfo.flags = 0;
+		commandPoolCreateInfo.flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT; // short lived one time submits only
 		commandPoolCreateInfo.queueFamilyIndex = mQueueFamilyIndexGraphics;
 		VK_CHECK(vkCreateCommandPool(mDevice, &commandPoolCreateInfo, VK_NULL_HANDLE, &mCommandPool));
 		assert(mCommandPool);
@@ -285,9 +328,10 @@ namespace VulkanHelpers {
 		{
 			if ((mQueueFamilyProperties[i].queueFlags & VK_QUEUE_GRAPHICS_BIT)) {
 				graphicsIndex = i;
-				// get present queue family property index
-				VkBool32 presentSupport = false;
-				vkGetPhysicalDeviceSurfaceSupportKHR(mPhysicalDevice, i, mSurface, &presentSupport);
+				// get present queue family property index (headless device presents nothing, graphics queue is used)
+				VkBool32 presentSupport = (mSurface == VK_NULL_HANDLE);
+				if (mSurface)
+					vkGetPhysicalDeviceSurfaceSupportKHR(mPhysicalDevice, i, mSurface, &presentSupport);
 				if (presentSupport)
 				{
 					graphicsIndex = i;
@@ -342,6 +386,71 @@ namespace VulkanHelpers {
 		return ((mDeviceMemoryProperties.memoryTypes[index].propertyFlags & propertyFlags) == propertyFlags);
 	}
 
+	// FindMemoryArchitecture
+	VulkanMemoryArchitecture VulkanDeviceInfo::FindMemoryArchitecture() const
+	{
+		// integrated and software devices share system memory
+		if ((mDeviceProperties.deviceType == VK_PHYSICAL_DEVICE_TYPE_INTEGRATED_GPU) || (mDeviceProperties.deviceType == VK_PHYSICAL_DEVICE_TYPE_CPU))
+			return VULKAN_MEMORY_ARCHITECTURE_UMA;
+
+		// check device local memory types
+		bool allDeviceLocalHostVisible = true;
+		VkDeviceSize hostVisibleDeviceLocalHeapSize = 0;
+		for (uint32_t i = 0; i < mDeviceMemoryProperties.memoryTypeCount; i++)
+		{
+			const VkMemoryType& memoryType = mDeviceMemoryProperties.memoryTypes[i];
+			if (!(memoryType.propertyFlags & VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT))
+				continue;
+			if (memoryType.propertyFlags & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT)
+				hostVisibleDeviceLocalHeapSize = std::max(hostVisibleDeviceLocalHeapSize, mDeviceMemoryProperties.memoryHeaps[memoryType.heapIndex].size);
+			else
+				allDeviceLocalHostVisible = false;
+		}
+
+		// every device local type can be mapped
+		if (allDeviceLocalHostVisible)
+			return VULKAN_MEMORY_ARCHITECTURE_UMA;
+
+		// host visible VRAM heap bigger than legacy 256 MB window
+		if (hostVisibleDeviceLocalHeapSize > 256ull * 1024 * 1024)
+			return VULKAN_MEMORY_ARCHITECTURE_BAR;
+
+		// return default
+		return VULKAN_MEMORY_ARCHITECTURE_DISCRETE;
+	}
+
+	// GetAllocationCreateInfo
+	VmaAllocationCreateInfo VulkanDeviceInfo::GetAllocationCreateInfo(VulkanMemoryAccess access) const
+	{
+		// VmaAllocationCreateInfo
+		VmaAllocationCreateInfo allocCreateInfo{};
+		switch (access)
+		{
+		case VULKAN_MEMORY_ACCESS_STATIC:
+			allocCreateInfo.usage = VMA_MEMORY_USAGE_GPU_ONLY;
+			break;
+		case VULKAN_MEMORY_ACCESS_UPLOAD_ONCE:
+			// UMA and BAR can write device local memory directly, discrete goes through staging
+			allocCreateInfo.usage = VMA_MEMORY_USAGE_GPU_ONLY;
+			if (mMemoryArchitecture != VULKAN_MEMORY_ARCHITECTURE_DISCRETE)
+				allocCreateInfo.preferredFlags = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT;
+			break;
+		case VULKAN_MEMORY_ACCESS_DYNAMIC:
+			// VMA prefers device local host visible memory (BAR window) for this usage
+			allocCreateInfo.usage = VMA_MEMORY_USAGE_CPU_TO_GPU;
+			allocCreateInfo.flags = VMA_ALLOCATION_CREATE_MAPPED_BIT;
+			break;
+		case VULKAN_MEMORY_ACCESS_READBACK:
+			allocCreateInfo.usage = VMA_MEMORY_USAGE_GPU_TO_CPU;
+			allocCreateInfo.flags = VMA_ALLOCATION_CREATE_MAPPED_BIT;
+			break;
+		default:
+			assert(0);
+			break;
+		}
+		return allocCreateInfo;
+	}
+
 	// FindSurfaceFormat
 	VkSurfaceFormatKHR VulkanDeviceInfo::FindSurfaceFormat() const
 	{
@@ -368,24 +477,43 @@ namespace VulkanHelpers {
 	}
 
 	// FindPresentMode()
-	VkPresentModeKHR VulkanDeviceInfo::FindPresentMode() const
+	VkPresentModeKHR VulkanDeviceInfo::FindPresentMode(VkPresentModeKHR desiredPresentMode) const
 	{
-		// try to find MAILBOX mode
+		// try to find desired mode
 		for (const auto& presentMode : mPresentModes)
-			if (presentMode == VK_PRESENT_MODE_MAILBOX_KHR)
+			if (presentMode == desiredPresentMode)
 				return presentMode;
 
-		// try to find FIFO mode
-		for (const auto& presentMode : mPresentModes)
-			if (presentMode == VK_PRESENT_MODE_FIFO_KHR)
-				return presentMode;
+		// FIFO mode is always supported
+		return VK_PRESENT_MODE_FIFO_KHR;
+	}
 
-		// return default
-		return mPresentModes[0];
+	// IsExtensionSupported
+	bool VulkanDeviceInfo::IsExtensionSupported(const char* extensionName) const
+	{
+		for (const auto& extensionProperties : mExtensionProperties)
+			if (strcmp(extensionProperties.extensionName, extensionName) == 0)
+				return true;
+		return false;
+	}
+
+	// IsExtensionEnabled
+	bool VulkanDeviceInfo::IsExtensionEnabled(const char* extensionName) const
+	{
+		for (const auto& enabledExtensionName : mEnabledExtensionNames)
+			if (enabledExtensionName == extensionName)
+				return true;
+		return false;
 	}
 
 	// CopyBuffers
 	void VulkanDeviceInfo::CopyBuffers(VkDeviceSize size, VkBuffer srcBuffer, VkBuffer dstBuffer) const
+	{
+		CopyBuffers(size, srcBuffer, 0, dstBuffer, 0);
+	}
+
+	// CopyBuffers (with offsets)
+	void VulkanDeviceInfo::CopyBuffers(VkDeviceSize size, VkBuffer srcBuffer, VkDeviceSize srcOffset, VkBuffer dstBuffer, VkDeviceSize dstOffset) const
 	{
 		// VkCommandBufferAllocateInfo
 		VkCommandBufferAllocateInfo commandBufferAllocateInfo{};
@@ -408,13 +536,20 @@ namespace VulkanHelpers {
 		commandBufferBeginInfo.pInheritanceInfo = nullptr; // Optional
 		VK_CHECK(vkBeginCommandBuffer(commandBuffer, &commandBufferBeginInfo));
 
+		// upload profiling
+		if (mProfilerInfo)
+			mProfilerInfo->BeginUpload(commandBuffer, "CopyBuffers");
+
 		// VkBufferCopy
 		VkBufferCopy bufferCopy{};
-		bufferCopy.srcOffset = 0;
-		bufferCopy.dstOffset = 0;
+		bufferCopy.srcOffset = srcOffset;
+		bufferCopy.dstOffset = dstOffset;
 		bufferCopy.size = size;
 		vkCmdCopyBuffer(commandBuffer, srcBuffer, dstBuffer, 1, &bufferCopy);
 
+		if (mProfilerInfo)
+			mProfilerInfo->EndUpload(commandBuffer);
+
 		// vkEndCommandBuffer
 		VK_CHECK(vkEndCommandBuffer(commandBuffer));
 
@@ -426,6 +561,8 @@ namespace VulkanHelpers {
 		submitInfo.pCommandBuffers = &commandBuffer;
 		VK_CHECK(vkQueueSubmit(mQueueGraphics, 1, &submitInfo, VK_NULL_HANDLE));
 		VK_CHECK(vkQueueWaitIdle(mQueueGraphics));
+		if (mProfilerInfo)
+			mProfilerInfo->CompleteUpload();
 
 		// free command buffer
 		vkFreeCommandBuffers(mDevice, mCommandPool, 1, &commandBuffer);
@@ -433,21 +570,27 @@ namespace VulkanHelpers {
 
 	// CreateBuffer (without initialization)
 	void VulkanDeviceInfo::CreateBuffer(VkDeviceSize size, VkBufferUsageFlags usage, VkBuffer& buffer, VmaAllocation& allocation)
+	{
+		CreateBuffer(size, usage, VULKAN_MEMORY_ACCESS_STATIC, buffer, allocation);
+	}
+
+	// CreateBuffer (with initialization)
+	void VulkanDeviceInfo::CreateBuffer(const void* data, VkDeviceSize size, VkBufferUsageFlags usage, VkBuffer& buffer, VmaAllocation& allocation)
+	{
+		CreateBuffer(data, size, usage, VULKAN_MEMORY_ACCESS_UPLOAD_ONCE, buffer, allocation);
+	}
+
+	// CreateBuffer (without initialization, access pattern)
+	void VulkanDeviceInfo::CreateBuffer(VkDeviceSize size, VkBufferUsageFlags usage, VulkanMemoryAccess access, VkBuffer& buffer, VmaAllocation& allocation)
 	{
 		// check size
 		assert(size);
 
 		// VkBufferCreateInfo
-		VkBufferCreateInfo bufferCreateInfo{};
-		bufferCreateInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
-		bufferCreateInfo.size = size;
-		bufferCreateInfo.usage = usage | VK_BUFFER_USAGE_TRANSFER_DST_BIT;
-		bufferCreateInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+		VkBufferCreateInfo bufferCreateInfo = InitBufferCreateInfo(size, usage);
 
 		// VmaAllocationCreateInfo
-		VmaAllocationCreateInfo allocCreateInfo{};
-		allocCreateInfo.usage = VMA_MEMORY_USAGE_GPU_ONLY;
-		allocCreateInfo.flags = 0;
+		VmaAllocationCreateInfo allocCreateInfo = GetAllocationCreateInfo(access);
 
 		// vmaCreateBuffer
 		VK_CHECK(vmaCreateBuffer(mAllocator, &bufferCreateInfo, &allocCreateInfo, &buffer, &allocation, VK_NULL_HANDLE));
@@ -455,19 +598,25 @@ namespace VulkanHelpers {
 		assert(allocation);
 	}
 
-	// CreateBuffer (with initialization)
-	void VulkanDeviceInfo::CreateBuffer(const void* data, VkDeviceSize size, VkBufferUsageFlags usage, VkBuffer& buffer, VmaAllocation& allocation)
+	// CreateBuffer (with initialization, access pattern)
+	void VulkanDeviceInfo::CreateBuffer(const void* data, VkDeviceSize size, VkBufferUsageFlags usage, VulkanMemoryAccess access, VkBuffer& buffer, VmaAllocation& allocation)
 	{
 		// check data
 		assert(data);
 		// create buffer
-		CreateBuffer(size, usage, buffer, allocation);
+		CreateBuffer(size, usage, access, buffer, allocation);
 		// write buffer
 		WriteBuffer(data, size, buffer, allocation);
 	}
 
 	// WriteBuffer
 	void VulkanDeviceInfo::WriteBuffer(const void* data, VkDeviceSize size, VkBuffer buffer, VmaAllocation& allocation)
+	{
+		WriteBuffer(data, 0, size, buffer, allocation);
+	}
+
+	// WriteBuffer (with offset)
+	void VulkanDeviceInfo::WriteBuffer(const void* data, VkDeviceSize offset, VkDeviceSize size, VkBuffer buffer, VmaAllocation& allocation)
 	{
 		// check data
 		assert(data);
@@ -478,13 +627,18 @@ namespace VulkanHelpers {
 		VkMemoryPropertyFlags memFlags;
 		vmaGetMemoryTypeProperties(mAllocator, allocationInfo.memoryType, &memFlags);
 
-		// if target device memory is host visible, then just map/unmap memory to device memory
+		// if target device memory is host visible, then write it in place (zero copy)
 		if ((memFlags & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT) == VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT) {
-			void* mappedData = nullptr;
-			vmaMapMemory(mAllocator, allocation, &mappedData);
+			// persistently mapped allocations are not mapped again
+			void* mappedData = allocationInfo.pMappedData;
+			if (!mappedData)
+				vmaMapMemory(mAllocator, allocation, &mappedData);
 			assert(mappedData);
-			memcpy(mappedData, &data, (size_t)size);
-			vmaUnmapMemory(mAllocator, allocation);
+			memcpy((uint8_t*)mappedData + offset, data, (size_t)size);
+			if ((memFlags & VK_MEMORY_PROPERTY_HOST_COHERENT_BIT) == 0)
+				vmaFlushAllocation(mAllocator, allocation, offset, size);
+			if (!allocationInfo.pMappedData)
+				vmaUnmapMemory(mAllocator, allocation);
 		}
 		else // if target device memory is NOT host visible, then we need use staging buffer
 		{
@@ -498,31 +652,57 @@ namespace VulkanHelpers {
 			// VmaAllocationCreateInfo
 			VmaAllocationCreateInfo allocCreateInfo{};
 			allocCreateInfo.usage = VMA_MEMORY_USAGE_CPU_ONLY;
-			allocCreateInfo.flags = 0;
+			allocCreateInfo.flags = VMA_ALLOCATION_CREATE_MAPPED_BIT;
 
-			// create staging buffer and memory
+			// create staging buffer and memory (mapped at creation)
 			VkBuffer stagingBuffer = VK_NULL_HANDLE;
 			VmaAllocation stagingBufferAlloc = VK_NULL_HANDLE;
-			VK_CHECK(vmaCreateBuffer(mAllocator, &bufferCreateInfo, &allocCreateInfo, &stagingBuffer, &stagingBufferAlloc, VK_NULL_HANDLE));
+			VmaAllocationInfo stagingAllocationInfo{};
+			VK_CHECK(vmaCreateBuffer(mAllocator, &bufferCreateInfo, &allocCreateInfo, &stagingBuffer, &stagingBufferAlloc, &stagingAllocationInfo));
+			assert(stagingAllocationInfo.pMappedData);
 
-			// map staging buffer and memory
-			void* mappedData = nullptr;
-			vmaMapMemory(mAllocator, stagingBufferAlloc, &mappedData);
-			assert(mappedData);
-			memcpy(mappedData, data, (size_t)size);
-			vmaUnmapMemory(mAllocator, stagingBufferAlloc);
+			// fill staging buffer (CPU_ONLY memory is always coherent)
+			memcpy(stagingAllocationInfo.pMappedData, data, (size_t)size);
 
 			// copy buffers
-			CopyBuffers(size, stagingBuffer, buffer);
+			CopyBuffers(size, stagingBuffer, 0, buffer, offset);
 
 			// destroy buffer and free memory
 			vmaDestroyBuffer(mAllocator, stagingBuffer, stagingBufferAlloc);
 		}
 	}
 
-	// CopyImages
-	void VulkanDeviceInfo::CopyImages(uint32_t width, uint32_t height, VkImage srcImage, VkImage dstImage) const
+	// ReadBuffer
+	void VulkanDeviceInfo::ReadBuffer(void* data, VkDeviceSize size, VmaAllocation& allocation)
 	{
+		// check data
+		assert(data);
+
+		// get memory buffer properties
+		VmaAllocationInfo allocationInfo{};
+		vmaGetAllocationInfo(mAllocator, allocation, &allocationInfo);
+		VkMemoryPropertyFlags memFlags;
+		vmaGetMemoryTypeProperties(mAllocator, allocationInfo.memoryType, &memFlags);
+		assert(memFlags & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT);
+
+		// persistently mapped allocations are not mapped again
+		void* mappedData = allocationInfo.pMappedData;
+		if (!mappedData)
+			vmaMapMemory(mAllocator, allocation, &mappedData);
+		assert(mappedData);
+		if ((memFlags & VK_MEMORY_PROPERTY_HOST_COHERENT_BIT) == 0)
+			vmaInvalidateAllocation(mAllocator, allocation, 0, size);
+		memcpy(data, mappedData, (size_t)size);
+		if (!allocationInfo.pMappedData)
+			vmaUnmapMemory(mAllocator, allocation);
+	}
+
+	// CopyBufferToImage
+	void VulkanDeviceInfo::CopyBufferToImage(VkBuffer srcBuffer, VkImage dstImage, VkImageAspectFlags aspectMask, const std::vector<VkBufferImageCopy>& bufferImageCopies) const
+	{
+		// check regions
+		assert(bufferImageCopies.size());
+
 		// VkCommandBufferAllocateInfo
 		VkCommandBufferAllocateInfo commandBufferAllocateInfo{};
 		commandBufferAllocateInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
@@ -544,62 +724,101 @@ namespace VulkanHelpers {
 		commandBufferBeginInfo.pInheritanceInfo = nullptr; // Optional
 		VK_CHECK(vkBeginCommandBuffer(commandBuffer, &commandBufferBeginInfo));
 
-		// VkImageMemoryBarrier
+		// upload profiling
+		if (mProfilerInfo)
+			mProfilerInfo->BeginUpload(commandBuffer, "CopyBufferToImage");
+
+		// VkImageMemoryBarrier (all mips and layers at once)
 		VkImageMemoryBarrier imgMemBarrier{};
 		imgMemBarrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
 		imgMemBarrier.pNext = VK_NULL_HANDLE;
 		imgMemBarrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
 		imgMemBarrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
-		imgMemBarrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+		imgMemBarrier.image = dstImage;
+		imgMemBarrier.subresourceRange.aspectMask = aspectMask;
 		imgMemBarrier.subresourceRange.baseMipLevel = 0;
-		imgMemBarrier.subresourceRange.levelCount = 1;
+		imgMemBarrier.subresourceRange.levelCount = VK_REMAINING_MIP_LEVELS;
 		imgMemBarrier.subresourceRange.baseArrayLayer = 0;
-		imgMemBarrier.subresourceRange.layerCount = 1;
-
-		imgMemBarrier.srcAccessMask = VK_ACCESS_HOST_WRITE_BIT;
-		imgMemBarrier.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
-		imgMemBarrier.oldLayout = VK_IMAGE_LAYOUT_PREINITIALIZED;
-		imgMemBarrier.newLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
-		imgMemBarrier.image = srcImage;
-		vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_HOST_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0, nullptr, 0, nullptr, 1, &imgMemBarrier);
+		imgMemBarrier.subresourceRange.layerCount = VK_REMAINING_ARRAY_LAYERS;
 
 		imgMemBarrier.srcAccessMask = 0;
 		imgMemBarrier.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
 		imgMemBarrier.oldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
 		imgMemBarrier.newLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
-		imgMemBarrier.image = dstImage;
 		vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0, nullptr, 0, nullptr, 1, &imgMemBarrier);
 
-		// VkImageCopy
-		VkImageCopy imageCopy{};
-		imageCopy.srcSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
-		imageCopy.srcSubresource.mipLevel = 0;
-		imageCopy.srcSubresource.baseArrayLayer = 0;
-		imageCopy.srcSubresource.layerCount = 1;
-		imageCopy.srcOffset.x = 0;
-		imageCopy.srcOffset.y = 0;
-		imageCopy.srcOffset.z = 0;
-		imageCopy.dstSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
-		imageCopy.dstSubresource.mipLevel = 0;
-		imageCopy.dstSubresource.baseArrayLayer = 0;
-		imageCopy.dstSubresource.layerCount = 1;
-		imageCopy.dstOffset.x = 0;
-		imageCopy.dstOffset.y = 0;
-		imageCopy.dstOffset.z = 0;
-		imageCopy.extent.width = width;
-		imageCopy.extent.height = height;
-		imageCopy.extent.depth = 1;
-
-		// vkCmdCopyImage
-		vkCmdCopyImage(commandBuffer, srcImage, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, dstImage, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &imageCopy);
+		// vkCmdCopyBufferToImage (one command for every subresource)
+		vkCmdCopyBufferToImage(commandBuffer, srcBuffer, dstImage, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, (uint32_t)bufferImageCopies.size(), bufferImageCopies.data());
 
 		imgMemBarrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
 		imgMemBarrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
 		imgMemBarrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
 		imgMemBarrier.newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
-		imgMemBarrier.image = dstImage;
 		vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, 0, 0, nullptr, 0, nullptr, 1, &imgMemBarrier);
 
+		if (mProfilerInfo)
+			mProfilerInfo->EndUpload(commandBuffer);
+
+		// vkEndCommandBuffer
+		VK_CHECK(vkEndCommandBuffer(commandBuffer));
+
+		// submit and wait
+		VkSubmitInfo submitInfo{};
+		submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+		submitInfo.pNext = VK_NULL_HANDLE;
+		submitInfo.commandBufferCount = 1;
+		submitInfo.pCommandBuffers = &commandBuffer;
+		VK_CHECK(vkQueueSubmit(mQueueGraphics, 1, &submitInfo, VK_NULL_HANDLE));
+		VK_CHECK(vkQueueWaitIdle(mQueueGraphics));
+		if (mProfilerInfo)
+			mProfilerInfo->CompleteUpload();
+
+		// free command buffer
+		vkFreeCommandBuffers(mDevice, mCommandPool, 1, &commandBuffer);
+	}
+
+	// TransitionImageLayout
+	void VulkanDeviceInfo::TransitionImageLayout(VkImage image, VkImageAspectFlags aspectMask, VkImageLayout oldLayout, VkImageLayout newLayout) const
+	{
+		// VkCommandBufferAllocateInfo
+		VkCommandBufferAllocateInfo commandBufferAllocateInfo{};
+		commandBufferAllocateInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+		commandBufferAllocateInfo.pNext = VK_NULL_HANDLE;
+		commandBufferAllocateInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+		commandBufferAllocateInfo.commandPool = mCommandPool;
+		commandBufferAllocateInfo.commandBufferCount = 1;
+
+		// VkCommandBuffer
+		VkCommandBuffer commandBuffer = VK_NULL_HANDLE;
+		VK_CHECK(vkAllocateCommandBuffers(mDevice, &commandBufferAllocateInfo, &commandBuffer));
+		assert(commandBuffer);
+
+		// VkCommandBufferBeginInfo
+		VkCommandBufferBeginInfo commandBufferBeginInfo{};
+		commandBufferBeginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+		commandBufferBeginInfo.pNext = VK_NULL_HANDLE;
+		commandBufferBeginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+		commandBufferBeginInfo.pInheritanceInfo = nullptr; // Optional
+		VK_CHECK(vkBeginCommandBuffer(commandBuffer, &commandBufferBeginInfo));
+
+		// VkImageMemoryBarrier (whole image, all subresources)
+		VkImageMemoryBarrier imgMemBarrier{};
+		imgMemBarrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+		imgMemBarrier.pNext = VK_NULL_HANDLE;
+		imgMemBarrier.srcAccessMask = VK_ACCESS_MEMORY_WRITE_BIT;
+		imgMemBarrier.dstAccessMask = VK_ACCESS_MEMORY_READ_BIT | VK_ACCESS_MEMORY_WRITE_BIT;
+		imgMemBarrier.oldLayout = oldLayout;
+		imgMemBarrier.newLayout = newLayout;
+		imgMemBarrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+		imgMemBarrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+		imgMemBarrier.image = image;
+		imgMemBarrier.subresourceRange.aspectMask = aspectMask;
+		imgMemBarrier.subresourceRange.baseMipLevel = 0;
+		imgMemBarrier.subresourceRange.levelCount = VK_REMAINING_MIP_LEVELS;
+		imgMemBarrier.subresourceRange.baseArrayLayer = 0;
+		imgMemBarrier.subresourceRange.layerCount = VK_REMAINING_ARRAY_LAYERS;
+		vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, 0, 0, nullptr, 0, nullptr, 1, &imgMemBarrier);
+
 		// vkEndCommandBuffer
 		VK_CHECK(vkEndCommandBuffer(commandBuffer));
 
@@ -618,30 +837,27 @@ namespace VulkanHelpers {
 
 	// CreateImage
 	void VulkanDeviceInfo::CreateImage(uint32_t width, uint32_t height, VkFormat format, VkImageUsageFlags usage, VkImage& image, VmaAllocation& allocation)
+	{
+		CreateImage(width, height, 1, 1, format, usage, 0, image, allocation);
+	}
+
+	// CreateImage
+	void VulkanDeviceInfo::CreateImage(const void* data, uint32_t width, uint32_t height, VkFormat format, VkImageUsageFlags usage, VkImage& image, VmaAllocation& allocation)
+	{
+		CreateImage(data, width, height, 1, 1, format, usage, 0, image, allocation);
+	}
+
+	// CreateImage (mip levels and array layers)
+	void VulkanDeviceInfo::CreateImage(uint32_t width, uint32_t height, uint32_t mipLevels, uint32_t arrayLayers, VkFormat format, VkImageUsageFlags usage, VkImageCreateFlags flags, VkImage& image, VmaAllocation& allocation)
 	{
 		// check width and height
 		assert(width);
 		assert(height);
+		assert(mipLevels);
+		assert(arrayLayers);
 
 		// VkImageCreateInfo
-		VkImageCreateInfo imageCreateInfo{};
-		imageCreateInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
-		imageCreateInfo.pNext = VK_NULL_HANDLE;
-		imageCreateInfo.flags = 0;
-		imageCreateInfo.imageType = VK_IMAGE_TYPE_2D;
-		imageCreateInfo.format = format;
-		imageCreateInfo.extent.width = width;
-		imageCreateInfo.extent.height = height;
-		imageCreateInfo.extent.depth = 1;
-		imageCreateInfo.mipLevels = 1;
-		imageCreateInfo.arrayLayers = 1;
-		imageCreateInfo.samples = VK_SAMPLE_COUNT_1_BIT;
-		imageCreateInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
-		imageCreateInfo.usage = usage | VK_IMAGE_USAGE_TRANSFER_DST_BIT;
-		imageCreateInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
-		imageCreateInfo.queueFamilyIndexCount = VK_QUEUE_FAMILY_IGNORED;
-		imageCreateInfo.pQueueFamilyIndices = VK_NULL_HANDLE;
-		imageCreateInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+		VkImageCreateInfo imageCreateInfo = InitImageCreateInfo(width, height, mipLevels, arrayLayers, format, usage, flags);
 
 		// VmaAllocationCreateInfo
 		VmaAllocationCreateInfo allocCreateInfo{};
@@ -653,81 +869,96 @@ namespace VulkanHelpers {
 		assert(image);
 	}
 
-	// CreateImage
-	void VulkanDeviceInfo::CreateImage(const void* data, uint32_t width, uint32_t height, VkFormat format, VkImageUsageFlags usage, VkImage& image, VmaAllocation& allocation)
+	// CreateImage (mip levels and array layers with initialization)
+	void VulkanDeviceInfo::CreateImage(const void* data, uint32_t width, uint32_t height, uint32_t mipLevels, uint32_t arrayLayers, VkFormat format, VkImageUsageFlags usage, VkImageCreateFlags flags, VkImage& image, VmaAllocation& allocation)
 	{
 		// create image
-		CreateImage(width, height, format, usage, image, allocation);
+		CreateImage(width, height, mipLevels, arrayLayers, format, usage, flags, image, allocation);
 		// write image
-		WriteImage(data, width, height, format, usage, image, allocation);
+		WriteImage(data, width, height, mipLevels, arrayLayers, format, image);
 	}
 
 	// WriteImage
-	void VulkanDeviceInfo::WriteImage(const void* data, uint32_t width, uint32_t height, VkFormat format, VkImageUsageFlags usage, VkImage& image, VmaAllocation& allocation)
+	void VulkanDeviceInfo::WriteImage(const void* data, uint32_t width, uint32_t height, uint32_t mipLevels, uint32_t arrayLayers, VkFormat format, VkImage image)
 	{
-		// get memory buffer properties
-		VmaAllocationInfo allocationInfo{};
-		vmaGetAllocationInfo(mAllocator, allocation, &allocationInfo);
-		VkMemoryPropertyFlags memFlags;
-		vmaGetMemoryTypeProperties(mAllocator, allocationInfo.memoryType, &memFlags);
-
-		// if target device memory is host visible, then just map/unmap memory to device memory
-		if ((memFlags & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT) == VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT) {
-			void* mappedData = nullptr;
-			vmaMapMemory(mAllocator, allocation, &mappedData);
-			assert(mappedData);
-			memcpy(mappedData, &data, width * height * 4);
-			vmaUnmapMemory(mAllocator, allocation);
-		}
-		else // if target device memory is NOT host visible, then we need use staging image
-		{
-			// VkImageCreateInfo
-			VkImageCreateInfo imageCreateInfo{};
-			imageCreateInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
-			imageCreateInfo.pNext = VK_NULL_HANDLE;
-			imageCreateInfo.flags = 0;
-			imageCreateInfo.imageType = VK_IMAGE_TYPE_2D;
-			imageCreateInfo.format = format;
-			imageCreateInfo.extent.width = width;
-			imageCreateInfo.extent.height = height;
-			imageCreateInfo.extent.depth = 1;
-			imageCreateInfo.mipLevels = 1;
-			imageCreateInfo.arrayLayers = 1;
-			imageCreateInfo.samples = VK_SAMPLE_COUNT_1_BIT;
-			imageCreateInfo.tiling = VK_IMAGE_TILING_LINEAR;
-			imageCreateInfo.usage = VK_IMAGE_USAGE_TRANSFER_SRC_BIT;
-			imageCreateInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
-			imageCreateInfo.queueFamilyIndexCount = VK_QUEUE_FAMILY_IGNORED;
-			imageCreateInfo.pQueueFamilyIndices = VK_NULL_HANDLE;
-			imageCreateInfo.initialLayout = VK_IMAGE_LAYOUT_PREINITIALIZED;
-
-			// VmaAllocationCreateInfo
-			VmaAllocationCreateInfo allocCreateInfo{};
-			allocCreateInfo.usage = VMA_MEMORY_USAGE_CPU_ONLY;
-			allocCreateInfo.flags = 0;
-
-			// create staging image and memory
-			VkImage stagingImage = VK_NULL_HANDLE;
-			VmaAllocation stagingImageAlloc = VK_NULL_HANDLE;
-
-			// vmaCreateImage
-			VK_CHECK(vmaCreateImage(mAllocator, &imageCreateInfo, &allocCreateInfo, &stagingImage, &stagingImageAlloc, VK_NULL_HANDLE));
-			assert(stagingImage);
-			assert(stagingImageAlloc);
+		// check data
+		assert(data);
 
-			// map staging buffer and memory
-			void* mappedData = nullptr;
-			vmaMapMemory(mAllocator, stagingImageAlloc, &mappedData);
-			assert(mappedData);
-			memcpy(mappedData, data, width * height * 4);
-			vmaUnmapMemory(mAllocator, stagingImageAlloc);
+		// get texel block parameters
+		uint32_t blockSize = 0, blockWidth = 0, blockHeight = 0;
+		GetFormatBlockInfo(format, blockSize, blockWidth, blockHeight);
+		assert(blockSize);
+
+		// staging offsets must be multiple of texel block size, 4 and optimalBufferCopyOffsetAlignment
+		VkDeviceSize offsetAlignment = std::max<VkDeviceSize>(mDeviceProperties.limits.optimalBufferCopyOffsetAlignment, 4);
+		while ((offsetAlignment % blockSize) != 0)
+			offsetAlignment += std::max<VkDeviceSize>(mDeviceProperties.limits.optimalBufferCopyOffsetAlignment, 4);
+
+		// fill copy regions, source data is tightly packed: layer 0 mips 0..N, layer 1 mips 0..N, ...
+		std::vector<VkBufferImageCopy> bufferImageCopies{};
+		std::vector<VkDeviceSize> srcOffsets{};
+		std::vector<VkDeviceSize> srcSizes{};
+		bufferImageCopies.reserve(mipLevels * arrayLayers);
+		VkDeviceSize srcOffset = 0;
+		VkDeviceSize dstOffset = 0;
+		for (uint32_t layer = 0; layer < arrayLayers; layer++)
+			for (uint32_t mipLevel = 0; mipLevel < mipLevels; mipLevel++)
+			{
+				// mip level extent and size
+				uint32_t mipWidth = std::max(width >> mipLevel, 1u);
+				uint32_t mipHeight = std::max(height >> mipLevel, 1u);
+				VkDeviceSize mipSize = GetImageDataSize(mipWidth, mipHeight, 1, 1, format);
+
+				// VkBufferImageCopy (zero row length and image height means tightly packed rows)
+				VkBufferImageCopy bufferImageCopy{};
+				bufferImageCopy.bufferOffset = dstOffset;
+				bufferImageCopy.bufferRowLength = 0;
+				bufferImageCopy.bufferImageHeight = 0;
+				bufferImageCopy.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+				bufferImageCopy.imageSubresource.mipLevel = mipLevel;
+				bufferImageCopy.imageSubresource.baseArrayLayer = layer;
+				bufferImageCopy.imageSubresource.layerCount = 1;
+				bufferImageCopy.imageOffset = { 0, 0, 0 };
+				bufferImageCopy.imageExtent = { mipWidth, mipHeight, 1 };
+				bufferImageCopies.push_back(bufferImageCopy);
+				srcOffsets.push_back(srcOffset);
+				srcSizes.push_back(mipSize);
+
+				// next subresource
+				srcOffset += mipSize;
+				dstOffset = (dstOffset + mipSize + offsetAlignment - 1) / offsetAlignment * offsetAlignment;
+			}
 
-			// copy images
-			CopyImages(width, height, stagingImage, image);
+		// VkBufferCreateInfo
+		VkBufferCreateInfo bufferCreateInfo{};
+		bufferCreateInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+		bufferCreateInfo.size = dstOffset;
+		bufferCreateInfo.usage = VK_BUFFER_USAGE_TRANSFER_SRC_BIT;
+		bufferCreateInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
 
-			// destroy buffer and free memory
-			vmaDestroyImage(mAllocator, stagingImage, stagingImageAlloc);
-		}
+		// VmaAllocationCreateInfo
+		VmaAllocationCreateInfo allocCreateInfo{};
+		allocCreateInfo.usage = VMA_MEMORY_USAGE_CPU_ONLY;
+		allocCreateInfo.flags = VMA_ALLOCATION_CREATE_MAPPED_BIT;
+
+		// create staging buffer and memory (mapped at creation)
+		VkBuffer stagingBuffer = VK_NULL_HANDLE;
+		VmaAllocation stagingBufferAlloc = VK_NULL_HANDLE;
+		VmaAllocationInfo stagingAllocationInfo{};
+		VK_CHECK(vmaCreateBuffer(mAllocator, &bufferCreateInfo, &allocCreateInfo, &stagingBuffer, &stagingBufferAlloc, &stagingAllocationInfo));
+		assert(stagingBuffer);
+		assert(stagingBufferAlloc);
+		assert(stagingAllocationInfo.pMappedData);
+
+		// fill staging buffer (optimal tiling images are never host writable, even on UMA)
+		for (size_t i = 0; i < bufferImageCopies.size(); i++)
+			memcpy((uint8_t*)stagingAllocationInfo.pMappedData + bufferImageCopies[i].bufferOffset, (const uint8_t*)data + srcOffsets[i], (size_t)srcSizes[i]);
+
+		// copy buffer to all image subresources
+		CopyBufferToImage(stagingBuffer, image, VK_IMAGE_ASPECT_COLOR_BIT, bufferImageCopies);
+
+		// destroy buffer and free memory
+		vmaDestroyBuffer(mAllocator, stagingBuffer, stagingBufferAlloc);
 	}
 
 	// CreateSemaphore
@@ -745,6 +976,21 @@ namespace VulkanHelpers {
 		return semaphore;
 	}
 
+	// CreateFence
+	VkFence VulkanDeviceInfo::CreateFence(VkFenceCreateFlags fenceCreateFlags)
+	{
+		// VkFenceCreateInfo
+		VkFenceCreateInfo fenceCreateInfo{};
+		fenceCreateInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+		fenceCreateInfo.pNext = VK_NULL_HANDLE;
+		fenceCreateInfo.flags = fenceCreateFlags;
+
+		// vkCreateFence
+		VkFence fence = VK_NULL_HANDLE;
+		VK_CHECK(vkCreateFence(mDevice, &fenceCreateInfo, VK_NULL_HANDLE, &fence));
+		return fence;
+	}
+
 	// CreateSampler
 	VkSampler VulkanDeviceInfo::CreateSampler(VkFilter filter, VkSamplerAddressMode samplerAddressMode)
 	{
@@ -777,6 +1023,12 @@ namespace VulkanHelpers {
 
 	// CreateImageView
 	VkImageView VulkanDeviceInfo::CreateImageView(VkImage image, VkFormat format, VkImageAspectFlags aspectMask)
+	{
+		return CreateImageView(image, VK_IMAGE_VIEW_TYPE_2D, format, aspectMask, 1, 1);
+	}
+
+	// CreateImageView (mip levels and array layers)
+	VkImageView VulkanDeviceInfo::CreateImageView(VkImage image, VkImageViewType viewType, VkFormat format, VkImageAspectFlags aspectMask, uint32_t mipLevels, uint32_t arrayLayers)
 	{
 		// VkImageViewCreateInfo
 		VkImageViewCreateInfo imageViewCreateInfo{};
@@ -784,7 +1036,7 @@ namespace VulkanHelpers {
 		imageViewCreateInfo.pNext = VK_NULL_HANDLE;
 		imageViewCreateInfo.flags = 0;
 		imageViewCreateInfo.image = image;
-		imageViewCreateInfo.viewType = VK_IMAGE_VIEW_TYPE_2D;
+		imageViewCreateInfo.viewType = viewType;
 		imageViewCreateInfo.format = format;
 		imageViewCreateInfo.components.r = VK_COMPONENT_SWIZZLE_IDENTITY;
 		imageViewCreateInfo.components.g = VK_COMPONENT_SWIZZLE_IDENTITY;
@@ -792,9 +1044,9 @@ namespace VulkanHelpers {
 		imageViewCreateInfo.components.a = VK_COMPONENT_SWIZZLE_IDENTITY;;
 		imageViewCreateInfo.subresourceRange.aspectMask = aspectMask;
 		imageViewCreateInfo.subresourceRange.baseMipLevel = 0;
-		imageViewCreateInfo.subresourceRange.levelCount = 1;
+		imageViewCreateInfo.subresourceRange.levelCount = mipLevels;
 		imageViewCreateInfo.subresourceRange.baseArrayLayer = 0;
-		imageViewCreateInfo.subresourceRange.layerCount = 1;
+		imageViewCreateInfo.subresourceRange.layerCount = arrayLayers;
 
 		// vkCreateImage
 		VkImageView imageView = VK_NULL_HANDLE;
@@ -854,20 +1106,37 @@ namespace VulkanHelpers {
 		assert(surface);
 
 		// get parameters
-		mPresentMode = mDeviceInfo->FindPresentMode();
 		mSurfaceFormat = mDeviceInfo->FindSurfaceFormat();
 
+		// create size dependent resources, render pass and framebuffers
+		CreateSwapchain(VK_NULL_HANDLE);
+		CreateRenderPass();
+		CreateFramebuffers();
+	}
+
+	// CreateSwapchain (swapchain, color image views and depth stencil image)
+	void VulkanSwapchainInfo::CreateSwapchain(VkSwapchainKHR oldSwapchain)
+	{
 		// VkSurfaceCapabilitiesKHR
 		VkSurfaceCapabilitiesKHR surfaceCapabilitiesKHR{};
-		VK_CHECK(vkGetPhysicalDeviceSurfaceCapabilitiesKHR(mDeviceInfo->mPhysicalDevice, surface, &surfaceCapabilitiesKHR));
+		VK_CHECK(vkGetPhysicalDeviceSurfaceCapabilitiesKHR(mDeviceInfo->mPhysicalDevice, mSurface, &surfaceCapabilitiesKHR));
 		mViewportWidth = surfaceCapabilitiesKHR.currentExtent.width;
 		mViewportHeight = surfaceCapabilitiesKHR.currentExtent.height;
 
+		// desired image count and present mode (maxImageCount 0 - no limit)
+		mImageCount = std::max(mDesiredImageCount, surfaceCapabilitiesKHR.minImageCount);
+		if (surfaceCapabilitiesKHR.maxImageCount > 0)
+			mImageCount = std::min(mImageCount, surfaceCapabilitiesKHR.maxImageCount);
+		mPresentMode = mDeviceInfo->FindPresentMode(mDesiredPresentMode);
+
+		// presents to new swapchain start from next id
+		mFirstPresentId = mPresentId + 1;
+
 		// VkSwapchainCreateInfoKHR
 		VkSwapchainCreateInfoKHR swapchainCreateInfoKHR{};
 		swapchainCreateInfoKHR.sType = VK_STRUCTURE_TYPE_SWAPCHAIN_CREATE_INFO_KHR;
-		swapchainCreateInfoKHR.surface = surface;
-		swapchainCreateInfoKHR.minImageCount = surfaceCapabilitiesKHR.maxImageCount;
+		swapchainCreateInfoKHR.surface = mSurface;
+		swapchainCreateInfoKHR.minImageCount = mImageCount;
 		swapchainCreateInfoKHR.imageFormat = mSurfaceFormat.format;
 		swapchainCreateInfoKHR.imageColorSpace = mSurfaceFormat.colorSpace;
 		swapchainCreateInfoKHR.imageExtent.width = surfaceCapabilitiesKHR.currentExtent.width;
@@ -881,7 +1150,7 @@ namespace VulkanHelpers {
 		swapchainCreateInfoKHR.compositeAlpha = VK_COMPOSITE_ALPHA_OPAQUE_BIT_KHR;
 		swapchainCreateInfoKHR.presentMode = mPresentMode;
 		swapchainCreateInfoKHR.clipped = VK_TRUE;
-		swapchainCreateInfoKHR.oldSwapchain = VK_NULL_HANDLE;
+		swapchainCreateInfoKHR.oldSwapchain = oldSwapchain;
 
 		// vkCreateSwapchainKHR
 		VK_CHECK(vkCreateSwapchainKHR(mDeviceInfo->mDevice, &swapchainCreateInfoKHR, nullptr, &mSwapchain));
@@ -922,9 +1191,11 @@ namespace VulkanHelpers {
 		// VkImageView
 		mImageViewDepthStencil = mDeviceInfo->CreateImageView(mImageDepthStencil, VK_FORMAT_D24_UNORM_S8_UINT, VK_IMAGE_ASPECT_DEPTH_BIT | VK_IMAGE_ASPECT_STENCIL_BIT);
 		assert(mImageViewDepthStencil);
+	}
 
-		//////////////////////////////////////////////////////////////////////////
-
+	// CreateRenderPass
+	void VulkanSwapchainInfo::CreateRenderPass()
+	{
 		// VkAttachmentDescription - color
 		std::array<VkAttachmentDescription, 2> attachmentDescriptions;
 		// color attachment
@@ -981,16 +1252,18 @@ namespace VulkanHelpers {
 
 		// vkCreateRenderPass
 		VK_CHECK(vkCreateRenderPass(mDeviceInfo->mDevice, &renderPassCreateInfo, VK_NULL_HANDLE, &mRenderPass));
+	}
 
-		//////////////////////////////////////////////////////////////////////////
-
+	// CreateFramebuffers
+	void VulkanSwapchainInfo::CreateFramebuffers()
+	{
 		// create framebuffers
 		mFramebuffers.clear();
-		mFramebuffers.reserve(imageColorsCount);
+		mFramebuffers.reserve(mImageViewColors.size());
 		for (const auto& imageViewColor : mImageViewColors) {
 			// create framebuffer
 			std::vector<VkImageView> imageViews = { imageViewColor, mImageViewDepthStencil };
-			VkFramebuffer framebuffer = mDeviceInfo->CreateFramebuffer(mRenderPass, imageViews, mViewportWidth, mViewportWidth);
+			VkFramebuffer framebuffer = mDeviceInfo->CreateFramebuffer(mRenderPass, imageViews, mViewportWidth, mViewportHeight);
 			assert(framebuffer);
 
 			// add framebuffer
@@ -1034,15 +1307,51 @@ namespace VulkanHelpers {
 		Initialize(deviceInfo, surface);
 	}
 
+	// Recreate
+	void VulkanSwapchainInfo::Recreate(VulkanDeletionQueue& deletionQueue, uint64_t frameNumber)
+	{
+		// minimized window has no surface extent (swapchain stays out of date, frames are skipped)
+		VkSurfaceCapabilitiesKHR surfaceCapabilitiesKHR{};
+		VK_CHECK(vkGetPhysicalDeviceSurfaceCapabilitiesKHR(mDeviceInfo->mPhysicalDevice, mSurface, &surfaceCapabilitiesKHR));
+		if ((surfaceCapabilitiesKHR.currentExtent.width == 0) || (surfaceCapabilitiesKHR.currentExtent.height == 0))
+			return;
+
+		// retire size dependent resources, frames in flight can still use them
+		VkDevice device = mDeviceInfo->mDevice;
+		VmaAllocator allocator = mDeviceInfo->mAllocator;
+		VkSwapchainKHR oldSwapchain = mSwapchain;
+		VkImage oldImageDepthStencil = mImageDepthStencil;
+		VkImageView oldImageViewDepthStencil = mImageViewDepthStencil;
+		VmaAllocation oldImageDepthStencilAllocation = mImageDepthStencilAllocation;
+		std::vector<VkImageView> oldImageViewColors = mImageViewColors;
+		std::vector<VkFramebuffer> oldFramebuffers = mFramebuffers;
+		deletionQueue.Push(frameNumber, [=]() {
+			for (const auto& framebuffer : oldFramebuffers)
+				vkDestroyFramebuffer(device, framebuffer, VK_NULL_HANDLE);
+			vkDestroyImageView(device, oldImageViewDepthStencil, VK_NULL_HANDLE);
+			vmaDestroyImage(allocator, oldImageDepthStencil, oldImageDepthStencilAllocation);
+			for (const auto& imageViewColor : oldImageViewColors)
+				vkDestroyImageView(device, imageViewColor, VK_NULL_HANDLE);
+			vkDestroySwapchainKHR(device, oldSwapchain, VK_NULL_HANDLE);
+		});
+
+		// create new swapchain from old one (render pass and pipelines are kept, format does not change)
+		CreateSwapchain(oldSwapchain);
+		CreateFramebuffers();
+	}
+
 	// BeginFrame
-	VkFramebuffer VulkanSwapchainInfo::BeginFrame(VkSemaphore signalSemaphore)
+	VkResult VulkanSwapchainInfo::BeginFrame(VkSemaphore signalSemaphore, VkFramebuffer& framebuffer)
 	{
-		VK_CHECK(vkAcquireNextImageKHR(mDeviceInfo->mDevice, mSwapchain, UINT64_MAX, signalSemaphore, VK_NULL_HANDLE, &mCurrentFramebufferIndex));
-		return mFramebuffers[mCurrentFramebufferIndex];
+		// suboptimal image is acquired (semaphore is signaled), so it is rendered and presented before recreation
+		VkResult result = vkAcquireNextImageKHR(mDeviceInfo->mDevice, mSwapchain, UINT64_MAX, signalSemaphore, VK_NULL_HANDLE, &mCurrentFramebufferIndex);
+		assert((result == VK_SUCCESS) || (result == VK_SUBOPTIMAL_KHR) || (result == VK_ERROR_OUT_OF_DATE_KHR));
+		framebuffer = (result == VK_ERROR_OUT_OF_DATE_KHR) ? VK_NULL_HANDLE : mFramebuffers[mCurrentFramebufferIndex];
+		return result;
 	}
 
 	// EndFrame
-	void VulkanSwapchainInfo::EndFrame(VkSemaphore waitSemaphore)
+	VkResult VulkanSwapchainInfo::EndFrame(VkSemaphore waitSemaphore)
 	{
 		// VkPresentInfoKHR
 		VkPresentInfoKHR presentInfo{};
@@ -1053,60 +1362,165 @@ namespace VulkanHelpers {
 		presentInfo.pSwapchains = &mSwapchain;
 		presentInfo.pImageIndices = &mCurrentFramebufferIndex;
 		presentInfo.pResults = nullptr; // Optional
-		VK_CHECK(vkQueuePresentKHR(mDeviceInfo->mQueuePresent, &presentInfo));
-		VK_CHECK(vkQueueWaitIdle(mDeviceInfo->mQueuePresent));
+
+		// VkPresentIdKHR (lets frame pacing wait for this present)
+		VkPresentIdKHR presentId{};
+		if (mPresentIdEnabled)
+		{
+			mPresentId++;
+			presentId.sType = VK_STRUCTURE_TYPE_PRESENT_ID_KHR;
+			presentId.pNext = VK_NULL_HANDLE;
+			presentId.swapchainCount = 1;
+			presentId.pPresentIds = &mPresentId;
+			presentInfo.pNext = &presentId;
+		}
+		VkResult result = vkQueuePresentKHR(mDeviceInfo->mQueuePresent, &presentInfo);
+		assert((result == VK_SUCCESS) || (result == VK_SUBOPTIMAL_KHR) || (result == VK_ERROR_OUT_OF_DATE_KHR));
+		return result;
 	}
 
 	//////////////////////////////////////////////////////////////////////////
-	// VulkanPipelineInfo
+	// VulkanDeletionQueue
 	//////////////////////////////////////////////////////////////////////////
 
-	// InitVertexInputDescriptions
-	void VulkanPipelineInfo::InitVertexInputDescriptions()
+	// Push
+	void VulkanDeletionQueue::Push(uint64_t frameNumber, std::function<void()> deleter)
 	{
-		// VkVertexInputBindingDescription
-		mVertexBindingDescriptions = {
-			{ 0, 10 * sizeof(float), VK_VERTEX_INPUT_RATE_VERTEX },
-		};
+		mEntries.push_back({ frameNumber, deleter });
+	}
 
-		// VkVertexInputAttributeDescription
-		mVertexAttributeDescriptions = {
-			{ 0, 0, VK_FORMAT_R32G32B32A32_SFLOAT,  0 }, // position
-			{ 1, 0, VK_FORMAT_R32G32B32A32_SFLOAT, 16 }, // color
-			{ 2, 0, VK_FORMAT_R32G32_SFLOAT      , 32 }, // texCoord
-		};
+	// Flush
+	void VulkanDeletionQueue::Flush(uint64_t completedFrameCount)
+	{
+		// entries are pushed in frame order
+		while (mEntries.size() && (mEntries.front().mFrameNumber <= completedFrameCount)) {
+			mEntries.front().mDeleter();
+			mEntries.pop_front();
+		}
 	}
 
-	// InitPipelineLayoutHandles
-	void VulkanPipelineInfo::InitPipelineLayoutDescriptions()
+	// FlushAll
+	void VulkanDeletionQueue::FlushAll()
 	{
-		// VkDescriptorSetLayoutBinding
-		mDescriptorSetLayoutBindings = {
-			{ 0, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 1, VK_SHADER_STAGE_FRAGMENT_BIT, VK_NULL_HANDLE }, // texture
-			{ 1, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER,         1, VK_SHADER_STAGE_VERTEX_BIT  , VK_NULL_HANDLE }, // buffer
-		};
+		for (auto& entry : mEntries)
+			entry.mDeleter();
+		mEntries.clear();
 	}
 
-	// Initialize
-	void VulkanPipelineInfo::Initialize(VulkanDeviceInfo& deviceInfo, VkRenderPass renderPass, const char* pathVS, const char* pathFS)
+	//////////////////////////////////////////////////////////////////////////
+	// VulkanPipelineState
+	//////////////////////////////////////////////////////////////////////////
+
+	// state is hashed and compared bytewise, so members must leave no padding
+	static_assert(sizeof(VulkanPipelineState) == 4 * sizeof(uint64_t) + 80 * sizeof(uint32_t), "VulkanPipelineState has padding");
+
+	// SetVertexInput
+	void VulkanPipelineState::SetVertexInput(const std::vector<VkVertexInputBindingDescription>& bindings, const std::vector<VkVertexInputAttributeDescription>& attributes)
 	{
-		// check device info and paths
-		assert(renderPass);
-		assert(pathVS);
-		assert(pathFS);
+		assert(bindings.size() <= VULKAN_PIPELINE_MAX_VERTEX_BINDINGS);
+		assert(attributes.size() <= VULKAN_PIPELINE_MAX_VERTEX_ATTRIBUTES);
+
+		// unused entries are cleared, they are part of key
+		memset(mVertexBindings, 0, sizeof(mVertexBindings));
+		memset(mVertexAttributes, 0, sizeof(mVertexAttributes));
+		mVertexBindingCount = (uint32_t)std::min<size_t>(bindings.size(), VULKAN_PIPELINE_MAX_VERTEX_BINDINGS);
+		mVertexAttributeCount = (uint32_t)std::min<size_t>(attributes.size(), VULKAN_PIPELINE_MAX_VERTEX_ATTRIBUTES);
+		std::copy(bindings.begin(), bindings.begin() + mVertexBindingCount, mVertexBindings);
+		std::copy(attributes.begin(), attributes.begin() + mVertexAttributeCount, mVertexAttributes);
+	}
 
-		// copy handles
-		mDeviceInfo = &deviceInfo;
+	// SetAlphaBlend (src alpha over, depth is tested but not written)
+	void VulkanPipelineState::SetAlphaBlend()
+	{
+		mBlendAttachment.blendEnable = VK_TRUE;
+		mBlendAttachment.srcColorBlendFactor = VK_BLEND_FACTOR_SRC_ALPHA;
+		mBlendAttachment.dstColorBlendFactor = VK_BLEND_FACTOR_ONE_MINUS_SRC_ALPHA;
+		mBlendAttachment.colorBlendOp = VK_BLEND_OP_ADD;
+		mBlendAttachment.srcAlphaBlendFactor = VK_BLEND_FACTOR_ONE;
+		mBlendAttachment.dstAlphaBlendFactor = VK_BLEND_FACTOR_ONE_MINUS_SRC_ALPHA;
+		mBlendAttachment.alphaBlendOp = VK_BLEND_OP_ADD;
+		mDepthWriteEnable = VK_FALSE;
+	}
 
-		// init handles
-		InitVertexInputDescriptions();
-		InitPipelineLayoutDescriptions();
+	// SetSpecializationConstant
+	void VulkanPipelineState::SetSpecializationConstant(uint32_t constantID, uint32_t value)
+	{
+		// find id (entries are sorted, so same constants give same key in any set order)
+		uint32_t index = 0;
+		while ((index < mSpecializationCount) && (mSpecializationIDs[index] < constantID))
+			index++;
+
+		// insert new id
+		if ((index == mSpecializationCount) || (mSpecializationIDs[index] != constantID)) {
+			assert(mSpecializationCount < VULKAN_PIPELINE_MAX_SPECIALIZATION_CONSTANTS);
+			if (mSpecializationCount == VULKAN_PIPELINE_MAX_SPECIALIZATION_CONSTANTS)
+				return;
+			for (uint32_t i = mSpecializationCount; i > index; i--) {
+				mSpecializationIDs[i] = mSpecializationIDs[i - 1];
+				mSpecializationValues[i] = mSpecializationValues[i - 1];
+			}
+			mSpecializationIDs[index] = constantID;
+			mSpecializationCount++;
+		}
+		mSpecializationValues[index] = value;
+	}
 
-		// create shaders
-		mShaderModuleVS = CreateShaderModuleFromFile(mDeviceInfo->mDevice, pathVS);
-		assert(mShaderModuleVS);
-		mShaderModuleFS = CreateShaderModuleFromFile(mDeviceInfo->mDevice, pathFS);
-		assert(mShaderModuleFS);
+	// SetSpecializationConstant
+	void VulkanPipelineState::SetSpecializationConstant(uint32_t constantID, float value)
+	{
+		uint32_t bits = 0;
+		memcpy(&bits, &value, sizeof(bits));
+		SetSpecializationConstant(constantID, bits);
+	}
+
+	// ClearSpecializationConstants
+	void VulkanPipelineState::ClearSpecializationConstants()
+	{
+		// unused entries are cleared, they are part of key
+		mSpecializationCount = 0;
+		memset(mSpecializationIDs, 0, sizeof(mSpecializationIDs));
+		memset(mSpecializationValues, 0, sizeof(mSpecializationValues));
+	}
+
+	// GetHash
+	uint64_t VulkanPipelineState::GetHash() const
+	{
+		return HashBytes(this, sizeof(VulkanPipelineState));
+	}
+
+	// operator==
+	bool VulkanPipelineState::operator==(const VulkanPipelineState& other) const
+	{
+		return memcmp(this, &other, sizeof(VulkanPipelineState)) == 0;
+	}
+
+	// CreateGraphicsPipeline
+	VkPipeline CreateGraphicsPipeline(VkDevice device, VkPipelineCache pipelineCache, const VulkanPipelineState& pipelineState)
+	{
+		// check handles
+		assert(pipelineState.mShaderModuleVS);
+		assert(pipelineState.mShaderModuleFS);
+		assert(pipelineState.mPipelineLayout);
+		assert(pipelineState.mRenderPass);
+		assert(pipelineState.mSpecializationCount <= VULKAN_PIPELINE_MAX_SPECIALIZATION_CONSTANTS);
+
+		// VkSpecializationMapEntry - specializationMapEntries (value i is word i of data)
+		std::array<VkSpecializationMapEntry, VULKAN_PIPELINE_MAX_SPECIALIZATION_CONSTANTS> specializationMapEntries;
+		for (uint32_t i = 0; i < pipelineState.mSpecializationCount; i++) {
+			specializationMapEntries[i].constantID = pipelineState.mSpecializationIDs[i];
+			specializationMapEntries[i].offset = i * sizeof(uint32_t);
+			specializationMapEntries[i].size = sizeof(uint32_t);
+		}
+
+		// VkSpecializationInfo - specializationInfo
+		VkSpecializationInfo specializationInfo{};
+		specializationInfo.mapEntryCount = pipelineState.mSpecializationCount;
+		specializationInfo.pMapEntries = specializationMapEntries.data();
+		specializationInfo.dataSize = pipelineState.mSpecializationCount * sizeof(uint32_t);
+		specializationInfo.pData = pipelineState.mSpecializationValues;
+		auto getSpecializationInfo = [&](VkShaderStageFlagBits stage) {
+			return (pipelineState.mSpecializationCount && (pipelineState.mSpecializationStages & stage)) ? &specializationInfo : VK_NULL_HANDLE;
+		};
 
 		// VkPipelineShaderStageCreateInfo - shaderStages
 		std::array<VkPipelineShaderStageCreateInfo, 2> shaderStages;
@@ -1115,17 +1529,17 @@ namespace VulkanHelpers {
 		shaderStages[0].pNext = VK_NULL_HANDLE;
 		shaderStages[0].flags = 0;
 		shaderStages[0].stage = VK_SHADER_STAGE_VERTEX_BIT;
-		shaderStages[0].module = mShaderModuleVS;
+		shaderStages[0].module = pipelineState.mShaderModuleVS;
 		shaderStages[0].pName = "main";
-		shaderStages[0].pSpecializationInfo = VK_NULL_HANDLE;
+		shaderStages[0].pSpecializationInfo = getSpecializationInfo(VK_SHADER_STAGE_VERTEX_BIT);
 		// fragment shader
 		shaderStages[1].sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
 		shaderStages[1].pNext = VK_NULL_HANDLE;
 		shaderStages[1].flags = 0;
 		shaderStages[1].stage = VK_SHADER_STAGE_FRAGMENT_BIT;
-		shaderStages[1].module = mShaderModuleFS;
+		shaderStages[1].module = pipelineState.mShaderModuleFS;
 		shaderStages[1].pName = "main";
-		shaderStages[1].pSpecializationInfo = VK_NULL_HANDLE;
+		shaderStages[1].pSpecializationInfo = getSpecializationInfo(VK_SHADER_STAGE_FRAGMENT_BIT);
 
 		//////////////////////////////////////////////////////////////////////////
 
@@ -1134,10 +1548,10 @@ namespace VulkanHelpers {
 		vertexInputState.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
 		vertexInputState.pNext = VK_NULL_HANDLE;
 		vertexInputState.flags = 0;
-		vertexInputState.vertexBindingDescriptionCount = (uint32_t)mVertexBindingDescriptions.size();
-		vertexInputState.pVertexBindingDescriptions = mVertexBindingDescriptions.data();
-		vertexInputState.vertexAttributeDescriptionCount = (uint32_t)mVertexAttributeDescriptions.size();
-		vertexInputState.pVertexAttributeDescriptions = mVertexAttributeDescriptions.data();
+		vertexInputState.vertexBindingDescriptionCount = pipelineState.mVertexBindingCount;
+		vertexInputState.pVertexBindingDescriptions = pipelineState.mVertexBindings;
+		vertexInputState.vertexAttributeDescriptionCount = pipelineState.mVertexAttributeCount;
+		vertexInputState.pVertexAttributeDescriptions = pipelineState.mVertexAttributes;
 
 		//////////////////////////////////////////////////////////////////////////
 
@@ -1146,8 +1560,8 @@ namespace VulkanHelpers {
 		inputAssemblyState.sType = VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO;
 		inputAssemblyState.pNext = VK_NULL_HANDLE;
 		inputAssemblyState.flags = 0;
-		inputAssemblyState.topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;
-		inputAssemblyState.primitiveRestartEnable = VK_FALSE;
+		inputAssemblyState.topology = pipelineState.mTopology;
+		inputAssemblyState.primitiveRestartEnable = pipelineState.mPrimitiveRestartEnable;
 
 		//////////////////////////////////////////////////////////////////////////
 
@@ -1195,14 +1609,13 @@ namespace VulkanHelpers {
 		rasterizationState.flags = 0;
 		rasterizationState.depthClampEnable = VK_FALSE;
 		rasterizationState.rasterizerDiscardEnable = VK_FALSE;
-		rasterizationState.polygonMode = VK_POLYGON_MODE_FILL;
-		//rasterizationState.polygonMode = VK_POLYGON_MODE_LINE;
-		rasterizationState.cullMode = VK_CULL_MODE_NONE;
-		rasterizationState.frontFace = VK_FRONT_FACE_CLOCKWISE;
-		rasterizationState.depthBiasEnable = VK_FALSE;
-		rasterizationState.depthBiasConstantFactor = 0.0f;
+		rasterizationState.polygonMode = pipelineState.mPolygonMode;
+		rasterizationState.cullMode = pipelineState.mCullMode;
+		rasterizationState.frontFace = pipelineState.mFrontFace;
+		rasterizationState.depthBiasEnable = pipelineState.mDepthBiasEnable;
+		rasterizationState.depthBiasConstantFactor = pipelineState.mDepthBiasConstantFactor;
 		rasterizationState.depthBiasClamp = 0.0f;
-		rasterizationState.depthBiasSlopeFactor = 0.0f;
+		rasterizationState.depthBiasSlopeFactor = pipelineState.mDepthBiasSlopeFactor;
 		rasterizationState.lineWidth = 1.0f;
 
 		//////////////////////////////////////////////////////////////////////////
@@ -1212,7 +1625,7 @@ namespace VulkanHelpers {
 		multisampleState.sType = VK_STRUCTURE_TYPE_PIPELINE_MULTISAMPLE_STATE_CREATE_INFO;
 		multisampleState.pNext = VK_NULL_HANDLE;
 		multisampleState.flags = 0;
-		multisampleState.rasterizationSamples = VK_SAMPLE_COUNT_1_BIT;
+		multisampleState.rasterizationSamples = pipelineState.mRasterizationSamples;
 		multisampleState.sampleShadingEnable = VK_FALSE;
 		multisampleState.minSampleShading = 1.0f;
 		multisampleState.pSampleMask = VK_NULL_HANDLE;
@@ -1226,10 +1639,10 @@ namespace VulkanHelpers {
 		depthStencilState.sType = VK_STRUCTURE_TYPE_PIPELINE_DEPTH_STENCIL_STATE_CREATE_INFO;
 		depthStencilState.pNext = VK_NULL_HANDLE;
 		depthStencilState.flags = 0;
-		depthStencilState.depthTestEnable = VK_TRUE;
-		depthStencilState.depthWriteEnable = VK_TRUE;
-		depthStencilState.depthCompareOp = VK_COMPARE_OP_LESS;
-		depthStencilState.depthBoundsTestEnable = VK_TRUE;
+		depthStencilState.depthTestEnable = pipelineState.mDepthTestEnable;
+		depthStencilState.depthWriteEnable = pipelineState.mDepthWriteEnable;
+		depthStencilState.depthCompareOp = pipelineState.mDepthCompareOp;
+		depthStencilState.depthBoundsTestEnable = pipelineState.mDepthBoundsTestEnable;
 		depthStencilState.stencilTestEnable = VK_FALSE;
 		depthStencilState.front.failOp = VK_STENCIL_OP_KEEP;
 		depthStencilState.front.passOp = VK_STENCIL_OP_KEEP;
@@ -1251,15 +1664,7 @@ namespace VulkanHelpers {
 		//////////////////////////////////////////////////////////////////////////
 
 		// VkPipelineColorBlendAttachmentState - attachments
-		std::array<VkPipelineColorBlendAttachmentState, 1> attachments;
-		attachments[0].blendEnable = VK_FALSE;
-		attachments[0].srcColorBlendFactor = VK_BLEND_FACTOR_ONE;
-		attachments[0].dstColorBlendFactor = VK_BLEND_FACTOR_ZERO;
-		attachments[0].colorBlendOp = VK_BLEND_OP_ADD;
-		attachments[0].srcAlphaBlendFactor = VK_BLEND_FACTOR_ONE;
-		attachments[0].dstAlphaBlendFactor = VK_BLEND_FACTOR_ZERO;
-		attachments[0].alphaBlendOp = VK_BLEND_OP_ADD;
-		attachments[0].colorWriteMask = VK_COLOR_COMPONENT_R_BIT | VK_COLOR_COMPONENT_G_BIT | VK_COLOR_COMPONENT_B_BIT | VK_COLOR_COMPONENT_A_BIT;
+		std::array<VkPipelineColorBlendAttachmentState, 1> attachments = { pipelineState.mBlendAttachment };
 
 		// VkPipelineColorBlendStateCreateInfo - colorBlendState
 		VkPipelineColorBlendStateCreateInfo colorBlendState{};
@@ -1290,7 +1695,101 @@ namespace VulkanHelpers {
 
 		//////////////////////////////////////////////////////////////////////////
 
-		// VkPipelineLayoutCreateInfo
+		// VkGraphicsPipelineCreateInfo
+		VkGraphicsPipelineCreateInfo createInfo{};
+		createInfo.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
+		createInfo.pNext = VK_NULL_HANDLE;
+		createInfo.flags = 0;
+		createInfo.stageCount = (uint32_t)shaderStages.size();
+		createInfo.pStages = shaderStages.data();
+		createInfo.pVertexInputState = &vertexInputState;
+		createInfo.pInputAssemblyState = &inputAssemblyState;
+		createInfo.pTessellationState = &tessellationState;
+		createInfo.pViewportState = &viewportState;
+		createInfo.pRasterizationState = &rasterizationState;
+		createInfo.pMultisampleState = &multisampleState;
+		createInfo.pDepthStencilState = &depthStencilState;
+		createInfo.pColorBlendState = &colorBlendState;
+		createInfo.pDynamicState = &dynamicState;
+		createInfo.layout = pipelineState.mPipelineLayout;
+		createInfo.renderPass = pipelineState.mRenderPass;
+		createInfo.subpass = pipelineState.mSubpass;
+		createInfo.basePipelineHandle = VK_NULL_HANDLE;
+		createInfo.basePipelineIndex = 0;
+
+		// vkCreateGraphicsPipelines
+		VkPipeline pipeline = VK_NULL_HANDLE;
+		VK_CHECK(vkCreateGraphicsPipelines(device, pipelineCache, 1, &createInfo, VK_NULL_HANDLE, &pipeline));
+		return pipeline;
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+	// VulkanPipelineInfo
+	//////////////////////////////////////////////////////////////////////////
+
+	// InitVertexInputDescriptions
+	void VulkanPipelineInfo::InitVertexInputDescriptions()
+	{
+		// VkVertexInputBindingDescription
+		mVertexBindingDescriptions = {
+			{ 0, 10 * sizeof(float), VK_VERTEX_INPUT_RATE_VERTEX },
+		};
+
+		// VkVertexInputAttributeDescription
+		mVertexAttributeDescriptions = {
+			{ 0, 0, VK_FORMAT_R32G32B32A32_SFLOAT,  0 }, // position
+			{ 1, 0, VK_FORMAT_R32G32B32A32_SFLOAT, 16 }, // color
+			{ 2, 0, VK_FORMAT_R32G32_SFLOAT      , 32 }, // texCoord
+		};
+	}
+
+	// InitPipelineLayoutHandles
+	void VulkanPipelineInfo::InitPipelineLayoutDescriptions()
+	{
+		// VkDescriptorSetLayoutBinding
+		mDescriptorSetLayoutBindings = {
+			{ 0, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 1, VK_SHADER_STAGE_FRAGMENT_BIT, VK_NULL_HANDLE }, // texture
+			{ 1, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC, 1, VK_SHADER_STAGE_VERTEX_BIT  , VK_NULL_HANDLE }, // buffer (one slot per frame in flight)
+		};
+	}
+
+	// Initialize
+	void VulkanPipelineInfo::Initialize(VulkanDeviceInfo& deviceInfo, VkRenderPass renderPass, const char* pathVS, const char* pathFS)
+	{
+		// check paths
+		assert(pathVS);
+		assert(pathFS);
+
+		// create shaders
+		VkShaderModule shaderModuleVS = CreateShaderModuleFromFile(deviceInfo.mDevice, pathVS);
+		assert(shaderModuleVS);
+		VkShaderModule shaderModuleFS = CreateShaderModuleFromFile(deviceInfo.mDevice, pathFS);
+		assert(shaderModuleFS);
+
+		// shaders are destroyed with pipeline
+		Initialize(deviceInfo, renderPass, shaderModuleVS, shaderModuleFS);
+		mOwnShaderModules = true;
+	}
+
+	// Initialize
+	void VulkanPipelineInfo::Initialize(VulkanDeviceInfo& deviceInfo, VkRenderPass renderPass, VkShaderModule shaderModuleVS, VkShaderModule shaderModuleFS)
+	{
+		// check render pass and shaders
+		assert(renderPass);
+		assert(shaderModuleVS);
+		assert(shaderModuleFS);
+
+		// copy handles
+		mDeviceInfo = &deviceInfo;
+		mShaderModuleVS = shaderModuleVS;
+		mShaderModuleFS = shaderModuleFS;
+		mOwnShaderModules = false;
+
+		// init handles
+		InitVertexInputDescriptions();
+		InitPipelineLayoutDescriptions();
+
+		// VkDescriptorSetLayoutCreateInfo
 		VkDescriptorSetLayoutCreateInfo descriptorSetLayoutCreateInfo{};
 		descriptorSetLayoutCreateInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
 		descriptorSetLayoutCreateInfo.pNext = VK_NULL_HANDLE;
@@ -1298,12 +1797,12 @@ namespace VulkanHelpers {
 		descriptorSetLayoutCreateInfo.bindingCount = (uint32_t)mDescriptorSetLayoutBindings.size();
 		descriptorSetLayoutCreateInfo.pBindings = mDescriptorSetLayoutBindings.data();
 
-		// vkCreatePipelineLayout
+		// vkCreateDescriptorSetLayout
 		VK_CHECK(vkCreateDescriptorSetLayout(mDeviceInfo->mDevice, &descriptorSetLayoutCreateInfo, VK_NULL_HANDLE, &mDescriptorSetLayout));
 
 		//////////////////////////////////////////////////////////////////////////
 
-			// VkPipelineLayoutCreateInfo
+		// VkPipelineLayoutCreateInfo
 		VkPipelineLayoutCreateInfo pipelineLayoutInfo{};
 		pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
 		pipelineLayoutInfo.pNext = VK_NULL_HANDLE;
@@ -1313,35 +1812,24 @@ namespace VulkanHelpers {
 		pipelineLayoutInfo.pushConstantRangeCount = 0; // Optional
 		pipelineLayoutInfo.pPushConstantRanges = VK_NULL_HANDLE; // Optional
 
-		// vkCreatePipelineLayout;
+		// vkCreatePipelineLayout
 		VK_CHECK(vkCreatePipelineLayout(mDeviceInfo->mDevice, &pipelineLayoutInfo, VK_NULL_HANDLE, &mPipelineLayout));
 
 		//////////////////////////////////////////////////////////////////////////
 
-		// VkGraphicsPipelineCreateInfo
-		VkGraphicsPipelineCreateInfo createInfo{};
-		createInfo.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
-		createInfo.pNext = VK_NULL_HANDLE;
-		createInfo.flags = 0;
-		createInfo.stageCount = (uint32_t)shaderStages.size();
-		createInfo.pStages = shaderStages.data();
-		createInfo.pVertexInputState = &vertexInputState;
-		createInfo.pInputAssemblyState = &inputAssemblyState;
-		createInfo.pTessellationState = &tessellationState;
-		createInfo.pViewportState = &viewportState;
-		createInfo.pRasterizationState = &rasterizationState;
-		createInfo.pMultisampleState = &multisampleState;
-		createInfo.pDepthStencilState = &depthStencilState;
-		createInfo.pColorBlendState = &colorBlendState;
-		createInfo.pDynamicState = &dynamicState;
-		createInfo.layout = mPipelineLayout;
-		createInfo.renderPass = renderPass;
-		createInfo.subpass = 0;
-		createInfo.basePipelineHandle = VK_NULL_HANDLE;
-		createInfo.basePipelineIndex = 0;
+		// VulkanPipelineState (fixed function state is kept)
+		mPipelineState.mShaderModuleVS = mShaderModuleVS;
+		mPipelineState.mShaderModuleFS = mShaderModuleFS;
+		mPipelineState.mPipelineLayout = mPipelineLayout;
+		mPipelineState.mRenderPass = renderPass;
+		mPipelineState.mSubpass = 0;
+		mPipelineState.SetVertexInput(mVertexBindingDescriptions, mVertexAttributeDescriptions);
 
-		// vkCreateGraphicsPipelines
-		VK_CHECK(vkCreateGraphicsPipelines(mDeviceInfo->mDevice, VK_NULL_HANDLE, 1, &createInfo, VK_NULL_HANDLE, &mPipeline));
+		// CreateGraphicsPipeline (with device pipeline cache if any, cache is dirty when pipeline added data to it)
+		VkPipelineCache pipelineCache = mDeviceInfo->mPipelineCacheInfo ? mDeviceInfo->mPipelineCacheInfo->mPipelineCache : VK_NULL_HANDLE;
+		mPipeline = CreateGraphicsPipeline(mDeviceInfo->mDevice, pipelineCache, mPipelineState);
+		if (mDeviceInfo->mPipelineCacheInfo)
+			mDeviceInfo->mPipelineCacheInfo->MarkDirty();
 
 		// get descriptor type counts
 		std::map<VkDescriptorType, uint32_t> descriptorTypeCounts{};
@@ -1388,10 +1876,13 @@ namespace VulkanHelpers {
 		mPipelineLayout = VK_NULL_HANDLE;
 		vkDestroyDescriptorSetLayout(mDeviceInfo->mDevice, mDescriptorSetLayout, VK_NULL_HANDLE);
 		mDescriptorSetLayout = VK_NULL_HANDLE;
-		vkDestroyShaderModule(mDeviceInfo->mDevice, mShaderModuleFS, VK_NULL_HANDLE);
+		if (mOwnShaderModules) {
+			vkDestroyShaderModule(mDeviceInfo->mDevice, mShaderModuleFS, VK_NULL_HANDLE);
+			vkDestroyShaderModule(mDeviceInfo->mDevice, mShaderModuleVS, VK_NULL_HANDLE);
+		}
 		mShaderModuleFS = VK_NULL_HANDLE;
-		vkDestroyShaderModule(mDeviceInfo->mDevice, mShaderModuleVS, VK_NULL_HANDLE);
 		mShaderModuleVS = VK_NULL_HANDLE;
+		mOwnShaderModules = false;
 	}
 
 	// BindImageView
@@ -1447,6 +1938,32 @@ namespace VulkanHelpers {
 		vkUpdateDescriptorSets(mDeviceInfo->mDevice, 1, &writeDescriptorSet, 0, VK_NULL_HANDLE);
 	}
 
+	// BindUnifromBufferDynamic
+	void VulkanPipelineInfo::BindUnifromBufferDynamic(uint32_t binding, VkBuffer buffer, VkDeviceSize range)
+	{
+		// VkDescriptorBufferInfo (offset is passed to vkCmdBindDescriptorSets)
+		VkDescriptorBufferInfo descriptorBufferInfo{};
+		descriptorBufferInfo.buffer = buffer;
+		descriptorBufferInfo.offset = 0;
+		descriptorBufferInfo.range = range;
+
+		// VkWriteDescriptorSet - dynamic uniform buffer
+		VkWriteDescriptorSet writeDescriptorSet{};
+		writeDescriptorSet.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+		writeDescriptorSet.pNext = VK_NULL_HANDLE;
+		writeDescriptorSet.dstSet = mDescriptorSet;
+		writeDescriptorSet.dstBinding = binding;
+		writeDescriptorSet.dstArrayElement = 0;
+		writeDescriptorSet.descriptorCount = 1;
+		writeDescriptorSet.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
+		writeDescriptorSet.pImageInfo = VK_NULL_HANDLE;
+		writeDescriptorSet.pBufferInfo = &descriptorBufferInfo;
+		writeDescriptorSet.pTexelBufferView = VK_NULL_HANDLE;
+
+		// vkUpdateDescriptorSets
+		vkUpdateDescriptorSets(mDeviceInfo->mDevice, 1, &writeDescriptorSet, 0, VK_NULL_HANDLE);
+	}
+
 	//////////////////////////////////////////////////////////////////////////
 	// Utilities
 	//////////////////////////////////////////////////////////////////////////
@@ -1464,6 +1981,177 @@ namespace VulkanHelpers {
 		return deviceQueueCreateInfo;
 	}
 
+	// InitBufferCreateInfo
+	VkBufferCreateInfo InitBufferCreateInfo(VkDeviceSize size, VkBufferUsageFlags usage)
+	{
+		VkBufferCreateInfo bufferCreateInfo{};
+		bufferCreateInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+		bufferCreateInfo.pNext = VK_NULL_HANDLE;
+		bufferCreateInfo.flags = 0;
+		bufferCreateInfo.size = size;
+		bufferCreateInfo.usage = usage | VK_BUFFER_USAGE_TRANSFER_DST_BIT;
+		bufferCreateInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+		bufferCreateInfo.queueFamilyIndexCount = 0;
+		bufferCreateInfo.pQueueFamilyIndices = VK_NULL_HANDLE;
+		return bufferCreateInfo;
+	}
+
+	// InitImageCreateInfo
+	VkImageCreateInfo InitImageCreateInfo(uint32_t width, uint32_t height, uint32_t mipLevels, uint32_t arrayLayers, VkFormat format, VkImageUsageFlags usage, VkImageCreateFlags flags)
+	{
+		VkImageCreateInfo imageCreateInfo{};
+		imageCreateInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+		imageCreateInfo.pNext = VK_NULL_HANDLE;
+		imageCreateInfo.flags = flags;
+		imageCreateInfo.imageType = VK_IMAGE_TYPE_2D;
+		imageCreateInfo.format = format;
+		imageCreateInfo.extent.width = width;
+		imageCreateInfo.extent.height = height;
+		imageCreateInfo.extent.depth = 1;
+		imageCreateInfo.mipLevels = mipLevels;
+		imageCreateInfo.arrayLayers = arrayLayers;
+		imageCreateInfo.samples = VK_SAMPLE_COUNT_1_BIT;
+		imageCreateInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
+		imageCreateInfo.usage = usage | VK_IMAGE_USAGE_TRANSFER_DST_BIT;
+		imageCreateInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+		imageCreateInfo.queueFamilyIndexCount = VK_QUEUE_FAMILY_IGNORED;
+		imageCreateInfo.pQueueFamilyIndices = VK_NULL_HANDLE;
+		imageCreateInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+		return imageCreateInfo;
+	}
+
+	// GetFormatBlockInfo
+	void GetFormatBlockInfo(VkFormat format, uint32_t& blockSize, uint32_t& blockWidth, uint32_t& blockHeight)
+	{
+		// uncompressed formats have 1x1 blocks
+		blockWidth = 1;
+		blockHeight = 1;
+		switch (format)
+		{
+		case VK_FORMAT_R8_UNORM:
+		case VK_FORMAT_R8_SNORM:
+		case VK_FORMAT_R8_UINT:
+		case VK_FORMAT_R8_SINT:
+		case VK_FORMAT_R8_SRGB:
+			blockSize = 1; break;
+		case VK_FORMAT_R8G8_UNORM:
+		case VK_FORMAT_R8G8_SNORM:
+		case VK_FORMAT_R8G8_UINT:
+		case VK_FORMAT_R8G8_SINT:
+		case VK_FORMAT_R16_UNORM:
+		case VK_FORMAT_R16_SFLOAT:
+		case VK_FORMAT_R16_UINT:
+		case VK_FORMAT_R5G6B5_UNORM_PACK16:
+		case VK_FORMAT_D16_UNORM:
+			blockSize = 2; break;
+		case VK_FORMAT_R8G8B8_UNORM:
+		case VK_FORMAT_R8G8B8_SNORM:
+		case VK_FORMAT_R8G8B8_SRGB:
+		case VK_FORMAT_B8G8R8_UNORM:
+		case VK_FORMAT_B8G8R8_SNORM:
+		case VK_FORMAT_B8G8R8_SRGB:
+			blockSize = 3; break;
+		case VK_FORMAT_R8G8B8A8_UNORM:
+		case VK_FORMAT_R8G8B8A8_SNORM:
+		case VK_FORMAT_R8G8B8A8_UINT:
+		case VK_FORMAT_R8G8B8A8_SINT:
+		case VK_FORMAT_R8G8B8A8_SRGB:
+		case VK_FORMAT_B8G8R8A8_UNORM:
+		case VK_FORMAT_B8G8R8A8_SNORM:
+		case VK_FORMAT_B8G8R8A8_SRGB:
+		case VK_FORMAT_A2R10G10B10_UNORM_PACK32:
+		case VK_FORMAT_A2B10G10R10_UNORM_PACK32:
+		case VK_FORMAT_B10G11R11_UFLOAT_PACK32:
+		case VK_FORMAT_R16G16_UNORM:
+		case VK_FORMAT_R16G16_SFLOAT:
+		case VK_FORMAT_R32_UINT:
+		case VK_FORMAT_R32_SINT:
+		case VK_FORMAT_R32_SFLOAT:
+		case VK_FORMAT_D32_SFLOAT:
+		case VK_FORMAT_D24_UNORM_S8_UINT:
+			blockSize = 4; break;
+		case VK_FORMAT_R16G16B16A16_UNORM:
+		case VK_FORMAT_R16G16B16A16_SFLOAT:
+		case VK_FORMAT_R32G32_UINT:
+		case VK_FORMAT_R32G32_SFLOAT:
+			blockSize = 8; break;
+		case VK_FORMAT_R32G32B32_SFLOAT:
+			blockSize = 12; break;
+		case VK_FORMAT_R32G32B32A32_UINT:
+		case VK_FORMAT_R32G32B32A32_SFLOAT:
+			blockSize = 16; break;
+		// block compressed formats
+		case VK_FORMAT_BC1_RGB_UNORM_BLOCK:
+		case VK_FORMAT_BC1_RGB_SRGB_BLOCK:
+		case VK_FORMAT_BC1_RGBA_UNORM_BLOCK:
+		case VK_FORMAT_BC1_RGBA_SRGB_BLOCK:
+		case VK_FORMAT_BC4_UNORM_BLOCK:
+		case VK_FORMAT_BC4_SNORM_BLOCK:
+		case VK_FORMAT_ETC2_R8G8B8_UNORM_BLOCK:
+		case VK_FORMAT_ETC2_R8G8B8_SRGB_BLOCK:
+			blockSize = 8; blockWidth = 4; blockHeight = 4; break;
+		case VK_FORMAT_BC2_UNORM_BLOCK:
+		case VK_FORMAT_BC2_SRGB_BLOCK:
+		case VK_FORMAT_BC3_UNORM_BLOCK:
+		case VK_FORMAT_BC3_SRGB_BLOCK:
+		case VK_FORMAT_BC5_UNORM_BLOCK:
+		case VK_FORMAT_BC5_SNORM_BLOCK:
+		case VK_FORMAT_BC6H_UFLOAT_BLOCK:
+		case VK_FORMAT_BC6H_SFLOAT_BLOCK:
+		case VK_FORMAT_BC7_UNORM_BLOCK:
+		case VK_FORMAT_BC7_SRGB_BLOCK:
+		case VK_FORMAT_ETC2_R8G8B8A8_UNORM_BLOCK:
+		case VK_FORMAT_ETC2_R8G8B8A8_SRGB_BLOCK:
+			blockSize = 16; blockWidth = 4; blockHeight = 4; break;
+		default:
+			// unknown format
+			blockSize = 0;
+			assert(0);
+			break;
+		}
+	}
+
+	// GetImageDataSize
+	VkDeviceSize GetImageDataSize(uint32_t width, uint32_t height, uint32_t mipLevels, uint32_t arrayLayers, VkFormat format)
+	{
+		// get texel block parameters
+		uint32_t blockSize = 0, blockWidth = 0, blockHeight = 0;
+		GetFormatBlockInfo(format, blockSize, blockWidth, blockHeight);
+
+		// sum all mip levels of one layer
+		VkDeviceSize layerSize = 0;
+		for (uint32_t mipLevel = 0; mipLevel < mipLevels; mipLevel++)
+		{
+			uint32_t mipWidth = std::max(width >> mipLevel, 1u);
+			uint32_t mipHeight = std::max(height >> mipLevel, 1u);
+			layerSize += (VkDeviceSize)((mipWidth + blockWidth - 1) / blockWidth) * ((mipHeight + blockHeight - 1) / blockHeight) * blockSize;
+		}
+		return layerSize * arrayLayers;
+	}
+
+	// GetMipLevelsCount
+	uint32_t GetMipLevelsCount(uint32_t width, uint32_t height)
+	{
+		uint32_t mipLevels = 1;
+		while ((width | height) >> mipLevels)
+			mipLevels++;
+		return mipLevels;
+	}
+
+	// HashBytes
+	uint64_t HashBytes(const void* data, size_t size, uint64_t seed)
+	{
+		const uint8_t* bytes = (const uint8_t*)data;
+		uint64_t hash = seed;
+		for (size_t i = 0; i < size; i++)
+		{
+			hash ^= bytes[i];
+			hash *= 1099511628211ull;
+		}
+		return hash;
+	}
+
+#ifdef _WIN32
 	// CreateSurface
 	VkSurfaceKHR CreateSurface(VkInstance instance, HWND hWnd)
 	{
@@ -1480,29 +2168,100 @@ namespace VulkanHelpers {
 		VK_CHECK(vkCreateWin32SurfaceKHR(instance, &win32SurfaceCreateInfoKHR, nullptr, &surface));
 		return surface;
 	}
+#endif
 
-	// CreateShaderModuleFromFile
-	VkShaderModule CreateShaderModuleFromFile(VkDevice device, const char* fileName)
+	//////////////////////////////////////////////////////////////////////////
+	// VulkanMappedFile
+	//////////////////////////////////////////////////////////////////////////
+
+	// Open
+	bool VulkanMappedFile::Open(const char* fileName)
 	{
-		// open file
-		std::ifstream file(fileName, std::ios::binary | std::ios::ate);
-		assert(file.is_open());
+		assert(fileName);
+		assert(!mData);
+#ifdef _WIN32
+		// CreateFileA
+		HANDLE fileHandle = CreateFileA(fileName, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+		if (fileHandle == INVALID_HANDLE_VALUE)
+			return false;
+		mFileHandle = fileHandle;
+
+		// GetFileSizeEx
+		LARGE_INTEGER fileSize{};
+		if (!GetFileSizeEx(fileHandle, &fileSize) || (fileSize.QuadPart <= 0)) {
+			Close();
+			return false;
+		}
+		mSize = (size_t)fileSize.QuadPart;
+
+		// CreateFileMappingA and MapViewOfFile
+		mMappingHandle = CreateFileMappingA(fileHandle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+		if (mMappingHandle)
+			mData = (const uint8_t*)MapViewOfFile(mMappingHandle, FILE_MAP_READ, 0, 0, 0);
+#else
+		// open
+		mFileDescriptor = open(fileName, O_RDONLY);
+		if (mFileDescriptor < 0)
+			return false;
+
+		// fstat
+		struct stat fileStat {};
+		if ((fstat(mFileDescriptor, &fileStat) != 0) || (fileStat.st_size <= 0)) {
+			Close();
+			return false;
+		}
+		mSize = (size_t)fileStat.st_size;
 
-		// get file size
-		auto fileSize = file.tellg();
-		assert(fileSize > 0);
+		// mmap
+		void* data = mmap(nullptr, mSize, PROT_READ, MAP_PRIVATE, mFileDescriptor, 0);
+		if (data != MAP_FAILED)
+			mData = (const uint8_t*)data;
+#endif
+		if (!mData) {
+			Close();
+			return false;
+		}
+		return true;
+	}
+
+	// Close
+	void VulkanMappedFile::Close()
+	{
+#ifdef _WIN32
+		if (mData)
+			UnmapViewOfFile(mData);
+		if (mMappingHandle)
+			CloseHandle(mMappingHandle);
+		if (mFileHandle)
+			CloseHandle(mFileHandle);
+#else
+		if (mData)
+			munmap((void*)mData, mSize);
+		if (mFileDescriptor >= 0)
+			close(mFileDescriptor);
+#endif
+		mFileHandle = nullptr;
+		mMappingHandle = nullptr;
+		mFileDescriptor = -1;
+		mData = nullptr;
+		mSize = 0;
+	}
 
-		// read data and close
-		std::vector<char> code((size_t)fileSize);
-		file.seekg(0, std::ios::beg);
-		file.read(code.data(), fileSize);
-		file.close();
+	// CreateShaderModule
+	VkShaderModule CreateShaderModule(VkDevice device, const uint32_t* code, size_t size)
+	{
+		// SPIR-V is stream of words
+		assert(code);
+		assert(size && (size % sizeof(uint32_t) == 0));
+		assert(((uintptr_t)code % sizeof(uint32_t)) == 0);
 
-		// VkShaderModuleCreateInfo - fragShaderModuleCreateInfo
+		// VkShaderModuleCreateInfo
 		VkShaderModuleCreateInfo shaderModuleCreateInfo{};
 		shaderModuleCreateInfo.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
-		shaderModuleCreateInfo.codeSize = (uint32_t)code.size();
-		shaderModuleCreateInfo.pCode = (uint32_t *)code.data();
+		shaderModuleCreateInfo.pNext = VK_NULL_HANDLE;
+		shaderModuleCreateInfo.flags = 0;
+		shaderModuleCreateInfo.codeSize = size;
+		shaderModuleCreateInfo.pCode = code;
 
 		// vkCreateShaderModule
 		VkShaderModule shaderModule = VK_NULL_HANDLE;
@@ -1510,6 +2269,22 @@ namespace VulkanHelpers {
 		return shaderModule;
 	}
 
+	// CreateShaderModuleFromFile
+	VkShaderModule CreateShaderModuleFromFile(VkDevice device, const char* fileName)
+	{
+		// map file (no read copy, driver reads mapping)
+		VulkanMappedFile mappedFile;
+		bool opened = mappedFile.Open(fileName);
+		assert(opened);
+		if (!opened)
+			return VK_NULL_HANDLE;
+
+		// CreateShaderModule
+		VkShaderModule shaderModule = CreateShaderModule(device, (const uint32_t*)mappedFile.mData, mappedFile.mSize);
+		mappedFile.Close();
+		return shaderModule;
+	}
+
 	// QueueSubmit
 	void QueueSubmit(VkQueue queue, VkCommandBuffer commandBuffer, VkSemaphore waitSemaphore, VkSemaphore signalSemaphore)
 	{
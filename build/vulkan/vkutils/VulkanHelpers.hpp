@@ -4,11 +4,44 @@
 #include <vector>
 #include <list>
 #include <map>
+#include <deque>
+#include <functional>
+#include <string>
 
 #ifdef _DEBUG
 #define VK_CHECK(func) { VkResult result = func; assert(result == VK_SUCCESS); };
 #else
-#define VK_CHECK(func)
+#define VK_CHECK(func) { func; };
+#endif
+
+// VK_KHR_present_id and VK_KHR_present_wait (not in bundled headers)
+#ifndef VK_KHR_present_id
+#define VK_KHR_present_id 1
+#define VK_KHR_PRESENT_ID_EXTENSION_NAME "VK_KHR_present_id"
+#define VK_STRUCTURE_TYPE_PRESENT_ID_KHR ((VkStructureType)1000294000)
+#define VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PRESENT_ID_FEATURES_KHR ((VkStructureType)1000294001)
+typedef struct VkPresentIdKHR {
+	VkStructureType sType;
+	const void*     pNext;
+	uint32_t        swapchainCount;
+	const uint64_t* pPresentIds;
+} VkPresentIdKHR;
+typedef struct VkPhysicalDevicePresentIdFeaturesKHR {
+	VkStructureType sType;
+	void*           pNext;
+	VkBool32        presentId;
+} VkPhysicalDevicePresentIdFeaturesKHR;
+#endif
+#ifndef VK_KHR_present_wait
+#define VK_KHR_present_wait 1
+#define VK_KHR_PRESENT_WAIT_EXTENSION_NAME "VK_KHR_present_wait"
+#define VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PRESENT_WAIT_FEATURES_KHR ((VkStructureType)1000248000)
+typedef struct VkPhysicalDevicePresentWaitFeaturesKHR {
+	VkStructureType sType;
+	void*           pNext;
+	VkBool32        presentWait;
+} VkPhysicalDevicePresentWaitFeaturesKHR;
+typedef VkResult (VKAPI_PTR *PFN_vkWaitForPresentKHR)(VkDevice device, VkSwapchainKHR swapchain, uint64_t presentId, uint64_t timeout);
 #endif
 
 // VulkanHelpers
@@ -54,6 +87,24 @@ namespace VulkanHelpers
 
 		// find functions
 		VkPhysicalDevice FindPhysicalDevice(VkPhysicalDeviceType physicalDeviceType);
+		bool IsLayerSupported(const char* layerName) const;
+	};
+
+	// VulkanMemoryArchitecture (how device local and host visible memory relate)
+	enum VulkanMemoryArchitecture
+	{
+		VULKAN_MEMORY_ARCHITECTURE_DISCRETE = 0, // separate VRAM, at most small host visible window
+		VULKAN_MEMORY_ARCHITECTURE_BAR = 1,      // whole VRAM is host visible (resizable BAR)
+		VULKAN_MEMORY_ARCHITECTURE_UMA = 2,      // device and host share memory (integrated, software)
+	};
+
+	// VulkanMemoryAccess (access pattern hint, chooses memory type and write path)
+	enum VulkanMemoryAccess
+	{
+		VULKAN_MEMORY_ACCESS_STATIC = 0,      // GPU only, never touched by CPU
+		VULKAN_MEMORY_ACCESS_UPLOAD_ONCE = 1, // written by CPU at creation, then read by GPU
+		VULKAN_MEMORY_ACCESS_DYNAMIC = 2,     // rewritten by CPU every frame, persistently mapped
+		VULKAN_MEMORY_ACCESS_READBACK = 3,    // written by GPU, read by CPU, persistently mapped
 	};
 
 	// VulkanBufferInfo
@@ -72,6 +123,10 @@ namespace VulkanHelpers
 		VmaAllocation mAllocation;
 	};
 
+	// VulkanProfilerInfo (VulkanProfiler.hpp)
+	struct VulkanProfilerInfo;
+	struct VulkanPipelineCacheInfo;
+
 	// VulkanDeviceInfo
 	struct VulkanDeviceInfo
 	{
@@ -83,16 +138,22 @@ namespace VulkanHelpers
 
 		// properties
 		VkPhysicalDeviceFeatures             mDeviceFeatures;
+		VkPhysicalDeviceFeatures             mEnabledFeatures{}; // subset of mDeviceFeatures passed to Initialize
 		VkPhysicalDeviceProperties           mDeviceProperties;
 		VkPhysicalDeviceMemoryProperties     mDeviceMemoryProperties;
 		std::vector<VkQueueFamilyProperties> mQueueFamilyProperties{};
 		std::vector<VkSurfaceFormatKHR>      mSurfaceFormats{};
 		std::vector<VkPresentModeKHR>        mPresentModes{};
+		std::vector<VkExtensionProperties>   mExtensionProperties{};
+		std::vector<std::string>             mEnabledExtensionNames{};
 
 		// memory type indexes
 		uint32_t mMemoryDeviceLocalTypeIndex = UINT32_MAX;
 		uint32_t mMemoryHostVisibleTypeIndex = UINT32_MAX;
 
+		// memory placement policy
+		VulkanMemoryArchitecture mMemoryArchitecture = VULKAN_MEMORY_ARCHITECTURE_DISCRETE;
+
 		// queue family indexes
 		uint32_t mQueueFamilyIndexGraphics = UINT32_MAX;
 		uint32_t mQueueFamilyIndexCompute = UINT32_MAX;
@@ -108,44 +169,120 @@ namespace VulkanHelpers
 		// command pool
 		VkCommandPool mCommandPool = VK_NULL_HANDLE;
 
+		// upload profiling (optional, not own)
+		VulkanProfilerInfo* mProfilerInfo = nullptr;
+
+		// pipeline cache used by pipeline creation (optional, not own)
+		VulkanPipelineCacheInfo* mPipelineCacheInfo = nullptr;
+
 		// Init/DeInit functions
 		void Initialize(
 			VkPhysicalDevice physicalDevice, VkSurfaceKHR surface,
 			VkPhysicalDeviceFeatures& physicalDeviceFeatures,
-			std::vector<const char *>& enabledExtensionNames);
+			std::vector<const char *>& enabledExtensionNames,
+			const void* pNextFeatures = nullptr); // extension feature structures chained to VkDeviceCreateInfo
 		void DeInitialize();
 
 		// utilities functions
+		bool IsExtensionSupported(const char* extensionName) const;
+		bool IsExtensionEnabled(const char* extensionName) const;
 		void FindPresentQueueFamilyIndexes(uint32_t& graphicsIndex, uint32_t& presentIndex) const;
 		uint32_t FindQueueFamilyIndexByFlags(uint32_t queueFlags) const;
 		uint32_t FindMemoryHeapIndexByFlags(VkMemoryPropertyFlags propertyFlags) const;
 		uint32_t FindMemoryHeapIndexByBits(uint32_t bits, VkMemoryPropertyFlags propertyFlags) const;
 		uint32_t CheckMemoryHeapIndexByBits(uint32_t index, VkMemoryPropertyFlags propertyFlags) const;
 		VkSurfaceFormatKHR FindSurfaceFormat() const;
-		VkPresentModeKHR FindPresentMode() const;
+		VkPresentModeKHR FindPresentMode(VkPresentModeKHR desiredPresentMode) const;
+		VulkanMemoryArchitecture FindMemoryArchitecture() const;
+		VmaAllocationCreateInfo GetAllocationCreateInfo(VulkanMemoryAccess access) const;
 
 		// buffer functions
 		void CopyBuffers(VkDeviceSize size, VkBuffer srcBuffer, VkBuffer dstBuffer) const;
+		void CopyBuffers(VkDeviceSize size, VkBuffer srcBuffer, VkDeviceSize srcOffset, VkBuffer dstBuffer, VkDeviceSize dstOffset) const;
 		void CreateBuffer(VkDeviceSize size, VkBufferUsageFlags usage, VkBuffer& buffer, VmaAllocation& allocation);
 		void CreateBuffer(const void* data, VkDeviceSize size, VkBufferUsageFlags usage, VkBuffer& buffer, VmaAllocation& allocation);
+		void CreateBuffer(VkDeviceSize size, VkBufferUsageFlags usage, VulkanMemoryAccess access, VkBuffer& buffer, VmaAllocation& allocation);
+		void CreateBuffer(const void* data, VkDeviceSize size, VkBufferUsageFlags usage, VulkanMemoryAccess access, VkBuffer& buffer, VmaAllocation& allocation);
+		// host visible memory is written in place (persistent mapping if any), other memory through staging buffer
 		void WriteBuffer(const void* data, VkDeviceSize size, VkBuffer buffer, VmaAllocation& allocation);
+		void WriteBuffer(const void* data, VkDeviceSize offset, VkDeviceSize size, VkBuffer buffer, VmaAllocation& allocation);
+		// memory must be host visible (VULKAN_MEMORY_ACCESS_READBACK)
+		void ReadBuffer(void* data, VkDeviceSize size, VmaAllocation& allocation);
 
 		// image functions
-		void CopyImages(uint32_t width, uint32_t height, VkImage srcImage, VkImage dstImage) const;
+		void CopyBufferToImage(VkBuffer srcBuffer, VkImage dstImage, VkImageAspectFlags aspectMask, const std::vector<VkBufferImageCopy>& bufferImageCopies) const;
+		void TransitionImageLayout(VkImage image, VkImageAspectFlags aspectMask, VkImageLayout oldLayout, VkImageLayout newLayout) const;
 		void CreateImage(uint32_t width, uint32_t height, VkFormat format, VkImageUsageFlags usage, VkImage& image, VmaAllocation& allocation);
 		void CreateImage(const void* data, uint32_t width, uint32_t height, VkFormat format, VkImageUsageFlags usage, VkImage& image, VmaAllocation& allocation);
-		void WriteImage(const void* data, uint32_t width, uint32_t height, VkFormat format, VkImageUsageFlags usage, VkImage& image, VmaAllocation& allocation);
+		void CreateImage(uint32_t width, uint32_t height, uint32_t mipLevels, uint32_t arrayLayers, VkFormat format, VkImageUsageFlags usage, VkImageCreateFlags flags, VkImage& image, VmaAllocation& allocation);
+		void CreateImage(const void* data, uint32_t width, uint32_t height, uint32_t mipLevels, uint32_t arrayLayers, VkFormat format, VkImageUsageFlags usage, VkImageCreateFlags flags, VkImage& image, VmaAllocation& allocation);
+		// data is tightly packed: layer 0 mips 0..N, layer 1 mips 0..N, ... (cube faces are layers +X,-X,+Y,-Y,+Z,-Z)
+		void WriteImage(const void* data, uint32_t width, uint32_t height, uint32_t mipLevels, uint32_t arrayLayers, VkFormat format, VkImage image);
 
 		// misc functions
 		VkSemaphore CreateSemaphore();
+		VkFence CreateFence(VkFenceCreateFlags fenceCreateFlags);
 		VkSampler CreateSampler(VkFilter filter, VkSamplerAddressMode samplerAddressMode);
 		VkImageView CreateImageView(VkImage image, VkFormat format, VkImageAspectFlags aspectMask);
+		VkImageView CreateImageView(VkImage image, VkImageViewType viewType, VkFormat format, VkImageAspectFlags aspectMask, uint32_t mipLevels, uint32_t arrayLayers);
 		VkCommandBuffer AllocateCommandBuffer(VkCommandBufferLevel commandBufferLevel);
 		VkFramebuffer CreateFramebuffer(VkRenderPass renderPass, std::vector<VkImageView>& imageViews, uint32_t width, uint32_t height);
 	};
 
+	// VulkanDeletionQueue
+	// handles retired at frame N are destroyed when all frames before N completed
+	struct VulkanDeletionQueue
+	{
+	private:
+		// VulkanDeletionEntry
+		struct VulkanDeletionEntry
+		{
+			uint64_t              mFrameNumber;
+			std::function<void()> mDeleter;
+		};
+		std::deque<VulkanDeletionEntry> mEntries{};
+	public:
+		// Push (frameNumber - number of first frame that does not use retired handles)
+		void Push(uint64_t frameNumber, std::function<void()> deleter);
+		// Flush (completedFrameCount - frames [0, completedFrameCount) are finished on GPU)
+		void Flush(uint64_t completedFrameCount);
+		void FlushAll();
+	};
+
+	// VulkanRenderTargetInfo
+	// framebuffers frames are rendered to (swapchain images or offscreen images)
+	struct VulkanRenderTargetInfo
+	{
+	public:
+		// render pass (compatible with all framebuffers, kept on Recreate)
+		VkRenderPass mRenderPass = VK_NULL_HANDLE;
+
+		// current frame index
+		uint32_t mCurrentFramebufferIndex = UINT32_MAX;
+
+		// viewport size
+		uint32_t mViewportWidth = UINT32_MAX;
+		uint32_t mViewportHeight = UINT32_MAX;
+
+		virtual ~VulkanRenderTargetInfo() {}
+
+		// DeInit functions
+		virtual void DeInitialize() = 0;
+		// Recreate (size changed: retires old images and framebuffers through deletion queue)
+		virtual void Recreate(VulkanDeletionQueue& deletionQueue, uint64_t frameNumber) = 0;
+
+		// get functions
+		virtual uint32_t GetImageCount() const = 0;
+
+		// frame processing (BeginFrame signals semaphore when image is ready, EndFrame waits rendering semaphore),
+		// VK_ERROR_OUT_OF_DATE_KHR of BeginFrame - no image was acquired, target must be recreated and frame skipped,
+		// VK_SUBOPTIMAL_KHR or VK_ERROR_OUT_OF_DATE_KHR of EndFrame - frame was submitted, target should be recreated
+		virtual VkResult BeginFrame(VkSemaphore signalSemaphore, VkFramebuffer& framebuffer) = 0;
+		virtual VkResult EndFrame(VkSemaphore waitSemaphore) = 0;
+	};
+
 	// VulkanSwapchainInfo
-	struct VulkanSwapchainInfo
+	struct VulkanSwapchainInfo : public VulkanRenderTargetInfo
 	{
 	private:
 		// base handles
@@ -156,6 +293,7 @@ namespace VulkanHelpers
 		VkSurfaceFormatKHR mSurfaceFormat{};
 		VkFormat           mDepthStencilFormat = VK_FORMAT_D24_UNORM_S8_UINT;
 		VkPresentModeKHR   mPresentMode = VK_PRESENT_MODE_MAILBOX_KHR;
+		uint32_t           mImageCount = 0;
 
 		// framebuffer data
 		VkImage                    mImageDepthStencil = VK_NULL_HANDLE;
@@ -164,28 +302,123 @@ namespace VulkanHelpers
 		std::vector<VkImage>       mImageColors{};
 		std::vector<VkImageView>   mImageViewColors{};
 		std::vector<VkFramebuffer> mFramebuffers{};
+
+		// create functions
+		void CreateSwapchain(VkSwapchainKHR oldSwapchain);
+		void CreateRenderPass();
+		void CreateFramebuffers();
 	public:
 		// swapchain
 		VkSwapchainKHR mSwapchain = VK_NULL_HANDLE;
-		VkRenderPass   mRenderPass = VK_NULL_HANDLE;
 
-		// current frame index
-		uint32_t mCurrentFramebufferIndex = UINT32_MAX;
+		// desired parameters (set before Initialize or Recreate, clamped to surface capabilities)
+		uint32_t         mDesiredImageCount = 3;
+		VkPresentModeKHR mDesiredPresentMode = VK_PRESENT_MODE_MAILBOX_KHR;
 
-		// viewport size
-		uint32_t mViewportWidth = UINT32_MAX;
-		uint32_t mViewportHeight = UINT32_MAX;
+		// present ids (VK_KHR_present_id, id of first present of current swapchain for present waits)
+		bool     mPresentIdEnabled = false;
+		uint64_t mPresentId = 0;
+		uint64_t mFirstPresentId = 1;
 
 		// Init/DeInit functions
 		void Initialize(VulkanDeviceInfo& deviceInfo, VkSurfaceKHR surface);
-		void DeInitialize();
+		void DeInitialize() override;
 		void ReInitialize(VulkanDeviceInfo& deviceInfo, VkSurfaceKHR surface);
+		// Recreate (resize: keeps render pass, retires old swapchain, images and framebuffers through deletion queue,
+		// minimized surface without extent keeps old swapchain)
+		void Recreate(VulkanDeletionQueue& deletionQueue, uint64_t frameNumber) override;
+
+		// get functions
+		uint32_t GetImageCount() const override { return (uint32_t)mFramebuffers.size(); }
+		VkPresentModeKHR GetPresentMode() const { return mPresentMode; }
 
 		// frame processing
-		VkFramebuffer BeginFrame(VkSemaphore signalSemaphore);
-		void EndFrame(VkSemaphore waitSemaphore);
+		VkResult BeginFrame(VkSemaphore signalSemaphore, VkFramebuffer& framebuffer) override;
+		VkResult EndFrame(VkSemaphore waitSemaphore) override;
 	};
 
+	// fixed size vertex input of VulkanPipelineState
+	const uint32_t VULKAN_PIPELINE_MAX_VERTEX_BINDINGS = 2;
+	const uint32_t VULKAN_PIPELINE_MAX_VERTEX_ATTRIBUTES = 8;
+	// specialization constants of VulkanPipelineState (32-bit values)
+	const uint32_t VULKAN_PIPELINE_MAX_SPECIALIZATION_CONSTANTS = 8;
+
+	// VulkanPipelineState
+	// value type description of graphics pipeline (one color attachment, viewport, scissor and line width are dynamic),
+	// it has no padding, so it is hashed and compared bytewise and can be used as key of pipeline caches
+	struct VulkanPipelineState
+	{
+		// shaders, layout and render pass (not own)
+		VkShaderModule   mShaderModuleVS = VK_NULL_HANDLE;
+		VkShaderModule   mShaderModuleFS = VK_NULL_HANDLE;
+		VkPipelineLayout mPipelineLayout = VK_NULL_HANDLE;
+		VkRenderPass     mRenderPass = VK_NULL_HANDLE;
+		uint32_t         mSubpass = 0;
+
+		// vertex input (unused entries stay zero)
+		uint32_t                          mVertexBindingCount = 0;
+		VkVertexInputBindingDescription   mVertexBindings[VULKAN_PIPELINE_MAX_VERTEX_BINDINGS]{};
+		uint32_t                          mVertexAttributeCount = 0;
+		VkVertexInputAttributeDescription mVertexAttributes[VULKAN_PIPELINE_MAX_VERTEX_ATTRIBUTES]{};
+
+		// input assembly
+		VkPrimitiveTopology mTopology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;
+		VkBool32            mPrimitiveRestartEnable = VK_FALSE;
+
+		// rasterization
+		VkPolygonMode   mPolygonMode = VK_POLYGON_MODE_FILL;
+		VkCullModeFlags mCullMode = VK_CULL_MODE_NONE;
+		VkFrontFace     mFrontFace = VK_FRONT_FACE_CLOCKWISE;
+		VkBool32        mDepthBiasEnable = VK_FALSE;
+		float           mDepthBiasConstantFactor = 0.0f;
+		float           mDepthBiasSlopeFactor = 0.0f;
+
+		// multisample
+		VkSampleCountFlagBits mRasterizationSamples = VK_SAMPLE_COUNT_1_BIT;
+
+		// depth
+		VkBool32    mDepthTestEnable = VK_TRUE;
+		VkBool32    mDepthWriteEnable = VK_TRUE;
+		VkCompareOp mDepthCompareOp = VK_COMPARE_OP_LESS;
+		VkBool32    mDepthBoundsTestEnable = VK_TRUE;
+
+		// blend
+		VkPipelineColorBlendAttachmentState mBlendAttachment{
+			VK_FALSE,
+			VK_BLEND_FACTOR_ONE, VK_BLEND_FACTOR_ZERO, VK_BLEND_OP_ADD,
+			VK_BLEND_FACTOR_ONE, VK_BLEND_FACTOR_ZERO, VK_BLEND_OP_ADD,
+			VK_COLOR_COMPONENT_R_BIT | VK_COLOR_COMPONENT_G_BIT | VK_COLOR_COMPONENT_B_BIT | VK_COLOR_COMPONENT_A_BIT
+		};
+
+		// specialization constants (sorted by id, given to every stage of mSpecializationStages, ids a stage does not declare are ignored)
+		VkShaderStageFlags mSpecializationStages = VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT;
+		uint32_t           mSpecializationCount = 0;
+		uint32_t           mSpecializationIDs[VULKAN_PIPELINE_MAX_SPECIALIZATION_CONSTANTS]{};
+		uint32_t           mSpecializationValues[VULKAN_PIPELINE_MAX_SPECIALIZATION_CONSTANTS]{};
+
+		// set functions
+		void SetVertexInput(const std::vector<VkVertexInputBindingDescription>& bindings, const std::vector<VkVertexInputAttributeDescription>& attributes);
+		void SetAlphaBlend();
+		// SetSpecializationConstant (bool constants are VkBool32, float ones are stored bitwise)
+		void SetSpecializationConstant(uint32_t constantID, uint32_t value);
+		void SetSpecializationConstant(uint32_t constantID, float value);
+		void ClearSpecializationConstants();
+
+		// key functions (FNV-1a of all bytes)
+		uint64_t GetHash() const;
+		bool operator==(const VulkanPipelineState& other) const;
+		bool operator!=(const VulkanPipelineState& other) const { return !(*this == other); }
+	};
+
+	// VulkanPipelineStateHasher (for unordered containers)
+	struct VulkanPipelineStateHasher
+	{
+		size_t operator()(const VulkanPipelineState& pipelineState) const { return (size_t)pipelineState.GetHash(); }
+	};
+
+	// CreateGraphicsPipeline (pipelineCache can be VK_NULL_HANDLE, safe to call from any thread with own or internally synchronized cache)
+	VkPipeline CreateGraphicsPipeline(VkDevice device, VkPipelineCache pipelineCache, const VulkanPipelineState& pipelineState);
+
 	// VulkanPipelineInfo
 	class VulkanPipelineInfo
 	{
@@ -198,9 +431,10 @@ namespace VulkanHelpers
 		std::vector<VkVertexInputAttributeDescription> mVertexAttributeDescriptions{};
 		std::vector<VkDescriptorSetLayoutBinding>      mDescriptorSetLayoutBindings{};
 
-		// shaders
+		// shaders (own when created from files)
 		VkShaderModule mShaderModuleVS = VK_NULL_HANDLE;
 		VkShaderModule mShaderModuleFS = VK_NULL_HANDLE;
+		bool           mOwnShaderModules = false;
 
 		// MUST fill mVertexBindingDescriptions and mVertexAttributeDescriptions
 		virtual void InitVertexInputDescriptions();
@@ -215,25 +449,83 @@ namespace VulkanHelpers
 		VkDescriptorPool      mDescriptorPool = VK_NULL_HANDLE;
 		VkDescriptorSet       mDescriptorSet = VK_NULL_HANDLE;
 
+		// state of mPipeline (fixed function part can be changed before Initialize, handles and vertex input are filled by it),
+		// base of derived states created by VulkanPipelineStateCacheInfo
+		VulkanPipelineState mPipelineState{};
+
 		// Init/DeInit functions
 		void Initialize(
 			VulkanDeviceInfo& deviceInfo,
 			VkRenderPass renderPass,
 			const char* pathVS, const char* pathFS);
+		// Initialize with existing shader modules (not own, must live until DeInitialize)
+		void Initialize(
+			VulkanDeviceInfo& deviceInfo,
+			VkRenderPass renderPass,
+			VkShaderModule shaderModuleVS, VkShaderModule shaderModuleFS);
 		void DeInitialize();
 
+		// get functions (bindings of mDescriptorSetLayout, for VulkanDescriptorCacheInfo::RegisterLayout)
+		const std::vector<VkDescriptorSetLayoutBinding>& GetDescriptorSetLayoutBindings() const { return mDescriptorSetLayoutBindings; }
+
 		// bind functions
 		void BindImageView(uint32_t binding, VkImageView imageView, VkSampler sampler);
 		void BindUnifromBuffer(uint32_t binding, VkBuffer buffer);
+		void BindUnifromBufferDynamic(uint32_t binding, VkBuffer buffer, VkDeviceSize range);
 	};
 
 	// InitDeviceQueueCreateInfo
 	VkDeviceQueueCreateInfo InitDeviceQueueCreateInfo(uint32_t queueIndex);
 
+	// InitBufferCreateInfo (same parameters VulkanDeviceInfo::CreateBuffer uses)
+	VkBufferCreateInfo InitBufferCreateInfo(VkDeviceSize size, VkBufferUsageFlags usage);
+
+	// InitImageCreateInfo (same parameters VulkanDeviceInfo::CreateImage uses)
+	VkImageCreateInfo InitImageCreateInfo(uint32_t width, uint32_t height, uint32_t mipLevels, uint32_t arrayLayers, VkFormat format, VkImageUsageFlags usage, VkImageCreateFlags flags);
+
+	// GetFormatBlockInfo (block size in bytes, block extent in texels)
+	void GetFormatBlockInfo(VkFormat format, uint32_t& blockSize, uint32_t& blockWidth, uint32_t& blockHeight);
+
+	// GetImageDataSize (size of tightly packed data VulkanDeviceInfo::WriteImage expects)
+	VkDeviceSize GetImageDataSize(uint32_t width, uint32_t height, uint32_t mipLevels, uint32_t arrayLayers, VkFormat format);
+
+	// GetMipLevelsCount (full mip chain down to 1x1)
+	uint32_t GetMipLevelsCount(uint32_t width, uint32_t height);
+
+	// seed of first HashBytes call (FNV-1a offset basis)
+	const uint64_t VULKAN_HASH_SEED = 14695981039346656037ull;
+
+	// HashBytes (FNV-1a, hash of previous range is seed of next one when key has several ranges)
+	uint64_t HashBytes(const void* data, size_t size, uint64_t seed = VULKAN_HASH_SEED);
+
+#ifdef _WIN32
 	// CreateSurface
 	VkSurfaceKHR CreateSurface(VkInstance instance, HWND hWnd);
+#endif
+
+	// VulkanMappedFile
+	// read only memory mapping of whole file (page aligned, so SPIR-V can be passed to driver without copy)
+	struct VulkanMappedFile
+	{
+	private:
+		// platform handles
+		void* mFileHandle = nullptr;
+		void* mMappingHandle = nullptr;
+		int   mFileDescriptor = -1;
+	public:
+		// mapped data (valid until Close)
+		const uint8_t* mData = nullptr;
+		size_t         mSize = 0;
+
+		// Open/Close functions (false - file does not exist, can not be mapped or is empty)
+		bool Open(const char* fileName);
+		void Close();
+	};
+
+	// CreateShaderModule (code must be 4 bytes aligned, size in bytes)
+	VkShaderModule CreateShaderModule(VkDevice device, const uint32_t* code, size_t size);
 
-	// CreateShaderModuleFromFile
+	// CreateShaderModuleFromFile (file is memory mapped)
 	VkShaderModule CreateShaderModuleFromFile(VkDevice device, const char* fileName);
 
 	// QueueSubmit
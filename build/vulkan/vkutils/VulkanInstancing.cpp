@@ -0,0 +1,140 @@
+#include "VulkanInstancing.hpp"
+#include <cassert>
+#include <cstring>
+#include <cstddef>
+#include <algorithm>
+
+// VulkanHelpers
+namespace VulkanHelpers {
+	//////////////////////////////////////////////////////////////////////////
+	// VulkanInstanceData
+	//////////////////////////////////////////////////////////////////////////
+
+	// SetTransform
+	void VulkanInstanceData::SetTransform(const DirectX::XMMATRIX& matrix)
+	{
+		// rows of transposed matrix are columns of row vector matrix, last one is (0, 0, 0, 1)
+		DirectX::XMFLOAT4X4 transposed{};
+		DirectX::XMStoreFloat4x4(&transposed, DirectX::XMMatrixTranspose(matrix));
+		memcpy(mTransform, transposed.m, sizeof(mTransform));
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+	// VulkanInstanceRingInfo
+	//////////////////////////////////////////////////////////////////////////
+
+	// Initialize
+	void VulkanInstanceRingInfo::Initialize(VulkanDeviceInfo& deviceInfo, uint32_t maxInstanceCount, uint32_t slotCount)
+	{
+		// store parameters
+		mDeviceInfo = &deviceInfo;
+		assert(mDeviceInfo->mDevice);
+		assert(maxInstanceCount > 0);
+		assert(slotCount > 0);
+		mMaxInstanceCount = maxInstanceCount;
+		mSlotCount = slotCount;
+		mSlot = 0;
+
+		// persistently mapped buffer (rewritten every frame, read once by vertex fetch)
+		mDeviceInfo->CreateBuffer(GetSlotOffset(mSlotCount), VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, VULKAN_MEMORY_ACCESS_DYNAMIC, mBuffer, mMemory);
+		assert(mBuffer);
+	}
+
+	// DeInitialize
+	void VulkanInstanceRingInfo::DeInitialize()
+	{
+		if (mBuffer)
+			vmaDestroyBuffer(mDeviceInfo->mAllocator, mBuffer, mMemory);
+		mBuffer = VK_NULL_HANDLE;
+		mMemory = VK_NULL_HANDLE;
+		mGroupIndices.clear();
+		mGroups.clear();
+		mBatches.clear();
+	}
+
+	// Begin
+	void VulkanInstanceRingInfo::Begin(uint32_t slot)
+	{
+		assert(slot < mSlotCount);
+		mSlot = slot;
+		for (auto& group : mGroups)
+			group.mInstances.clear();
+		mBatches.clear();
+	}
+
+	// Add
+	void VulkanInstanceRingInfo::Add(const VulkanInstanceBatchKey& key, const VulkanInstanceData& instance)
+	{
+		// find group (new keys get new group)
+		auto it = mGroupIndices.find(key);
+		if (it == mGroupIndices.end()) {
+			it = mGroupIndices.emplace(key, (uint32_t)mGroups.size()).first;
+			mGroups.push_back({ key, {} });
+		}
+		mGroups[it->second].mInstances.push_back(instance);
+	}
+
+	// Add (model)
+	void VulkanInstanceRingInfo::Add(const VulkanModelObj& model, uint64_t material, const float params[4])
+	{
+		// VulkanInstanceData
+		VulkanInstanceData instance{};
+		instance.SetTransform(model.mModelMatrix);
+		memcpy(instance.mParams, params, sizeof(instance.mParams));
+
+		// one instance per mesh
+		for (const auto mesh : model.mMeshes) {
+			VulkanInstanceBatchKey key{};
+			key.mMesh = (uint64_t)(uintptr_t)mesh;
+			key.mMaterial = material;
+			Add(key, instance);
+		}
+	}
+
+	// End
+	void VulkanInstanceRingInfo::End()
+	{
+		// groups are written one after another (few large writes to mapped memory)
+		uint32_t instanceCount = 0;
+		for (const auto& group : mGroups) {
+			uint32_t groupCount = std::min((uint32_t)group.mInstances.size(), mMaxInstanceCount - instanceCount);
+			if (groupCount == 0)
+				continue;
+
+			// write instances
+			VkDeviceSize offset = GetSlotOffset(mSlot) + (VkDeviceSize)instanceCount * sizeof(VulkanInstanceData);
+			mDeviceInfo->WriteBuffer(group.mInstances.data(), offset, groupCount * sizeof(VulkanInstanceData), mBuffer, mMemory);
+
+			// VulkanInstanceBatch
+			VulkanInstanceBatch batch{};
+			batch.mKey = group.mKey;
+			batch.mFirstInstance = instanceCount;
+			batch.mInstanceCount = groupCount;
+			mBatches.push_back(batch);
+			instanceCount += groupCount;
+		}
+	}
+
+	// Bind
+	void VulkanInstanceRingInfo::Bind(VkCommandBuffer commandBuffer, uint32_t binding) const
+	{
+		VkDeviceSize offset = GetSlotOffset(mSlot);
+		vkCmdBindVertexBuffers(commandBuffer, binding, 1, &mBuffer, &offset);
+	}
+
+	// GetVertexInputDescriptions
+	void VulkanInstanceRingInfo::GetVertexInputDescriptions(uint32_t binding, uint32_t firstLocation,
+		VkVertexInputBindingDescription& bindingDescription, std::vector<VkVertexInputAttributeDescription>& attributeDescriptions)
+	{
+		// VkVertexInputBindingDescription
+		bindingDescription.binding = binding;
+		bindingDescription.stride = sizeof(VulkanInstanceData);
+		bindingDescription.inputRate = VK_VERTEX_INPUT_RATE_INSTANCE;
+
+		// VkVertexInputAttributeDescription
+		attributeDescriptions.push_back({ firstLocation + 0, binding, VK_FORMAT_R32G32B32A32_SFLOAT, offsetof(VulkanInstanceData, mTransform) + 0 });  // transform row 0
+		attributeDescriptions.push_back({ firstLocation + 1, binding, VK_FORMAT_R32G32B32A32_SFLOAT, offsetof(VulkanInstanceData, mTransform) + 16 }); // transform row 1
+		attributeDescriptions.push_back({ firstLocation + 2, binding, VK_FORMAT_R32G32B32A32_SFLOAT, offsetof(VulkanInstanceData, mTransform) + 32 }); // transform row 2
+		attributeDescriptions.push_back({ firstLocation + 3, binding, VK_FORMAT_R32G32B32A32_SFLOAT, offsetof(VulkanInstanceData, mParams) });         // params
+	}
+}
@@ -0,0 +1,99 @@
+#pragma once
+
+#include "VulkanHelpers.hpp"
+#include "vkmesh.hpp"
+#include <unordered_map>
+
+// VulkanHelpers
+namespace VulkanHelpers
+{
+	// VulkanInstanceData
+	// per instance vertex data (VK_VERTEX_INPUT_RATE_INSTANCE), 3 rows of transposed world matrix (affine, last row is implicit)
+	// and free parameters (color, texture slot, ...)
+	struct VulkanInstanceData
+	{
+		float mTransform[3][4];
+		float mParams[4];
+
+		// SetTransform (DirectXMath row vector matrix, shader computes dot(mTransform[i], position))
+		void SetTransform(const DirectX::XMMATRIX& matrix);
+	};
+
+	// VulkanInstanceBatchKey (mesh and material, any unique values, e.g. handles or pointers)
+	struct VulkanInstanceBatchKey
+	{
+		uint64_t mMesh = 0;
+		uint64_t mMaterial = 0;
+
+		bool operator==(const VulkanInstanceBatchKey& other) const { return (mMesh == other.mMesh) && (mMaterial == other.mMaterial); }
+	};
+
+	// VulkanInstanceBatchKeyHasher
+	struct VulkanInstanceBatchKeyHasher
+	{
+		size_t operator()(const VulkanInstanceBatchKey& key) const { return (size_t)(key.mMesh * 1099511628211ull ^ key.mMaterial); }
+	};
+
+	// VulkanInstanceBatch (instances [mFirstInstance, mFirstInstance + mInstanceCount) of ring slot, one vkCmdDrawIndexed)
+	struct VulkanInstanceBatch
+	{
+		VulkanInstanceBatchKey mKey{};
+		uint32_t               mFirstInstance = 0;
+		uint32_t               mInstanceCount = 0;
+	};
+
+	// VulkanInstanceRingInfo
+	// instances added during frame are grouped by mesh and material, End writes each group contiguously
+	// into ring slot of persistently mapped buffer, bound as per instance vertex buffer
+	struct VulkanInstanceRingInfo
+	{
+	private:
+		// base handles
+		VulkanDeviceInfo* mDeviceInfo = nullptr;
+
+		// groups of current frame (kept between frames, so their storage is reused)
+		struct VulkanInstanceGroup
+		{
+			VulkanInstanceBatchKey          mKey{};
+			std::vector<VulkanInstanceData> mInstances{};
+		};
+		std::unordered_map<VulkanInstanceBatchKey, uint32_t, VulkanInstanceBatchKeyHasher> mGroupIndices{};
+		std::vector<VulkanInstanceGroup> mGroups{};
+
+		// ring
+		uint32_t mMaxInstanceCount = 0; // per slot
+		uint32_t mSlotCount = 0;
+		uint32_t mSlot = 0;
+	public:
+		// buffer (own)
+		VkBuffer      mBuffer = VK_NULL_HANDLE;
+		VmaAllocation mMemory = VK_NULL_HANDLE;
+
+		// batches written by last End
+		std::vector<VulkanInstanceBatch> mBatches{};
+
+		// Init/DeInit functions (slotCount - frames in flight or cached command buffers, maxInstanceCount - per slot)
+		void Initialize(VulkanDeviceInfo& deviceInfo, uint32_t maxInstanceCount, uint32_t slotCount);
+		void DeInitialize();
+
+		// Begin (slot is not read by GPU anymore)
+		void Begin(uint32_t slot);
+		// Add instance (grouped with other instances of same key)
+		void Add(const VulkanInstanceBatchKey& key, const VulkanInstanceData& instance);
+		// Add instances of model meshes (mModelMatrix is transform of each)
+		void Add(const VulkanModelObj& model, uint64_t material, const float params[4]);
+		// End (writes groups, fills mBatches, instances over mMaxInstanceCount are dropped)
+		void End();
+
+		// Bind (per instance vertex buffer at offset of current slot)
+		void Bind(VkCommandBuffer commandBuffer, uint32_t binding) const;
+
+		// get functions
+		VkDeviceSize GetSlotOffset(uint32_t slot) const { return (VkDeviceSize)slot * mMaxInstanceCount * sizeof(VulkanInstanceData); }
+		uint32_t GetMaxInstanceCount() const { return mMaxInstanceCount; }
+
+		// GetVertexInputDescriptions (binding description and mat3x4 rows plus params at locations [firstLocation, firstLocation + 4))
+		static void GetVertexInputDescriptions(uint32_t binding, uint32_t firstLocation,
+			VkVertexInputBindingDescription& bindingDescription, std::vector<VkVertexInputAttributeDescription>& attributeDescriptions);
+	};
+}
@@ -0,0 +1,346 @@
+#include "VulkanOffscreen.hpp"
+#include <cassert>
+#include <array>
+
+// VulkanHelpers
+namespace VulkanHelpers {
+	//////////////////////////////////////////////////////////////////////////
+	// VulkanOffscreenInfo
+	//////////////////////////////////////////////////////////////////////////
+
+	// Initialize
+	void VulkanOffscreenInfo::Initialize(VulkanDeviceInfo& deviceInfo, uint32_t width, uint32_t height, uint32_t imageCount, bool readbackEnabled)
+	{
+		// store parameters
+		mDeviceInfo = &deviceInfo;
+		mDesiredWidth = width;
+		mDesiredHeight = height;
+		mImageCount = imageCount;
+		mReadbackEnabled = readbackEnabled;
+		assert(mDeviceInfo->mDevice);
+		assert(width && height);
+		assert(imageCount);
+
+		// depth format supported by device (software rasterizers may lack D24S8)
+		mDepthStencilFormat = FindDepthStencilFormat();
+
+		// VkCommandPoolCreateInfo (readback command buffers are recorded once per image)
+		VkCommandPoolCreateInfo commandPoolCreateInfo{};
+		commandPoolCreateInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+		commandPoolCreateInfo.pNext = VK_NULL_HANDLE;
+		commandPoolCreateInfo.flags = 0;
+		commandPoolCreateInfo.queueFamilyIndex = mDeviceInfo->mQueueFamilyIndexGraphics;
+		VK_CHECK(vkCreateCommandPool(mDeviceInfo->mDevice, &commandPoolCreateInfo, VK_NULL_HANDLE, &mCommandPool));
+		assert(mCommandPool);
+
+		// create render pass and images
+		CreateRenderPass();
+		CreateImages();
+	}
+
+	// DeInitialize
+	void VulkanOffscreenInfo::DeInitialize()
+	{
+		// destroy images
+		DestroyImages(mImages, mImageDepthStencil, mImageViewDepthStencil, mImageDepthStencilAllocation);
+		mImages.clear();
+		mImageDepthStencil = VK_NULL_HANDLE;
+		mImageViewDepthStencil = VK_NULL_HANDLE;
+		mImageDepthStencilAllocation = VK_NULL_HANDLE;
+
+		// destroy render pass and command pool
+		vkDestroyRenderPass(mDeviceInfo->mDevice, mRenderPass, VK_NULL_HANDLE);
+		mRenderPass = VK_NULL_HANDLE;
+		vkDestroyCommandPool(mDeviceInfo->mDevice, mCommandPool, VK_NULL_HANDLE);
+		mCommandPool = VK_NULL_HANDLE;
+	}
+
+	// Recreate
+	void VulkanOffscreenInfo::Recreate(VulkanDeletionQueue& deletionQueue, uint64_t frameNumber)
+	{
+		// retire images, frames in flight can still use them
+		std::vector<VulkanOffscreenImage> oldImages = mImages;
+		VkImage oldImageDepthStencil = mImageDepthStencil;
+		VkImageView oldImageViewDepthStencil = mImageViewDepthStencil;
+		VmaAllocation oldImageDepthStencilAllocation = mImageDepthStencilAllocation;
+		deletionQueue.Push(frameNumber, [=]() mutable {
+			DestroyImages(oldImages, oldImageDepthStencil, oldImageViewDepthStencil, oldImageDepthStencilAllocation);
+		});
+
+		// create new images (render pass is kept)
+		CreateImages();
+	}
+
+	// FindDepthStencilFormat
+	VkFormat VulkanOffscreenInfo::FindDepthStencilFormat() const
+	{
+		// try formats in order of preference
+		std::array<VkFormat, 3> depthStencilFormats = { VK_FORMAT_D24_UNORM_S8_UINT, VK_FORMAT_D32_SFLOAT_S8_UINT, VK_FORMAT_D16_UNORM_S8_UINT };
+		for (const auto& depthStencilFormat : depthStencilFormats)
+		{
+			VkFormatProperties formatProperties{};
+			vkGetPhysicalDeviceFormatProperties(mDeviceInfo->mPhysicalDevice, depthStencilFormat, &formatProperties);
+			if (formatProperties.optimalTilingFeatures & VK_FORMAT_FEATURE_DEPTH_STENCIL_ATTACHMENT_BIT)
+				return depthStencilFormat;
+		}
+
+		// return default
+		return VK_FORMAT_D24_UNORM_S8_UINT;
+	}
+
+	// CreateRenderPass
+	void VulkanOffscreenInfo::CreateRenderPass()
+	{
+		// VkAttachmentDescription - color
+		std::array<VkAttachmentDescription, 2> attachmentDescriptions;
+		// color attachment (left ready for readback copy)
+		attachmentDescriptions[0].flags = 0;
+		attachmentDescriptions[0].format = mColorFormat;
+		attachmentDescriptions[0].samples = VK_SAMPLE_COUNT_1_BIT;
+		attachmentDescriptions[0].loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
+		attachmentDescriptions[0].storeOp = VK_ATTACHMENT_STORE_OP_STORE;
+		attachmentDescriptions[0].stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+		attachmentDescriptions[0].stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+		attachmentDescriptions[0].initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+		attachmentDescriptions[0].finalLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+		// depth-stencil attachment
+		attachmentDescriptions[1].flags = 0;
+		attachmentDescriptions[1].format = mDepthStencilFormat;
+		attachmentDescriptions[1].samples = VK_SAMPLE_COUNT_1_BIT;
+		attachmentDescriptions[1].loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
+		attachmentDescriptions[1].storeOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+		attachmentDescriptions[1].stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+		attachmentDescriptions[1].stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+		attachmentDescriptions[1].initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+		attachmentDescriptions[1].finalLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
+
+		// VkAttachmentReference - color
+		std::array<VkAttachmentReference, 1> colorAttachmentReferences;
+		colorAttachmentReferences[0].attachment = 0;
+		colorAttachmentReferences[0].layout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+
+		// VkAttachmentReference - depth-stencil
+		VkAttachmentReference depthStencilAttachmentReference{};
+		depthStencilAttachmentReference.attachment = 1;
+		depthStencilAttachmentReference.layout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
+
+		// VkSubpassDescription - subpassDescriptions
+		std::array<VkSubpassDescription, 1> subpassDescriptions;
+		subpassDescriptions[0].flags = 0;
+		subpassDescriptions[0].pipelineBindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS;
+		subpassDescriptions[0].inputAttachmentCount = 0;
+		subpassDescriptions[0].pInputAttachments = VK_NULL_HANDLE;
+		subpassDescriptions[0].colorAttachmentCount = (uint32_t)colorAttachmentReferences.size();
+		subpassDescriptions[0].pColorAttachments = colorAttachmentReferences.data();
+		subpassDescriptions[0].pResolveAttachments = VK_NULL_HANDLE;
+		subpassDescriptions[0].pDepthStencilAttachment = &depthStencilAttachmentReference;
+		subpassDescriptions[0].preserveAttachmentCount = 0;
+		subpassDescriptions[0].pPreserveAttachments = VK_NULL_HANDLE;
+
+		// VkSubpassDependency (color writes are visible to readback copy)
+		VkSubpassDependency subpassDependency{};
+		subpassDependency.srcSubpass = 0;
+		subpassDependency.dstSubpass = VK_SUBPASS_EXTERNAL;
+		subpassDependency.srcStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+		subpassDependency.dstStageMask = VK_PIPELINE_STAGE_TRANSFER_BIT;
+		subpassDependency.srcAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+		subpassDependency.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+		subpassDependency.dependencyFlags = 0;
+
+		// VkRenderPassCreateInfo
+		VkRenderPassCreateInfo renderPassCreateInfo{};
+		renderPassCreateInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO;
+		renderPassCreateInfo.attachmentCount = (uint32_t)attachmentDescriptions.size();
+		renderPassCreateInfo.pAttachments = attachmentDescriptions.data();
+		renderPassCreateInfo.subpassCount = (uint32_t)subpassDescriptions.size();
+		renderPassCreateInfo.pSubpasses = subpassDescriptions.data();
+		renderPassCreateInfo.dependencyCount = 1;
+		renderPassCreateInfo.pDependencies = &subpassDependency;
+
+		// vkCreateRenderPass
+		VK_CHECK(vkCreateRenderPass(mDeviceInfo->mDevice, &renderPassCreateInfo, VK_NULL_HANDLE, &mRenderPass));
+		assert(mRenderPass);
+	}
+
+	// CreateImages
+	void VulkanOffscreenInfo::CreateImages()
+	{
+		// size
+		mViewportWidth = mDesiredWidth;
+		mViewportHeight = mDesiredHeight;
+		mNextImageIndex = 0;
+
+		// depth stencil image
+		mDeviceInfo->CreateImage(mViewportWidth, mViewportHeight, mDepthStencilFormat, VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT, mImageDepthStencil, mImageDepthStencilAllocation);
+		assert(mImageDepthStencil);
+		mImageViewDepthStencil = mDeviceInfo->CreateImageView(mImageDepthStencil, mDepthStencilFormat, VK_IMAGE_ASPECT_DEPTH_BIT | VK_IMAGE_ASPECT_STENCIL_BIT);
+		assert(mImageViewDepthStencil);
+
+		// VkCommandBufferAllocateInfo
+		std::vector<VkCommandBuffer> commandBuffers(mImageCount, VK_NULL_HANDLE);
+		if (mReadbackEnabled)
+		{
+			VkCommandBufferAllocateInfo commandBufferAllocateInfo{};
+			commandBufferAllocateInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+			commandBufferAllocateInfo.pNext = VK_NULL_HANDLE;
+			commandBufferAllocateInfo.commandPool = mCommandPool;
+			commandBufferAllocateInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+			commandBufferAllocateInfo.commandBufferCount = mImageCount;
+			VK_CHECK(vkAllocateCommandBuffers(mDeviceInfo->mDevice, &commandBufferAllocateInfo, commandBuffers.data()));
+		}
+
+		// color images
+		mImages.resize(mImageCount);
+		for (uint32_t i = 0; i < mImageCount; i++)
+		{
+			VulkanOffscreenImage& image = mImages[i];
+			image = VulkanOffscreenImage();
+
+			// color image and framebuffer
+			mDeviceInfo->CreateImage(mViewportWidth, mViewportHeight, mColorFormat, VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT, image.mImageColor, image.mImageColorAllocation);
+			assert(image.mImageColor);
+			image.mImageViewColor = mDeviceInfo->CreateImageView(image.mImageColor, mColorFormat, VK_IMAGE_ASPECT_COLOR_BIT);
+			assert(image.mImageViewColor);
+			std::vector<VkImageView> imageViews = { image.mImageViewColor, mImageViewDepthStencil };
+			image.mFramebuffer = mDeviceInfo->CreateFramebuffer(mRenderPass, imageViews, mViewportWidth, mViewportHeight);
+			assert(image.mFramebuffer);
+
+			// EndFrame submit fence
+			image.mFence = mDeviceInfo->CreateFence(0);
+			assert(image.mFence);
+
+			// readback
+			if (!mReadbackEnabled)
+				continue;
+			VkDeviceSize readbackSize = (VkDeviceSize)mViewportWidth * mViewportHeight * 4;
+			mDeviceInfo->CreateBuffer(readbackSize, VK_BUFFER_USAGE_TRANSFER_DST_BIT, VULKAN_MEMORY_ACCESS_READBACK, image.mReadbackBuffer, image.mReadbackAllocation);
+			assert(image.mReadbackBuffer);
+			image.mCommandBuffer = commandBuffers[i];
+
+			// VkCommandBufferBeginInfo
+			VkCommandBufferBeginInfo commandBufferBeginInfo{};
+			commandBufferBeginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+			commandBufferBeginInfo.pNext = VK_NULL_HANDLE;
+			commandBufferBeginInfo.flags = 0;
+			commandBufferBeginInfo.pInheritanceInfo = nullptr;
+			VK_CHECK(vkBeginCommandBuffer(image.mCommandBuffer, &commandBufferBeginInfo));
+
+			// VkBufferImageCopy (image is in TRANSFER_SRC_OPTIMAL after render pass)
+			VkBufferImageCopy bufferImageCopy{};
+			bufferImageCopy.bufferOffset = 0;
+			bufferImageCopy.bufferRowLength = 0;
+			bufferImageCopy.bufferImageHeight = 0;
+			bufferImageCopy.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+			bufferImageCopy.imageSubresource.mipLevel = 0;
+			bufferImageCopy.imageSubresource.baseArrayLayer = 0;
+			bufferImageCopy.imageSubresource.layerCount = 1;
+			bufferImageCopy.imageOffset = { 0, 0, 0 };
+			bufferImageCopy.imageExtent = { mViewportWidth, mViewportHeight, 1 };
+			vkCmdCopyImageToBuffer(image.mCommandBuffer, image.mImageColor, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, image.mReadbackBuffer, 1, &bufferImageCopy);
+
+			// VkBufferMemoryBarrier (copy is visible to host after fence)
+			VkBufferMemoryBarrier bufferMemoryBarrier{};
+			bufferMemoryBarrier.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+			bufferMemoryBarrier.pNext = VK_NULL_HANDLE;
+			bufferMemoryBarrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+			bufferMemoryBarrier.dstAccessMask = VK_ACCESS_HOST_READ_BIT;
+			bufferMemoryBarrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+			bufferMemoryBarrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+			bufferMemoryBarrier.buffer = image.mReadbackBuffer;
+			bufferMemoryBarrier.offset = 0;
+			bufferMemoryBarrier.size = VK_WHOLE_SIZE;
+			vkCmdPipelineBarrier(image.mCommandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_HOST_BIT, 0, 0, nullptr, 1, &bufferMemoryBarrier, 0, nullptr);
+
+			// vkEndCommandBuffer
+			VK_CHECK(vkEndCommandBuffer(image.mCommandBuffer));
+		}
+	}
+
+	// DestroyImages
+	void VulkanOffscreenInfo::DestroyImages(std::vector<VulkanOffscreenImage>& images, VkImage imageDepthStencil, VkImageView imageViewDepthStencil, VmaAllocation imageDepthStencilAllocation)
+	{
+		for (auto& image : images)
+		{
+			// EndFrame submits are not covered by frame fences
+			if (image.mSubmitted)
+				VK_CHECK(vkWaitForFences(mDeviceInfo->mDevice, 1, &image.mFence, VK_TRUE, UINT64_MAX));
+			vkDestroyFence(mDeviceInfo->mDevice, image.mFence, VK_NULL_HANDLE);
+			if (image.mCommandBuffer)
+				vkFreeCommandBuffers(mDeviceInfo->mDevice, mCommandPool, 1, &image.mCommandBuffer);
+			if (image.mReadbackBuffer)
+				vmaDestroyBuffer(mDeviceInfo->mAllocator, image.mReadbackBuffer, image.mReadbackAllocation);
+			vkDestroyFramebuffer(mDeviceInfo->mDevice, image.mFramebuffer, VK_NULL_HANDLE);
+			vkDestroyImageView(mDeviceInfo->mDevice, image.mImageViewColor, VK_NULL_HANDLE);
+			vmaDestroyImage(mDeviceInfo->mAllocator, image.mImageColor, image.mImageColorAllocation);
+		}
+		vkDestroyImageView(mDeviceInfo->mDevice, imageViewDepthStencil, VK_NULL_HANDLE);
+		vmaDestroyImage(mDeviceInfo->mAllocator, imageDepthStencil, imageDepthStencilAllocation);
+	}
+
+	// BeginFrame
+	VkResult VulkanOffscreenInfo::BeginFrame(VkSemaphore signalSemaphore, VkFramebuffer& framebuffer)
+	{
+		// images are used round robin (like FIFO swapchain)
+		mCurrentFramebufferIndex = mNextImageIndex;
+		mNextImageIndex = (mNextImageIndex + 1) % (uint32_t)mImages.size();
+		VulkanOffscreenImage& image = mImages[mCurrentFramebufferIndex];
+
+		// readback of previous frame rendered to this image must be finished
+		if (image.mSubmitted)
+		{
+			VK_CHECK(vkWaitForFences(mDeviceInfo->mDevice, 1, &image.mFence, VK_TRUE, UINT64_MAX));
+			VK_CHECK(vkResetFences(mDeviceInfo->mDevice, 1, &image.mFence));
+			image.mSubmitted = false;
+		}
+
+		// VkSubmitInfo (image is available at once, empty submit only signals semaphore)
+		VkSubmitInfo submitInfo{};
+		submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+		submitInfo.pNext = VK_NULL_HANDLE;
+		submitInfo.waitSemaphoreCount = 0;
+		submitInfo.commandBufferCount = 0;
+		submitInfo.signalSemaphoreCount = 1;
+		submitInfo.pSignalSemaphores = &signalSemaphore;
+		VK_CHECK(vkQueueSubmit(mDeviceInfo->mQueueGraphics, 1, &submitInfo, VK_NULL_HANDLE));
+		framebuffer = image.mFramebuffer;
+		return VK_SUCCESS;
+	}
+
+	// EndFrame
+	VkResult VulkanOffscreenInfo::EndFrame(VkSemaphore waitSemaphore)
+	{
+		VulkanOffscreenImage& image = mImages[mCurrentFramebufferIndex];
+
+		// VkSubmitInfo (waits rendering, copies image to readback buffer if enabled)
+		VkPipelineStageFlags waitStageMask = VK_PIPELINE_STAGE_TRANSFER_BIT;
+		VkSubmitInfo submitInfo{};
+		submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+		submitInfo.pNext = VK_NULL_HANDLE;
+		submitInfo.waitSemaphoreCount = 1;
+		submitInfo.pWaitSemaphores = &waitSemaphore;
+		submitInfo.pWaitDstStageMask = &waitStageMask;
+		submitInfo.commandBufferCount = image.mCommandBuffer ? 1 : 0;
+		submitInfo.pCommandBuffers = &image.mCommandBuffer;
+		submitInfo.signalSemaphoreCount = 0;
+		VK_CHECK(vkQueueSubmit(mDeviceInfo->mQueueGraphics, 1, &submitInfo, image.mFence));
+		image.mSubmitted = true;
+		return VK_SUCCESS;
+	}
+
+	// ReadImage
+	bool VulkanOffscreenInfo::ReadImage(uint32_t imageIndex, std::vector<uint8_t>& pixels)
+	{
+		assert(imageIndex < mImages.size());
+		VulkanOffscreenImage& image = mImages[imageIndex];
+		if (!mReadbackEnabled || !image.mSubmitted)
+			return false;
+
+		// wait readback copy
+		VK_CHECK(vkWaitForFences(mDeviceInfo->mDevice, 1, &image.mFence, VK_TRUE, UINT64_MAX));
+
+		// copy pixels
+		pixels.resize((size_t)mViewportWidth * mViewportHeight * 4);
+		mDeviceInfo->ReadBuffer(pixels.data(), pixels.size(), image.mReadbackAllocation);
+		return true;
+	}
+}
@@ -0,0 +1,74 @@
+#pragma once
+
+#include "VulkanHelpers.hpp"
+
+// VulkanHelpers
+namespace VulkanHelpers
+{
+	// VulkanOffscreenInfo
+	// ring of offscreen color/depth framebuffers replacing swapchain on devices without surface,
+	// rendered images can be copied to host visible buffers
+	struct VulkanOffscreenInfo : public VulkanRenderTargetInfo
+	{
+	private:
+		// VulkanOffscreenImage
+		struct VulkanOffscreenImage
+		{
+			VkImage         mImageColor = VK_NULL_HANDLE;
+			VkImageView     mImageViewColor = VK_NULL_HANDLE;
+			VmaAllocation   mImageColorAllocation = VK_NULL_HANDLE;
+			VkFramebuffer   mFramebuffer = VK_NULL_HANDLE;
+			VkBuffer        mReadbackBuffer = VK_NULL_HANDLE;
+			VmaAllocation   mReadbackAllocation = VK_NULL_HANDLE;
+			VkCommandBuffer mCommandBuffer = VK_NULL_HANDLE; // readback copy, recorded once
+			VkFence         mFence = VK_NULL_HANDLE;         // EndFrame submit
+			bool            mSubmitted = false;
+		};
+
+		// base handles
+		VulkanDeviceInfo* mDeviceInfo = nullptr;
+
+		// framebuffer formats
+		VkFormat mColorFormat = VK_FORMAT_B8G8R8A8_UNORM;
+		VkFormat mDepthStencilFormat = VK_FORMAT_D24_UNORM_S8_UINT;
+
+		// framebuffer data (depth is shared, frames are rendered in submission order)
+		VkImage                           mImageDepthStencil = VK_NULL_HANDLE;
+		VkImageView                       mImageViewDepthStencil = VK_NULL_HANDLE;
+		VmaAllocation                     mImageDepthStencilAllocation = VK_NULL_HANDLE;
+		std::vector<VulkanOffscreenImage> mImages{};
+		VkCommandPool                     mCommandPool = VK_NULL_HANDLE;
+		uint32_t                          mImageCount = 0;
+		uint32_t                          mNextImageIndex = 0;
+
+		// create functions
+		VkFormat FindDepthStencilFormat() const;
+		void CreateRenderPass();
+		void CreateImages();
+		void DestroyImages(std::vector<VulkanOffscreenImage>& images, VkImage imageDepthStencil, VkImageView imageViewDepthStencil, VmaAllocation imageDepthStencilAllocation);
+	public:
+		// copy every rendered image to its readback buffer
+		bool mReadbackEnabled = false;
+
+		// desired size (set before Recreate)
+		uint32_t mDesiredWidth = 0;
+		uint32_t mDesiredHeight = 0;
+
+		// Init/DeInit functions
+		void Initialize(VulkanDeviceInfo& deviceInfo, uint32_t width, uint32_t height, uint32_t imageCount, bool readbackEnabled);
+		void DeInitialize() override;
+		// Recreate (resize to desired size)
+		void Recreate(VulkanDeletionQueue& deletionQueue, uint64_t frameNumber) override;
+
+		// get functions
+		uint32_t GetImageCount() const override { return (uint32_t)mImages.size(); }
+		VkFormat GetColorFormat() const { return mColorFormat; }
+
+		// frame processing (semaphores are signaled and waited by empty or readback submits)
+		VkResult BeginFrame(VkSemaphore signalSemaphore, VkFramebuffer& framebuffer) override;
+		VkResult EndFrame(VkSemaphore waitSemaphore) override;
+
+		// ReadImage waits readback of image and copies tightly packed pixels (4 bytes per pixel, mColorFormat)
+		bool ReadImage(uint32_t imageIndex, std::vector<uint8_t>& pixels);
+	};
+}
@@ -0,0 +1,138 @@
+#include "VulkanParallelRecord.hpp"
+#include <cassert>
+#include <chrono>
+#include <algorithm>
+
+// VulkanHelpers
+namespace VulkanHelpers {
+	//////////////////////////////////////////////////////////////////////////
+	// VulkanParallelRecordInfo
+	//////////////////////////////////////////////////////////////////////////
+
+	// Initialize
+	void VulkanParallelRecordInfo::Initialize(VulkanDeviceInfo& deviceInfo, CThreadPool& threadPool, uint32_t framesInFlight)
+	{
+		// store parameters
+		mDeviceInfo = &deviceInfo;
+		mThreadPool = &threadPool;
+		assert(mDeviceInfo->mDevice);
+		assert(framesInFlight);
+
+		// create command pools (command pools are externally synchronized, so each thread owns one)
+		mCommandPools.resize(framesInFlight);
+		for (auto& framePools : mCommandPools)
+		{
+			framePools.resize(mThreadPool->GetThreadCount());
+			for (auto& threadCommandPool : framePools)
+			{
+				// VkCommandPoolCreateInfo (reset once per frame)
+				VkCommandPoolCreateInfo commandPoolCreateInfo{};
+				commandPoolCreateInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+				commandPoolCreateInfo.pNext = VK_NULL_HANDLE;
+				commandPoolCreateInfo.flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT;
+				commandPoolCreateInfo.queueFamilyIndex = mDeviceInfo->mQueueFamilyIndexGraphics;
+				VK_CHECK(vkCreateCommandPool(mDeviceInfo->mDevice, &commandPoolCreateInfo, VK_NULL_HANDLE, &threadCommandPool.mCommandPool));
+				assert(threadCommandPool.mCommandPool);
+			}
+		}
+	}
+
+	// DeInitialize
+	void VulkanParallelRecordInfo::DeInitialize()
+	{
+		for (auto& framePools : mCommandPools)
+			for (auto& threadCommandPool : framePools)
+				vkDestroyCommandPool(mDeviceInfo->mDevice, threadCommandPool.mCommandPool, VK_NULL_HANDLE);
+		mCommandPools.clear();
+		mSecondaryCommandBuffers.clear();
+	}
+
+	// AcquireCommandBuffer
+	VkCommandBuffer VulkanParallelRecordInfo::AcquireCommandBuffer(VulkanThreadCommandPool& threadCommandPool)
+	{
+		// allocate new secondary command buffer only when all are used
+		if (threadCommandPool.mUsedCount == threadCommandPool.mCommandBuffers.size())
+		{
+			// VkCommandBufferAllocateInfo
+			VkCommandBufferAllocateInfo commandBufferAllocateInfo{};
+			commandBufferAllocateInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+			commandBufferAllocateInfo.pNext = VK_NULL_HANDLE;
+			commandBufferAllocateInfo.commandPool = threadCommandPool.mCommandPool;
+			commandBufferAllocateInfo.level = VK_COMMAND_BUFFER_LEVEL_SECONDARY;
+			commandBufferAllocateInfo.commandBufferCount = 1;
+
+			// vkAllocateCommandBuffers
+			VkCommandBuffer commandBuffer = VK_NULL_HANDLE;
+			VK_CHECK(vkAllocateCommandBuffers(mDeviceInfo->mDevice, &commandBufferAllocateInfo, &commandBuffer));
+			assert(commandBuffer);
+			threadCommandPool.mCommandBuffers.push_back(commandBuffer);
+		}
+		return threadCommandPool.mCommandBuffers[threadCommandPool.mUsedCount++];
+	}
+
+	// Record
+	const std::vector<VkCommandBuffer>& VulkanParallelRecordInfo::Record(
+		uint32_t frameIndex, VkRenderPass renderPass, uint32_t subpass, VkFramebuffer framebuffer, uint32_t drawCount,
+		std::function<void(VkCommandBuffer commandBuffer, uint32_t drawBegin, uint32_t drawEnd)> recordFunc)
+	{
+		assert(frameIndex < mCommandPools.size());
+
+		// record start time
+		auto recordTimeBegin = std::chrono::high_resolution_clock::now();
+
+		// reset command pools of frame (frame fence was already waited)
+		std::vector<VulkanThreadCommandPool>& framePools = mCommandPools[frameIndex];
+		for (auto& threadCommandPool : framePools)
+		{
+			VK_CHECK(vkResetCommandPool(mDeviceInfo->mDevice, threadCommandPool.mCommandPool, 0));
+			threadCommandPool.mUsedCount = 0;
+		}
+
+		// split draws in ranges (at least one range per thread when there are enough draws)
+		uint32_t threadCount = mThreadPool->GetThreadCount();
+		uint32_t drawsPerTask = std::max(mMinDrawsPerTask, (drawCount + threadCount - 1) / threadCount);
+		uint32_t taskCount = (drawCount + drawsPerTask - 1) / drawsPerTask;
+		mSecondaryCommandBuffers.resize(taskCount);
+
+		// VkCommandBufferInheritanceInfo (secondary buffers continue render pass of primary)
+		VkCommandBufferInheritanceInfo commandBufferInheritanceInfo{};
+		commandBufferInheritanceInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_INFO;
+		commandBufferInheritanceInfo.pNext = VK_NULL_HANDLE;
+		commandBufferInheritanceInfo.renderPass = renderPass;
+		commandBufferInheritanceInfo.subpass = subpass;
+		commandBufferInheritanceInfo.framebuffer = framebuffer;
+		commandBufferInheritanceInfo.occlusionQueryEnable = VK_FALSE;
+		commandBufferInheritanceInfo.queryFlags = 0;
+		commandBufferInheritanceInfo.pipelineStatistics = 0;
+
+		// record ranges on workers
+		mThreadPool->Dispatch(taskCount, [&](uint32_t taskIndex, uint32_t threadIndex) {
+			// thread owns its command pool
+			VkCommandBuffer commandBuffer = AcquireCommandBuffer(framePools[threadIndex]);
+
+			// VkCommandBufferBeginInfo
+			VkCommandBufferBeginInfo commandBufferBeginInfo{};
+			commandBufferBeginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+			commandBufferBeginInfo.pNext = VK_NULL_HANDLE;
+			commandBufferBeginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT | VK_COMMAND_BUFFER_USAGE_RENDER_PASS_CONTINUE_BIT;
+			commandBufferBeginInfo.pInheritanceInfo = &commandBufferInheritanceInfo;
+			VK_CHECK(vkBeginCommandBuffer(commandBuffer, &commandBufferBeginInfo));
+
+			// record draw range
+			uint32_t drawBegin = taskIndex * drawsPerTask;
+			uint32_t drawEnd = std::min(drawBegin + drawsPerTask, drawCount);
+			recordFunc(commandBuffer, drawBegin, drawEnd);
+
+			// vkEndCommandBuffer
+			VK_CHECK(vkEndCommandBuffer(commandBuffer));
+
+			// keep draw order
+			mSecondaryCommandBuffers[taskIndex] = commandBuffer;
+		});
+
+		// record time
+		auto recordTimeEnd = std::chrono::high_resolution_clock::now();
+		mLastRecordTime = std::chrono::duration_cast<std::chrono::duration<double, std::milli>>(recordTimeEnd - recordTimeBegin).count();
+		return mSecondaryCommandBuffers;
+	}
+}
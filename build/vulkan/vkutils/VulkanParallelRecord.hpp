@@ -0,0 +1,52 @@
+#pragma once
+
+#include "VulkanHelpers.hpp"
+#include "../utils/ThreadPool.hpp"
+#include <functional>
+
+// VulkanHelpers
+namespace VulkanHelpers
+{
+	// VulkanParallelRecordInfo
+	// records draw ranges into secondary command buffers on worker threads (one command pool per frame and thread)
+	struct VulkanParallelRecordInfo
+	{
+	private:
+		// VulkanThreadCommandPool
+		struct VulkanThreadCommandPool
+		{
+			VkCommandPool                mCommandPool = VK_NULL_HANDLE;
+			std::vector<VkCommandBuffer> mCommandBuffers{};
+			uint32_t                     mUsedCount = 0;
+		};
+
+		// base handles
+		VulkanDeviceInfo* mDeviceInfo = nullptr;
+		CThreadPool*      mThreadPool = nullptr;
+
+		// command pools [frame][thread] (own)
+		std::vector<std::vector<VulkanThreadCommandPool>> mCommandPools{};
+
+		// secondary command buffers of last Record call in draw order
+		std::vector<VkCommandBuffer> mSecondaryCommandBuffers{};
+
+		// get next free secondary command buffer of thread pool
+		VkCommandBuffer AcquireCommandBuffer(VulkanThreadCommandPool& threadCommandPool);
+	public:
+		// draws per secondary command buffer (smaller ranges balance better, bigger cost less submission)
+		uint32_t mMinDrawsPerTask = 256;
+
+		// statistics of last Record call (milliseconds)
+		double mLastRecordTime = 0.0;
+
+		// Init/DeInit functions
+		void Initialize(VulkanDeviceInfo& deviceInfo, CThreadPool& threadPool, uint32_t framesInFlight);
+		void DeInitialize();
+
+		// Record resets command pools of frame and records drawCount draws split in ranges,
+		// recordFunc(commandBuffer, drawBegin, drawEnd) runs on workers and must set its own dynamic state
+		const std::vector<VkCommandBuffer>& Record(
+			uint32_t frameIndex, VkRenderPass renderPass, uint32_t subpass, VkFramebuffer framebuffer, uint32_t drawCount,
+			std::function<void(VkCommandBuffer commandBuffer, uint32_t drawBegin, uint32_t drawEnd)> recordFunc);
+	};
+}
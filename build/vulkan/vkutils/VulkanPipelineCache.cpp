@@ -0,0 +1,224 @@
+#include "VulkanPipelineCache.hpp"
+#include <cassert>
+#include <cstring>
+#include <cstdio>
+#include <fstream>
+
+// VulkanHelpers
+namespace VulkanHelpers {
+	// cache file identification ("VKPC", version of VulkanPipelineCacheHeader layout)
+	const uint32_t VULKAN_PIPELINE_CACHE_MAGIC = 0x43504B56;
+	const uint32_t VULKAN_PIPELINE_CACHE_VERSION = 1;
+	static_assert(sizeof(VulkanPipelineCacheHeader) == 6 * sizeof(uint32_t) + VK_UUID_SIZE + 2 * sizeof(uint64_t), "VulkanPipelineCacheHeader has padding");
+
+	// ReplaceFile (atomic on both platforms, readers see old or new file, never partial one)
+	static bool ReplaceFile(const std::string& srcFileName, const std::string& dstFileName)
+	{
+#ifdef _WIN32
+		return MoveFileExA(srcFileName.c_str(), dstFileName.c_str(), MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH) != 0;
+#else
+		return std::rename(srcFileName.c_str(), dstFileName.c_str()) == 0;
+#endif
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+	// VulkanPipelineCacheInfo
+	//////////////////////////////////////////////////////////////////////////
+
+	// Initialize
+	void VulkanPipelineCacheInfo::Initialize(VulkanDeviceInfo& deviceInfo, const char* fileName)
+	{
+		// store parameters
+		mDeviceInfo = &deviceInfo;
+		assert(mDeviceInfo->mDevice);
+		mFileName = fileName ? fileName : "";
+		mLastSaveTime = std::chrono::high_resolution_clock::now();
+
+		// load initial data (invalid file is ignored, cache starts empty)
+		std::vector<uint8_t> data{};
+		mLoaded = LoadFile(data);
+		mLoadedSize = data.size();
+		mSavedSize = data.size();
+		mSavedHash = HashBytes(data.data(), data.size());
+
+		// VkPipelineCacheCreateInfo
+		VkPipelineCacheCreateInfo pipelineCacheCreateInfo{};
+		pipelineCacheCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO;
+		pipelineCacheCreateInfo.pNext = VK_NULL_HANDLE;
+		pipelineCacheCreateInfo.flags = 0;
+		pipelineCacheCreateInfo.initialDataSize = data.size();
+		pipelineCacheCreateInfo.pInitialData = data.empty() ? nullptr : data.data();
+
+		// vkCreatePipelineCache (driver can still reject data, then cache starts empty)
+		if (vkCreatePipelineCache(mDeviceInfo->mDevice, &pipelineCacheCreateInfo, VK_NULL_HANDLE, &mPipelineCache) != VK_SUCCESS)
+		{
+			pipelineCacheCreateInfo.initialDataSize = 0;
+			pipelineCacheCreateInfo.pInitialData = nullptr;
+			mLoaded = false;
+			mLoadedSize = 0;
+			VK_CHECK(vkCreatePipelineCache(mDeviceInfo->mDevice, &pipelineCacheCreateInfo, VK_NULL_HANDLE, &mPipelineCache));
+		}
+		assert(mPipelineCache);
+		mDataSize = GetDataSize();
+	}
+
+	// DeInitialize
+	void VulkanPipelineCacheInfo::DeInitialize()
+	{
+		if (mDirty)
+			Save();
+		if (mPipelineCache)
+			vkDestroyPipelineCache(mDeviceInfo->mDevice, mPipelineCache, VK_NULL_HANDLE);
+		mPipelineCache = VK_NULL_HANDLE;
+	}
+
+	// LoadFile
+	bool VulkanPipelineCacheInfo::LoadFile(std::vector<uint8_t>& data) const
+	{
+		data.clear();
+		if (mFileName.empty())
+			return false;
+
+		// open file
+		std::ifstream file(mFileName, std::ios::in | std::ios::binary);
+		if (!file.is_open())
+			return false;
+
+		// read and check header
+		VulkanPipelineCacheHeader header{};
+		if (!file.read((char*)&header, sizeof(header)) || !IsHeaderValid(header))
+			return false;
+
+		// read and check data
+		data.resize((size_t)header.mDataSize);
+		if (!file.read((char*)data.data(), data.size()) || (HashBytes(data.data(), data.size()) != header.mDataHash))
+		{
+			data.clear();
+			return false;
+		}
+		return true;
+	}
+
+	// IsHeaderValid (data from other device, driver or cache format is dropped)
+	bool VulkanPipelineCacheInfo::IsHeaderValid(const VulkanPipelineCacheHeader& header) const
+	{
+		const VkPhysicalDeviceProperties& properties = mDeviceInfo->mDeviceProperties;
+		return
+			(header.mMagic == VULKAN_PIPELINE_CACHE_MAGIC) &&
+			(header.mVersion == VULKAN_PIPELINE_CACHE_VERSION) &&
+			(header.mVendorID == properties.vendorID) &&
+			(header.mDeviceID == properties.deviceID) &&
+			(header.mDriverVersion == properties.driverVersion) &&
+			(memcmp(header.mPipelineCacheUUID, properties.pipelineCacheUUID, VK_UUID_SIZE) == 0) &&
+			(header.mDataSize > 0);
+	}
+
+	// GetDataSize (size query only, data is not copied)
+	size_t VulkanPipelineCacheInfo::GetDataSize() const
+	{
+		size_t dataSize = 0;
+		VK_CHECK(vkGetPipelineCacheData(mDeviceInfo->mDevice, mPipelineCache, &dataSize, nullptr));
+		return dataSize;
+	}
+
+	// CheckDataSize (called with locked mutex, pipeline found in cache does not change its data)
+	void VulkanPipelineCacheInfo::CheckDataSize()
+	{
+		size_t dataSize = GetDataSize();
+		if (dataSize != mDataSize)
+		{
+			mDataSize = dataSize;
+			mDirty = true;
+		}
+	}
+
+	// MarkDirty
+	void VulkanPipelineCacheInfo::MarkDirty()
+	{
+		std::lock_guard<std::mutex> lock(mMutex);
+		CheckDataSize();
+	}
+
+	// Save
+	bool VulkanPipelineCacheInfo::Save()
+	{
+		std::lock_guard<std::mutex> lock(mMutex);
+		mLastSaveTime = std::chrono::high_resolution_clock::now();
+		if (mFileName.empty())
+			return false;
+
+		// vkGetPipelineCacheData (size, then data)
+		size_t dataSize = 0;
+		VK_CHECK(vkGetPipelineCacheData(mDeviceInfo->mDevice, mPipelineCache, &dataSize, nullptr));
+		std::vector<uint8_t> data(dataSize);
+		if (dataSize)
+			VK_CHECK(vkGetPipelineCacheData(mDeviceInfo->mDevice, mPipelineCache, &dataSize, data.data()));
+		data.resize(dataSize);
+		mDataSize = dataSize;
+		if (data.empty())
+			return false;
+
+		// data equal to file (same size and hash) is not written again
+		uint64_t dataHash = HashBytes(data.data(), data.size());
+		if ((data.size() == mSavedSize) && (dataHash == mSavedHash))
+		{
+			mDirty = false;
+			return true;
+		}
+
+		// VulkanPipelineCacheHeader
+		const VkPhysicalDeviceProperties& properties = mDeviceInfo->mDeviceProperties;
+		VulkanPipelineCacheHeader header{};
+		header.mMagic = VULKAN_PIPELINE_CACHE_MAGIC;
+		header.mVersion = VULKAN_PIPELINE_CACHE_VERSION;
+		header.mVendorID = properties.vendorID;
+		header.mDeviceID = properties.deviceID;
+		header.mDriverVersion = properties.driverVersion;
+		memcpy(header.mPipelineCacheUUID, properties.pipelineCacheUUID, VK_UUID_SIZE);
+		header.mDataSize = data.size();
+		header.mDataHash = dataHash;
+
+		// write temporary file (partially written one is removed)
+		std::string tempFileName = mFileName + ".tmp";
+		{
+			std::ofstream file(tempFileName, std::ios::out | std::ios::binary | std::ios::trunc);
+			if (!file.is_open())
+				return false;
+			file.write((const char*)&header, sizeof(header));
+			file.write((const char*)data.data(), data.size());
+			file.flush();
+			if (!file.good())
+			{
+				file.close();
+				std::remove(tempFileName.c_str());
+				return false;
+			}
+		}
+
+		// replace cache file
+		if (!ReplaceFile(tempFileName, mFileName))
+		{
+			std::remove(tempFileName.c_str());
+			return false;
+		}
+		mSavedSize = data.size();
+		mSavedHash = dataHash;
+		mDirty = false;
+		return true;
+	}
+
+	// Update
+	void VulkanPipelineCacheInfo::Update()
+	{
+		// check interval
+		{
+			std::lock_guard<std::mutex> lock(mMutex);
+			if (!mDirty || (mSaveInterval <= 0.0))
+				return;
+			double elapsed = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - mLastSaveTime).count();
+			if (elapsed < mSaveInterval)
+				return;
+		}
+		Save();
+	}
+}
@@ -0,0 +1,77 @@
+#pragma once
+
+#include "VulkanHelpers.hpp"
+#include <chrono>
+#include <mutex>
+#include <string>
+
+// VulkanHelpers
+namespace VulkanHelpers
+{
+	// VulkanPipelineCacheHeader
+	// prefix of cache file, data of other device or driver is never passed to driver
+	struct VulkanPipelineCacheHeader
+	{
+		uint32_t mMagic = 0;
+		uint32_t mVersion = 0;
+		uint32_t mVendorID = 0;
+		uint32_t mDeviceID = 0;
+		uint32_t mDriverVersion = 0;
+		uint8_t  mPipelineCacheUUID[VK_UUID_SIZE]{};
+		uint32_t mReserved = 0; // explicit alignment of mDataSize, header is written without uninitialized bytes
+		uint64_t mDataSize = 0;
+		uint64_t mDataHash = 0;
+	};
+
+	// VulkanPipelineCacheInfo
+	// VkPipelineCache loaded from disk at device init and written back atomically (temporary file and rename)
+	struct VulkanPipelineCacheInfo
+	{
+	private:
+		// base handles
+		VulkanDeviceInfo* mDeviceInfo = nullptr;
+
+		// file
+		std::string mFileName{};
+
+		// save state (guarded, pipelines are created and marked from any thread)
+		std::mutex                                     mMutex;
+		bool                                           mDirty = false;
+		std::chrono::high_resolution_clock::time_point mLastSaveTime{};
+
+		// data of cache when it was last checked (size) and written or loaded (size and hash)
+		size_t   mDataSize = 0;
+		size_t   mSavedSize = 0;
+		uint64_t mSavedHash = 0;
+
+		// cache functions
+		bool LoadFile(std::vector<uint8_t>& data) const;
+		size_t GetDataSize() const;
+		void CheckDataSize();
+		bool IsHeaderValid(const VulkanPipelineCacheHeader& header) const;
+	public:
+		// main cache (own)
+		VkPipelineCache mPipelineCache = VK_NULL_HANDLE;
+
+		// cache was loaded from valid file
+		bool mLoaded = false;
+		// size of loaded data (bytes)
+		size_t mLoadedSize = 0;
+
+		// periodic save interval (seconds, 0 - only on DeInitialize)
+		double mSaveInterval = 0.0;
+
+		// Init/DeInit functions (fileName can be empty - cache is not persistent)
+		void Initialize(VulkanDeviceInfo& deviceInfo, const char* fileName);
+		// DeInitialize saves cache when pipelines were added
+		void DeInitialize();
+
+		// MarkDirty (pipelines were created with main cache, cache is dirty only when size of its data changed)
+		void MarkDirty();
+
+		// Save writes cache atomically, data equal to file is not written (false - file can not be written)
+		bool Save();
+		// Update saves dirty cache when save interval elapsed
+		void Update();
+	};
+}
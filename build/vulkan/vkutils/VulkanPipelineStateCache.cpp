@@ -0,0 +1,268 @@
+#include "VulkanPipelineStateCache.hpp"
+#include "VulkanPipelineCache.hpp"
+#include <cassert>
+#include <chrono>
+#include <algorithm>
+
+// VulkanHelpers
+namespace VulkanHelpers {
+	//////////////////////////////////////////////////////////////////////////
+	// VulkanPipelineStateCacheInfo
+	//////////////////////////////////////////////////////////////////////////
+
+	// Initialize
+	void VulkanPipelineStateCacheInfo::Initialize(VulkanDeviceInfo& deviceInfo, uint32_t threadCount)
+	{
+		// store parameters
+		mDeviceInfo = &deviceInfo;
+		assert(mDeviceInfo->mDevice);
+		mPipelineCacheInfo = mDeviceInfo->mPipelineCacheInfo;
+
+		// reset state
+		mStop = false;
+		mActiveCount = 0;
+		mRequestCount = 0;
+		mMissCount = 0;
+		mStats = {};
+
+		// start workers
+		for (uint32_t i = 0; i < threadCount; i++)
+			mThreads.emplace_back(&VulkanPipelineStateCacheInfo::WorkerMain, this);
+	}
+
+	// DeInitialize
+	void VulkanPipelineStateCacheInfo::DeInitialize()
+	{
+		// stop workers (pipeline being compiled is finished)
+		{
+			std::lock_guard<std::mutex> lock(mQueueMutex);
+			mStop = true;
+			mQueue.clear();
+		}
+		mQueueCondition.notify_all();
+		for (auto& thread : mThreads)
+			thread.join();
+		mThreads.clear();
+
+		// destroy pipelines (dropped states have none)
+		for (auto& pipeline : mPipelines)
+			if (pipeline.second.mPipeline)
+				vkDestroyPipeline(mDeviceInfo->mDevice, pipeline.second.mPipeline, VK_NULL_HANDLE);
+		mPipelines.clear();
+		mPipelineCacheInfo = nullptr;
+	}
+
+	// WorkerMain
+	void VulkanPipelineStateCacheInfo::WorkerMain()
+	{
+		for (;;)
+		{
+			// wait for state
+			VulkanPipelineState pipelineState{};
+			{
+				std::unique_lock<std::mutex> lock(mQueueMutex);
+				mQueueCondition.wait(lock, [this]() { return mStop || !mQueue.empty(); });
+				if (mStop)
+					return;
+				pipelineState = mQueue.front();
+				mQueue.pop_front();
+				mActiveCount++;
+			}
+
+			// compile
+			Compile(pipelineState);
+
+			// done
+			{
+				std::lock_guard<std::mutex> lock(mQueueMutex);
+				mActiveCount--;
+			}
+			mIdleCondition.notify_all();
+		}
+	}
+
+	// Compile
+	VkPipeline VulkanPipelineStateCacheInfo::Compile(const VulkanPipelineState& pipelineState)
+	{
+		// creation with shared cache is internally synchronized, so workers use device cache directly (warm data from disk is hit)
+		VkPipelineCache pipelineCache = mPipelineCacheInfo ? mPipelineCacheInfo->mPipelineCache : VK_NULL_HANDLE;
+		auto beginTime = std::chrono::high_resolution_clock::now();
+		VkPipeline pipeline = CreateGraphicsPipeline(mDeviceInfo->mDevice, pipelineCache, pipelineState);
+		double compileTime = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - beginTime).count();
+		if (pipeline && mPipelineCacheInfo)
+			mPipelineCacheInfo->MarkDirty();
+
+		// publish (failed state is kept so it is not queued again, state retired meanwhile drops unused pipeline)
+		{
+			std::lock_guard<std::shared_timed_mutex> lock(mPipelinesMutex);
+			auto it = mPipelines.find(pipelineState);
+			if (it != mPipelines.end())
+			{
+				it->second.mPipeline = pipeline;
+				it->second.mFailed = !pipeline;
+			}
+			else if (pipeline)
+			{
+				vkDestroyPipeline(mDeviceInfo->mDevice, pipeline, VK_NULL_HANDLE);
+				pipeline = VK_NULL_HANDLE;
+			}
+		}
+
+		// stats (waiters are woken on failure too)
+		{
+			std::lock_guard<std::mutex> lock(mQueueMutex);
+			if (pipeline)
+			{
+				mStats.mCompiledCount++;
+				mStats.mCompileTime += compileTime;
+				mStats.mMaxCompileTime = std::max(mStats.mMaxCompileTime, compileTime);
+			}
+			else
+				mStats.mFailedCount++;
+		}
+		mIdleCondition.notify_all();
+		return pipeline;
+	}
+
+	// GetPipeline
+	VkPipeline VulkanPipelineStateCacheInfo::GetPipeline(const VulkanPipelineState& pipelineState, VkPipeline fallbackPipeline)
+	{
+		mRequestCount++;
+
+		// known state (ready or compiling)
+		{
+			std::shared_lock<std::shared_timed_mutex> lock(mPipelinesMutex);
+			auto it = mPipelines.find(pipelineState);
+			if (it != mPipelines.end())
+			{
+				if (it->second.mPipeline)
+					return it->second.mPipeline;
+				mMissCount++;
+				return fallbackPipeline;
+			}
+		}
+
+		// new state (other thread could insert it meanwhile, only first one queues it)
+		{
+			std::lock_guard<std::shared_timed_mutex> lock(mPipelinesMutex);
+			if (!mPipelines.emplace(pipelineState, VulkanPipelineStateEntry{}).second)
+			{
+				mMissCount++;
+				return fallbackPipeline;
+			}
+		}
+
+		// no workers, compile now
+		if (mThreads.empty())
+			return Compile(pipelineState);
+
+		// queue state
+		{
+			std::lock_guard<std::mutex> lock(mQueueMutex);
+			mQueue.push_back(pipelineState);
+		}
+		mQueueCondition.notify_one();
+		mMissCount++;
+		return fallbackPipeline;
+	}
+
+	// GetPipelineSync
+	VkPipeline VulkanPipelineStateCacheInfo::GetPipelineSync(const VulkanPipelineState& pipelineState)
+	{
+		// ready, failed or new state (state inserted here is compiled here)
+		bool inserted = false;
+		{
+			std::lock_guard<std::shared_timed_mutex> lock(mPipelinesMutex);
+			auto result = mPipelines.emplace(pipelineState, VulkanPipelineStateEntry{});
+			if (result.first->second.mPipeline || result.first->second.mFailed)
+				return result.first->second.mPipeline;
+			inserted = result.second;
+		}
+		if (inserted)
+			return Compile(pipelineState);
+
+		// still queued state is taken from queue
+		bool queued = false;
+		{
+			std::lock_guard<std::mutex> lock(mQueueMutex);
+			auto it = std::find(mQueue.begin(), mQueue.end(), pipelineState);
+			queued = (it != mQueue.end());
+			if (queued)
+				mQueue.erase(it);
+		}
+		if (queued)
+			return Compile(pipelineState);
+
+		// worker is compiling it (until it is published, failed or retired)
+		VkPipeline pipeline = VK_NULL_HANDLE;
+		std::unique_lock<std::mutex> lock(mQueueMutex);
+		mIdleCondition.wait(lock, [&]() {
+			std::shared_lock<std::shared_timed_mutex> pipelinesLock(mPipelinesMutex);
+			auto it = mPipelines.find(pipelineState);
+			if (it == mPipelines.end())
+				return true;
+			pipeline = it->second.mPipeline;
+			return pipeline || it->second.mFailed || mStop;
+		});
+		return pipeline;
+	}
+
+	// RetirePipeline
+	void VulkanPipelineStateCacheInfo::RetirePipeline(VkPipeline pipeline, VulkanDeletionQueue& deletionQueue, uint64_t frameNumber)
+	{
+		if (!pipeline)
+			return;
+
+		// state of pipeline (replaced states are rare, so search is linear)
+		{
+			std::lock_guard<std::shared_timed_mutex> lock(mPipelinesMutex);
+			auto it = std::find_if(mPipelines.begin(), mPipelines.end(), [pipeline](const std::pair<const VulkanPipelineState, VulkanPipelineStateEntry>& entry) {
+				return entry.second.mPipeline == pipeline;
+			});
+			if (it == mPipelines.end())
+				return;
+			mPipelines.erase(it);
+		}
+
+		// frames in flight could still use it
+		VkDevice device = mDeviceInfo->mDevice;
+		deletionQueue.Push(frameNumber, [device, pipeline]() {
+			vkDestroyPipeline(device, pipeline, VK_NULL_HANDLE);
+		});
+	}
+
+	// WaitIdle
+	void VulkanPipelineStateCacheInfo::WaitIdle()
+	{
+		std::unique_lock<std::mutex> lock(mQueueMutex);
+		mIdleCondition.wait(lock, [this]() { return mQueue.empty() && (mActiveCount == 0); });
+	}
+
+	// GetPendingCount
+	uint32_t VulkanPipelineStateCacheInfo::GetPendingCount()
+	{
+		std::lock_guard<std::mutex> lock(mQueueMutex);
+		return (uint32_t)mQueue.size() + mActiveCount;
+	}
+
+	// GetVariantCount
+	uint32_t VulkanPipelineStateCacheInfo::GetVariantCount(VkShaderModule shaderModule)
+	{
+		std::shared_lock<std::shared_timed_mutex> lock(mPipelinesMutex);
+		uint32_t variantCount = 0;
+		for (const auto& pipeline : mPipelines)
+			if ((pipeline.first.mShaderModuleVS == shaderModule) || (pipeline.first.mShaderModuleFS == shaderModule))
+				variantCount++;
+		return variantCount;
+	}
+
+	// GetStats
+	VulkanPipelineStateCacheStats VulkanPipelineStateCacheInfo::GetStats()
+	{
+		std::lock_guard<std::mutex> lock(mQueueMutex);
+		VulkanPipelineStateCacheStats stats = mStats;
+		stats.mRequestCount = mRequestCount;
+		stats.mMissCount = mMissCount;
+		return stats;
+	}
+}
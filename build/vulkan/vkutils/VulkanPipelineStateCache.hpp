@@ -0,0 +1,90 @@
+#pragma once
+
+#include "VulkanHelpers.hpp"
+#include <unordered_map>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <shared_mutex>
+#include <condition_variable>
+#include <atomic>
+
+// VulkanHelpers
+namespace VulkanHelpers
+{
+	// VulkanPipelineStateCacheStats
+	struct VulkanPipelineStateCacheStats
+	{
+		uint64_t mRequestCount = 0;  // GetPipeline calls
+		uint64_t mMissCount = 0;     // GetPipeline calls without ready pipeline (fallback returned)
+		uint64_t mCompiledCount = 0; // pipelines created
+		uint64_t mFailedCount = 0;   // pipeline creations that failed (state keeps fallback)
+		double   mCompileTime = 0.0; // sum of creation times (milliseconds)
+		double   mMaxCompileTime = 0.0;
+	};
+
+	// VulkanPipelineStateCacheInfo
+	// pipelines by VulkanPipelineState, identical states share one pipeline,
+	// missing pipelines are compiled on worker threads and callers draw with fallback (or skip) until they are ready
+	struct VulkanPipelineStateCacheInfo
+	{
+	private:
+		// VulkanPipelineStateEntry (mPipeline is VK_NULL_HANDLE while compiling or after failed creation)
+		struct VulkanPipelineStateEntry
+		{
+			VkPipeline mPipeline = VK_NULL_HANDLE;
+			bool       mFailed = false;
+		};
+
+		// base handles
+		VulkanDeviceInfo*        mDeviceInfo = nullptr;
+		VulkanPipelineCacheInfo* mPipelineCacheInfo = nullptr;
+
+		// pipelines (shared lock for lookups, exclusive for inserts)
+		std::shared_timed_mutex mPipelinesMutex;
+		std::unordered_map<VulkanPipelineState, VulkanPipelineStateEntry, VulkanPipelineStateHasher> mPipelines{};
+
+		// compile queue
+		std::mutex                      mQueueMutex;
+		std::condition_variable         mQueueCondition;
+		std::condition_variable         mIdleCondition;
+		std::deque<VulkanPipelineState> mQueue{};
+		uint32_t                        mActiveCount = 0;
+		bool                            mStop = false;
+		std::vector<std::thread>        mThreads{};
+
+		// stats (lookup counters are atomic, compile stats are guarded by mQueueMutex)
+		std::atomic<uint64_t>         mRequestCount{ 0 };
+		std::atomic<uint64_t>         mMissCount{ 0 };
+		VulkanPipelineStateCacheStats mStats{};
+
+		// worker thread function
+		void WorkerMain();
+		// Compile (creates pipeline and publishes it or failed state, any thread)
+		VkPipeline Compile(const VulkanPipelineState& pipelineState);
+	public:
+		// Init/DeInit functions (threadCount == 0 - pipelines are compiled on calling thread, device pipeline cache is used when set)
+		void Initialize(VulkanDeviceInfo& deviceInfo, uint32_t threadCount);
+		// DeInitialize drops queued states and destroys all pipelines (device must be idle)
+		void DeInitialize();
+
+		// GetPipeline does not wait for compilation: returns ready pipeline, otherwise queues state and returns fallbackPipeline
+		// (failed states are not compiled again, fallbackPipeline is returned for them)
+		VkPipeline GetPipeline(const VulkanPipelineState& pipelineState, VkPipeline fallbackPipeline = VK_NULL_HANDLE);
+		// GetPipelineSync returns pipeline, compiling it on calling thread when needed (loading screens, fallbacks),
+		// VK_NULL_HANDLE when creation failed
+		VkPipeline GetPipelineSync(const VulkanPipelineState& pipelineState);
+		// RetirePipeline removes state of pipeline, pipeline is destroyed when frames before frameNumber completed
+		// (states replaced by shader reloads, pipelines not created by cache are ignored)
+		void RetirePipeline(VkPipeline pipeline, VulkanDeletionQueue& deletionQueue, uint64_t frameNumber);
+
+		// WaitIdle (all queued pipelines are compiled)
+		void WaitIdle();
+
+		// get functions
+		uint32_t GetPendingCount();
+		// GetVariantCount (states using shader module in any stage, ready, compiling or failed)
+		uint32_t GetVariantCount(VkShaderModule shaderModule);
+		VulkanPipelineStateCacheStats GetStats();
+	};
+}
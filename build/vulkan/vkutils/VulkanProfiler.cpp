@@ -0,0 +1,365 @@
+#include "VulkanProfiler.hpp"
+#include <cassert>
+#include <cstring>
+#include <atomic>
+#include <fstream>
+#include <algorithm>
+
+// VulkanHelpers
+namespace VulkanHelpers {
+	// GetThreadId (small sequential ids, first profiled thread is 0)
+	static uint32_t GetThreadId()
+	{
+		static std::atomic<uint32_t> threadCounter{ 0 };
+		static thread_local uint32_t threadId = threadCounter++;
+		return threadId;
+	}
+
+	// GetProfileStats
+	VulkanProfileStats GetProfileStats(std::vector<double>& samples)
+	{
+		VulkanProfileStats stats{};
+		if (samples.empty())
+			return stats;
+
+		// sort samples
+		std::sort(samples.begin(), samples.end());
+		auto percentile = [&samples](double p) {
+			size_t index = (size_t)(p * (samples.size() - 1) + 0.5);
+			return samples[std::min(index, samples.size() - 1)];
+		};
+
+		// fill stats
+		stats.mCount = (uint32_t)samples.size();
+		for (const auto& sample : samples)
+			stats.mAverage += sample;
+		stats.mAverage /= samples.size();
+		stats.mMin = samples.front();
+		stats.mP50 = percentile(0.50);
+		stats.mP95 = percentile(0.95);
+		stats.mP99 = percentile(0.99);
+		stats.mMax = samples.back();
+		return stats;
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+	// VulkanProfilerInfo
+	//////////////////////////////////////////////////////////////////////////
+
+	// Initialize
+	void VulkanProfilerInfo::Initialize(VulkanDeviceInfo& deviceInfo, uint32_t gpuSlotCount, uint32_t eventCapacity, uint32_t frameCapacity)
+	{
+		// store parameters
+		mDeviceInfo = &deviceInfo;
+		assert(mDeviceInfo->mDevice);
+		assert(gpuSlotCount);
+		assert(eventCapacity);
+		assert(frameCapacity);
+
+		// rings
+		mEvents.resize(eventCapacity);
+		mEventCount = 0;
+		mFrames.assign(frameCapacity, VulkanProfileFrame());
+		mGpuSlots.assign(gpuSlotCount, VulkanGpuSlot());
+		CreateQueryPool(gpuSlotCount);
+	}
+
+	// DeInitialize
+	void VulkanProfilerInfo::DeInitialize()
+	{
+		if (mQueryPool)
+			vkDestroyQueryPool(mDeviceInfo->mDevice, mQueryPool, VK_NULL_HANDLE);
+		mQueryPool = VK_NULL_HANDLE;
+		mGpuSlots.clear();
+	}
+
+	// ResizeGpuSlots
+	void VulkanProfilerInfo::ResizeGpuSlots(uint32_t gpuSlotCount)
+	{
+		assert(gpuSlotCount);
+		if (mQueryPool)
+			vkDestroyQueryPool(mDeviceInfo->mDevice, mQueryPool, VK_NULL_HANDLE);
+		mQueryPool = VK_NULL_HANDLE;
+		mGpuSlots.assign(gpuSlotCount, VulkanGpuSlot());
+		CreateQueryPool(gpuSlotCount);
+	}
+
+	// CreateQueryPool
+	void VulkanProfilerInfo::CreateQueryPool(uint32_t gpuSlotCount)
+	{
+		// timestamps must be supported by graphics queue
+		uint32_t timestampValidBits = mDeviceInfo->mQueueFamilyProperties[mDeviceInfo->mQueueFamilyIndexGraphics].timestampValidBits;
+		if (timestampValidBits == 0)
+			return;
+		mTimestampPeriod = mDeviceInfo->mDeviceProperties.limits.timestampPeriod;
+		mTimestampMask = (timestampValidBits >= 64) ? UINT64_MAX : ((uint64_t(1) << timestampValidBits) - 1);
+
+		// VkQueryPoolCreateInfo
+		mUploadQuery = gpuSlotCount * mMaxGpuScopes * 2;
+		VkQueryPoolCreateInfo queryPoolCreateInfo{};
+		queryPoolCreateInfo.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+		queryPoolCreateInfo.pNext = VK_NULL_HANDLE;
+		queryPoolCreateInfo.flags = 0;
+		queryPoolCreateInfo.queryType = VK_QUERY_TYPE_TIMESTAMP;
+		queryPoolCreateInfo.queryCount = mUploadQuery + 2;
+		queryPoolCreateInfo.pipelineStatistics = 0;
+		VK_CHECK(vkCreateQueryPool(mDeviceInfo->mDevice, &queryPoolCreateInfo, VK_NULL_HANDLE, &mQueryPool));
+		assert(mQueryPool);
+	}
+
+	// GetTime
+	double VulkanProfilerInfo::GetTime() const
+	{
+		auto time = std::chrono::high_resolution_clock::now() - mStartTime;
+		return std::chrono::duration_cast<std::chrono::duration<double, std::micro>>(time).count();
+	}
+
+	// PushEvent
+	void VulkanProfilerInfo::PushEvent(const VulkanProfileEvent& event)
+	{
+		// events recorded before Initialize are dropped
+		std::lock_guard<std::mutex> lock(mMutex);
+		if (mEvents.empty())
+			return;
+		mEvents[mEventCount % mEvents.size()] = event;
+		mEventCount++;
+	}
+
+	// BeginFrame
+	void VulkanProfilerInfo::BeginFrame(uint64_t frameNumber)
+	{
+		mFrameNumber = frameNumber;
+		mFrameBeginTime = GetTime();
+	}
+
+	// EndFrame
+	void VulkanProfilerInfo::EndFrame()
+	{
+		if (!mEnabled)
+			return;
+
+		// frame sample (GPU time is filled when its timestamps are read)
+		double frameEndTime = GetTime();
+		AddCpuScope("Frame", mFrameBeginTime, frameEndTime);
+		std::lock_guard<std::mutex> lock(mMutex);
+		VulkanProfileFrame& frame = mFrames[mFrameNumber % mFrames.size()];
+		frame.mFrameNumber = mFrameNumber;
+		frame.mCpuTime = (frameEndTime - mFrameBeginTime) / 1000.0;
+		frame.mGpuTime = 0.0;
+	}
+
+	// AddCpuScope
+	void VulkanProfilerInfo::AddCpuScope(const char* name, double begin, double end)
+	{
+		if (!mEnabled)
+			return;
+
+		// VulkanProfileEvent
+		VulkanProfileEvent event{};
+		event.mName = name;
+		event.mFrameNumber = mFrameNumber;
+		event.mThreadId = GetThreadId();
+		event.mGpu = false;
+		event.mBegin = begin;
+		event.mDuration = end - begin;
+		PushEvent(event);
+	}
+
+	// ReadGpuScopes
+	bool VulkanProfilerInfo::ReadGpuScopes(uint32_t firstQuery, const std::vector<const char*>& scopeNames, uint64_t frameNumber, double submitTime, double& gpuTime)
+	{
+		// results without wait flag (VK_NOT_READY - leave them)
+		std::vector<uint64_t> timestamps(scopeNames.size() * 2);
+		VkResult result = vkGetQueryPoolResults(mDeviceInfo->mDevice, mQueryPool, firstQuery, (uint32_t)timestamps.size(),
+			timestamps.size() * sizeof(uint64_t), timestamps.data(), sizeof(uint64_t), VK_QUERY_RESULT_64_BIT);
+		if (result != VK_SUCCESS)
+			return false;
+
+		// ticks to microseconds
+		auto toMicroseconds = [this](uint64_t ticks) { return double(ticks & mTimestampMask) * mTimestampPeriod / 1000.0; };
+
+		// align GPU timeline to CPU (first scope starts after submit)
+		double gpuBegin = toMicroseconds(timestamps[0]);
+		double offset = submitTime - gpuBegin;
+		if (!mGpuTimeOffsetValid || (offset > mGpuTimeOffset))
+			mGpuTimeOffset = offset;
+		mGpuTimeOffsetValid = true;
+
+		// GPU events
+		double gpuEnd = gpuBegin;
+		for (size_t i = 0; i < scopeNames.size(); i++)
+		{
+			double begin = toMicroseconds(timestamps[i * 2 + 0]);
+			double end = toMicroseconds(timestamps[i * 2 + 1]);
+			gpuEnd = std::max(gpuEnd, end);
+
+			// VulkanProfileEvent
+			VulkanProfileEvent event{};
+			event.mName = scopeNames[i];
+			event.mFrameNumber = frameNumber;
+			event.mThreadId = 0;
+			event.mGpu = true;
+			event.mBegin = begin + mGpuTimeOffset;
+			event.mDuration = end - begin;
+			PushEvent(event);
+		}
+		gpuTime = (gpuEnd - gpuBegin) / 1000.0;
+		return true;
+	}
+
+	// CollectGpuSlot
+	void VulkanProfilerInfo::CollectGpuSlot(uint32_t slot)
+	{
+		assert(slot < mGpuSlots.size());
+		VulkanGpuSlot& gpuSlot = mGpuSlots[slot];
+		if (!mQueryPool || !gpuSlot.mPending || gpuSlot.mScopeNames.empty())
+			return;
+		gpuSlot.mPending = false;
+
+		// frame GPU time (frame may already be overwritten in ring)
+		double gpuTime = 0.0;
+		if (ReadGpuScopes(slot * mMaxGpuScopes * 2, gpuSlot.mScopeNames, gpuSlot.mFrameNumber, gpuSlot.mSubmitTime, gpuTime))
+		{
+			std::lock_guard<std::mutex> lock(mMutex);
+			VulkanProfileFrame& frame = mFrames[gpuSlot.mFrameNumber % mFrames.size()];
+			if (frame.mFrameNumber == gpuSlot.mFrameNumber)
+				frame.mGpuTime = gpuTime;
+		}
+	}
+
+	// ResetGpuSlot
+	void VulkanProfilerInfo::ResetGpuSlot(VkCommandBuffer commandBuffer, uint32_t slot)
+	{
+		assert(slot < mGpuSlots.size());
+		mGpuSlots[slot].mScopeNames.clear();
+		mGpuSlots[slot].mPending = false;
+		if (mQueryPool)
+			vkCmdResetQueryPool(commandBuffer, mQueryPool, slot * mMaxGpuScopes * 2, mMaxGpuScopes * 2);
+	}
+
+	// BeginGpuScope
+	uint32_t VulkanProfilerInfo::BeginGpuScope(VkCommandBuffer commandBuffer, uint32_t slot, const char* name)
+	{
+		// scopes over limit are not recorded
+		VulkanGpuSlot& gpuSlot = mGpuSlots[slot];
+		if (!mQueryPool || (gpuSlot.mScopeNames.size() >= mMaxGpuScopes))
+			return UINT32_MAX;
+
+		// vkCmdWriteTimestamp
+		uint32_t scope = (uint32_t)gpuSlot.mScopeNames.size();
+		gpuSlot.mScopeNames.push_back(name);
+		vkCmdWriteTimestamp(commandBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, mQueryPool, (slot * mMaxGpuScopes + scope) * 2 + 0);
+		return scope;
+	}
+
+	// EndGpuScope
+	void VulkanProfilerInfo::EndGpuScope(VkCommandBuffer commandBuffer, uint32_t slot, uint32_t scope)
+	{
+		if (scope == UINT32_MAX)
+			return;
+		vkCmdWriteTimestamp(commandBuffer, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, mQueryPool, (slot * mMaxGpuScopes + scope) * 2 + 1);
+	}
+
+	// SubmitGpuSlot
+	void VulkanProfilerInfo::SubmitGpuSlot(uint32_t slot, uint64_t frameNumber)
+	{
+		assert(slot < mGpuSlots.size());
+		VulkanGpuSlot& gpuSlot = mGpuSlots[slot];
+		gpuSlot.mFrameNumber = frameNumber;
+		gpuSlot.mSubmitTime = GetTime();
+		gpuSlot.mPending = mEnabled;
+	}
+
+	// BeginUpload
+	void VulkanProfilerInfo::BeginUpload(VkCommandBuffer commandBuffer, const char* name)
+	{
+		mUploadName = name;
+		if (!mQueryPool || !mEnabled)
+			return;
+		vkCmdResetQueryPool(commandBuffer, mQueryPool, mUploadQuery, 2);
+		vkCmdWriteTimestamp(commandBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, mQueryPool, mUploadQuery + 0);
+	}
+
+	// EndUpload
+	void VulkanProfilerInfo::EndUpload(VkCommandBuffer commandBuffer)
+	{
+		mUploadSubmitTime = GetTime();
+		if (!mQueryPool || !mEnabled)
+			return;
+		vkCmdWriteTimestamp(commandBuffer, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, mQueryPool, mUploadQuery + 1);
+	}
+
+	// CompleteUpload
+	void VulkanProfilerInfo::CompleteUpload()
+	{
+		// CPU side includes submit and queue wait
+		AddCpuScope(mUploadName, mUploadSubmitTime, GetTime());
+		if (!mQueryPool || !mEnabled)
+			return;
+		double gpuTime = 0.0;
+		ReadGpuScopes(mUploadQuery, { mUploadName }, mFrameNumber, mUploadSubmitTime, gpuTime);
+	}
+
+	// GetFrameStats
+	VulkanProfileStats VulkanProfilerInfo::GetFrameStats(bool gpu) const
+	{
+		// collect frame times in ring
+		std::vector<double> samples;
+		{
+			std::lock_guard<std::mutex> lock(mMutex);
+			samples.reserve(mFrames.size());
+			for (const auto& frame : mFrames)
+				if ((frame.mFrameNumber != UINT64_MAX) && (!gpu || (frame.mGpuTime > 0.0)))
+					samples.push_back(gpu ? frame.mGpuTime : frame.mCpuTime);
+		}
+		return GetProfileStats(samples);
+	}
+
+	// GetScopeStats
+	VulkanProfileStats VulkanProfilerInfo::GetScopeStats(const char* name, bool gpu) const
+	{
+		// collect scope durations in ring
+		std::vector<double> samples;
+		{
+			std::lock_guard<std::mutex> lock(mMutex);
+			uint64_t eventCount = std::min<uint64_t>(mEventCount, mEvents.size());
+			for (uint64_t i = 0; i < eventCount; i++)
+			{
+				const VulkanProfileEvent& event = mEvents[i];
+				if ((event.mGpu == gpu) && (strcmp(event.mName, name) == 0))
+					samples.push_back(event.mDuration / 1000.0);
+			}
+		}
+		return GetProfileStats(samples);
+	}
+
+	// ExportChromeTrace
+	bool VulkanProfilerInfo::ExportChromeTrace(const char* fileName) const
+	{
+		std::ofstream file(fileName, std::ios::out | std::ios::trunc);
+		if (!file.is_open())
+			return false;
+
+		// process and thread names
+		file << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+		file << "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"args\":{\"name\":\"CPU\"}},\n";
+		file << "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":2,\"args\":{\"name\":\"GPU\"}}";
+
+		// complete events, oldest first
+		std::lock_guard<std::mutex> lock(mMutex);
+		uint64_t eventCount = std::min<uint64_t>(mEventCount, mEvents.size());
+		uint64_t firstEvent = mEventCount - eventCount;
+		file.precision(3);
+		file << std::fixed;
+		for (uint64_t i = firstEvent; i < mEventCount; i++)
+		{
+			const VulkanProfileEvent& event = mEvents[i % mEvents.size()];
+			file << ",\n{\"name\":\"" << event.mName << "\",\"cat\":\"" << (event.mGpu ? "gpu" : "cpu")
+				<< "\",\"ph\":\"X\",\"ts\":" << event.mBegin << ",\"dur\":" << event.mDuration
+				<< ",\"pid\":" << (event.mGpu ? 2 : 1) << ",\"tid\":" << event.mThreadId
+				<< ",\"args\":{\"frame\":" << event.mFrameNumber << "}}";
+		}
+		file << "\n]}\n";
+		return file.good();
+	}
+}
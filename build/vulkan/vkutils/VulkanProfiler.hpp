@@ -0,0 +1,151 @@
+#pragma once
+
+#include "VulkanHelpers.hpp"
+#include <chrono>
+#include <mutex>
+
+// VulkanHelpers
+namespace VulkanHelpers
+{
+	// VulkanProfileEvent (times in microseconds since profiler creation)
+	struct VulkanProfileEvent
+	{
+		const char* mName = nullptr; // must outlive profiler (string literals)
+		uint64_t    mFrameNumber = 0;
+		uint32_t    mThreadId = 0;
+		bool        mGpu = false;
+		double      mBegin = 0.0;
+		double      mDuration = 0.0;
+	};
+
+	// VulkanProfileFrame (milliseconds, GPU time arrives some frames later)
+	struct VulkanProfileFrame
+	{
+		uint64_t mFrameNumber = UINT64_MAX;
+		double   mCpuTime = 0.0;
+		double   mGpuTime = 0.0;
+	};
+
+	// VulkanProfileStats (milliseconds over samples in ring, unit of samples for GetProfileStats)
+	struct VulkanProfileStats
+	{
+		uint32_t mCount = 0;
+		double   mAverage = 0.0;
+		double   mMin = 0.0;
+		double   mP50 = 0.0;
+		double   mP95 = 0.0;
+		double   mP99 = 0.0;
+		double   mMax = 0.0;
+	};
+
+	// GetProfileStats (sorts samples, percentile p is sample at rounded linear index p * (count - 1))
+	VulkanProfileStats GetProfileStats(std::vector<double>& samples);
+
+	// VulkanProfilerInfo
+	// named CPU scopes and GPU timestamp scopes kept in ring buffers, GPU results are read back
+	// when slot is reused (its fence was already waited), so reading never stalls
+	struct VulkanProfilerInfo
+	{
+	private:
+		// VulkanGpuSlot (queries of one command buffer: frame in flight or cached swapchain image)
+		struct VulkanGpuSlot
+		{
+			std::vector<const char*> mScopeNames{};
+			uint64_t                 mFrameNumber = 0;
+			double                   mSubmitTime = 0.0;
+			bool                     mPending = false;
+		};
+
+		// base handles
+		VulkanDeviceInfo* mDeviceInfo = nullptr;
+
+		// timestamp queries (own), two per scope, upload scope is last
+		VkQueryPool                mQueryPool = VK_NULL_HANDLE;
+		std::vector<VulkanGpuSlot> mGpuSlots{};
+		uint32_t                   mUploadQuery = 0;
+		const char*                mUploadName = nullptr;
+		double                     mUploadSubmitTime = 0.0;
+		double                     mTimestampPeriod = 0.0; // nanoseconds per tick
+		uint64_t                   mTimestampMask = 0;
+
+		// GPU to CPU timeline offset (microseconds, GPU work never starts before its submit)
+		double mGpuTimeOffset = 0.0;
+		bool   mGpuTimeOffsetValid = false;
+
+		// time base
+		std::chrono::high_resolution_clock::time_point mStartTime = std::chrono::high_resolution_clock::now();
+
+		// rings (guarded, CPU scopes come from worker threads too)
+		mutable std::mutex              mMutex;
+		std::vector<VulkanProfileEvent> mEvents{};
+		uint64_t                        mEventCount = 0;
+		std::vector<VulkanProfileFrame> mFrames{};
+
+		// current frame
+		uint64_t mFrameNumber = 0;
+		double   mFrameBeginTime = 0.0;
+
+		// create query pool of GPU slots and upload queries (timestamps must be supported by graphics queue)
+		void CreateQueryPool(uint32_t gpuSlotCount);
+		// add event to ring
+		void PushEvent(const VulkanProfileEvent& event);
+		// read timestamps of scopes to GPU events (false - not available yet)
+		bool ReadGpuScopes(uint32_t firstQuery, const std::vector<const char*>& scopeNames, uint64_t frameNumber, double submitTime, double& gpuTime);
+	public:
+		// disabled profiler records nothing
+		bool mEnabled = true;
+
+		// GPU scopes per slot
+		uint32_t mMaxGpuScopes = 16;
+
+		// Init/DeInit functions
+		void Initialize(VulkanDeviceInfo& deviceInfo, uint32_t gpuSlotCount, uint32_t eventCapacity = 65536, uint32_t frameCapacity = 1024);
+		void DeInitialize();
+		// ResizeGpuSlots (pending results are dropped, slots must not be in use by GPU)
+		void ResizeGpuSlots(uint32_t gpuSlotCount);
+
+		// get functions
+		bool IsGpuSupported() const { return mQueryPool != VK_NULL_HANDLE; }
+		double GetTime() const; // microseconds since profiler creation
+
+		// CPU functions
+		void BeginFrame(uint64_t frameNumber);
+		void EndFrame();
+		void AddCpuScope(const char* name, double begin, double end);
+
+		// GPU functions (slot is reused only after its commands completed)
+		// CollectGpuSlot reads results of previous submit of slot
+		void CollectGpuSlot(uint32_t slot);
+		// ResetGpuSlot records query reset (outside of render pass) and starts new scope list
+		void ResetGpuSlot(VkCommandBuffer commandBuffer, uint32_t slot);
+		uint32_t BeginGpuScope(VkCommandBuffer commandBuffer, uint32_t slot, const char* name);
+		void EndGpuScope(VkCommandBuffer commandBuffer, uint32_t slot, uint32_t scope);
+		// SubmitGpuSlot (call when command buffer recorded with slot scopes is submitted)
+		void SubmitGpuSlot(uint32_t slot, uint64_t frameNumber);
+
+		// upload functions (one time command buffers of device, queue is idle after submit)
+		void BeginUpload(VkCommandBuffer commandBuffer, const char* name);
+		void EndUpload(VkCommandBuffer commandBuffer);
+		void CompleteUpload();
+
+		// stats and export
+		VulkanProfileStats GetFrameStats(bool gpu) const;
+		VulkanProfileStats GetScopeStats(const char* name, bool gpu) const;
+		// Chrome trace / Perfetto JSON (chrome://tracing, ui.perfetto.dev)
+		bool ExportChromeTrace(const char* fileName) const;
+	};
+
+	// VulkanCpuScope
+	// records CPU scope from construction to destruction
+	struct VulkanCpuScope
+	{
+	private:
+		VulkanProfilerInfo& mProfilerInfo;
+		const char*         mName;
+		double              mBegin;
+	public:
+		VulkanCpuScope(VulkanProfilerInfo& profilerInfo, const char* name) :
+			mProfilerInfo(profilerInfo), mName(name), mBegin(profilerInfo.GetTime()) {}
+		~VulkanCpuScope() { mProfilerInfo.AddCpuScope(mName, mBegin, mProfilerInfo.GetTime()); }
+	};
+}
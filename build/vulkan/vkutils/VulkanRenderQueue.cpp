@@ -0,0 +1,315 @@
+#include "VulkanRenderQueue.hpp"
+#include <cassert>
+#include <cstring>
+#include <chrono>
+#include <algorithm>
+
+// VulkanHelpers
+namespace VulkanHelpers {
+	// digits of radix sort (8 bits per pass)
+	const uint32_t VULKAN_RADIX_BITS = 8;
+	const uint32_t VULKAN_RADIX_SIZE = 1 << VULKAN_RADIX_BITS;
+
+	// field masks
+	const uint64_t VULKAN_SORT_KEY_PIPELINE_MASK = (1ull << VULKAN_SORT_KEY_PIPELINE_BITS) - 1;
+	const uint64_t VULKAN_SORT_KEY_MATERIAL_MASK = (1ull << VULKAN_SORT_KEY_MATERIAL_BITS) - 1;
+	const uint64_t VULKAN_SORT_KEY_DEPTH_MASK = (1ull << VULKAN_SORT_KEY_DEPTH_BITS) - 1;
+
+	//////////////////////////////////////////////////////////////////////////
+	// VulkanSortKey
+	//////////////////////////////////////////////////////////////////////////
+
+	// Make
+	uint64_t VulkanSortKey::Make(uint32_t pass, uint32_t pipeline, uint32_t material, uint32_t depthBucket, bool backToFront)
+	{
+		assert(pass < (1u << VULKAN_SORT_KEY_PASS_BITS));
+		assert(pipeline <= VULKAN_SORT_KEY_PIPELINE_MASK);
+		assert(material <= VULKAN_SORT_KEY_MATERIAL_MASK);
+		assert(depthBucket <= VULKAN_SORT_KEY_DEPTH_MASK);
+		uint64_t key = ((uint64_t)pass << 57) | ((uint64_t)(backToFront ? 1 : 0) << 56);
+
+		// depth first (inverted, so farthest is lowest), state within equal depths
+		if (backToFront)
+			return key | ((VULKAN_SORT_KEY_DEPTH_MASK - depthBucket) << 40) | ((uint64_t)pipeline << 24) | material;
+
+		// state first, front to back within same state (early depth test rejects more)
+		return key | ((uint64_t)pipeline << 40) | ((uint64_t)material << 16) | depthBucket;
+	}
+
+	// GetPipeline
+	uint32_t VulkanSortKey::GetPipeline(uint64_t key)
+	{
+		return (uint32_t)((key >> (IsBackToFront(key) ? 24 : 40)) & VULKAN_SORT_KEY_PIPELINE_MASK);
+	}
+
+	// GetMaterial
+	uint32_t VulkanSortKey::GetMaterial(uint64_t key)
+	{
+		return (uint32_t)((key >> (IsBackToFront(key) ? 0 : 16)) & VULKAN_SORT_KEY_MATERIAL_MASK);
+	}
+
+	// GetDepthBucket
+	uint32_t VulkanSortKey::GetDepthBucket(uint64_t key)
+	{
+		if (IsBackToFront(key))
+			return (uint32_t)(VULKAN_SORT_KEY_DEPTH_MASK - ((key >> 40) & VULKAN_SORT_KEY_DEPTH_MASK));
+		return (uint32_t)(key & VULKAN_SORT_KEY_DEPTH_MASK);
+	}
+
+	// QuantizeDepth
+	uint32_t VulkanSortKey::QuantizeDepth(float viewDepth)
+	{
+		// bits of positive floats are ordered as floats (sign bit is zero, exponent and 7 bits of mantissa remain)
+		if (!(viewDepth > 0.0f))
+			return 0;
+		uint32_t bits = 0;
+		memcpy(&bits, &viewDepth, sizeof(bits));
+		return bits >> (32 - VULKAN_SORT_KEY_DEPTH_BITS - 1);
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+	// VulkanRenderQueueInfo
+	//////////////////////////////////////////////////////////////////////////
+
+	// Initialize
+	void VulkanRenderQueueInfo::Initialize(CThreadPool& threadPool)
+	{
+		mThreadPool = &threadPool;
+	}
+
+	// DeInitialize
+	void VulkanRenderQueueInfo::DeInitialize()
+	{
+		Clear();
+		mPipelines.clear();
+		mMaterials.clear();
+		mPipelineIds.clear();
+		mMaterialIds.clear();
+		mFreePipelineIds.clear();
+		mFreeMaterialIds.clear();
+		mScratch.clear();
+		mHistograms.clear();
+		mThreadPool = nullptr;
+	}
+
+	// RegisterPipeline
+	uint32_t VulkanRenderQueueInfo::RegisterPipeline(VkPipeline pipeline, VkPipelineLayout pipelineLayout, VkShaderStageFlags constantStages, uint32_t constantSize)
+	{
+		assert(pipeline && pipelineLayout);
+		assert(constantSize <= VULKAN_RENDER_QUEUE_CONSTANT_SIZE);
+
+		// VulkanRenderQueuePipeline
+		VulkanRenderQueuePipeline queuePipeline{};
+		queuePipeline.mPipeline = pipeline;
+		queuePipeline.mPipelineLayout = pipelineLayout;
+		queuePipeline.mConstantStages = constantStages;
+		queuePipeline.mConstantSize = constantSize;
+
+		// registered pipeline keeps id
+		auto it = mPipelineIds.find(pipeline);
+		if (it != mPipelineIds.end()) {
+			mPipelines[it->second] = queuePipeline;
+			return it->second;
+		}
+
+		// new id (free one first)
+		uint32_t id = (uint32_t)mPipelines.size();
+		if (!mFreePipelineIds.empty()) {
+			id = mFreePipelineIds.back();
+			mFreePipelineIds.pop_back();
+			mPipelines[id] = queuePipeline;
+		}
+		else {
+			assert(mPipelines.size() <= VULKAN_SORT_KEY_PIPELINE_MASK);
+			mPipelines.push_back(queuePipeline);
+		}
+		mPipelineIds[pipeline] = id;
+		return id;
+	}
+
+	// RegisterMaterial
+	uint32_t VulkanRenderQueueInfo::RegisterMaterial(VkDescriptorSet descriptorSet)
+	{
+		assert(descriptorSet);
+		auto it = mMaterialIds.find(descriptorSet);
+		if (it != mMaterialIds.end())
+			return it->second;
+
+		// new id (free one first)
+		uint32_t id = (uint32_t)mMaterials.size();
+		if (!mFreeMaterialIds.empty()) {
+			id = mFreeMaterialIds.back();
+			mFreeMaterialIds.pop_back();
+			mMaterials[id] = descriptorSet;
+		}
+		else {
+			assert(mMaterials.size() <= VULKAN_SORT_KEY_MATERIAL_MASK);
+			mMaterials.push_back(descriptorSet);
+		}
+		mMaterialIds[descriptorSet] = id;
+		return id;
+	}
+
+	// UnregisterPipeline
+	void VulkanRenderQueueInfo::UnregisterPipeline(VkPipeline pipeline)
+	{
+		auto it = mPipelineIds.find(pipeline);
+		if (it == mPipelineIds.end())
+			return;
+		mPipelines[it->second] = VulkanRenderQueuePipeline{};
+		mFreePipelineIds.push_back(it->second);
+		mPipelineIds.erase(it);
+	}
+
+	// UnregisterMaterial
+	void VulkanRenderQueueInfo::UnregisterMaterial(VkDescriptorSet descriptorSet)
+	{
+		auto it = mMaterialIds.find(descriptorSet);
+		if (it == mMaterialIds.end())
+			return;
+		mMaterials[it->second] = VK_NULL_HANDLE;
+		mFreeMaterialIds.push_back(it->second);
+		mMaterialIds.erase(it);
+	}
+
+	// Clear
+	void VulkanRenderQueueInfo::Clear()
+	{
+		mPayloads.clear();
+		mItems.clear();
+	}
+
+	// Add
+	void VulkanRenderQueueInfo::Add(uint64_t key, const VulkanDrawPayload& payload)
+	{
+		assert((VulkanSortKey::GetPipeline(key) < mPipelines.size()) && mPipelines[VulkanSortKey::GetPipeline(key)].mPipeline);
+		assert((VulkanSortKey::GetMaterial(key) < mMaterials.size()) && mMaterials[VulkanSortKey::GetMaterial(key)]);
+		mItems.push_back({ key, (uint32_t)mPayloads.size() });
+		mPayloads.push_back(payload);
+	}
+
+	// Sort
+	void VulkanRenderQueueInfo::Sort()
+	{
+		assert(mThreadPool);
+
+		// sort start time
+		auto sortTimeBegin = std::chrono::high_resolution_clock::now();
+		mLastSortPasses = 0;
+
+		// split items in ranges (at least one range per thread when there are enough items)
+		uint32_t itemCount = (uint32_t)mItems.size();
+		uint32_t threadCount = mThreadPool->GetThreadCount();
+		uint32_t itemsPerTask = std::max(std::max(mMinItemsPerTask, (itemCount + threadCount - 1) / threadCount), 1u);
+		uint32_t taskCount = (itemCount + itemsPerTask - 1) / itemsPerTask;
+		mScratch.resize(itemCount);
+		mHistograms.resize((size_t)taskCount * VULKAN_RADIX_SIZE);
+
+		// LSD passes, each pass is stable, so lower digits keep their order within equal higher digits
+		for (uint32_t shift = 0; shift < 64; shift += VULKAN_RADIX_BITS) {
+			// digit counts of ranges
+			mThreadPool->Dispatch(taskCount, [&](uint32_t taskIndex, uint32_t threadIndex) {
+				uint32_t* histogram = mHistograms.data() + (size_t)taskIndex * VULKAN_RADIX_SIZE;
+				memset(histogram, 0, VULKAN_RADIX_SIZE * sizeof(uint32_t));
+				uint32_t itemBegin = taskIndex * itemsPerTask;
+				uint32_t itemEnd = std::min(itemBegin + itemsPerTask, itemCount);
+				for (uint32_t i = itemBegin; i < itemEnd; i++)
+					histogram[(mItems[i].mKey >> shift) & (VULKAN_RADIX_SIZE - 1)]++;
+			});
+
+			// offsets of digits in ranges (digit major, ranges in order), pass is skipped when all items have same digit
+			uint32_t offset = 0;
+			bool sameDigit = false;
+			for (uint32_t digit = 0; digit < VULKAN_RADIX_SIZE; digit++) {
+				uint32_t digitBegin = offset;
+				for (uint32_t task = 0; task < taskCount; task++) {
+					uint32_t& count = mHistograms[(size_t)task * VULKAN_RADIX_SIZE + digit];
+					uint32_t digitCount = count;
+					count = offset;
+					offset += digitCount;
+				}
+				sameDigit |= (offset - digitBegin) == itemCount;
+			}
+			if (sameDigit)
+				continue;
+
+			// scatter ranges to their offsets
+			mThreadPool->Dispatch(taskCount, [&](uint32_t taskIndex, uint32_t threadIndex) {
+				uint32_t* offsets = mHistograms.data() + (size_t)taskIndex * VULKAN_RADIX_SIZE;
+				uint32_t itemBegin = taskIndex * itemsPerTask;
+				uint32_t itemEnd = std::min(itemBegin + itemsPerTask, itemCount);
+				for (uint32_t i = itemBegin; i < itemEnd; i++)
+					mScratch[offsets[(mItems[i].mKey >> shift) & (VULKAN_RADIX_SIZE - 1)]++] = mItems[i];
+			});
+			mItems.swap(mScratch);
+			mLastSortPasses++;
+		}
+
+		// sort time
+		auto sortTimeEnd = std::chrono::high_resolution_clock::now();
+		mLastSortTime = std::chrono::duration_cast<std::chrono::duration<double, std::milli>>(sortTimeEnd - sortTimeBegin).count();
+	}
+
+	// Record
+	VulkanRenderQueueStats VulkanRenderQueueInfo::Record(VkCommandBuffer commandBuffer, uint32_t itemBegin, uint32_t itemEnd) const
+	{
+		assert(itemEnd <= mItems.size());
+		VulkanRenderQueueStats stats{};
+
+		// bound state (invalid ids and null handles, so first packet binds all)
+		uint32_t pipelineId = UINT32_MAX;
+		uint32_t materialId = UINT32_MAX;
+		uint32_t uniformOffset = 0;
+		VkPipelineLayout pipelineLayout = VK_NULL_HANDLE;
+		VkBuffer vertexBuffer = VK_NULL_HANDLE;
+		VkBuffer indexBuffer = VK_NULL_HANDLE;
+		VkIndexType indexType = VK_INDEX_TYPE_UINT16;
+
+		for (uint32_t i = itemBegin; i < itemEnd; i++) {
+			uint64_t key = mItems[i].mKey;
+			const VulkanDrawPayload& payload = mPayloads[mItems[i].mPacket];
+
+			// pipeline (other layout disturbs material set)
+			uint32_t keyPipelineId = VulkanSortKey::GetPipeline(key);
+			const VulkanRenderQueuePipeline& pipeline = mPipelines[keyPipelineId];
+			if (keyPipelineId != pipelineId) {
+				vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline.mPipeline);
+				if (pipeline.mPipelineLayout != pipelineLayout)
+					materialId = UINT32_MAX;
+				pipelineId = keyPipelineId;
+				pipelineLayout = pipeline.mPipelineLayout;
+				stats.mPipelineBinds++;
+			}
+
+			// material set at uniform slot of packet
+			uint32_t keyMaterialId = VulkanSortKey::GetMaterial(key);
+			if ((keyMaterialId != materialId) || (payload.mUniformOffset != uniformOffset)) {
+				vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipelineLayout, 0, 1, &mMaterials[keyMaterialId], 1, &payload.mUniformOffset);
+				materialId = keyMaterialId;
+				uniformOffset = payload.mUniformOffset;
+				stats.mDescriptorSetBinds++;
+			}
+
+			// buffers
+			if (payload.mVertexBuffer != vertexBuffer) {
+				VkDeviceSize offset = 0;
+				vkCmdBindVertexBuffers(commandBuffer, 0, 1, &payload.mVertexBuffer, &offset);
+				vertexBuffer = payload.mVertexBuffer;
+				stats.mVertexBufferBinds++;
+			}
+			if ((payload.mIndexBuffer != indexBuffer) || (payload.mIndexType != indexType)) {
+				vkCmdBindIndexBuffer(commandBuffer, payload.mIndexBuffer, 0, payload.mIndexType);
+				indexBuffer = payload.mIndexBuffer;
+				indexType = payload.mIndexType;
+				stats.mIndexBufferBinds++;
+			}
+
+			// push constants are per draw
+			if (pipeline.mConstantSize)
+				vkCmdPushConstants(commandBuffer, pipelineLayout, pipeline.mConstantStages, 0, pipeline.mConstantSize, payload.mConstants);
+			vkCmdDrawIndexed(commandBuffer, payload.mIndexCount, 1, payload.mFirstIndex, payload.mVertexOffset, 0);
+			stats.mDrawCount++;
+		}
+		return stats;
+	}
+}
@@ -0,0 +1,140 @@
+#pragma once
+
+#include "VulkanHelpers.hpp"
+#include "../utils/ThreadPool.hpp"
+#include <unordered_map>
+
+// VulkanHelpers
+namespace VulkanHelpers
+{
+	// sort key fields (bits from highest): pass, order, then pipeline, material, depth for front to back passes
+	// or inverted depth, pipeline, material for back to front passes
+	const uint32_t VULKAN_SORT_KEY_PASS_BITS = 7;
+	const uint32_t VULKAN_SORT_KEY_PIPELINE_BITS = 16;
+	const uint32_t VULKAN_SORT_KEY_MATERIAL_BITS = 24;
+	const uint32_t VULKAN_SORT_KEY_DEPTH_BITS = 16;
+
+	// push constants of draw packet (bytes)
+	const uint32_t VULKAN_RENDER_QUEUE_CONSTANT_SIZE = 16;
+
+	// VulkanSortKey (packing of 64 bit draw key, ids must fit their fields)
+	struct VulkanSortKey
+	{
+		// Make (backToFront - transparent pass, farthest draws first and state changes only between equal depths)
+		static uint64_t Make(uint32_t pass, uint32_t pipeline, uint32_t material, uint32_t depthBucket, bool backToFront);
+
+		// get functions
+		static uint32_t GetPass(uint64_t key) { return (uint32_t)(key >> 57); }
+		static bool IsBackToFront(uint64_t key) { return ((key >> 56) & 1) != 0; }
+		static uint32_t GetPipeline(uint64_t key);
+		static uint32_t GetMaterial(uint64_t key);
+		static uint32_t GetDepthBucket(uint64_t key);
+
+		// QuantizeDepth (view depth to depth bucket, top bits of float, so buckets are logarithmic with about 1% steps)
+		static uint32_t QuantizeDepth(float viewDepth);
+	};
+
+	// VulkanDrawPayload (draw packet data besides key, indexed draw of one instance)
+	struct VulkanDrawPayload
+	{
+		VkBuffer    mVertexBuffer = VK_NULL_HANDLE; // binding 0
+		VkBuffer    mIndexBuffer = VK_NULL_HANDLE;
+		VkIndexType mIndexType = VK_INDEX_TYPE_UINT16;
+		uint32_t    mIndexCount = 0;
+		uint32_t    mFirstIndex = 0;
+		int32_t     mVertexOffset = 0;
+		uint32_t    mUniformOffset = 0;                                       // dynamic offset of material set
+		uint32_t    mConstants[VULKAN_RENDER_QUEUE_CONSTANT_SIZE / 4]{};     // push constants of pipeline
+	};
+
+	// VulkanRenderQueueStats (state changes of Record call)
+	struct VulkanRenderQueueStats
+	{
+		uint32_t mDrawCount = 0;
+		uint32_t mPipelineBinds = 0;
+		uint32_t mDescriptorSetBinds = 0;
+		uint32_t mVertexBufferBinds = 0;
+		uint32_t mIndexBufferBinds = 0;
+	};
+
+	// VulkanRenderQueueInfo
+	// draw packets (64 bit key and payload) added during frame are ordered by parallel LSD radix sort of keys,
+	// Record walks sorted packets and binds pipeline, material set (set 0) and buffers only when they change,
+	// so draws of one pipeline and material are recorded together and transparent draws are recorded back to front
+	struct VulkanRenderQueueInfo
+	{
+	private:
+		// VulkanRenderQueuePipeline
+		struct VulkanRenderQueuePipeline
+		{
+			VkPipeline         mPipeline = VK_NULL_HANDLE;
+			VkPipelineLayout   mPipelineLayout = VK_NULL_HANDLE;
+			VkShaderStageFlags mConstantStages = 0;
+			uint32_t           mConstantSize = 0;
+		};
+
+		// VulkanSortItem (key and packet index, moved by sort instead of packets)
+		struct VulkanSortItem
+		{
+			uint64_t mKey;
+			uint32_t mPacket;
+		};
+
+		// base handles
+		CThreadPool* mThreadPool = nullptr;
+
+		// registered pipelines and materials (id is index, ids of unregistered ones are reused)
+		std::vector<VulkanRenderQueuePipeline> mPipelines{};
+		std::vector<VkDescriptorSet> mMaterials{};
+		std::unordered_map<VkPipeline, uint32_t> mPipelineIds{};
+		std::unordered_map<VkDescriptorSet, uint32_t> mMaterialIds{};
+		std::vector<uint32_t> mFreePipelineIds{};
+		std::vector<uint32_t> mFreeMaterialIds{};
+
+		// packets of frame and sorted items (scratch is other buffer of sort passes)
+		std::vector<VulkanDrawPayload> mPayloads{};
+		std::vector<VulkanSortItem> mItems{};
+		std::vector<VulkanSortItem> mScratch{};
+
+		// digit counts of tasks, then their scatter offsets [task][digit]
+		std::vector<uint32_t> mHistograms{};
+	public:
+		// items per sort task (smaller ranges balance better, each task adds prefix work)
+		uint32_t mMinItemsPerTask = 16384;
+
+		// statistics of last Sort call (milliseconds and byte passes done, passes with equal digits are skipped)
+		double   mLastSortTime = 0.0;
+		uint32_t mLastSortPasses = 0;
+
+		// Init/DeInit functions (threadPool is shared, Sort must not overlap its other dispatches)
+		void Initialize(CThreadPool& threadPool);
+		void DeInitialize();
+
+		// RegisterPipeline (id of pipeline, registered again it keeps its id and takes new layout and constants,
+		// constantSize <= VULKAN_RENDER_QUEUE_CONSTANT_SIZE)
+		uint32_t RegisterPipeline(VkPipeline pipeline, VkPipelineLayout pipelineLayout, VkShaderStageFlags constantStages, uint32_t constantSize);
+		// RegisterMaterial (id of descriptor set bound at set 0 with one dynamic offset)
+		uint32_t RegisterMaterial(VkDescriptorSet descriptorSet);
+
+		// Unregister replaced or destroyed pipeline and material (not registered ones are ignored),
+		// packets added since last Clear must not use them, their ids are given to next registrations
+		void UnregisterPipeline(VkPipeline pipeline);
+		void UnregisterMaterial(VkDescriptorSet descriptorSet);
+
+		// Clear packets (registrations are kept)
+		void Clear();
+		// Add packet (pipeline and material of key must be registered)
+		void Add(uint64_t key, const VulkanDrawPayload& payload);
+		// Sort packets by key (equal keys keep order of Add)
+		void Sort();
+
+		// Record sorted packets [itemBegin, itemEnd), first packet binds all state (ranges can be recorded in parallel),
+		// viewport, scissor and sets above 0 are set by caller and must be compatible with layouts of registered pipelines
+		VulkanRenderQueueStats Record(VkCommandBuffer commandBuffer, uint32_t itemBegin, uint32_t itemEnd) const;
+
+		// get functions (order of last Sort)
+		uint32_t GetCount() const { return (uint32_t)mItems.size(); }
+		uint64_t GetKey(uint32_t item) const { return mItems[item].mKey; }
+		const VulkanDrawPayload& GetPayload(uint32_t item) const { return mPayloads[mItems[item].mPacket]; }
+	};
+}
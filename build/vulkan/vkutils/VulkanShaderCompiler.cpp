@@ -0,0 +1,354 @@
+#include "VulkanShaderCompiler.hpp"
+#include <cassert>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <algorithm>
+#include <sys/stat.h>
+#ifdef _WIN32
+#include <direct.h>
+#endif
+
+// VulkanHelpers
+namespace VulkanHelpers {
+	// SPIR-V magic number (first word of module)
+	const uint32_t SPIRV_MAGIC = 0x07230203;
+
+	// GetWriteTime (0 - file does not exist)
+	static time_t GetWriteTime(const std::string& fileName)
+	{
+		struct stat fileStat {};
+		if (stat(fileName.c_str(), &fileStat) != 0)
+			return 0;
+		return fileStat.st_mtime;
+	}
+
+	// ReadCode (whole SPIR-V file, false - missing or not SPIR-V)
+	static bool ReadCode(const std::string& fileName, std::vector<uint32_t>& code)
+	{
+		VulkanMappedFile mappedFile;
+		if (!mappedFile.Open(fileName.c_str()))
+			return false;
+		const uint32_t* words = (const uint32_t*)mappedFile.mData;
+		bool valid = (mappedFile.mSize >= sizeof(uint32_t)) && (mappedFile.mSize % sizeof(uint32_t) == 0) && (words[0] == SPIRV_MAGIC);
+		if (valid)
+			code.assign(words, words + mappedFile.mSize / sizeof(uint32_t));
+		mappedFile.Close();
+		return valid;
+	}
+
+	// ReadText (log files)
+	static std::string ReadText(const std::string& fileName)
+	{
+		std::ifstream file(fileName, std::ios::in | std::ios::binary);
+		if (!file.is_open())
+			return std::string();
+		return std::string(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+	}
+
+	// ReadIncludes (names and texts of files included by source, recursively, paths are relative to including file
+	// as glslangValidator resolves them, every file is read once, missing file adds only its name)
+	static void ReadIncludes(const std::string& fileName, const std::string& source, std::vector<std::string>& fileNames, std::string& includes)
+	{
+		size_t directoryEnd = fileName.find_last_of("/\\");
+		std::string directory = (directoryEnd == std::string::npos) ? std::string() : fileName.substr(0, directoryEnd + 1);
+		size_t lineBegin = 0;
+		while (lineBegin < source.size()) {
+			size_t lineEnd = source.find('\n', lineBegin);
+			if (lineEnd == std::string::npos)
+				lineEnd = source.size();
+
+			// #include "name" or #include <name>
+			size_t i = source.find_first_not_of(" \t", lineBegin);
+			if ((i < lineEnd) && (source[i] == '#')) {
+				i = source.find_first_not_of(" \t", i + 1);
+				if ((i < lineEnd) && (source.compare(i, 7, "include") == 0)) {
+					i = source.find_first_not_of(" \t", i + 7);
+					if ((i < lineEnd) && ((source[i] == '"') || (source[i] == '<'))) {
+						size_t nameEnd = source.find(source[i] == '"' ? '"' : '>', i + 1);
+						if (nameEnd < lineEnd) {
+							std::string includeFileName = directory + source.substr(i + 1, nameEnd - i - 1);
+							if (std::find(fileNames.begin(), fileNames.end(), includeFileName) == fileNames.end()) {
+								fileNames.push_back(includeFileName);
+								std::string includeSource = ReadText(includeFileName);
+								includes += includeFileName + '\0' + includeSource + '\0'; // terminators separate files
+								ReadIncludes(includeFileName, includeSource, fileNames, includes);
+							}
+						}
+					}
+				}
+			}
+			lineBegin = lineEnd + 1;
+		}
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+	// VulkanShaderCompilerInfo
+	//////////////////////////////////////////////////////////////////////////
+
+	// Initialize
+	void VulkanShaderCompilerInfo::Initialize(const char* compilerPath, const char* cacheDirectory, uint32_t threadCount)
+	{
+		// store parameters
+		assert(compilerPath);
+		assert(cacheDirectory);
+		mCompilerPath = compilerPath;
+		mCacheDirectory = cacheDirectory;
+		mLastPollTime = std::chrono::high_resolution_clock::now();
+
+		// create cache directory (existing one is kept)
+		std::string directory = mCacheDirectory;
+		if (!directory.empty() && ((directory.back() == '/') || (directory.back() == '\\')))
+			directory.pop_back();
+#ifdef _WIN32
+		_mkdir(directory.c_str());
+#else
+		mkdir(directory.c_str(), 0755);
+#endif
+
+		// start workers
+		mStop = false;
+		for (uint32_t i = 0; i < threadCount; i++)
+			mThreads.emplace_back(&VulkanShaderCompilerInfo::WorkerMain, this);
+	}
+
+	// DeInitialize
+	void VulkanShaderCompilerInfo::DeInitialize()
+	{
+		// stop workers (running compilation is finished)
+		{
+			std::lock_guard<std::mutex> lock(mQueueMutex);
+			mStop = true;
+			mQueue.clear();
+		}
+		mQueueCondition.notify_all();
+		for (auto& thread : mThreads)
+			thread.join();
+		mThreads.clear();
+
+		// clear state
+		mResults.clear();
+		mSources.clear();
+		std::lock_guard<std::mutex> lock(mCacheMutex);
+		mCache.clear();
+	}
+
+	// WorkerMain
+	void VulkanShaderCompilerInfo::WorkerMain()
+	{
+		for (;;)
+		{
+			// wait for source
+			VulkanShaderSource source{};
+			{
+				std::unique_lock<std::mutex> lock(mQueueMutex);
+				mQueueCondition.wait(lock, [this]() { return mStop || !mQueue.empty(); });
+				if (mStop)
+					return;
+				source = mQueue.front();
+				mQueue.pop_front();
+			}
+
+			// compile and publish result
+			VulkanShaderCompileResult result{};
+			Compile(source.mFileName.c_str(), source.mDefines, result);
+			std::lock_guard<std::mutex> lock(mQueueMutex);
+			mResults.push_back(std::move(result));
+		}
+	}
+
+	// RunCompiler
+	bool VulkanShaderCompilerInfo::RunCompiler(const std::string& sourceFileName, const std::vector<std::string>& defines, VkShaderStageFlagBits stage,
+		const std::string& outputFileName, std::string& log) const
+	{
+		// glslangValidator stage names
+		const char* stageName = "vert";
+		switch (stage) {
+		case VK_SHADER_STAGE_VERTEX_BIT: stageName = "vert"; break;
+		case VK_SHADER_STAGE_FRAGMENT_BIT: stageName = "frag"; break;
+		case VK_SHADER_STAGE_COMPUTE_BIT: stageName = "comp"; break;
+		case VK_SHADER_STAGE_GEOMETRY_BIT: stageName = "geom"; break;
+		case VK_SHADER_STAGE_TESSELLATION_CONTROL_BIT: stageName = "tesc"; break;
+		case VK_SHADER_STAGE_TESSELLATION_EVALUATION_BIT: stageName = "tese"; break;
+		default: assert(false); break;
+		}
+
+		// command line (compiler output goes to log file)
+		std::string logFileName = outputFileName + ".log";
+		std::string command = "\"" + mCompilerPath + "\" -V -S " + stageName;
+		for (const auto& define : defines)
+			command += " -D" + define;
+		command += " \"" + sourceFileName + "\" -o \"" + outputFileName + "\" > \"" + logFileName + "\" 2>&1";
+#ifdef _WIN32
+		// cmd /c strips first and last quote of command line
+		command = "\"" + command + "\"";
+#endif
+
+		// run compiler
+		int exitCode = std::system(command.c_str());
+		log += ReadText(logFileName);
+		std::remove(logFileName.c_str());
+		return exitCode == 0;
+	}
+
+	// Compile
+	bool VulkanShaderCompilerInfo::Compile(const char* sourceFileName, const std::vector<std::string>& defines, VulkanShaderCompileResult& result)
+	{
+		assert(sourceFileName);
+		result = {};
+		result.mSourceFileName = sourceFileName;
+		result.mDefines = defines;
+
+		// stage by file name
+		if (!GetShaderStage(sourceFileName, result.mStage)) {
+			result.mLog = "unknown shader stage of " + result.mSourceFileName;
+			return false;
+		}
+
+		// read source and included files (key of cache)
+		std::string source = ReadText(sourceFileName);
+		if (source.empty()) {
+			result.mLog = "can not read " + result.mSourceFileName;
+			return false;
+		}
+		std::vector<std::string> includeFileNames{};
+		std::string includes{};
+		ReadIncludes(result.mSourceFileName, source, includeFileNames, includes);
+		uint64_t hash = GetSourceHash(source, includes, defines, result.mStage);
+
+		// memory cache
+		{
+			std::lock_guard<std::mutex> lock(mCacheMutex);
+			auto it = mCache.find(hash);
+			if (it != mCache.end()) {
+				result.mCode = it->second;
+				result.mSuccess = true;
+				result.mCacheHit = true;
+				mCacheHitCount++;
+				return true;
+			}
+		}
+
+		// disk cache (file name is hash)
+		char hashName[32];
+		snprintf(hashName, sizeof(hashName), "%016llx", (unsigned long long)hash);
+		std::string cacheFileName = mCacheDirectory + hashName + ".spv";
+		result.mCacheHit = ReadCode(cacheFileName, result.mCode);
+		if (!result.mCacheHit) {
+			// compile to file of this thread, publish by rename (readers never see partial file)
+			std::string tempFileName = cacheFileName + "." + std::to_string(std::hash<std::thread::id>()(std::this_thread::get_id())) + ".tmp";
+			bool compiled = RunCompiler(sourceFileName, defines, result.mStage, tempFileName, result.mLog) && ReadCode(tempFileName, result.mCode);
+			if (!compiled || (std::rename(tempFileName.c_str(), cacheFileName.c_str()) != 0))
+				std::remove(tempFileName.c_str()); // failed or other thread published same code
+			if (!compiled)
+				return false;
+		}
+
+		// store
+		std::lock_guard<std::mutex> lock(mCacheMutex);
+		if (result.mCacheHit)
+			mCacheHitCount++;
+		else
+			mCompileCount++;
+		mCache[hash] = result.mCode;
+		result.mSuccess = true;
+		return true;
+	}
+
+	// CompileAsync
+	void VulkanShaderCompilerInfo::CompileAsync(const char* sourceFileName, const std::vector<std::string>& defines)
+	{
+		assert(sourceFileName);
+
+		// no workers, compile now
+		if (mThreads.empty()) {
+			VulkanShaderCompileResult result{};
+			Compile(sourceFileName, defines, result);
+			std::lock_guard<std::mutex> lock(mQueueMutex);
+			mResults.push_back(std::move(result));
+			return;
+		}
+
+		// queue source
+		VulkanShaderSource source{};
+		source.mFileName = sourceFileName;
+		source.mDefines = defines;
+		{
+			std::lock_guard<std::mutex> lock(mQueueMutex);
+			mQueue.push_back(source);
+		}
+		mQueueCondition.notify_one();
+	}
+
+	// Watch
+	void VulkanShaderCompilerInfo::Watch(const char* sourceFileName, const std::vector<std::string>& defines)
+	{
+		assert(sourceFileName);
+		VulkanShaderSource source{};
+		source.mFileName = sourceFileName;
+		source.mDefines = defines;
+		source.mWriteTime = GetWriteTime(source.mFileName);
+		mSources.push_back(source);
+	}
+
+	// Update
+	void VulkanShaderCompilerInfo::Update()
+	{
+		// poll interval
+		auto time = std::chrono::high_resolution_clock::now();
+		if (std::chrono::duration<double>(time - mLastPollTime).count() < mPollInterval)
+			return;
+		mLastPollTime = time;
+
+		// changed sources (saved files only, deleted ones are kept watched)
+		for (auto& source : mSources) {
+			time_t writeTime = GetWriteTime(source.mFileName);
+			if (writeTime && (writeTime != source.mWriteTime)) {
+				source.mWriteTime = writeTime;
+				CompileAsync(source.mFileName.c_str(), source.mDefines);
+			}
+		}
+	}
+
+	// TakeResults
+	std::vector<VulkanShaderCompileResult> VulkanShaderCompilerInfo::TakeResults()
+	{
+		std::lock_guard<std::mutex> lock(mQueueMutex);
+		std::vector<VulkanShaderCompileResult> results;
+		results.swap(mResults);
+		return results;
+	}
+
+	// GetShaderStage
+	bool VulkanShaderCompilerInfo::GetShaderStage(const char* sourceFileName, VkShaderStageFlagBits& stage)
+	{
+		// VkShaderStageFlagBits by extension part
+		static const std::pair<const char*, VkShaderStageFlagBits> STAGE_NAMES[] = {
+			{ ".vert", VK_SHADER_STAGE_VERTEX_BIT },
+			{ ".frag", VK_SHADER_STAGE_FRAGMENT_BIT },
+			{ ".comp", VK_SHADER_STAGE_COMPUTE_BIT },
+			{ ".geom", VK_SHADER_STAGE_GEOMETRY_BIT },
+			{ ".tesc", VK_SHADER_STAGE_TESSELLATION_CONTROL_BIT },
+			{ ".tese", VK_SHADER_STAGE_TESSELLATION_EVALUATION_BIT },
+		};
+		for (const auto& stageName : STAGE_NAMES) {
+			if (strstr(sourceFileName, stageName.first)) {
+				stage = stageName.second;
+				return true;
+			}
+		}
+		return false;
+	}
+
+	// GetSourceHash (HashBytes of stage, defines, source and included files)
+	uint64_t VulkanShaderCompilerInfo::GetSourceHash(const std::string& source, const std::string& includes, const std::vector<std::string>& defines, VkShaderStageFlagBits stage)
+	{
+		uint64_t hash = HashBytes(&stage, sizeof(stage));
+		for (const auto& define : defines)
+			hash = HashBytes(define.c_str(), define.size() + 1, hash); // terminator separates defines
+		hash = HashBytes(source.c_str(), source.size() + 1, hash);
+		return HashBytes(includes.data(), includes.size(), hash);
+	}
+}
@@ -0,0 +1,96 @@
+#pragma once
+
+#include "VulkanHelpers.hpp"
+#include <unordered_map>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+#include <ctime>
+
+// VulkanHelpers
+namespace VulkanHelpers
+{
+	// VulkanShaderCompileResult
+	struct VulkanShaderCompileResult
+	{
+		std::string              mSourceFileName{};
+		std::vector<std::string> mDefines{};
+		VkShaderStageFlagBits    mStage = VK_SHADER_STAGE_VERTEX_BIT;
+		std::vector<uint32_t>    mCode{};
+		std::string              mLog{};           // compiler output (errors)
+		bool                     mSuccess = false;
+		bool                     mCacheHit = false; // SPIR-V was found in cache, compiler did not run
+	};
+
+	// VulkanShaderCompilerInfo
+	// GLSL to SPIR-V with glslangValidator process (library is not part of SDK headers),
+	// SPIR-V is cached by hash of stage, defines, source and included files in memory and cache directory,
+	// watched sources are compiled again on worker threads when their files change
+	struct VulkanShaderCompilerInfo
+	{
+	private:
+		// VulkanShaderSource
+		struct VulkanShaderSource
+		{
+			std::string              mFileName{};
+			std::vector<std::string> mDefines{};
+			time_t                   mWriteTime = 0;
+		};
+
+		// settings
+		std::string mCompilerPath{};
+		std::string mCacheDirectory{};
+
+		// watched sources (calling thread only)
+		std::vector<VulkanShaderSource>                mSources{};
+		std::chrono::high_resolution_clock::time_point mLastPollTime{};
+
+		// compile queue and finished results
+		std::mutex                             mQueueMutex;
+		std::condition_variable                mQueueCondition;
+		std::deque<VulkanShaderSource>         mQueue{};
+		std::vector<VulkanShaderCompileResult> mResults{};
+		bool                                   mStop = false;
+		std::vector<std::thread>               mThreads{};
+
+		// SPIR-V by hash (guarded)
+		std::mutex                                              mCacheMutex;
+		std::unordered_map<uint64_t, std::vector<uint32_t>>     mCache{};
+
+		// worker thread function
+		void WorkerMain();
+		// RunCompiler (writes outputFileName, compiler output is appended to log)
+		bool RunCompiler(const std::string& sourceFileName, const std::vector<std::string>& defines, VkShaderStageFlagBits stage,
+			const std::string& outputFileName, std::string& log) const;
+	public:
+		// watch poll interval (seconds)
+		double mPollInterval = 0.5;
+
+		// stats (guarded by mCacheMutex)
+		uint64_t mCompileCount = 0;
+		uint64_t mCacheHitCount = 0;
+
+		// Init/DeInit functions (cacheDirectory with trailing slash is created when missing)
+		void Initialize(const char* compilerPath, const char* cacheDirectory, uint32_t threadCount);
+		void DeInitialize();
+
+		// Compile on calling thread (stage by file name: .vert, .frag, .comp, .geom, .tesc, .tese)
+		bool Compile(const char* sourceFileName, const std::vector<std::string>& defines, VulkanShaderCompileResult& result);
+		// CompileAsync (result is returned by TakeResults)
+		void CompileAsync(const char* sourceFileName, const std::vector<std::string>& defines);
+
+		// Watch source file, Update polls watched files and queues changed ones (calling thread)
+		void Watch(const char* sourceFileName, const std::vector<std::string>& defines);
+		void Update();
+
+		// TakeResults (finished async compilations, successful or not)
+		std::vector<VulkanShaderCompileResult> TakeResults();
+
+		// static functions
+		static bool GetShaderStage(const char* sourceFileName, VkShaderStageFlagBits& stage);
+		// GetSourceHash (includes - names and texts of included files)
+		static uint64_t GetSourceHash(const std::string& source, const std::string& includes, const std::vector<std::string>& defines, VkShaderStageFlagBits stage);
+	};
+}
@@ -0,0 +1,103 @@
+#include "VulkanShaderModuleCache.hpp"
+#include <cassert>
+#include <cstring>
+
+// VulkanHelpers
+namespace VulkanHelpers {
+	//////////////////////////////////////////////////////////////////////////
+	// VulkanShaderModuleCacheInfo
+	//////////////////////////////////////////////////////////////////////////
+
+	// Initialize
+	void VulkanShaderModuleCacheInfo::Initialize(VulkanDeviceInfo& deviceInfo, const char* overrideDirectory)
+	{
+		// store parameters
+		mDeviceInfo = &deviceInfo;
+		assert(mDeviceInfo->mDevice);
+		mOverrideDirectory = overrideDirectory ? overrideDirectory : "";
+
+		// reset stats
+		mCreateCount = 0;
+		mHitCount = 0;
+		mOverrideCount = 0;
+	}
+
+	// DeInitialize
+	void VulkanShaderModuleCacheInfo::DeInitialize()
+	{
+		std::lock_guard<std::mutex> lock(mMutex);
+		for (auto& shaderModule : mShaderModules)
+			vkDestroyShaderModule(mDeviceInfo->mDevice, shaderModule.second.mShaderModule, VK_NULL_HANDLE);
+		mShaderModules.clear();
+	}
+
+	// GetShaderModule
+	VkShaderModule VulkanShaderModuleCacheInfo::GetShaderModule(const uint32_t* code, size_t size)
+	{
+		assert(code);
+		assert(size && (size % sizeof(uint32_t) == 0));
+
+		// find module with same code
+		uint64_t hash = GetCodeHash(code, size);
+		std::lock_guard<std::mutex> lock(mMutex);
+		auto range = mShaderModules.equal_range(hash);
+		for (auto it = range.first; it != range.second; ++it) {
+			const std::vector<uint32_t>& entryCode = it->second.mCode;
+			if ((entryCode.size() * sizeof(uint32_t) == size) && (memcmp(entryCode.data(), code, size) == 0)) {
+				mHitCount++;
+				return it->second.mShaderModule;
+			}
+		}
+
+		// VulkanShaderModuleEntry
+		VulkanShaderModuleEntry entry{};
+		entry.mCode.assign(code, code + size / sizeof(uint32_t));
+		entry.mShaderModule = CreateShaderModule(mDeviceInfo->mDevice, code, size);
+		assert(entry.mShaderModule);
+		mCreateCount++;
+		return mShaderModules.emplace(hash, std::move(entry))->second.mShaderModule;
+	}
+
+	// GetShaderModule
+	VkShaderModule VulkanShaderModuleCacheInfo::GetShaderModule(const char* name, const uint32_t* embeddedCode, size_t embeddedSize)
+	{
+		assert(name);
+
+		// override file
+		if (!mOverrideDirectory.empty()) {
+			VkShaderModule shaderModule = GetShaderModuleFromFile((mOverrideDirectory + name).c_str());
+			if (shaderModule) {
+				std::lock_guard<std::mutex> lock(mMutex);
+				mOverrideCount++;
+				return shaderModule;
+			}
+		}
+
+		// embedded code
+		return GetShaderModule(embeddedCode, embeddedSize);
+	}
+
+	// GetShaderModuleFromFile
+	VkShaderModule VulkanShaderModuleCacheInfo::GetShaderModuleFromFile(const char* fileName)
+	{
+		// map file (page aligned, words can be read in place)
+		VulkanMappedFile mappedFile;
+		if (!mappedFile.Open(fileName))
+			return VK_NULL_HANDLE;
+		if (mappedFile.mSize % sizeof(uint32_t)) {
+			mappedFile.Close();
+			return VK_NULL_HANDLE;
+		}
+
+		// GetShaderModule
+		VkShaderModule shaderModule = GetShaderModule((const uint32_t*)mappedFile.mData, mappedFile.mSize);
+		mappedFile.Close();
+		return shaderModule;
+	}
+
+	// GetCodeHash
+	uint64_t VulkanShaderModuleCacheInfo::GetCodeHash(const uint32_t* code, size_t size)
+	{
+		return HashBytes(code, size);
+	}
+}
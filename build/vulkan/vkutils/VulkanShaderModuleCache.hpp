@@ -0,0 +1,53 @@
+#pragma once
+
+#include "VulkanHelpers.hpp"
+#include <unordered_map>
+#include <mutex>
+
+// VulkanHelpers
+namespace VulkanHelpers
+{
+	// VulkanShaderModuleCacheInfo
+	// shader modules by hash of SPIR-V, identical code is never created twice;
+	// named modules can be overridden by files of override directory (memory mapped), otherwise embedded code is used
+	struct VulkanShaderModuleCacheInfo
+	{
+	private:
+		// VulkanShaderModuleEntry (code copy resolves hash collisions)
+		struct VulkanShaderModuleEntry
+		{
+			std::vector<uint32_t> mCode{};
+			VkShaderModule        mShaderModule = VK_NULL_HANDLE;
+		};
+
+		// base handles
+		VulkanDeviceInfo* mDeviceInfo = nullptr;
+
+		// override directory (empty - embedded code only)
+		std::string mOverrideDirectory{};
+
+		// modules (guarded, pipelines are created from any thread)
+		std::mutex mMutex;
+		std::unordered_multimap<uint64_t, VulkanShaderModuleEntry> mShaderModules{};
+	public:
+		// stats
+		uint64_t mCreateCount = 0;   // modules created
+		uint64_t mHitCount = 0;      // requests served by existing module
+		uint64_t mOverrideCount = 0; // named requests served from override files
+
+		// Init/DeInit functions (overrideDirectory with trailing slash, can be nullptr)
+		void Initialize(VulkanDeviceInfo& deviceInfo, const char* overrideDirectory);
+		// DeInitialize destroys all modules (pipelines using them must be destroyed first)
+		void DeInitialize();
+
+		// GetShaderModule by code (size in bytes)
+		VkShaderModule GetShaderModule(const uint32_t* code, size_t size);
+		// GetShaderModule by name (override file when it exists, embedded code otherwise)
+		VkShaderModule GetShaderModule(const char* name, const uint32_t* embeddedCode, size_t embeddedSize);
+		// GetShaderModuleFromFile (memory mapped, VK_NULL_HANDLE when file can not be read)
+		VkShaderModule GetShaderModuleFromFile(const char* fileName);
+
+		// GetCodeHash (HashBytes of SPIR-V)
+		static uint64_t GetCodeHash(const uint32_t* code, size_t size);
+	};
+}
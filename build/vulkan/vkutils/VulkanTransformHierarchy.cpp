@@ -0,0 +1,198 @@
+#include "VulkanTransformHierarchy.hpp"
+#include <cassert>
+#include <cstring>
+#include <chrono>
+#include <numeric>
+#include <algorithm>
+
+// VulkanHelpers
+namespace VulkanHelpers {
+	//////////////////////////////////////////////////////////////////////////
+	// VulkanTransformHierarchyInfo
+	//////////////////////////////////////////////////////////////////////////
+
+	// Initialize
+	void VulkanTransformHierarchyInfo::Initialize(CThreadPool& threadPool)
+	{
+		mThreadPool = &threadPool;
+	}
+
+	// DeInitialize
+	void VulkanTransformHierarchyInfo::DeInitialize()
+	{
+		mParents.clear();
+		mLocals.clear();
+		mWorlds.clear();
+		mDirty.clear();
+		mIds.clear();
+		mIndices.clear();
+		mRootBegins.clear();
+		mNodeRoots.clear();
+		mRootDirty.clear();
+		mTaskBegins.clear();
+		mTaskUpdatedCounts.clear();
+		mLayoutChanged = false;
+		mChanged = false;
+		mThreadPool = nullptr;
+	}
+
+	// AddNode
+	uint32_t VulkanTransformHierarchyInfo::AddNode(uint32_t parent, const DirectX::XMMATRIX& local)
+	{
+		assert((parent == VULKAN_TRANSFORM_INVALID) || (parent < mIds.size()));
+
+		// appended until layout is rebuilt (parent is before it already)
+		uint32_t id = (uint32_t)mIds.size();
+		mParents.push_back((parent == VULKAN_TRANSFORM_INVALID) ? VULKAN_TRANSFORM_INVALID : mIndices[parent]);
+		mLocals.push_back(local);
+		mWorlds.push_back(local);
+		mDirty.push_back(1);
+		mIds.push_back(id);
+		mIndices.push_back(id);
+		mLayoutChanged = true;
+		mChanged = true;
+		return id;
+	}
+
+	// SetLocal
+	void VulkanTransformHierarchyInfo::SetLocal(uint32_t node, const DirectX::XMMATRIX& local)
+	{
+		assert(node < mIndices.size());
+		uint32_t index = mIndices[node];
+		mLocals[index] = local;
+		mDirty[index] = 1;
+		mChanged = true;
+		// subtrees are known after layout is rebuilt (rebuild marks subtrees of dirty nodes)
+		if (!mLayoutChanged)
+			mRootDirty[mNodeRoots[index]] = 1;
+	}
+
+	// GetParent
+	uint32_t VulkanTransformHierarchyInfo::GetParent(uint32_t node) const
+	{
+		uint32_t parentIndex = mParents[mIndices[node]];
+		return (parentIndex == VULKAN_TRANSFORM_INVALID) ? VULKAN_TRANSFORM_INVALID : mIds[parentIndex];
+	}
+
+	// RebuildLayout
+	void VulkanTransformHierarchyInfo::RebuildLayout()
+	{
+		// root and depth of nodes (parent id is lower than id of its children)
+		uint32_t nodeCount = (uint32_t)mIds.size();
+		std::vector<uint32_t> roots(nodeCount);
+		std::vector<uint32_t> depths(nodeCount);
+		for (uint32_t id = 0; id < nodeCount; id++) {
+			uint32_t parent = GetParent(id);
+			roots[id] = (parent == VULKAN_TRANSFORM_INVALID) ? id : roots[parent];
+			depths[id] = (parent == VULKAN_TRANSFORM_INVALID) ? 0 : depths[parent] + 1;
+		}
+
+		// order by root subtree, then by depth (parents are before children, levels of subtree are contiguous)
+		std::vector<uint32_t> order(nodeCount);
+		std::iota(order.begin(), order.end(), 0);
+		std::sort(order.begin(), order.end(), [&roots, &depths](uint32_t a, uint32_t b) {
+			if (roots[a] != roots[b])
+				return roots[a] < roots[b];
+			if (depths[a] != depths[b])
+				return depths[a] < depths[b];
+			return a < b;
+		});
+
+		// permute arrays
+		std::vector<uint32_t> indices(nodeCount);
+		for (uint32_t index = 0; index < nodeCount; index++)
+			indices[order[index]] = index;
+		std::vector<uint32_t> parents(nodeCount);
+		std::vector<DirectX::XMMATRIX> locals(nodeCount);
+		std::vector<DirectX::XMMATRIX> worlds(nodeCount);
+		std::vector<uint8_t> dirty(nodeCount);
+		for (uint32_t index = 0; index < nodeCount; index++) {
+			uint32_t id = order[index];
+			uint32_t oldIndex = mIndices[id];
+			uint32_t parent = GetParent(id);
+			parents[index] = (parent == VULKAN_TRANSFORM_INVALID) ? VULKAN_TRANSFORM_INVALID : indices[parent];
+			locals[index] = mLocals[oldIndex];
+			worlds[index] = mWorlds[oldIndex];
+			dirty[index] = mDirty[oldIndex];
+		}
+		mParents.swap(parents);
+		mLocals.swap(locals);
+		mWorlds.swap(worlds);
+		mDirty.swap(dirty);
+		mIds.swap(order);
+		mIndices.swap(indices);
+
+		// root subtrees (subtree is dirty when any of its nodes is)
+		mRootBegins.clear();
+		mRootDirty.clear();
+		mNodeRoots.resize(nodeCount);
+		for (uint32_t index = 0; index < nodeCount; index++) {
+			if (mParents[index] == VULKAN_TRANSFORM_INVALID) {
+				mRootBegins.push_back(index);
+				mRootDirty.push_back(0);
+			}
+			mNodeRoots[index] = (uint32_t)mRootBegins.size() - 1;
+			mRootDirty.back() |= mDirty[index];
+		}
+		uint32_t rootCount = (uint32_t)mRootBegins.size();
+		mRootBegins.push_back(nodeCount);
+
+		// tasks of whole subtrees (at least one task per thread when there are enough nodes)
+		uint32_t threadCount = mThreadPool->GetThreadCount();
+		uint32_t nodesPerTask = std::max(mMinNodesPerTask, (nodeCount + threadCount - 1) / threadCount);
+		mTaskBegins.clear();
+		for (uint32_t root = 0; root < rootCount; root++)
+			if (mTaskBegins.empty() || (mRootBegins[root] - mRootBegins[mTaskBegins.back()] >= nodesPerTask))
+				mTaskBegins.push_back(root);
+		mTaskBegins.push_back(rootCount);
+		mTaskUpdatedCounts.resize(mTaskBegins.size() - 1);
+		mLayoutChanged = false;
+	}
+
+	// Update
+	void VulkanTransformHierarchyInfo::Update()
+	{
+		assert(mThreadPool);
+
+		// update start time
+		auto updateTimeBegin = std::chrono::high_resolution_clock::now();
+		mLastUpdatedCount = 0;
+
+		if (mLayoutChanged)
+			RebuildLayout();
+
+		// subtrees of tasks (clean subtrees are skipped, dirty flag is passed from parent to children, clean nodes keep their world)
+		if (mChanged) {
+			uint32_t taskCount = (uint32_t)mTaskUpdatedCounts.size();
+			mThreadPool->Dispatch(taskCount, [&](uint32_t taskIndex, uint32_t threadIndex) {
+				uint32_t updatedCount = 0;
+				for (uint32_t root = mTaskBegins[taskIndex]; root < mTaskBegins[taskIndex + 1]; root++) {
+					if (!mRootDirty[root])
+						continue;
+					uint32_t nodeBegin = mRootBegins[root];
+					uint32_t nodeEnd = mRootBegins[root + 1];
+					for (uint32_t i = nodeBegin; i < nodeEnd; i++) {
+						uint32_t parent = mParents[i];
+						if ((parent != VULKAN_TRANSFORM_INVALID) && mDirty[parent])
+							mDirty[i] = 1;
+						if (!mDirty[i])
+							continue;
+						mWorlds[i] = (parent == VULKAN_TRANSFORM_INVALID) ? mLocals[i] : DirectX::XMMatrixMultiply(mLocals[i], mWorlds[parent]);
+						updatedCount++;
+					}
+					// flags are cleared after whole subtree, children read flags of their parents
+					memset(mDirty.data() + nodeBegin, 0, nodeEnd - nodeBegin);
+					mRootDirty[root] = 0;
+				}
+				mTaskUpdatedCounts[taskIndex] = updatedCount;
+			});
+			for (uint32_t updatedCount : mTaskUpdatedCounts)
+				mLastUpdatedCount += updatedCount;
+			mChanged = false;
+		}
+
+		// update time
+		auto updateTimeEnd = std::chrono::high_resolution_clock::now();
+		mLastUpdateTime = std::chrono::duration_cast<std::chrono::duration<double, std::milli>>(updateTimeEnd - updateTimeBegin).count();
+	}
+}
@@ -0,0 +1,74 @@
+#pragma once
+
+#include "VulkanHelpers.hpp"
+#include "../utils/ThreadPool.hpp"
+#include <DirectXMath.h>
+
+// VulkanHelpers
+namespace VulkanHelpers
+{
+	// node without parent
+	const uint32_t VULKAN_TRANSFORM_INVALID = UINT32_MAX;
+
+	// VulkanTransformHierarchyInfo
+	// transforms of nodes are kept in structure of arrays ordered by root subtree and depth, so every subtree is range
+	// with parents before children, Update walks ranges of subtrees on workers, skips subtrees without changed nodes
+	// and computes world = local * world of parent only for nodes whose local or some ancestor changed since last Update
+	struct VulkanTransformHierarchyInfo
+	{
+	private:
+		// base handles
+		CThreadPool* mThreadPool = nullptr;
+
+		// SoA of nodes (index is position in update order)
+		std::vector<uint32_t>          mParents{}; // index of parent or VULKAN_TRANSFORM_INVALID
+		std::vector<DirectX::XMMATRIX> mLocals{};
+		std::vector<DirectX::XMMATRIX> mWorlds{};
+		std::vector<uint8_t>           mDirty{};
+
+		// node ids (stable, returned by AddNode) and their indices
+		std::vector<uint32_t> mIds{};     // [index]
+		std::vector<uint32_t> mIndices{}; // [id]
+
+		// root subtrees (node ranges [mRootBegins[i], mRootBegins[i + 1]), subtree of node, subtree has dirty node)
+		std::vector<uint32_t> mRootBegins{};
+		std::vector<uint32_t> mNodeRoots{}; // [index]
+		std::vector<uint8_t>  mRootDirty{};
+
+		// ranges of whole subtrees per task ([mTaskBegins[i], mTaskBegins[i + 1]) of roots)
+		std::vector<uint32_t> mTaskBegins{};
+		std::vector<uint32_t> mTaskUpdatedCounts{};
+
+		// nodes were added since last Update (order and task ranges are rebuilt), some node is dirty
+		bool mLayoutChanged = false;
+		bool mChanged = false;
+
+		// RebuildLayout (sorts nodes by root and depth, splits roots into task ranges)
+		void RebuildLayout();
+	public:
+		// nodes per task (smaller ranges balance better, subtree is never split)
+		uint32_t mMinNodesPerTask = 4096;
+
+		// statistics of last Update call (milliseconds and recomputed world matrices)
+		double   mLastUpdateTime = 0.0;
+		uint32_t mLastUpdatedCount = 0;
+
+		// Init/DeInit functions (threadPool is shared, Update must not overlap its other dispatches)
+		void Initialize(CThreadPool& threadPool);
+		void DeInitialize();
+
+		// AddNode (parent must be added before, VULKAN_TRANSFORM_INVALID - root), returns id of node
+		uint32_t AddNode(uint32_t parent, const DirectX::XMMATRIX& local);
+		// SetLocal (node and its subtree are updated by next Update)
+		void SetLocal(uint32_t node, const DirectX::XMMATRIX& local);
+
+		// Update world matrices of dirty subtrees
+		void Update();
+
+		// get functions (world is result of last Update)
+		uint32_t GetNodeCount() const { return (uint32_t)mIds.size(); }
+		uint32_t GetParent(uint32_t node) const;
+		const DirectX::XMMATRIX& GetLocal(uint32_t node) const { return mLocals[mIndices[node]]; }
+		const DirectX::XMMATRIX& GetWorld(uint32_t node) const { return mWorlds[mIndices[node]]; }
+	};
+}
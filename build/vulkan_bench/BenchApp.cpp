@@ -0,0 +1,470 @@
+#include "BenchApp.hpp"
+#include <iostream>
+#include <fstream>
+#include <cassert>
+#include <array>
+#include <algorithm>
+#include <cstdio>
+
+// max profiled events per scene (frame scopes and uploads)
+const uint32_t BENCH_EVENT_CAPACITY = 1024 * 1024;
+
+// WriteJsonString (escapes quotes and backslashes)
+static void WriteJsonString(std::ostream& stream, const char* str)
+{
+	stream << '"';
+	for (const char* c = str; *c; c++)
+	{
+		if ((*c == '"') || (*c == '\\'))
+			stream << '\\';
+		stream << *c;
+	}
+	stream << '"';
+}
+
+// WriteJsonStats
+static void WriteJsonStats(std::ostream& stream, const VulkanHelpers::VulkanProfileStats& stats)
+{
+	stream << "{\"count\":" << stats.mCount << ",\"avg\":" << stats.mAverage << ",\"min\":" << stats.mMin
+		<< ",\"p50\":" << stats.mP50 << ",\"p95\":" << stats.mP95 << ",\"p99\":" << stats.mP99 << ",\"max\":" << stats.mMax << "}";
+}
+
+// Initialize
+void CBenchApp::Initialize(uint32_t width, uint32_t height)
+{
+	// no validation layers and surface extensions (layers would be measured too)
+	std::vector<const char *> enabledInstanceLayerNames{};
+	std::vector<const char *> enabledInstanceExtensionNames{};
+	mInstanceInfo.Initialize("Vulkan bench", VK_MAKE_VERSION(1, 0, 1), "Vulkan Engine", VK_MAKE_VERSION(1, 0, 1), enabledInstanceLayerNames, enabledInstanceExtensionNames, VK_API_VERSION_1_1);
+	assert(mInstanceInfo.mInstance);
+	assert(mInstanceInfo.mPhysicalDeviceGPU);
+
+	// VkPhysicalDeviceFeatures (only supported ones)
+	VkPhysicalDeviceFeatures supportedFeatures{};
+	vkGetPhysicalDeviceFeatures(mInstanceInfo.mPhysicalDeviceGPU, &supportedFeatures);
+	VkPhysicalDeviceFeatures physicalDeviceFeatures{};
+	physicalDeviceFeatures.samplerAnisotropy = supportedFeatures.samplerAnisotropy;
+
+	// any device (lavapipe too)
+	std::vector<const char *> enabledDeviceExtensionNames{};
+	mDeviceInfo.Initialize(mInstanceInfo.mPhysicalDeviceGPU, VK_NULL_HANDLE, physicalDeviceFeatures, enabledDeviceExtensionNames);
+	assert(mDeviceInfo.mDevice);
+
+	// offscreen images without readback (one per frame in flight)
+	mOffscreenInfo.Initialize(mDeviceInfo, width, height, mFramesInFlight, false);
+
+	// base pipeline
+	mPipelineInfo.Initialize(mDeviceInfo, mOffscreenInfo.mRenderPass, (mShaderDirectory + "base.vert.spv").c_str(), (mShaderDirectory + "base.frag.spv").c_str());
+	assert(mPipelineInfo.mPipeline);
+
+	mFrameRingInfo.Initialize(mDeviceInfo, mFramesInFlight);
+	mProfilerInfo.Initialize(mDeviceInfo, mFramesInFlight, BENCH_EVENT_CAPACITY);
+	mDeviceInfo.mProfilerInfo = &mProfilerInfo;
+
+	mSampler = mDeviceInfo.CreateSampler(VK_FILTER_LINEAR, VK_SAMPLER_ADDRESS_MODE_REPEAT);
+	assert(mSampler);
+
+	// camera looks at grid of objects in XY plane
+	DirectX::XMMATRIX matView = DirectX::XMMatrixLookAtRH(
+		DirectX::XMVectorSet(0.0f, 0.0f, 40.0f, 1.0f),
+		DirectX::XMVectorSet(0.0f, 0.0f, 0.0f, 1.0f),
+		DirectX::XMVectorSet(0.0f, 1.0f, 0.0f, 1.0f));
+	DirectX::XMMATRIX matProj = DirectX::XMMatrixPerspectiveFovRH(DirectX::XMConvertToRadians(45.0f), (float)width / height, 1.0f, 1000.0f);
+	mViewProj = matView * matProj;
+	mProjScale = DirectX::XMVectorGetY(matProj.r[1]);
+}
+
+// DeInitialize
+void CBenchApp::DeInitialize()
+{
+	mFrameRingInfo.WaitIdle();
+	vkDestroySampler(mDeviceInfo.mDevice, mSampler, VK_NULL_HANDLE);
+	mDeviceInfo.mProfilerInfo = nullptr;
+	mProfilerInfo.DeInitialize();
+	mFrameRingInfo.DeInitialize();
+	mPipelineInfo.DeInitialize();
+	mOffscreenInfo.DeInitialize();
+	mDeviceInfo.DeInitialize();
+	mInstanceInfo.DeInitialize();
+}
+
+// MeasurePipelineCreation
+VulkanHelpers::VulkanProfileStats CBenchApp::MeasurePipelineCreation(uint32_t repeatCount)
+{
+	// fresh rings, only pipeline scopes are recorded
+	mProfilerInfo.DeInitialize();
+	mProfilerInfo.Initialize(mDeviceInfo, mFramesInFlight, BENCH_EVENT_CAPACITY);
+
+	for (uint32_t i = 0; i < repeatCount; i++)
+	{
+		VulkanHelpers::VulkanPipelineInfo pipelineInfo;
+		double beginTime = mProfilerInfo.GetTime();
+		pipelineInfo.Initialize(mDeviceInfo, mOffscreenInfo.mRenderPass, (mShaderDirectory + "base.vert.spv").c_str(), (mShaderDirectory + "base.frag.spv").c_str());
+		mProfilerInfo.AddCpuScope("PipelineCreate", beginTime, mProfilerInfo.GetTime());
+		assert(pipelineInfo.mPipeline);
+		pipelineInfo.DeInitialize();
+	}
+	return mProfilerInfo.GetScopeStats("PipelineCreate", false);
+}
+
+// MeasurePipelineCacheStartup
+CBenchPipelineCacheResult CBenchApp::MeasurePipelineCacheStartup(uint32_t repeatCount, const char* fileName)
+{
+	// fresh rings, only pipeline scopes are recorded
+	mProfilerInfo.DeInitialize();
+	mProfilerInfo.Initialize(mDeviceInfo, mFramesInFlight, BENCH_EVENT_CAPACITY);
+
+	for (uint32_t i = 0; i < repeatCount; i++)
+	{
+		// cold start writes cache file, warm start loads it, both create new VkPipelineCache
+		// (cold one is empty, internal shader cache of driver is not cleared, so cold is lower bound of real cold start)
+		std::remove(fileName);
+		for (const char* scopeName : { "PipelineCreateCold", "PipelineCreateWarm" })
+		{
+			VulkanHelpers::VulkanPipelineCacheInfo pipelineCacheInfo;
+			pipelineCacheInfo.Initialize(mDeviceInfo, fileName);
+			mDeviceInfo.mPipelineCacheInfo = &pipelineCacheInfo;
+
+			VulkanHelpers::VulkanPipelineInfo pipelineInfo;
+			double beginTime = mProfilerInfo.GetTime();
+			pipelineInfo.Initialize(mDeviceInfo, mOffscreenInfo.mRenderPass, (mShaderDirectory + "base.vert.spv").c_str(), (mShaderDirectory + "base.frag.spv").c_str());
+			mProfilerInfo.AddCpuScope(scopeName, beginTime, mProfilerInfo.GetTime());
+			assert(pipelineInfo.mPipeline);
+			pipelineInfo.DeInitialize();
+
+			mDeviceInfo.mPipelineCacheInfo = nullptr;
+			pipelineCacheInfo.DeInitialize();
+		}
+	}
+	std::remove(fileName);
+
+	// CBenchPipelineCacheResult
+	CBenchPipelineCacheResult result{};
+	result.mCold = mProfilerInfo.GetScopeStats("PipelineCreateCold", false);
+	result.mWarm = mProfilerInfo.GetScopeStats("PipelineCreateWarm", false);
+	return result;
+}
+
+// RunScene
+CBenchResult CBenchApp::RunScene(CBenchScene& scene, uint32_t seed, uint32_t objectCount, uint32_t warmupFrameCount, uint32_t frameCount)
+{
+	assert(frameCount);
+
+	// fresh rings (one frame sample per measured frame)
+	mProfilerInfo.DeInitialize();
+	mProfilerInfo.Initialize(mDeviceInfo, mFramesInFlight, BENCH_EVENT_CAPACITY, frameCount);
+
+	// CBenchResult
+	CBenchResult result{};
+	result.mName = scene.GetName();
+	result.mObjectCount = objectCount;
+	result.mFrameCount = frameCount;
+
+	// create scene (every scene gets its own generator, so scenes do not depend on each other)
+	std::mt19937 random(seed);
+	mUploadBytes = 0;
+	mUploadTime = 0.0;
+	double setupBeginTime = mProfilerInfo.GetTime();
+	scene.Initialize(*this, random, objectCount);
+	result.mSetupTime = (mProfilerInfo.GetTime() - setupBeginTime) / 1000.0;
+	result.mSetupUploadBytes = mUploadBytes;
+	result.mSetupUploadThroughput = (mUploadTime > 0.0) ? mUploadBytes / (mUploadTime / 1000000.0) : 0.0;
+
+	// warmup frames are not recorded (animation time is fixed step, results do not depend on frame rate)
+	mProfilerInfo.mEnabled = false;
+	for (uint32_t i = 0; i < warmupFrameCount; i++)
+		RenderFrame(scene, i / 60.0f);
+	mProfilerInfo.mEnabled = true;
+
+	// measured frames
+	mUploadBytes = 0;
+	mUploadTime = 0.0;
+	for (uint32_t i = 0; i < frameCount; i++)
+		RenderFrame(scene, (warmupFrameCount + i) / 60.0f);
+	result.mDrawCount = mDrawCount;
+	result.mFrameUploadBytes = mUploadBytes;
+	result.mFrameUploadThroughput = (mUploadTime > 0.0) ? mUploadBytes / (mUploadTime / 1000000.0) : 0.0;
+
+	// GPU timestamps of last frames
+	mFrameRingInfo.WaitIdle();
+	for (uint32_t i = 0; i < mFramesInFlight; i++)
+		mProfilerInfo.CollectGpuSlot(i);
+
+	// stats
+	result.mCpuFrame = mProfilerInfo.GetFrameStats(false);
+	result.mGpuFrame = mProfilerInfo.GetFrameStats(true);
+	result.mUpdate = mProfilerInfo.GetScopeStats("Update", false);
+	result.mRecord = mProfilerInfo.GetScopeStats("Record", false);
+	result.mSubmit = mProfilerInfo.GetScopeStats("Submit", false);
+
+	scene.DeInitialize(*this);
+	return result;
+}
+
+// RenderFrame
+void CBenchApp::RenderFrame(CBenchScene& scene, float time)
+{
+	uint64_t frameNumber = mFrameRingInfo.mFrameNumber;
+	mProfilerInfo.BeginFrame(frameNumber);
+
+	// begin frame (frame resources and its profiler slot are free after this)
+	VulkanHelpers::VulkanFrameInfo& frame = mFrameRingInfo.BeginFrame();
+	VkFramebuffer framebuffer = VK_NULL_HANDLE;
+	VK_CHECK(mOffscreenInfo.BeginFrame(frame.mImageAvailableSemaphore, framebuffer));
+	uint32_t frameIndex = mFrameRingInfo.mFrameIndex;
+	mProfilerInfo.CollectGpuSlot(frameIndex);
+
+	// update scene
+	{
+		VulkanHelpers::VulkanCpuScope scope(mProfilerInfo, "Update");
+		scene.Update(*this, frameIndex, time);
+	}
+
+	// record
+	double recordBeginTime = mProfilerInfo.GetTime();
+	VkCommandBuffer commandBuffer = frame.mCommandBuffer;
+
+	// VkCommandBufferBeginInfo
+	VkCommandBufferBeginInfo commandBufferBeginInfo{};
+	commandBufferBeginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+	commandBufferBeginInfo.pNext = VK_NULL_HANDLE;
+	commandBufferBeginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+	commandBufferBeginInfo.pInheritanceInfo = nullptr;
+	VK_CHECK(vkBeginCommandBuffer(commandBuffer, &commandBufferBeginInfo));
+	mProfilerInfo.ResetGpuSlot(commandBuffer, frameIndex);
+
+	// VkClearValue
+	VkClearValue clearColors[2];
+	clearColors[0].color = { 0.0f, 0.125f, 0.3f, 1.0f };
+	clearColors[1].depthStencil.depth = 1.0f;
+	clearColors[1].depthStencil.stencil = 0;
+
+	// VkRenderPassBeginInfo
+	VkRenderPassBeginInfo renderPassBeginInfo{};
+	renderPassBeginInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
+	renderPassBeginInfo.renderPass = mOffscreenInfo.mRenderPass;
+	renderPassBeginInfo.framebuffer = framebuffer;
+	renderPassBeginInfo.renderArea.offset = { 0, 0 };
+	renderPassBeginInfo.renderArea.extent = GetExtent();
+	renderPassBeginInfo.clearValueCount = 2;
+	renderPassBeginInfo.pClearValues = clearColors;
+
+	// VkViewport (flipped, as in application)
+	VkViewport viewport{};
+	viewport.x = 0.0f;
+	viewport.y = (float)mOffscreenInfo.mViewportHeight;
+	viewport.width = (float)mOffscreenInfo.mViewportWidth;
+	viewport.height = -(float)mOffscreenInfo.mViewportHeight;
+	viewport.minDepth = 0.0f;
+	viewport.maxDepth = 1.0f;
+
+	// VkRect2D - scissor
+	VkRect2D scissor{};
+	scissor.offset = { 0, 0 };
+	scissor.extent = GetExtent();
+
+	// render pass with scene draws
+	uint32_t renderPassScope = mProfilerInfo.BeginGpuScope(commandBuffer, frameIndex, "RenderPass");
+	vkCmdBeginRenderPass(commandBuffer, &renderPassBeginInfo, VK_SUBPASS_CONTENTS_INLINE);
+	vkCmdSetViewport(commandBuffer, 0, 1, &viewport);
+	vkCmdSetScissor(commandBuffer, 0, 1, &scissor);
+	vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, mPipelineInfo.mPipeline);
+	mDrawCount = scene.Record(*this, commandBuffer, frameIndex);
+	vkCmdEndRenderPass(commandBuffer);
+	mProfilerInfo.EndGpuScope(commandBuffer, frameIndex, renderPassScope);
+	VK_CHECK(vkEndCommandBuffer(commandBuffer));
+	mProfilerInfo.AddCpuScope("Record", recordBeginTime, mProfilerInfo.GetTime());
+
+	// submit
+	{
+		VulkanHelpers::VulkanCpuScope scope(mProfilerInfo, "Submit");
+		mFrameRingInfo.EndFrame(mDeviceInfo.mQueueGraphics, VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT, commandBuffer);
+		mProfilerInfo.SubmitGpuSlot(frameIndex, frameNumber);
+	}
+
+	VK_CHECK(mOffscreenInfo.EndFrame(frame.mRenderFinishedSemaphore));
+	mProfilerInfo.EndFrame();
+}
+
+// UploadBuffer (create device local buffer)
+void CBenchApp::UploadBuffer(const void* data, VkDeviceSize size, VkBufferUsageFlags usage, VkBuffer& buffer, VmaAllocation& allocation)
+{
+	double beginTime = mProfilerInfo.GetTime();
+	mDeviceInfo.CreateBuffer(data, size, usage, buffer, allocation);
+	assert(buffer);
+	mUploadTime += mProfilerInfo.GetTime() - beginTime;
+	mUploadBytes += size;
+}
+
+// UploadBuffer (write existing buffer)
+void CBenchApp::UploadBuffer(const void* data, VkDeviceSize size, VkBuffer buffer, VmaAllocation& allocation)
+{
+	double beginTime = mProfilerInfo.GetTime();
+	mDeviceInfo.WriteBuffer(data, size, buffer, allocation);
+	mUploadTime += mProfilerInfo.GetTime() - beginTime;
+	mUploadBytes += size;
+}
+
+// UploadImage (create sampled RGBA8 image and its view)
+void CBenchApp::UploadImage(const void* data, uint32_t width, uint32_t height, VkImage& image, VmaAllocation& allocation, VkImageView& imageView)
+{
+	double beginTime = mProfilerInfo.GetTime();
+	mDeviceInfo.CreateImage(data, width, height, 1, 1, VK_FORMAT_R8G8B8A8_UNORM, VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT, 0, image, allocation);
+	assert(image);
+	imageView = mDeviceInfo.CreateImageView(image, VK_FORMAT_R8G8B8A8_UNORM, VK_IMAGE_ASPECT_COLOR_BIT);
+	assert(imageView);
+	mUploadTime += mProfilerInfo.GetTime() - beginTime;
+	mUploadBytes += (uint64_t)width * height * 4;
+}
+
+// UploadImage (write existing RGBA8 image, it must not be in use)
+void CBenchApp::UploadImage(const void* data, uint32_t width, uint32_t height, VkImage image)
+{
+	double beginTime = mProfilerInfo.GetTime();
+	mDeviceInfo.WriteImage(data, width, height, 1, 1, VK_FORMAT_R8G8B8A8_UNORM, image);
+	mUploadTime += mProfilerInfo.GetTime() - beginTime;
+	mUploadBytes += (uint64_t)width * height * 4;
+}
+
+// CreateDescriptorPool
+VkDescriptorPool CBenchApp::CreateDescriptorPool(uint32_t setCount)
+{
+	// VkDescriptorPoolSize
+	std::array<VkDescriptorPoolSize, 2> descriptorPoolSizes{};
+	descriptorPoolSizes[0].type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+	descriptorPoolSizes[0].descriptorCount = setCount;
+	descriptorPoolSizes[1].type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
+	descriptorPoolSizes[1].descriptorCount = setCount;
+
+	// VkDescriptorPoolCreateInfo
+	VkDescriptorPoolCreateInfo descriptorPoolCreateInfo{};
+	descriptorPoolCreateInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+	descriptorPoolCreateInfo.pNext = VK_NULL_HANDLE;
+	descriptorPoolCreateInfo.flags = 0;
+	descriptorPoolCreateInfo.maxSets = setCount;
+	descriptorPoolCreateInfo.poolSizeCount = (uint32_t)descriptorPoolSizes.size();
+	descriptorPoolCreateInfo.pPoolSizes = descriptorPoolSizes.data();
+
+	// vkCreateDescriptorPool
+	VkDescriptorPool descriptorPool = VK_NULL_HANDLE;
+	VK_CHECK(vkCreateDescriptorPool(mDeviceInfo.mDevice, &descriptorPoolCreateInfo, VK_NULL_HANDLE, &descriptorPool));
+	return descriptorPool;
+}
+
+// AllocateDescriptorSet
+VkDescriptorSet CBenchApp::AllocateDescriptorSet(VkDescriptorPool descriptorPool)
+{
+	// VkDescriptorSetAllocateInfo
+	VkDescriptorSetAllocateInfo descriptorSetAllocateInfo{};
+	descriptorSetAllocateInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+	descriptorSetAllocateInfo.pNext = VK_NULL_HANDLE;
+	descriptorSetAllocateInfo.descriptorPool = descriptorPool;
+	descriptorSetAllocateInfo.descriptorSetCount = 1;
+	descriptorSetAllocateInfo.pSetLayouts = &mPipelineInfo.mDescriptorSetLayout;
+
+	// vkAllocateDescriptorSets
+	VkDescriptorSet descriptorSet = VK_NULL_HANDLE;
+	VK_CHECK(vkAllocateDescriptorSets(mDeviceInfo.mDevice, &descriptorSetAllocateInfo, &descriptorSet));
+	return descriptorSet;
+}
+
+// WriteDescriptorSet (texture and dynamic uniform slot with one matrix)
+void CBenchApp::WriteDescriptorSet(VkDescriptorSet descriptorSet, VkImageView imageView, VkBuffer uniformBuffer)
+{
+	// VkDescriptorImageInfo
+	VkDescriptorImageInfo descriptorImageInfo{};
+	descriptorImageInfo.sampler = mSampler;
+	descriptorImageInfo.imageView = imageView;
+	descriptorImageInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+
+	// VkDescriptorBufferInfo
+	VkDescriptorBufferInfo descriptorBufferInfo{};
+	descriptorBufferInfo.buffer = uniformBuffer;
+	descriptorBufferInfo.offset = 0;
+	descriptorBufferInfo.range = sizeof(DirectX::XMMATRIX);
+
+	// VkWriteDescriptorSet
+	std::array<VkWriteDescriptorSet, 2> writeDescriptorSets{};
+	writeDescriptorSets[0].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+	writeDescriptorSets[0].dstSet = descriptorSet;
+	writeDescriptorSets[0].dstBinding = 0;
+	writeDescriptorSets[0].descriptorCount = 1;
+	writeDescriptorSets[0].descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+	writeDescriptorSets[0].pImageInfo = &descriptorImageInfo;
+	writeDescriptorSets[1].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+	writeDescriptorSets[1].dstSet = descriptorSet;
+	writeDescriptorSets[1].dstBinding = 1;
+	writeDescriptorSets[1].descriptorCount = 1;
+	writeDescriptorSets[1].descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
+	writeDescriptorSets[1].pBufferInfo = &descriptorBufferInfo;
+	vkUpdateDescriptorSets(mDeviceInfo.mDevice, (uint32_t)writeDescriptorSets.size(), writeDescriptorSets.data(), 0, nullptr);
+}
+
+// GetUniformSlotSize (one matrix, dynamic offsets must be aligned)
+VkDeviceSize CBenchApp::GetUniformSlotSize() const
+{
+	VkDeviceSize uniformAlignment = mDeviceInfo.mDeviceProperties.limits.minUniformBufferOffsetAlignment;
+	return (sizeof(DirectX::XMMATRIX) + uniformAlignment - 1) / uniformAlignment * uniformAlignment;
+}
+
+// WriteJson
+bool CBenchApp::WriteJson(const char* fileName, uint32_t seed, const VulkanHelpers::VulkanProfileStats& pipelineStats, const CBenchPipelineCacheResult& pipelineCacheResult,
+	const std::vector<CBenchResult>& results, const std::vector<CBenchResultMicro>& microResults) const
+{
+	std::ofstream file(fileName, std::ios::out | std::ios::trunc);
+	if (!file.is_open())
+		return false;
+
+	// device and run parameters
+	const VkPhysicalDeviceProperties& properties = mDeviceInfo.mDeviceProperties;
+	file << "{\n\"device\":{\"name\":";
+	WriteJsonString(file, properties.deviceName);
+	file << ",\"vendorID\":" << properties.vendorID << ",\"deviceID\":" << properties.deviceID
+		<< ",\"deviceType\":" << properties.deviceType << ",\"driverVersion\":" << properties.driverVersion
+		<< ",\"apiVersion\":\"" << VK_VERSION_MAJOR(properties.apiVersion) << "." << VK_VERSION_MINOR(properties.apiVersion) << "." << VK_VERSION_PATCH(properties.apiVersion) << "\"},\n";
+	file << "\"seed\":" << seed << ",\"width\":" << mOffscreenInfo.mViewportWidth << ",\"height\":" << mOffscreenInfo.mViewportHeight
+		<< ",\"framesInFlight\":" << mFramesInFlight << ",\n";
+
+	// milliseconds
+	file.precision(4);
+	file << std::fixed;
+	file << "\"pipelineCreation\":";
+	WriteJsonStats(file, pipelineStats);
+	file << ",\n\"pipelineCache\":{\"cold\":";
+	WriteJsonStats(file, pipelineCacheResult.mCold);
+	file << ",\"warm\":";
+	WriteJsonStats(file, pipelineCacheResult.mWarm);
+	file << "},\n\"scenarios\":[";
+
+	// scenarios
+	for (size_t i = 0; i < results.size(); i++)
+	{
+		const CBenchResult& result = results[i];
+		file << (i ? ",\n" : "\n") << "{\"name\":";
+		WriteJsonString(file, result.mName.c_str());
+		file << ",\"objects\":" << result.mObjectCount << ",\"frames\":" << result.mFrameCount << ",\"draws\":" << result.mDrawCount;
+		file << ",\n \"cpuFrame\":"; WriteJsonStats(file, result.mCpuFrame);
+		file << ",\n \"gpuFrame\":"; WriteJsonStats(file, result.mGpuFrame);
+		file << ",\n \"update\":"; WriteJsonStats(file, result.mUpdate);
+		file << ",\n \"record\":"; WriteJsonStats(file, result.mRecord);
+		file << ",\n \"submit\":"; WriteJsonStats(file, result.mSubmit);
+		file << ",\n \"setup\":{\"time\":" << result.mSetupTime << ",\"uploadBytes\":" << result.mSetupUploadBytes
+			<< ",\"uploadBytesPerSecond\":" << result.mSetupUploadThroughput << "}";
+		file << ",\n \"frameUploads\":{\"bytes\":" << result.mFrameUploadBytes
+			<< ",\"bytesPerSecond\":" << result.mFrameUploadThroughput << "}}";
+	}
+
+	// microbenchmarks (microseconds per call)
+	file << "\n],\n\"microbenchmarks\":[";
+	for (size_t i = 0; i < microResults.size(); i++)
+	{
+		const CBenchResultMicro& result = microResults[i];
+		file << (i ? ",\n" : "\n") << "{\"name\":";
+		WriteJsonString(file, result.mName.c_str());
+		file << ",\"arg\":" << result.mArg << ",\"unit\":\"us\",\"stats\":";
+		WriteJsonStats(file, result.mStats);
+		file << ",\"bytesPerSecond\":" << result.mBytesPerSecond << ",\"valid\":" << (result.mError.empty() ? "true" : "false") << "}";
+	}
+	file << "\n]}\n";
+	return file.good();
+}
@@ -0,0 +1,139 @@
+#pragma once
+
+#include <DirectXMath.h>
+#include <random>
+#include <string>
+#include "BenchHarness.hpp"
+#include "../vulkan/vkutils/VulkanHelpers.hpp"
+#include "../vulkan/vkutils/VulkanFrameRing.hpp"
+#include "../vulkan/vkutils/VulkanProfiler.hpp"
+#include "../vulkan/vkutils/VulkanOffscreen.hpp"
+#include "../vulkan/vkutils/VulkanPipelineCache.hpp"
+
+// bench vertex (matches base.vert.glsl attributes)
+struct CBenchVertex { float X, Y, Z, W; float R, G, B, A; float U, V; };
+
+// CBenchResult (times in milliseconds, throughput in bytes per second)
+struct CBenchResult
+{
+	std::string mName{};
+	uint32_t    mObjectCount = 0;
+	uint32_t    mFrameCount = 0;
+	uint32_t    mDrawCount = 0; // per frame
+
+	// frame timings
+	VulkanHelpers::VulkanProfileStats mCpuFrame{};
+	VulkanHelpers::VulkanProfileStats mGpuFrame{};
+	VulkanHelpers::VulkanProfileStats mUpdate{};
+	VulkanHelpers::VulkanProfileStats mRecord{};
+	VulkanHelpers::VulkanProfileStats mSubmit{};
+
+	// scene creation and uploads (setup and per frame)
+	double   mSetupTime = 0.0;
+	uint64_t mSetupUploadBytes = 0;
+	double   mSetupUploadThroughput = 0.0;
+	uint64_t mFrameUploadBytes = 0;
+	double   mFrameUploadThroughput = 0.0;
+};
+
+// CBenchPipelineCacheResult (pipeline creation with empty and loaded on-disk cache, milliseconds)
+struct CBenchPipelineCacheResult
+{
+	VulkanHelpers::VulkanProfileStats mCold{};
+	VulkanHelpers::VulkanProfileStats mWarm{};
+};
+
+class CBenchApp;
+
+// CBenchScene
+// procedurally generated scene, all random values come from generator seeded by bench
+class CBenchScene
+{
+public:
+	virtual ~CBenchScene() {};
+
+	// scenario name (JSON key)
+	virtual const char* GetName() const = 0;
+
+	// Init/DeInit (uploads must go through CBenchApp upload functions to be measured)
+	virtual void Initialize(CBenchApp& app, std::mt19937& random, uint32_t objectCount) = 0;
+	virtual void DeInitialize(CBenchApp& app) = 0;
+
+	// Update (resources of frameIndex are not used by GPU anymore)
+	virtual void Update(CBenchApp& app, uint32_t frameIndex, float time) = 0;
+	// Record draws inside render pass, returns draw count
+	virtual uint32_t Record(CBenchApp& app, VkCommandBuffer commandBuffer, uint32_t frameIndex) = 0;
+};
+
+// CBenchApp
+// headless device, offscreen render target, base pipeline and frame ring shared by scenes
+class CBenchApp
+{
+private:
+	// vulkan handle holders
+	VulkanHelpers::VulkanInstanceInfo mInstanceInfo;
+
+	// upload counters (reset per scene phase)
+	uint64_t mUploadBytes = 0;
+	double   mUploadTime = 0.0;
+
+	// draws recorded in last frame
+	uint32_t mDrawCount = 0;
+
+	// run frame of scene
+	void RenderFrame(CBenchScene& scene, float time);
+public:
+	// vulkan handle holders
+	VulkanHelpers::VulkanDeviceInfo    mDeviceInfo;
+	VulkanHelpers::VulkanOffscreenInfo mOffscreenInfo;
+	VulkanHelpers::VulkanPipelineInfo  mPipelineInfo;
+	VulkanHelpers::VulkanFrameRingInfo mFrameRingInfo;
+	VulkanHelpers::VulkanProfilerInfo  mProfilerInfo;
+
+	// shared sampler
+	VkSampler mSampler = VK_NULL_HANDLE;
+
+	// frames CPU can record ahead of GPU
+	uint32_t mFramesInFlight = 2;
+
+	// shader directory (base.vert.spv and base.frag.spv)
+	std::string mShaderDirectory = "../vulkan/shaders/";
+
+	// camera (fixed for all scenes), projection[1][1] gives projected sizes
+	DirectX::XMMATRIX mViewProj{};
+	float             mProjScale = 1.0f;
+public:
+	CBenchApp() {};
+	virtual ~CBenchApp() {};
+
+	// Init/DeInit functions
+	void Initialize(uint32_t width, uint32_t height);
+	void DeInitialize();
+
+	// MeasurePipelineCreation (creates base pipeline repeatCount times, shader modules are loaded every time)
+	VulkanHelpers::VulkanProfileStats MeasurePipelineCreation(uint32_t repeatCount);
+	// MeasurePipelineCacheStartup (cold - cache file removed, warm - cache file written by cold run)
+	CBenchPipelineCacheResult MeasurePipelineCacheStartup(uint32_t repeatCount, const char* fileName);
+	// RunScene (same seed gives same scene on every run)
+	CBenchResult RunScene(CBenchScene& scene, uint32_t seed, uint32_t objectCount, uint32_t warmupFrameCount, uint32_t frameCount);
+
+	// upload functions for scenes (timed and counted, all of them wait for transfer)
+	void UploadBuffer(const void* data, VkDeviceSize size, VkBufferUsageFlags usage, VkBuffer& buffer, VmaAllocation& allocation);
+	void UploadBuffer(const void* data, VkDeviceSize size, VkBuffer buffer, VmaAllocation& allocation);
+	void UploadImage(const void* data, uint32_t width, uint32_t height, VkImage& image, VmaAllocation& allocation, VkImageView& imageView);
+	void UploadImage(const void* data, uint32_t width, uint32_t height, VkImage image);
+
+	// descriptor functions for scenes (sets use layout of base pipeline)
+	VkDescriptorPool CreateDescriptorPool(uint32_t setCount);
+	VkDescriptorSet AllocateDescriptorSet(VkDescriptorPool descriptorPool);
+	void WriteDescriptorSet(VkDescriptorSet descriptorSet, VkImageView imageView, VkBuffer uniformBuffer);
+
+	// get functions
+	VkDeviceSize GetUniformSlotSize() const;
+	VkExtent2D GetExtent() const { return { mOffscreenInfo.mViewportWidth, mOffscreenInfo.mViewportHeight }; }
+	const char* GetDeviceName() const { return mDeviceInfo.mDeviceProperties.deviceName; }
+
+	// WriteJson (machine readable results of scenes and microbenchmarks)
+	bool WriteJson(const char* fileName, uint32_t seed, const VulkanHelpers::VulkanProfileStats& pipelineStats, const CBenchPipelineCacheResult& pipelineCacheResult,
+		const std::vector<CBenchResult>& results, const std::vector<CBenchResultMicro>& microResults) const;
+};
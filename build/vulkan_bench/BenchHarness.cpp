@@ -0,0 +1,129 @@
+#include "BenchHarness.hpp"
+#include <iostream>
+#include <iomanip>
+#include <cassert>
+#include <algorithm>
+
+//////////////////////////////////////////////////////////////////////////
+// CBenchState
+//////////////////////////////////////////////////////////////////////////
+
+// KeepRunning
+bool CBenchState::KeepRunning()
+{
+	// close previous iteration
+	Clock::time_point time = Clock::now();
+	if (mIteration > 0)
+	{
+		if (!mPaused)
+			mIterationTime += std::chrono::duration<double, std::micro>(time - mBeginTime).count();
+		mSamples.push_back(mIterationTime);
+	}
+
+	// start next iteration
+	if (mIteration == mIterationCount)
+		return false;
+	mIteration++;
+	mIterationTime = 0.0;
+	mPaused = false;
+	mBeginTime = Clock::now();
+	return true;
+}
+
+// PauseTiming
+void CBenchState::PauseTiming()
+{
+	assert(!mPaused);
+	mIterationTime += std::chrono::duration<double, std::micro>(Clock::now() - mBeginTime).count();
+	mPaused = true;
+}
+
+// ResumeTiming
+void CBenchState::ResumeTiming()
+{
+	assert(mPaused);
+	mPaused = false;
+	mBeginTime = Clock::now();
+}
+
+//////////////////////////////////////////////////////////////////////////
+// CBenchRegistry
+//////////////////////////////////////////////////////////////////////////
+
+// Register
+CBenchRegistry& CBenchRegistry::Register(const char* name, BenchFunction function)
+{
+	CBenchDefinition definition{};
+	definition.mName = name;
+	definition.mFunction = function;
+	mDefinitions.push_back(definition);
+	return *this;
+}
+
+// Arg
+CBenchRegistry& CBenchRegistry::Arg(int64_t arg)
+{
+	assert(!mDefinitions.empty());
+	mDefinitions.back().mArgs.push_back(arg);
+	return *this;
+}
+
+// Range
+CBenchRegistry& CBenchRegistry::Range(int64_t minArg, int64_t maxArg, int64_t multiplier)
+{
+	assert(minArg > 0);
+	assert(multiplier > 1);
+	for (int64_t arg = minArg; arg <= maxArg; arg *= multiplier)
+		Arg(arg);
+	return *this;
+}
+
+// Run
+std::vector<CBenchResultMicro> CBenchRegistry::Run(CBenchApp& app, const std::string& filter) const
+{
+	std::vector<CBenchResultMicro> results;
+	for (const auto& definition : mDefinitions)
+	{
+		if (!filter.empty() && (definition.mName.find(filter) == std::string::npos))
+			continue;
+
+		// benchmarks without arguments run once with 0
+		std::vector<int64_t> args = definition.mArgs;
+		if (args.empty())
+			args.push_back(0);
+		for (int64_t arg : args)
+		{
+			// single iteration estimates time (it is warmup too)
+			CBenchState estimateState(1, arg);
+			definition.mFunction(app, estimateState);
+			double estimate = std::max(estimateState.GetSamples().empty() ? 0.0 : estimateState.GetSamples()[0], 1.0);
+			uint64_t iterationCount = std::min<uint64_t>(std::max<uint64_t>((uint64_t)(mMinTime * 1000000.0 / estimate), 1), mMaxIterations);
+
+			// measured run
+			CBenchState state(iterationCount, arg);
+			definition.mFunction(app, state);
+
+			// CBenchResultMicro
+			CBenchResultMicro result{};
+			result.mName = definition.mName;
+			result.mArg = arg;
+			std::vector<double> samples = state.GetSamples();
+			result.mStats = VulkanHelpers::GetProfileStats(samples);
+			result.mError = estimateState.GetError().empty() ? state.GetError() : estimateState.GetError();
+			if (state.mBytesPerIteration && (result.mStats.mP50 > 0.0))
+				result.mBytesPerSecond = state.mBytesPerIteration / (result.mStats.mP50 / 1000000.0);
+			results.push_back(result);
+
+			// console line (Google Benchmark like)
+			std::cout << std::left << std::setw(40) << (definition.mName + "/" + std::to_string(arg)) << std::right
+				<< " p50 " << std::setw(10) << result.mStats.mP50 << " us, p99 " << std::setw(10) << result.mStats.mP99
+				<< " us, " << std::setw(6) << result.mStats.mCount << " iterations";
+			if (result.mBytesPerSecond > 0.0)
+				std::cout << ", " << result.mBytesPerSecond / (1024.0 * 1024.0) << " MB/s";
+			if (!result.mError.empty())
+				std::cout << ", FAILED: " << result.mError;
+			std::cout << std::endl;
+		}
+	}
+	return results;
+}
@@ -0,0 +1,101 @@
+#pragma once
+
+#include <chrono>
+#include <string>
+#include <vector>
+#include <functional>
+#include <cstdint>
+#include "../vulkan/vkutils/VulkanProfiler.hpp"
+
+class CBenchApp;
+
+// CBenchState
+// Google Benchmark style loop state: while (state.KeepRunning()) { ... },
+// every iteration is timed separately, so results are latency distributions
+class CBenchState
+{
+private:
+	using Clock = std::chrono::high_resolution_clock;
+
+	// iterations
+	uint64_t mIterationCount = 0;
+	uint64_t mIteration = 0;
+
+	// timing of current iteration (paused parts are excluded)
+	Clock::time_point mBeginTime{};
+	double            mIterationTime = 0.0;
+	bool              mPaused = false;
+
+	// samples of finished iterations
+	std::vector<double> mSamples{};
+
+	// validation error (empty - results are valid)
+	std::string mError{};
+public:
+	// argument of run (buffer size, image resolution, ...)
+	int64_t mArg = 0;
+
+	// bytes processed per iteration (0 - not applicable)
+	uint64_t mBytesPerIteration = 0;
+
+	CBenchState(uint64_t iterationCount, int64_t arg) : mIterationCount(iterationCount), mArg(arg) { mSamples.reserve((size_t)iterationCount); }
+
+	// KeepRunning (closes previous iteration, returns false when all iterations are done)
+	bool KeepRunning();
+
+	// exclude part of iteration (setup and cleanup of measured call)
+	void PauseTiming();
+	void ResumeTiming();
+
+	// SetError (results of benchmark do not match reference, run fails)
+	void SetError(const std::string& error) { mError = error; }
+
+	// get functions
+	int64_t GetArg() const { return mArg; }
+	const std::vector<double>& GetSamples() const { return mSamples; }
+	const std::string& GetError() const { return mError; }
+};
+
+// CBenchResultMicro
+struct CBenchResultMicro
+{
+	std::string mName{};
+	int64_t     mArg = 0;
+	VulkanHelpers::VulkanProfileStats mStats{}; // microseconds per iteration
+	double      mBytesPerSecond = 0.0; // by median iteration
+	std::string mError{};              // empty - results are valid
+};
+
+// CBenchRegistry
+// registered benchmarks run with every argument, iteration count is chosen to fill minimal time
+class CBenchRegistry
+{
+public:
+	using BenchFunction = std::function<void(CBenchApp& app, CBenchState& state)>;
+private:
+	// CBenchDefinition
+	struct CBenchDefinition
+	{
+		std::string          mName{};
+		BenchFunction        mFunction{};
+		std::vector<int64_t> mArgs{};
+	};
+
+	std::vector<CBenchDefinition> mDefinitions{};
+public:
+	// run settings
+	double   mMinTime = 0.25;       // seconds per benchmark and argument
+	uint64_t mMaxIterations = 10000;
+
+	// Register returns registry to add arguments to last registered benchmark
+	CBenchRegistry& Register(const char* name, BenchFunction function);
+	CBenchRegistry& Arg(int64_t arg);
+	// Range (arguments from minArg to maxArg, multiplied by multiplier)
+	CBenchRegistry& Range(int64_t minArg, int64_t maxArg, int64_t multiplier);
+
+	// Run (benchmarks whose name contains filter, empty filter runs all)
+	std::vector<CBenchResultMicro> Run(CBenchApp& app, const std::string& filter) const;
+};
+
+// RegisterMicroBenchmarks (VulkanHelpers primitives)
+void RegisterMicroBenchmarks(CBenchRegistry& registry, int64_t maxBufferSize);
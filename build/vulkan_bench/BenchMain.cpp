@@ -0,0 +1,131 @@
+#include <string>
+#include <memory>
+#include <cstring>
+#include <iostream>
+#include <algorithm>
+#include "BenchScenes.hpp"
+
+// headless benchmark (any Vulkan device, lavapipe too): scene-scale scenarios and microbenchmarks
+// of VulkanHelpers primitives, results are written to JSON
+// usage: vulkan_bench [--mode all|scenes|micro] [--seed N] [--frames N] [--warmup N] [--width N] [--height N]
+//                     [--count N] [--pipelines N] [--scenario quads|obj_instances|texture_heavy|upload_heavy]...
+//                     [--filter name] [--min-time seconds] [--max-size bytes] [--shaders dir/] [--output file.json]
+
+// CBenchScenario
+struct CBenchScenario
+{
+	std::unique_ptr<CBenchScene> mScene;
+	uint32_t                     mObjectCount;
+};
+
+// main
+int main(int argc, char* argv[])
+{
+	// default arguments
+	uint32_t seed = 1;
+	uint32_t frameCount = 300;
+	uint32_t warmupFrameCount = 30;
+	uint32_t width = 1280;
+	uint32_t height = 720;
+	uint32_t objectCount = 0; // 0 - scenario default
+	uint32_t pipelineCount = 20;
+	std::string shaderDirectory = "../vulkan/shaders/";
+	std::string outputFileName = "vulkan_bench.json";
+	std::vector<std::string> scenarioNames{};
+	std::string mode = "all";
+	std::string filter{};
+	double minTime = 0.25;
+	int64_t maxBufferSize = 256 * 1024 * 1024;
+
+	// parse arguments
+	for (int i = 1; i + 1 < argc; i += 2)
+	{
+		const char* name = argv[i];
+		const char* value = argv[i + 1];
+		if (strcmp(name, "--seed") == 0) seed = (uint32_t)std::stoul(value);
+		else if (strcmp(name, "--frames") == 0) frameCount = std::max((uint32_t)std::stoul(value), 1u);
+		else if (strcmp(name, "--warmup") == 0) warmupFrameCount = (uint32_t)std::stoul(value);
+		else if (strcmp(name, "--width") == 0) width = (uint32_t)std::stoul(value);
+		else if (strcmp(name, "--height") == 0) height = (uint32_t)std::stoul(value);
+		else if (strcmp(name, "--count") == 0) objectCount = (uint32_t)std::stoul(value);
+		else if (strcmp(name, "--pipelines") == 0) pipelineCount = (uint32_t)std::stoul(value);
+		else if (strcmp(name, "--scenario") == 0) scenarioNames.push_back(value);
+		else if (strcmp(name, "--shaders") == 0) shaderDirectory = value;
+		else if (strcmp(name, "--output") == 0) outputFileName = value;
+		else if (strcmp(name, "--mode") == 0) mode = value;
+		else if (strcmp(name, "--filter") == 0) filter = value;
+		else if (strcmp(name, "--min-time") == 0) minTime = std::stod(value);
+		else if (strcmp(name, "--max-size") == 0) maxBufferSize = std::stoll(value);
+		else {
+			std::cerr << "unknown argument " << name << std::endl;
+			return 1;
+		}
+	}
+
+	// scenarios with default object counts
+	std::vector<CBenchScenario> scenarios;
+	scenarios.push_back({ std::unique_ptr<CBenchScene>(new CBenchSceneQuads()), 2000 });
+	scenarios.push_back({ std::unique_ptr<CBenchScene>(new CBenchSceneObj()), 500 });
+	scenarios.push_back({ std::unique_ptr<CBenchScene>(new CBenchSceneTextures()), 256 });
+	scenarios.push_back({ std::unique_ptr<CBenchScene>(new CBenchSceneUploads()), 1000 });
+
+	// headless device
+	CBenchApp benchApp;
+	benchApp.mShaderDirectory = shaderDirectory;
+	benchApp.Initialize(width, height);
+	std::cout << "device: " << benchApp.GetDeviceName() << ", seed " << seed << std::endl;
+
+	// pipeline creation
+	VulkanHelpers::VulkanProfileStats pipelineStats = benchApp.MeasurePipelineCreation(std::max(pipelineCount, 1u));
+	std::cout << "pipeline creation ms: p50 " << pipelineStats.mP50 << ", max " << pipelineStats.mMax << std::endl;
+	CBenchPipelineCacheResult pipelineCacheResult = benchApp.MeasurePipelineCacheStartup(std::max(pipelineCount, 1u), "vulkan_bench_pipeline_cache.bin");
+	std::cout << "pipeline creation with cache ms: cold p50 " << pipelineCacheResult.mCold.mP50 << ", warm p50 " << pipelineCacheResult.mWarm.mP50
+		<< " (new VkPipelineCache per cold run, internal cache of driver is not cleared)" << std::endl;
+
+	// run selected scenarios (all by default)
+	std::vector<CBenchResult> results;
+	for (auto& scenario : scenarios)
+	{
+		if (mode == "micro")
+			break;
+		const char* scenarioName = scenario.mScene->GetName();
+		if (!scenarioNames.empty() && std::find(scenarioNames.begin(), scenarioNames.end(), scenarioName) == scenarioNames.end())
+			continue;
+
+		CBenchResult result = benchApp.RunScene(*scenario.mScene, seed, objectCount ? objectCount : scenario.mObjectCount, warmupFrameCount, frameCount);
+		std::cout << scenarioName << ": " << result.mObjectCount << " objects, cpu frame ms p50 " << result.mCpuFrame.mP50
+			<< ", p99 " << result.mCpuFrame.mP99 << ", submit ms p50 " << result.mSubmit.mP50
+			<< ", setup upload MB/s " << result.mSetupUploadThroughput / (1024.0 * 1024.0)
+			<< ", frame upload MB/s " << result.mFrameUploadThroughput / (1024.0 * 1024.0) << std::endl;
+		results.push_back(result);
+	}
+
+	// microbenchmarks (no frames are in flight)
+	std::vector<CBenchResultMicro> microResults;
+	if (mode != "scenes")
+	{
+		CBenchRegistry registry;
+		registry.mMinTime = minTime;
+		RegisterMicroBenchmarks(registry, maxBufferSize);
+		microResults = registry.Run(benchApp, filter);
+	}
+
+	// write results (run fails when results of some microbenchmark are not valid)
+	int exitCode = 0;
+	for (const auto& microResult : microResults)
+	{
+		if (!microResult.mError.empty())
+		{
+			std::cerr << microResult.mName << "/" << microResult.mArg << " failed: " << microResult.mError << std::endl;
+			exitCode = 1;
+		}
+	}
+	if (!benchApp.WriteJson(outputFileName.c_str(), seed, pipelineStats, pipelineCacheResult, results, microResults))
+	{
+		std::cerr << "failed to write " << outputFileName << std::endl;
+		exitCode = 1;
+	}
+
+	benchApp.DeInitialize();
+	return exitCode;
+}
@@ -0,0 +1,656 @@
+#include "BenchHarness.hpp"
+#include "BenchApp.hpp"
+#include "../vulkan/vkutils/VulkanPipelineStateCache.hpp"
+#include "../vulkan/vkutils/VulkanDescriptors.hpp"
+#include "../vulkan/vkutils/VulkanCulling.hpp"
+#include "../vulkan/vkutils/VulkanFrustumCulling.hpp"
+#include "../vulkan/vkutils/VulkanRenderQueue.hpp"
+#include "../vulkan/vkutils/VulkanTransformHierarchy.hpp"
+#include "../vulkan/AppShaders.hpp"
+#include <cassert>
+#include <random>
+#include <iostream>
+#include <algorithm>
+
+// RGBA8 images of microbenchmarks
+const VkFormat BENCH_IMAGE_FORMAT = VK_FORMAT_R8G8B8A8_UNORM;
+const VkImageUsageFlags BENCH_IMAGE_USAGE = VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT;
+
+// culling LODs (projected size thresholds, smallest instances are culled)
+const VulkanHelpers::VulkanCullLod BENCH_CULL_LODS[] = {
+	{ 6, 0, 0, 0.05f },
+	{ 6, 0, 0, 0.01f },
+	{ 6, 0, 0, 0.002f },
+};
+
+// CBenchDescriptorResources (bound resources of descriptor cache benchmarks)
+struct CBenchDescriptorResources
+{
+	VkImage       mImage = VK_NULL_HANDLE;
+	VmaAllocation mImageAllocation = VK_NULL_HANDLE;
+	VkImageView   mImageView = VK_NULL_HANDLE;
+	VkBuffer      mBuffer = VK_NULL_HANDLE;
+	VmaAllocation mBufferAllocation = VK_NULL_HANDLE;
+	VulkanHelpers::VulkanDescriptorData mDescriptorData[2]{}; // layout of base pipeline (texture, dynamic buffer)
+};
+
+// InitDescriptorCache (64x64 image and uniform buffer, set layout of base pipeline is registered)
+static void InitDescriptorCache(CBenchApp& app, VulkanHelpers::VulkanDescriptorCacheInfo& descriptorCacheInfo, CBenchDescriptorResources& resources)
+{
+	std::vector<uint8_t> data(64 * 64 * 4, 0x5A);
+	app.mDeviceInfo.CreateImage(data.data(), 64, 64, 1, 1, BENCH_IMAGE_FORMAT, BENCH_IMAGE_USAGE, 0, resources.mImage, resources.mImageAllocation);
+	resources.mImageView = app.mDeviceInfo.CreateImageView(resources.mImage, BENCH_IMAGE_FORMAT, VK_IMAGE_ASPECT_COLOR_BIT);
+	app.mDeviceInfo.CreateBuffer(app.GetUniformSlotSize(), VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT, VulkanHelpers::VULKAN_MEMORY_ACCESS_DYNAMIC, resources.mBuffer, resources.mBufferAllocation);
+	resources.mDescriptorData[0] = VulkanHelpers::VulkanDescriptorData::Image(resources.mImageView, app.mSampler);
+	resources.mDescriptorData[1] = VulkanHelpers::VulkanDescriptorData::Buffer(resources.mBuffer, 0, sizeof(DirectX::XMMATRIX));
+	descriptorCacheInfo.Initialize(app.mDeviceInfo, 1);
+	descriptorCacheInfo.RegisterLayout(app.mPipelineInfo.mDescriptorSetLayout, app.mPipelineInfo.GetDescriptorSetLayoutBindings());
+}
+
+// DeInitDescriptorCache
+static void DeInitDescriptorCache(CBenchApp& app, VulkanHelpers::VulkanDescriptorCacheInfo& descriptorCacheInfo, CBenchDescriptorResources& resources)
+{
+	descriptorCacheInfo.DeInitialize();
+	vmaDestroyBuffer(app.mDeviceInfo.mAllocator, resources.mBuffer, resources.mBufferAllocation);
+	vkDestroyImageView(app.mDeviceInfo.mDevice, resources.mImageView, VK_NULL_HANDLE);
+	vmaDestroyImage(app.mDeviceInfo.mAllocator, resources.mImage, resources.mImageAllocation);
+}
+
+// InitCulling (embedded cull.comp.spv and cull_subgroup.comp.spv as in CAppMain, random scaled quads around camera target,
+// index of instance is stored in mParams[0] so compacted outputs can be matched with reference)
+static bool InitCulling(CBenchApp& app, VulkanHelpers::VulkanCullingInfo& cullingInfo, uint32_t instanceCount, VkShaderModule shaderModules[2])
+{
+	const AppShaders::CShaderBlob* shaderBlobCull = AppShaders::FindShader("cull.comp.spv");
+	const AppShaders::CShaderBlob* shaderBlobCullSubgroup = AppShaders::FindShader("cull_subgroup.comp.spv");
+	if (!shaderBlobCull || !shaderBlobCullSubgroup)
+		return false;
+	shaderModules[0] = VulkanHelpers::CreateShaderModule(app.mDeviceInfo.mDevice, shaderBlobCull->mCode, shaderBlobCull->mSize);
+	shaderModules[1] = VulkanHelpers::CreateShaderModule(app.mDeviceInfo.mDevice, shaderBlobCullSubgroup->mCode, shaderBlobCullSubgroup->mSize);
+	if (!shaderModules[0] || !shaderModules[1])
+		return false;
+	cullingInfo.Initialize(app.mDeviceInfo, shaderModules[0], shaderModules[1], BENCH_CULL_LODS, 3, instanceCount, 1);
+
+	// VulkanCullInstance
+	std::mt19937 random(1);
+	std::uniform_real_distribution<float> position(-60.0f, 60.0f);
+	std::uniform_real_distribution<float> scale(0.1f, 4.0f);
+	const float sphere[4] = { 0.0f, 0.0f, 0.0f, 1.41421356f };
+	cullingInfo.Begin(0);
+	for (uint32_t i = 0; i < instanceCount; i++) {
+		float instanceScale = scale(random);
+		float x = position(random);
+		float y = position(random);
+		float z = position(random);
+		VulkanHelpers::VulkanInstanceData instance{};
+		instance.SetTransform(DirectX::XMMatrixScaling(instanceScale, instanceScale, instanceScale) * DirectX::XMMatrixTranslation(x, y, z));
+		instance.mParams[0] = (float)i;
+		instance.mParams[1] = instance.mParams[2] = instance.mParams[3] = 1.0f;
+		cullingInfo.Add(instance, sphere);
+	}
+	cullingInfo.End(app.mViewProj, app.mProjScale);
+	return true;
+}
+
+// DeInitCulling
+static void DeInitCulling(CBenchApp& app, VulkanHelpers::VulkanCullingInfo& cullingInfo, VkShaderModule shaderModules[2])
+{
+	cullingInfo.DeInitialize();
+	for (uint32_t i = 0; i < 2; i++)
+		if (shaderModules[i])
+			vkDestroyShaderModule(app.mDeviceInfo.mDevice, shaderModules[i], VK_NULL_HANDLE);
+}
+
+// RunCulling (records compute pass, submits and waits)
+static void RunCulling(CBenchApp& app, const VulkanHelpers::VulkanCullingInfo& cullingInfo)
+{
+	VkCommandBuffer commandBuffer = app.mDeviceInfo.AllocateCommandBuffer(VK_COMMAND_BUFFER_LEVEL_PRIMARY);
+
+	// VkCommandBufferBeginInfo
+	VkCommandBufferBeginInfo commandBufferBeginInfo{};
+	commandBufferBeginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+	commandBufferBeginInfo.pNext = VK_NULL_HANDLE;
+	commandBufferBeginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+	commandBufferBeginInfo.pInheritanceInfo = nullptr;
+	VK_CHECK(vkBeginCommandBuffer(commandBuffer, &commandBufferBeginInfo));
+	cullingInfo.Record(commandBuffer);
+	VK_CHECK(vkEndCommandBuffer(commandBuffer));
+
+	// submit and wait
+	VkSubmitInfo submitInfo{};
+	submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+	submitInfo.pNext = VK_NULL_HANDLE;
+	submitInfo.commandBufferCount = 1;
+	submitInfo.pCommandBuffers = &commandBuffer;
+	VK_CHECK(vkQueueSubmit(app.mDeviceInfo.mQueueGraphics, 1, &submitInfo, VK_NULL_HANDLE));
+	VK_CHECK(vkQueueWaitIdle(app.mDeviceInfo.mQueueGraphics));
+	vkFreeCommandBuffers(app.mDeviceInfo.mDevice, app.mDeviceInfo.mCommandPool, 1, &commandBuffer);
+}
+
+// ValidateCulling (LOD counts and sets of compacted instances must match CPU reference, order within LOD is not defined)
+static bool ValidateCulling(CBenchApp& app, VulkanHelpers::VulkanCullingInfo& cullingInfo)
+{
+	uint32_t lodCount = cullingInfo.GetLodCount();
+	VkDeviceSize outputSize = cullingInfo.GetOutputOffset(lodCount);
+	VkDeviceSize indirectSize = lodCount * sizeof(VkDrawIndexedIndirectCommand);
+
+	// read back outputs
+	VkBuffer outputBuffer = VK_NULL_HANDLE;
+	VmaAllocation outputMemory = VK_NULL_HANDLE;
+	VkBuffer indirectBuffer = VK_NULL_HANDLE;
+	VmaAllocation indirectMemory = VK_NULL_HANDLE;
+	app.mDeviceInfo.CreateBuffer(outputSize, 0, VulkanHelpers::VULKAN_MEMORY_ACCESS_READBACK, outputBuffer, outputMemory);
+	app.mDeviceInfo.CreateBuffer(indirectSize, 0, VulkanHelpers::VULKAN_MEMORY_ACCESS_READBACK, indirectBuffer, indirectMemory);
+	app.mDeviceInfo.CopyBuffers(outputSize, cullingInfo.mOutputBuffer, outputBuffer);
+	app.mDeviceInfo.CopyBuffers(indirectSize, cullingInfo.mIndirectBuffer, indirectBuffer);
+	std::vector<VulkanHelpers::VulkanInstanceData> outputs((size_t)(outputSize / sizeof(VulkanHelpers::VulkanInstanceData)));
+	std::vector<VkDrawIndexedIndirectCommand> commands(lodCount);
+	app.mDeviceInfo.ReadBuffer(outputs.data(), outputSize, outputMemory);
+	app.mDeviceInfo.ReadBuffer(commands.data(), indirectSize, indirectMemory);
+	vmaDestroyBuffer(app.mDeviceInfo.mAllocator, outputBuffer, outputMemory);
+	vmaDestroyBuffer(app.mDeviceInfo.mAllocator, indirectBuffer, indirectMemory);
+
+	// CPU reference
+	std::vector<uint32_t> lodInstances[VulkanHelpers::VULKAN_CULL_MAX_LODS];
+	VulkanHelpers::VulkanCullingInfo::CullReference(cullingInfo.GetParams(), cullingInfo.GetInstances().data(), lodInstances);
+
+	// compare
+	bool valid = true;
+	for (uint32_t lod = 0; lod < lodCount; lod++) {
+		uint32_t count = commands[lod].instanceCount;
+		std::vector<uint32_t> instances{};
+		for (uint32_t i = 0; (i < count) && (i < cullingInfo.GetMaxInstanceCount()); i++)
+			instances.push_back((uint32_t)outputs[(size_t)lod * cullingInfo.GetMaxInstanceCount() + i].mParams[0]);
+		std::sort(instances.begin(), instances.end());
+		if (instances != lodInstances[lod]) {
+			std::cerr << "culling: LOD " << lod << " has " << count << " instances, reference " << lodInstances[lod].size() << std::endl;
+			valid = false;
+		}
+	}
+	return valid;
+}
+
+// InitFrustumCulling (random rotated and scaled unit cubes around camera target)
+static void InitFrustumCulling(VulkanHelpers::VulkanFrustumCullingInfo& frustumCullingInfo, CThreadPool& threadPool, uint32_t objectCount)
+{
+	frustumCullingInfo.Initialize(threadPool);
+	frustumCullingInfo.Resize(objectCount);
+	std::mt19937 random(1);
+	std::uniform_real_distribution<float> position(-60.0f, 60.0f);
+	std::uniform_real_distribution<float> scale(0.1f, 4.0f);
+	std::uniform_real_distribution<float> angle(0.0f, 2.0f * DirectX::XM_PI);
+	for (uint32_t i = 0; i < objectCount; i++) {
+		float objectScale = scale(random);
+		DirectX::XMMATRIX transform = DirectX::XMMatrixScaling(objectScale, objectScale, objectScale) *
+			DirectX::XMMatrixRotationRollPitchYaw(angle(random), angle(random), angle(random));
+		float x = position(random);
+		float y = position(random);
+		float z = position(random);
+		VulkanHelpers::VulkanBounds bounds{};
+		bounds.SetTransformed(DirectX::XMFLOAT3(-1.0f, -1.0f, -1.0f), DirectX::XMFLOAT3(1.0f, 1.0f, 1.0f), transform * DirectX::XMMatrixTranslation(x, y, z));
+		frustumCullingInfo.SetBounds(i, bounds);
+	}
+}
+
+// ValidateFrustumCulling (visible indices of last Cull must match CPU reference)
+static bool ValidateFrustumCulling(const VulkanHelpers::VulkanFrustumCullingInfo& frustumCullingInfo, const VulkanHelpers::VulkanFrustum& frustum)
+{
+	std::vector<uint32_t> visibleIndices{};
+	frustumCullingInfo.CullReference(frustum, visibleIndices);
+	const uint32_t* culledIndices = frustumCullingInfo.GetVisibleIndices();
+	if ((visibleIndices.size() != frustumCullingInfo.GetVisibleCount()) || !std::equal(visibleIndices.begin(), visibleIndices.end(), culledIndices)) {
+		std::cerr << "frustum culling: " << frustumCullingInfo.GetVisibleCount() << " visible, reference " << visibleIndices.size() << std::endl;
+		return false;
+	}
+	return true;
+}
+
+// RunFrustumCulling (threadCount 0 - one per core, avx2 false - scalar path), first run is validated against CPU reference
+static void RunFrustumCulling(CBenchApp& app, CBenchState& state, uint32_t threadCount, bool avx2)
+{
+	CThreadPool threadPool;
+	threadPool.Initialize(threadCount ? threadCount : std::max(std::thread::hardware_concurrency(), 1u));
+	VulkanHelpers::VulkanFrustumCullingInfo frustumCullingInfo;
+	InitFrustumCulling(frustumCullingInfo, threadPool, (uint32_t)state.GetArg());
+	frustumCullingInfo.mAvx2 = avx2 && frustumCullingInfo.mAvx2;
+	state.mBytesPerIteration = (uint64_t)state.GetArg() * 10 * sizeof(float);
+
+	VulkanHelpers::VulkanFrustum frustum{};
+	frustum.SetViewProjection(app.mViewProj);
+	frustumCullingInfo.Cull(frustum);
+	if (!ValidateFrustumCulling(frustumCullingInfo, frustum))
+		state.SetError("frustum culling differs from CPU reference");
+	while (state.KeepRunning())
+		frustumCullingInfo.Cull(frustum);
+	frustumCullingInfo.DeInitialize();
+	threadPool.DeInitialize();
+}
+
+// MakeRenderQueueKeys (64 pipelines and 1024 materials, quarter of packets is transparent pass)
+static std::vector<uint64_t> MakeRenderQueueKeys(uint32_t packetCount)
+{
+	std::mt19937 random(1);
+	std::uniform_real_distribution<float> depth(0.5f, 500.0f);
+	std::vector<uint64_t> keys(packetCount);
+	for (auto& key : keys) {
+		bool transparent = (random() % 4) == 0;
+		uint32_t pipeline = random() % 64;
+		uint32_t material = random() % 1024;
+		key = VulkanHelpers::VulkanSortKey::Make(transparent ? 1 : 0, pipeline, material, VulkanHelpers::VulkanSortKey::QuantizeDepth(depth(random)), transparent);
+	}
+	return keys;
+}
+
+// RunRenderQueueSort (threadCount 0 - one per core), first sort is validated against std::stable_sort
+static void RunRenderQueueSort(CBenchState& state, uint32_t threadCount)
+{
+	CThreadPool threadPool;
+	threadPool.Initialize(threadCount ? threadCount : std::max(std::thread::hardware_concurrency(), 1u));
+	VulkanHelpers::VulkanRenderQueueInfo renderQueueInfo;
+	renderQueueInfo.Initialize(threadPool);
+	for (uint32_t i = 0; i < 64; i++)
+		renderQueueInfo.RegisterPipeline((VkPipeline)(uintptr_t)(i + 1), (VkPipelineLayout)(uintptr_t)1, 0, 0);
+	for (uint32_t i = 0; i < 1024; i++)
+		renderQueueInfo.RegisterMaterial((VkDescriptorSet)(uintptr_t)(i + 1));
+	std::vector<uint64_t> keys = MakeRenderQueueKeys((uint32_t)state.GetArg());
+	state.mBytesPerIteration = (uint64_t)keys.size() * sizeof(uint64_t);
+
+	// packets are added again for every sort (adding is not measured)
+	auto addPackets = [&]() {
+		renderQueueInfo.Clear();
+		VulkanHelpers::VulkanDrawPayload payload{};
+		for (uint32_t i = 0; i < keys.size(); i++) {
+			payload.mFirstIndex = i;
+			renderQueueInfo.Add(keys[i], payload);
+		}
+	};
+	addPackets();
+	renderQueueInfo.Sort();
+	std::vector<uint32_t> order(keys.size());
+	for (uint32_t i = 0; i < order.size(); i++)
+		order[i] = i;
+	std::stable_sort(order.begin(), order.end(), [&keys](uint32_t a, uint32_t b) { return keys[a] < keys[b]; });
+	for (uint32_t i = 0; i < order.size(); i++) {
+		if (renderQueueInfo.GetPayload(i).mFirstIndex != order[i]) {
+			std::cerr << "render queue: packet " << i << " is out of order" << std::endl;
+			state.SetError("render queue sort differs from std::stable_sort");
+			break;
+		}
+	}
+
+	while (state.KeepRunning()) {
+		state.PauseTiming();
+		addPackets();
+		state.ResumeTiming();
+		renderQueueInfo.Sort();
+	}
+	renderQueueInfo.DeInitialize();
+	threadPool.DeInitialize();
+}
+
+// InitTransformHierarchy (forest of trees with 64 nodes, parent of node is random earlier node of its tree), returns roots
+static std::vector<uint32_t> InitTransformHierarchy(VulkanHelpers::VulkanTransformHierarchyInfo& transformHierarchyInfo, uint32_t nodeCount)
+{
+	std::mt19937 random(1);
+	std::uniform_real_distribution<float> angle(0.0f, 2.0f * DirectX::XM_PI);
+	std::uniform_real_distribution<float> offset(-2.0f, 2.0f);
+	std::vector<uint32_t> roots;
+	for (uint32_t i = 0; i < nodeCount; i++) {
+		uint32_t treeIndex = i % 64;
+		uint32_t parent = treeIndex ? roots.back() + (uint32_t)(random() % treeIndex) : VulkanHelpers::VULKAN_TRANSFORM_INVALID;
+		DirectX::XMMATRIX local = DirectX::XMMatrixRotationZ(angle(random)) * DirectX::XMMatrixTranslation(offset(random), offset(random), offset(random));
+		uint32_t node = transformHierarchyInfo.AddNode(parent, local);
+		if (!treeIndex)
+			roots.push_back(node);
+	}
+	return roots;
+}
+
+// ValidateTransformHierarchy (world of node must match product of locals along its parent chain)
+static bool ValidateTransformHierarchy(const VulkanHelpers::VulkanTransformHierarchyInfo& transformHierarchyInfo)
+{
+	for (uint32_t node = 0; node < transformHierarchyInfo.GetNodeCount(); node++) {
+		DirectX::XMMATRIX world = transformHierarchyInfo.GetLocal(node);
+		for (uint32_t parent = transformHierarchyInfo.GetParent(node); parent != VulkanHelpers::VULKAN_TRANSFORM_INVALID; parent = transformHierarchyInfo.GetParent(parent))
+			world = world * transformHierarchyInfo.GetLocal(parent);
+		const DirectX::XMMATRIX& result = transformHierarchyInfo.GetWorld(node);
+		for (uint32_t row = 0; row < 4; row++) {
+			if (!DirectX::XMVector4NearEqual(world.r[row], result.r[row], DirectX::XMVectorSet(1e-3f, 1e-3f, 1e-3f, 1e-3f))) {
+				std::cerr << "transform hierarchy: world of node " << node << " does not match" << std::endl;
+				return false;
+			}
+		}
+	}
+	return true;
+}
+
+// RunTransformHierarchy (threadCount 0 - one per core, every dirtyRootStep-th tree is changed before each Update),
+// first full update is validated against products of parent chains
+static void RunTransformHierarchy(CBenchState& state, uint32_t threadCount, uint32_t dirtyRootStep)
+{
+	CThreadPool threadPool;
+	threadPool.Initialize(threadCount ? threadCount : std::max(std::thread::hardware_concurrency(), 1u));
+	VulkanHelpers::VulkanTransformHierarchyInfo transformHierarchyInfo;
+	transformHierarchyInfo.Initialize(threadPool);
+	std::vector<uint32_t> roots = InitTransformHierarchy(transformHierarchyInfo, (uint32_t)state.GetArg());
+	transformHierarchyInfo.Update();
+	if (!ValidateTransformHierarchy(transformHierarchyInfo))
+		state.SetError("transform hierarchy differs from products of parent chains");
+
+	// changed trees are rotated by small step (SetLocal is not measured)
+	DirectX::XMMATRIX step = DirectX::XMMatrixRotationZ(0.01f);
+	uint64_t updatedCount = 0;
+	uint64_t updateCount = 0;
+	while (state.KeepRunning()) {
+		state.PauseTiming();
+		for (uint32_t i = 0; i < roots.size(); i += dirtyRootStep)
+			transformHierarchyInfo.SetLocal(roots[i], transformHierarchyInfo.GetLocal(roots[i]) * step);
+		state.ResumeTiming();
+		transformHierarchyInfo.Update();
+		updatedCount += transformHierarchyInfo.mLastUpdatedCount;
+		updateCount++;
+	}
+	state.mBytesPerIteration = (updateCount ? updatedCount / updateCount : 0) * sizeof(DirectX::XMMATRIX);
+	transformHierarchyInfo.DeInitialize();
+	threadPool.DeInitialize();
+}
+
+// RegisterMicroBenchmarks
+void RegisterMicroBenchmarks(CBenchRegistry& registry, int64_t maxBufferSize)
+{
+	//////////////////////////////////////////////////////////////////////////
+	// buffers (64 B to maxBufferSize)
+	//////////////////////////////////////////////////////////////////////////
+
+	// CreateBuffer with data (device local, staging upload)
+	registry.Register("CreateBuffer/Static", [](CBenchApp& app, CBenchState& state) {
+		std::vector<uint8_t> data((size_t)state.GetArg(), 0x5A);
+		state.mBytesPerIteration = data.size();
+		while (state.KeepRunning()) {
+			VkBuffer buffer = VK_NULL_HANDLE;
+			VmaAllocation allocation = VK_NULL_HANDLE;
+			app.mDeviceInfo.CreateBuffer(data.data(), data.size(), VK_BUFFER_USAGE_VERTEX_BUFFER_BIT, buffer, allocation);
+			state.PauseTiming();
+			vmaDestroyBuffer(app.mDeviceInfo.mAllocator, buffer, allocation);
+			state.ResumeTiming();
+		}
+	}).Range(64, maxBufferSize, 4);
+
+	// CreateBuffer without data (host visible, persistently mapped)
+	registry.Register("CreateBuffer/Dynamic", [](CBenchApp& app, CBenchState& state) {
+		while (state.KeepRunning()) {
+			VkBuffer buffer = VK_NULL_HANDLE;
+			VmaAllocation allocation = VK_NULL_HANDLE;
+			app.mDeviceInfo.CreateBuffer((VkDeviceSize)state.GetArg(), VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT, VulkanHelpers::VULKAN_MEMORY_ACCESS_DYNAMIC, buffer, allocation);
+			state.PauseTiming();
+			vmaDestroyBuffer(app.mDeviceInfo.mAllocator, buffer, allocation);
+			state.ResumeTiming();
+		}
+	}).Range(64, maxBufferSize, 4);
+
+	// WriteBuffer to device local buffer (staging buffer and copy)
+	registry.Register("WriteBuffer/Static", [](CBenchApp& app, CBenchState& state) {
+		std::vector<uint8_t> data((size_t)state.GetArg(), 0x5A);
+		state.mBytesPerIteration = data.size();
+		VkBuffer buffer = VK_NULL_HANDLE;
+		VmaAllocation allocation = VK_NULL_HANDLE;
+		app.mDeviceInfo.CreateBuffer(data.size(), VK_BUFFER_USAGE_VERTEX_BUFFER_BIT, VulkanHelpers::VULKAN_MEMORY_ACCESS_STATIC, buffer, allocation);
+		while (state.KeepRunning())
+			app.mDeviceInfo.WriteBuffer(data.data(), data.size(), buffer, allocation);
+		vmaDestroyBuffer(app.mDeviceInfo.mAllocator, buffer, allocation);
+	}).Range(64, maxBufferSize, 4);
+
+	// WriteBuffer to host visible buffer (memcpy to mapping)
+	registry.Register("WriteBuffer/Dynamic", [](CBenchApp& app, CBenchState& state) {
+		std::vector<uint8_t> data((size_t)state.GetArg(), 0x5A);
+		state.mBytesPerIteration = data.size();
+		VkBuffer buffer = VK_NULL_HANDLE;
+		VmaAllocation allocation = VK_NULL_HANDLE;
+		app.mDeviceInfo.CreateBuffer(data.size(), VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT, VulkanHelpers::VULKAN_MEMORY_ACCESS_DYNAMIC, buffer, allocation);
+		while (state.KeepRunning())
+			app.mDeviceInfo.WriteBuffer(data.data(), data.size(), buffer, allocation);
+		vmaDestroyBuffer(app.mDeviceInfo.mAllocator, buffer, allocation);
+	}).Range(64, maxBufferSize, 4);
+
+	//////////////////////////////////////////////////////////////////////////
+	// images (square RGBA8, argument is resolution)
+	//////////////////////////////////////////////////////////////////////////
+
+	// CreateImage with data (staging upload and layout transitions)
+	registry.Register("CreateImage", [](CBenchApp& app, CBenchState& state) {
+		uint32_t size = (uint32_t)state.GetArg();
+		std::vector<uint8_t> data((size_t)size * size * 4, 0x5A);
+		state.mBytesPerIteration = data.size();
+		while (state.KeepRunning()) {
+			VkImage image = VK_NULL_HANDLE;
+			VmaAllocation allocation = VK_NULL_HANDLE;
+			app.mDeviceInfo.CreateImage(data.data(), size, size, 1, 1, BENCH_IMAGE_FORMAT, BENCH_IMAGE_USAGE, 0, image, allocation);
+			state.PauseTiming();
+			vmaDestroyImage(app.mDeviceInfo.mAllocator, image, allocation);
+			state.ResumeTiming();
+		}
+	}).Arg(64).Arg(256).Arg(1024).Arg(2048).Arg(4096);
+
+	// WriteImage to existing image
+	registry.Register("WriteImage", [](CBenchApp& app, CBenchState& state) {
+		uint32_t size = (uint32_t)state.GetArg();
+		std::vector<uint8_t> data((size_t)size * size * 4, 0x5A);
+		state.mBytesPerIteration = data.size();
+		VkImage image = VK_NULL_HANDLE;
+		VmaAllocation allocation = VK_NULL_HANDLE;
+		app.mDeviceInfo.CreateImage(size, size, 1, 1, BENCH_IMAGE_FORMAT, BENCH_IMAGE_USAGE, 0, image, allocation);
+		while (state.KeepRunning())
+			app.mDeviceInfo.WriteImage(data.data(), size, size, 1, 1, BENCH_IMAGE_FORMAT, image);
+		vmaDestroyImage(app.mDeviceInfo.mAllocator, image, allocation);
+	}).Arg(64).Arg(256).Arg(1024).Arg(2048).Arg(4096);
+
+	//////////////////////////////////////////////////////////////////////////
+	// objects and descriptors
+	//////////////////////////////////////////////////////////////////////////
+
+	// CreateSampler
+	registry.Register("CreateSampler", [](CBenchApp& app, CBenchState& state) {
+		while (state.KeepRunning()) {
+			VkSampler sampler = app.mDeviceInfo.CreateSampler(VK_FILTER_LINEAR, VK_SAMPLER_ADDRESS_MODE_REPEAT);
+			state.PauseTiming();
+			vkDestroySampler(app.mDeviceInfo.mDevice, sampler, VK_NULL_HANDLE);
+			state.ResumeTiming();
+		}
+	});
+
+	// AllocateCommandBuffer (device command pool)
+	registry.Register("AllocateCommandBuffer", [](CBenchApp& app, CBenchState& state) {
+		while (state.KeepRunning()) {
+			VkCommandBuffer commandBuffer = app.mDeviceInfo.AllocateCommandBuffer(VK_COMMAND_BUFFER_LEVEL_PRIMARY);
+			state.PauseTiming();
+			vkFreeCommandBuffers(app.mDeviceInfo.mDevice, app.mDeviceInfo.mCommandPool, 1, &commandBuffer);
+			state.ResumeTiming();
+		}
+	});
+
+	// BindImageView (descriptor set of base pipeline, binding 0)
+	registry.Register("BindImageView", [](CBenchApp& app, CBenchState& state) {
+		std::vector<uint8_t> data(64 * 64 * 4, 0x5A);
+		VkImage image = VK_NULL_HANDLE;
+		VmaAllocation allocation = VK_NULL_HANDLE;
+		app.mDeviceInfo.CreateImage(data.data(), 64, 64, 1, 1, BENCH_IMAGE_FORMAT, BENCH_IMAGE_USAGE, 0, image, allocation);
+		VkImageView imageView = app.mDeviceInfo.CreateImageView(image, BENCH_IMAGE_FORMAT, VK_IMAGE_ASPECT_COLOR_BIT);
+		while (state.KeepRunning())
+			app.mPipelineInfo.BindImageView(0, imageView, app.mSampler);
+		vkDestroyImageView(app.mDeviceInfo.mDevice, imageView, VK_NULL_HANDLE);
+		vmaDestroyImage(app.mDeviceInfo.mAllocator, image, allocation);
+	});
+
+	// BindUnifromBufferDynamic (base pipeline binding 1 is dynamic uniform buffer, BindUnifromBuffer would not match its layout)
+	registry.Register("BindUnifromBufferDynamic", [](CBenchApp& app, CBenchState& state) {
+		VkBuffer buffer = VK_NULL_HANDLE;
+		VmaAllocation allocation = VK_NULL_HANDLE;
+		app.mDeviceInfo.CreateBuffer(app.GetUniformSlotSize(), VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT, VulkanHelpers::VULKAN_MEMORY_ACCESS_DYNAMIC, buffer, allocation);
+		while (state.KeepRunning())
+			app.mPipelineInfo.BindUnifromBufferDynamic(1, buffer, sizeof(DirectX::XMMATRIX));
+		vmaDestroyBuffer(app.mDeviceInfo.mAllocator, buffer, allocation);
+	});
+
+	// VulkanDescriptorCacheInfo::GetDescriptorSet of bound resources (hash and lookup per material bind)
+	registry.Register("DescriptorCache/Hit", [](CBenchApp& app, CBenchState& state) {
+		CBenchDescriptorResources resources{};
+		VulkanHelpers::VulkanDescriptorCacheInfo descriptorCacheInfo;
+		InitDescriptorCache(app, descriptorCacheInfo, resources);
+		VkDescriptorSet descriptorSet = VK_NULL_HANDLE;
+		while (state.KeepRunning())
+			descriptorSet = descriptorCacheInfo.GetDescriptorSet(app.mPipelineInfo.mDescriptorSetLayout, resources.mDescriptorData, 2);
+		assert(descriptorSet);
+		DeInitDescriptorCache(app, descriptorCacheInfo, resources);
+	});
+
+	// VulkanDescriptorCacheInfo::AllocateFrameSet (pool chain allocation and template write, pools reset in bulk)
+	registry.Register("DescriptorCache/FrameSet", [](CBenchApp& app, CBenchState& state) {
+		CBenchDescriptorResources resources{};
+		VulkanHelpers::VulkanDescriptorCacheInfo descriptorCacheInfo;
+		InitDescriptorCache(app, descriptorCacheInfo, resources);
+		uint32_t setCount = 0;
+		while (state.KeepRunning()) {
+			VkDescriptorSet descriptorSet = descriptorCacheInfo.AllocateFrameSet(0, app.mPipelineInfo.mDescriptorSetLayout, resources.mDescriptorData, 2);
+			assert(descriptorSet);
+			if (++setCount == 4096) {
+				state.PauseTiming();
+				descriptorCacheInfo.ResetFrame(0);
+				setCount = 0;
+				state.ResumeTiming();
+			}
+		}
+		DeInitDescriptorCache(app, descriptorCacheInfo, resources);
+	});
+
+	//////////////////////////////////////////////////////////////////////////
+	// pipelines
+	//////////////////////////////////////////////////////////////////////////
+
+	// VulkanPipelineInfo::Initialize (shader modules, layouts, descriptor pool and pipeline)
+	registry.Register("PipelineInfo/Initialize", [](CBenchApp& app, CBenchState& state) {
+		std::string pathVS = app.mShaderDirectory + "base.vert.spv";
+		std::string pathFS = app.mShaderDirectory + "base.frag.spv";
+		while (state.KeepRunning()) {
+			VulkanHelpers::VulkanPipelineInfo pipelineInfo;
+			pipelineInfo.Initialize(app.mDeviceInfo, app.mOffscreenInfo.mRenderPass, pathVS.c_str(), pathFS.c_str());
+			state.PauseTiming();
+			assert(pipelineInfo.mPipeline);
+			pipelineInfo.DeInitialize();
+			state.ResumeTiming();
+		}
+	});
+
+	// VulkanPipelineStateCacheInfo::GetPipeline of ready state (hash and shared lookup per draw)
+	registry.Register("PipelineStateCache/Hit", [](CBenchApp& app, CBenchState& state) {
+		VulkanHelpers::VulkanPipelineStateCacheInfo pipelineStateCacheInfo;
+		pipelineStateCacheInfo.Initialize(app.mDeviceInfo, 0);
+		VkPipeline pipeline = pipelineStateCacheInfo.GetPipelineSync(app.mPipelineInfo.mPipelineState);
+		while (state.KeepRunning())
+			pipeline = pipelineStateCacheInfo.GetPipeline(app.mPipelineInfo.mPipelineState);
+		assert(pipeline);
+		pipelineStateCacheInfo.DeInitialize();
+	});
+
+	// VulkanPipelineStateCacheInfo::GetPipelineSync of new state (every iteration has other depth bias)
+	registry.Register("PipelineStateCache/Compile", [](CBenchApp& app, CBenchState& state) {
+		VulkanHelpers::VulkanPipelineStateCacheInfo pipelineStateCacheInfo;
+		pipelineStateCacheInfo.Initialize(app.mDeviceInfo, 0);
+		VulkanHelpers::VulkanPipelineState pipelineState = app.mPipelineInfo.mPipelineState;
+		pipelineState.mDepthBiasEnable = VK_TRUE;
+		while (state.KeepRunning()) {
+			pipelineState.mDepthBiasConstantFactor += 1.0f;
+			VkPipeline pipeline = pipelineStateCacheInfo.GetPipelineSync(pipelineState);
+			assert(pipeline);
+		}
+		pipelineStateCacheInfo.DeInitialize();
+	});
+
+	//////////////////////////////////////////////////////////////////////////
+	// culling (argument is instance count)
+	//////////////////////////////////////////////////////////////////////////
+
+	// VulkanCullingInfo compute pass (submit and wait), first run is validated against CPU reference
+	registry.Register("Culling/Gpu", [](CBenchApp& app, CBenchState& state) {
+		VulkanHelpers::VulkanCullingInfo cullingInfo;
+		VkShaderModule shaderModules[2] = {};
+		if (!InitCulling(app, cullingInfo, (uint32_t)state.GetArg(), shaderModules)) {
+			state.SetError("cull shaders not found");
+			DeInitCulling(app, cullingInfo, shaderModules);
+			return;
+		}
+		state.mBytesPerIteration = (uint64_t)state.GetArg() * sizeof(VulkanHelpers::VulkanCullInstance);
+		RunCulling(app, cullingInfo);
+		if (!ValidateCulling(app, cullingInfo))
+			state.SetError(std::string("GPU culling differs from CPU reference (") + (cullingInfo.mSubgroupCompaction ? "subgroup" : "atomic") + " compaction)");
+		while (state.KeepRunning())
+			RunCulling(app, cullingInfo);
+		DeInitCulling(app, cullingInfo, shaderModules);
+	}).Arg(1024).Arg(16384).Arg(262144);
+
+	// VulkanCullingInfo::CullReference (same tests on one CPU thread)
+	registry.Register("Culling/CpuReference", [](CBenchApp& app, CBenchState& state) {
+		VulkanHelpers::VulkanCullingInfo cullingInfo;
+		VkShaderModule shaderModules[2] = {};
+		if (!InitCulling(app, cullingInfo, (uint32_t)state.GetArg(), shaderModules)) {
+			state.SetError("cull shaders not found");
+			DeInitCulling(app, cullingInfo, shaderModules);
+			return;
+		}
+		state.mBytesPerIteration = (uint64_t)state.GetArg() * sizeof(VulkanHelpers::VulkanCullInstance);
+		std::vector<uint32_t> lodInstances[VulkanHelpers::VULKAN_CULL_MAX_LODS];
+		while (state.KeepRunning())
+			VulkanHelpers::VulkanCullingInfo::CullReference(cullingInfo.GetParams(), cullingInfo.GetInstances().data(), lodInstances);
+		DeInitCulling(app, cullingInfo, shaderModules);
+	}).Arg(1024).Arg(16384).Arg(262144);
+
+	//////////////////////////////////////////////////////////////////////////
+	// frustum culling (argument is object count)
+	//////////////////////////////////////////////////////////////////////////
+
+	// VulkanFrustumCullingInfo::Cull (AVX2 when supported, ranges on all cores)
+	registry.Register("FrustumCulling/Simd", [](CBenchApp& app, CBenchState& state) {
+		RunFrustumCulling(app, state, 0, true);
+	}).Arg(65536).Arg(1048576);
+
+	// VulkanFrustumCullingInfo::Cull (AVX2 when supported, one thread)
+	registry.Register("FrustumCulling/SimdOneThread", [](CBenchApp& app, CBenchState& state) {
+		RunFrustumCulling(app, state, 1, true);
+	}).Arg(65536).Arg(1048576);
+
+	// VulkanFrustumCullingInfo::Cull (scalar, ranges on all cores)
+	registry.Register("FrustumCulling/Scalar", [](CBenchApp& app, CBenchState& state) {
+		RunFrustumCulling(app, state, 0, false);
+	}).Arg(65536).Arg(1048576);
+
+	//////////////////////////////////////////////////////////////////////////
+	// render queue (argument is packet count)
+	//////////////////////////////////////////////////////////////////////////
+
+	// VulkanRenderQueueInfo::Sort (ranges on all cores)
+	registry.Register("RenderQueue/Sort", [](CBenchApp& app, CBenchState& state) {
+		RunRenderQueueSort(state, 0);
+	}).Arg(16384).Arg(262144).Arg(1048576);
+
+	// VulkanRenderQueueInfo::Sort (one thread)
+	registry.Register("RenderQueue/SortOneThread", [](CBenchApp& app, CBenchState& state) {
+		RunRenderQueueSort(state, 1);
+	}).Arg(16384).Arg(262144).Arg(1048576);
+
+	//////////////////////////////////////////////////////////////////////////
+	// transform hierarchy (argument is node count, trees of 64 nodes)
+	//////////////////////////////////////////////////////////////////////////
+
+	// VulkanTransformHierarchyInfo::Update (all trees changed, subtrees on all cores)
+	registry.Register("Transforms/UpdateAll", [](CBenchApp& app, CBenchState& state) {
+		RunTransformHierarchy(state, 0, 1);
+	}).Arg(65536).Arg(1048576);
+
+	// VulkanTransformHierarchyInfo::Update (all trees changed, one thread)
+	registry.Register("Transforms/UpdateAllOneThread", [](CBenchApp& app, CBenchState& state) {
+		RunTransformHierarchy(state, 1, 1);
+	}).Arg(65536).Arg(1048576);
+
+	// VulkanTransformHierarchyInfo::Update (every 16th tree changed, clean subtrees keep their worlds)
+	registry.Register("Transforms/UpdateDirty", [](CBenchApp& app, CBenchState& state) {
+		RunTransformHierarchy(state, 0, 16);
+	}).Arg(65536).Arg(1048576);
+}
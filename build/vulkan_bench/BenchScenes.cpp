@@ -0,0 +1,440 @@
+#include "BenchScenes.hpp"
+#include "../vulkan/utils/tiny_obj_loader.h"
+#include <sstream>
+#include <cassert>
+#include <cstring>
+#include <cmath>
+#include <algorithm>
+
+// quad (same layout as application quad)
+static const CBenchVertex quadVertices[] = {
+	{ +1.0f, -1.0f, +0.0f, +1.0, /**/+1.0f, +0.0f, +0.0f, +1.0, /**/+1, +0 },
+	{ +1.0f, +1.0f, +0.0f, +1.0, /**/+0.0f, +1.0f, +0.0f, +1.0, /**/+1, +1 },
+	{ -1.0f, -1.0f, +0.0f, +1.0, /**/+0.0f, +0.0f, +1.0f, +1.0, /**/+0, +0 },
+	{ -1.0f, +1.0f, +0.0f, +1.0, /**/+1.0f, +1.0f, +0.0f, +1.0, /**/+0, +1 },
+};
+static const uint16_t quadIndexes[] = { 0, 1, 2, 2, 1, 3 };
+
+// RandomFloat (std distributions are implementation defined, raw mt19937 output is the same everywhere)
+static float RandomFloat(std::mt19937& random, float minValue, float maxValue)
+{
+	return minValue + (maxValue - minValue) * (float)(random() / 4294967296.0);
+}
+
+// GenerateTexture (RGBA8 checker of two random colors with hashed noise)
+static void GenerateTexture(std::mt19937& random, uint32_t size, std::vector<uint8_t>& pixels)
+{
+	uint32_t colors[2] = { (uint32_t)random(), (uint32_t)random() };
+	uint32_t cellShift = 3 + (uint32_t)random() % 3;
+	uint32_t noiseSeed = (uint32_t)random();
+	pixels.resize((size_t)size * size * 4);
+	for (uint32_t y = 0; y < size; y++)
+		for (uint32_t x = 0; x < size; x++)
+		{
+			uint32_t color = colors[((x >> cellShift) ^ (y >> cellShift)) & 1];
+			uint32_t noise = ((x * 73856093u) ^ (y * 19349663u) ^ noiseSeed) & 31;
+			uint8_t* pixel = &pixels[((size_t)y * size + x) * 4];
+			pixel[0] = (uint8_t)std::min<uint32_t>(((color >> 0) & 0xFF) + noise, 255);
+			pixel[1] = (uint8_t)std::min<uint32_t>(((color >> 8) & 0xFF) + noise, 255);
+			pixel[2] = (uint8_t)std::min<uint32_t>(((color >> 16) & 0xFF) + noise, 255);
+			pixel[3] = 255;
+		}
+}
+
+// GenerateSphereObj (OBJ text of sphere with randomly displaced vertices, poles and seam are shared)
+static std::string GenerateSphereObj(std::mt19937& random, uint32_t rings, uint32_t segments)
+{
+	// radius per ring and segment
+	std::vector<float> radiuses((rings + 1) * segments);
+	for (auto& radius : radiuses)
+		radius = RandomFloat(random, 0.9f, 1.1f);
+	for (uint32_t s = 0; s < segments; s++) {
+		radiuses[s] = radiuses[0];
+		radiuses[rings * segments + s] = radiuses[rings * segments];
+	}
+
+	// positions, texture coordinates and normals (seam column is duplicated for texture coordinates)
+	std::ostringstream obj;
+	const float pi = 3.14159265f;
+	for (uint32_t r = 0; r <= rings; r++)
+		for (uint32_t s = 0; s <= segments; s++)
+		{
+			float theta = pi * r / rings;
+			float phi = 2.0f * pi * s / segments;
+			float nx = std::sin(theta) * std::cos(phi);
+			float ny = std::cos(theta);
+			float nz = std::sin(theta) * std::sin(phi);
+			float radius = radiuses[r * segments + s % segments];
+			obj << "v " << nx * radius << " " << ny * radius << " " << nz * radius << "\n";
+			obj << "vt " << (float)s / segments << " " << (float)r / rings << "\n";
+			obj << "vn " << nx << " " << ny << " " << nz << "\n";
+		}
+
+	// faces (1-based indexes)
+	for (uint32_t r = 0; r < rings; r++)
+		for (uint32_t s = 0; s < segments; s++)
+		{
+			uint32_t i0 = r * (segments + 1) + s + 1;
+			uint32_t i1 = i0 + 1;
+			uint32_t i2 = i0 + segments + 1;
+			uint32_t i3 = i2 + 1;
+			obj << "f " << i0 << "/" << i0 << "/" << i0 << " " << i2 << "/" << i2 << "/" << i2 << " " << i1 << "/" << i1 << "/" << i1 << "\n";
+			obj << "f " << i1 << "/" << i1 << "/" << i1 << " " << i2 << "/" << i2 << "/" << i2 << " " << i3 << "/" << i3 << "/" << i3 << "\n";
+		}
+	return obj.str();
+}
+
+//////////////////////////////////////////////////////////////////////////
+// CBenchSceneObjects
+//////////////////////////////////////////////////////////////////////////
+
+// InitObjects
+void CBenchSceneObjects::InitObjects(CBenchApp& app, std::mt19937& random, uint32_t objectCount)
+{
+	// objects in view frustum
+	mObjects.resize(objectCount);
+	for (auto& object : mObjects)
+	{
+		object.mPosition = { RandomFloat(random, -24.0f, 24.0f), RandomFloat(random, -14.0f, 14.0f), RandomFloat(random, -20.0f, 5.0f) };
+		DirectX::XMVECTOR axis = DirectX::XMVectorSet(RandomFloat(random, -1.0f, 1.0f), RandomFloat(random, -1.0f, 1.0f), RandomFloat(random, 0.1f, 1.0f), 0.0f);
+		DirectX::XMStoreFloat3(&object.mAxis, DirectX::XMVector3Normalize(axis));
+		object.mSpeed = RandomFloat(random, -2.0f, 2.0f);
+		object.mScale = RandomFloat(random, 0.5f, 1.5f);
+	}
+
+	// uniform slots (objects of frame 0, objects of frame 1, ...)
+	mUniformSlotSize = app.GetUniformSlotSize();
+	mUniformData.assign((size_t)(mUniformSlotSize * objectCount), 0);
+	app.mDeviceInfo.CreateBuffer(mUniformSlotSize * objectCount * app.mFramesInFlight, VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT, VulkanHelpers::VULKAN_MEMORY_ACCESS_DYNAMIC, mUniformBuffer, mUniformMemory);
+	assert(mUniformBuffer);
+}
+
+// DeInitObjects
+void CBenchSceneObjects::DeInitObjects(CBenchApp& app)
+{
+	vmaDestroyBuffer(app.mDeviceInfo.mAllocator, mUniformBuffer, mUniformMemory);
+	mUniformBuffer = VK_NULL_HANDLE;
+	mUniformMemory = VK_NULL_HANDLE;
+	mObjects.clear();
+	mUniformData.clear();
+}
+
+// WriteUniforms
+void CBenchSceneObjects::WriteUniforms(CBenchApp& app, uint32_t frameIndex, float time)
+{
+	if (mObjects.empty())
+		return;
+
+	// WorldViewProjection of every object
+	for (size_t i = 0; i < mObjects.size(); i++)
+	{
+		const CBenchObject& object = mObjects[i];
+		DirectX::XMMATRIX matWorld =
+			DirectX::XMMatrixScaling(object.mScale, object.mScale, object.mScale) *
+			DirectX::XMMatrixRotationAxis(DirectX::XMLoadFloat3(&object.mAxis), object.mSpeed * time) *
+			DirectX::XMMatrixTranslation(object.mPosition.x, object.mPosition.y, object.mPosition.z);
+		DirectX::XMMATRIX matWVP = matWorld * app.mViewProj;
+		memcpy(&mUniformData[(size_t)(i * mUniformSlotSize)], &matWVP, sizeof(matWVP));
+	}
+
+	// persistently mapped, no staging
+	app.mDeviceInfo.WriteBuffer(mUniformData.data(), GetUniformOffset(frameIndex, 0), mUniformData.size(), mUniformBuffer, mUniformMemory);
+}
+
+// GetUniformOffset
+uint32_t CBenchSceneObjects::GetUniformOffset(uint32_t frameIndex, uint32_t objectIndex) const
+{
+	return (uint32_t)(mUniformSlotSize * ((size_t)frameIndex * mObjects.size() + objectIndex));
+}
+
+//////////////////////////////////////////////////////////////////////////
+// CBenchSceneQuads
+//////////////////////////////////////////////////////////////////////////
+
+// Initialize
+void CBenchSceneQuads::Initialize(CBenchApp& app, std::mt19937& random, uint32_t objectCount)
+{
+	InitObjects(app, random, objectCount);
+
+	// geometry and texture
+	app.UploadBuffer(quadVertices, sizeof(quadVertices), VK_BUFFER_USAGE_VERTEX_BUFFER_BIT, mVertexBuffer, mVertexMemory);
+	app.UploadBuffer(quadIndexes, sizeof(quadIndexes), VK_BUFFER_USAGE_INDEX_BUFFER_BIT, mIndexBuffer, mIndexMemory);
+	std::vector<uint8_t> pixels;
+	GenerateTexture(random, 256, pixels);
+	app.UploadImage(pixels.data(), 256, 256, mImage, mImageMemory, mImageView);
+
+	// descriptor set
+	mDescriptorPool = app.CreateDescriptorPool(1);
+	mDescriptorSet = app.AllocateDescriptorSet(mDescriptorPool);
+	app.WriteDescriptorSet(mDescriptorSet, mImageView, mUniformBuffer);
+}
+
+// DeInitialize
+void CBenchSceneQuads::DeInitialize(CBenchApp& app)
+{
+	vkDestroyDescriptorPool(app.mDeviceInfo.mDevice, mDescriptorPool, VK_NULL_HANDLE);
+	vkDestroyImageView(app.mDeviceInfo.mDevice, mImageView, VK_NULL_HANDLE);
+	vmaDestroyImage(app.mDeviceInfo.mAllocator, mImage, mImageMemory);
+	vmaDestroyBuffer(app.mDeviceInfo.mAllocator, mIndexBuffer, mIndexMemory);
+	vmaDestroyBuffer(app.mDeviceInfo.mAllocator, mVertexBuffer, mVertexMemory);
+	DeInitObjects(app);
+}
+
+// Update
+void CBenchSceneQuads::Update(CBenchApp& app, uint32_t frameIndex, float time)
+{
+	WriteUniforms(app, frameIndex, time);
+}
+
+// Record
+uint32_t CBenchSceneQuads::Record(CBenchApp& app, VkCommandBuffer commandBuffer, uint32_t frameIndex)
+{
+	VkDeviceSize offsets[] = { 0 };
+	vkCmdBindVertexBuffers(commandBuffer, 0, 1, &mVertexBuffer, offsets);
+	vkCmdBindIndexBuffer(commandBuffer, mIndexBuffer, 0, VK_INDEX_TYPE_UINT16);
+	for (uint32_t i = 0; i < (uint32_t)mObjects.size(); i++)
+	{
+		uint32_t uniformOffset = GetUniformOffset(frameIndex, i);
+		vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, app.mPipelineInfo.mPipelineLayout, 0, 1, &mDescriptorSet, 1, &uniformOffset);
+		vkCmdDrawIndexed(commandBuffer, 6, 1, 0, 0, 0);
+	}
+	return (uint32_t)mObjects.size();
+}
+
+//////////////////////////////////////////////////////////////////////////
+// CBenchSceneObj
+//////////////////////////////////////////////////////////////////////////
+
+// Initialize
+void CBenchSceneObj::Initialize(CBenchApp& app, std::mt19937& random, uint32_t objectCount)
+{
+	InitObjects(app, random, objectCount);
+
+	// load generated OBJ through tinyobj (as model files are loaded)
+	std::istringstream objStream(GenerateSphereObj(random, mRings, mSegments));
+	tinyobj::attrib_t attribs;
+	std::vector<tinyobj::shape_t> shapes;
+	std::vector<tinyobj::material_t> materials;
+	std::string err;
+	bool loaded = tinyobj::LoadObj(&attribs, &shapes, &materials, &err, &objStream);
+	assert(loaded && !shapes.empty());
+	(void)loaded;
+
+	// unindexed vertices (color from normal)
+	std::vector<CBenchVertex> vertices;
+	vertices.reserve(shapes[0].mesh.indices.size());
+	for (const tinyobj::index_t& index : shapes[0].mesh.indices)
+	{
+		CBenchVertex vertex{};
+		vertex.X = attribs.vertices[3 * index.vertex_index + 0];
+		vertex.Y = attribs.vertices[3 * index.vertex_index + 1];
+		vertex.Z = attribs.vertices[3 * index.vertex_index + 2];
+		vertex.W = 1.0f;
+		vertex.R = attribs.normals[3 * index.normal_index + 0] * 0.5f + 0.5f;
+		vertex.G = attribs.normals[3 * index.normal_index + 1] * 0.5f + 0.5f;
+		vertex.B = attribs.normals[3 * index.normal_index + 2] * 0.5f + 0.5f;
+		vertex.A = 1.0f;
+		vertex.U = attribs.texcoords[2 * index.texcoord_index + 0];
+		vertex.V = attribs.texcoords[2 * index.texcoord_index + 1];
+		vertices.push_back(vertex);
+	}
+	mVertexCount = (uint32_t)vertices.size();
+	app.UploadBuffer(vertices.data(), vertices.size() * sizeof(CBenchVertex), VK_BUFFER_USAGE_VERTEX_BUFFER_BIT, mVertexBuffer, mVertexMemory);
+
+	// texture
+	std::vector<uint8_t> pixels;
+	GenerateTexture(random, 256, pixels);
+	app.UploadImage(pixels.data(), 256, 256, mImage, mImageMemory, mImageView);
+
+	// descriptor set
+	mDescriptorPool = app.CreateDescriptorPool(1);
+	mDescriptorSet = app.AllocateDescriptorSet(mDescriptorPool);
+	app.WriteDescriptorSet(mDescriptorSet, mImageView, mUniformBuffer);
+}
+
+// DeInitialize
+void CBenchSceneObj::DeInitialize(CBenchApp& app)
+{
+	vkDestroyDescriptorPool(app.mDeviceInfo.mDevice, mDescriptorPool, VK_NULL_HANDLE);
+	vkDestroyImageView(app.mDeviceInfo.mDevice, mImageView, VK_NULL_HANDLE);
+	vmaDestroyImage(app.mDeviceInfo.mAllocator, mImage, mImageMemory);
+	vmaDestroyBuffer(app.mDeviceInfo.mAllocator, mVertexBuffer, mVertexMemory);
+	DeInitObjects(app);
+}
+
+// Update
+void CBenchSceneObj::Update(CBenchApp& app, uint32_t frameIndex, float time)
+{
+	WriteUniforms(app, frameIndex, time);
+}
+
+// Record
+uint32_t CBenchSceneObj::Record(CBenchApp& app, VkCommandBuffer commandBuffer, uint32_t frameIndex)
+{
+	VkDeviceSize offsets[] = { 0 };
+	vkCmdBindVertexBuffers(commandBuffer, 0, 1, &mVertexBuffer, offsets);
+	for (uint32_t i = 0; i < (uint32_t)mObjects.size(); i++)
+	{
+		uint32_t uniformOffset = GetUniformOffset(frameIndex, i);
+		vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, app.mPipelineInfo.mPipelineLayout, 0, 1, &mDescriptorSet, 1, &uniformOffset);
+		vkCmdDraw(commandBuffer, mVertexCount, 1, 0, 0);
+	}
+	return (uint32_t)mObjects.size();
+}
+
+//////////////////////////////////////////////////////////////////////////
+// CBenchSceneTextures
+//////////////////////////////////////////////////////////////////////////
+
+// Initialize
+void CBenchSceneTextures::Initialize(CBenchApp& app, std::mt19937& random, uint32_t objectCount)
+{
+	InitObjects(app, random, objectCount);
+
+	// geometry
+	app.UploadBuffer(quadVertices, sizeof(quadVertices), VK_BUFFER_USAGE_VERTEX_BUFFER_BIT, mVertexBuffer, mVertexMemory);
+	app.UploadBuffer(quadIndexes, sizeof(quadIndexes), VK_BUFFER_USAGE_INDEX_BUFFER_BIT, mIndexBuffer, mIndexMemory);
+
+	// texture and descriptor set per object
+	mImages.resize(objectCount);
+	mImageMemories.resize(objectCount);
+	mImageViews.resize(objectCount);
+	mDescriptorSets.resize(objectCount);
+	mDescriptorPool = app.CreateDescriptorPool(objectCount);
+	std::vector<uint8_t> pixels;
+	for (uint32_t i = 0; i < objectCount; i++)
+	{
+		GenerateTexture(random, mTextureSize, pixels);
+		app.UploadImage(pixels.data(), mTextureSize, mTextureSize, mImages[i], mImageMemories[i], mImageViews[i]);
+		mDescriptorSets[i] = app.AllocateDescriptorSet(mDescriptorPool);
+		app.WriteDescriptorSet(mDescriptorSets[i], mImageViews[i], mUniformBuffer);
+	}
+}
+
+// DeInitialize
+void CBenchSceneTextures::DeInitialize(CBenchApp& app)
+{
+	vkDestroyDescriptorPool(app.mDeviceInfo.mDevice, mDescriptorPool, VK_NULL_HANDLE);
+	for (size_t i = 0; i < mImages.size(); i++)
+	{
+		vkDestroyImageView(app.mDeviceInfo.mDevice, mImageViews[i], VK_NULL_HANDLE);
+		vmaDestroyImage(app.mDeviceInfo.mAllocator, mImages[i], mImageMemories[i]);
+	}
+	mImages.clear();
+	mImageMemories.clear();
+	mImageViews.clear();
+	mDescriptorSets.clear();
+	vmaDestroyBuffer(app.mDeviceInfo.mAllocator, mIndexBuffer, mIndexMemory);
+	vmaDestroyBuffer(app.mDeviceInfo.mAllocator, mVertexBuffer, mVertexMemory);
+	DeInitObjects(app);
+}
+
+// Update
+void CBenchSceneTextures::Update(CBenchApp& app, uint32_t frameIndex, float time)
+{
+	WriteUniforms(app, frameIndex, time);
+}
+
+// Record
+uint32_t CBenchSceneTextures::Record(CBenchApp& app, VkCommandBuffer commandBuffer, uint32_t frameIndex)
+{
+	VkDeviceSize offsets[] = { 0 };
+	vkCmdBindVertexBuffers(commandBuffer, 0, 1, &mVertexBuffer, offsets);
+	vkCmdBindIndexBuffer(commandBuffer, mIndexBuffer, 0, VK_INDEX_TYPE_UINT16);
+	for (uint32_t i = 0; i < (uint32_t)mObjects.size(); i++)
+	{
+		uint32_t uniformOffset = GetUniformOffset(frameIndex, i);
+		vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, app.mPipelineInfo.mPipelineLayout, 0, 1, &mDescriptorSets[i], 1, &uniformOffset);
+		vkCmdDrawIndexed(commandBuffer, 6, 1, 0, 0, 0);
+	}
+	return (uint32_t)mObjects.size();
+}
+
+//////////////////////////////////////////////////////////////////////////
+// CBenchSceneUploads
+//////////////////////////////////////////////////////////////////////////
+
+// Initialize
+void CBenchSceneUploads::Initialize(CBenchApp& app, std::mt19937& random, uint32_t objectCount)
+{
+	InitObjects(app, random, objectCount);
+
+	// per frame generator continues scene sequence
+	mRandom.seed(random());
+
+	// index buffer (quads are separate in vertex buffer)
+	std::vector<uint32_t> indexes(objectCount * 6);
+	for (uint32_t i = 0; i < objectCount; i++)
+		for (uint32_t j = 0; j < 6; j++)
+			indexes[i * 6 + j] = i * 4 + quadIndexes[j];
+	app.UploadBuffer(indexes.data(), indexes.size() * sizeof(uint32_t), VK_BUFFER_USAGE_INDEX_BUFFER_BIT, mIndexBuffer, mIndexMemory);
+
+	// frame resources are written only when frame is reused (no copies while GPU reads)
+	mVertices.resize(objectCount * 4);
+	mPixels.resize((size_t)mTextureSize * mTextureSize * 4);
+	mFrames.resize(app.mFramesInFlight);
+	mDescriptorPool = app.CreateDescriptorPool(app.mFramesInFlight);
+	for (auto& frame : mFrames)
+	{
+		app.mDeviceInfo.CreateBuffer(mVertices.size() * sizeof(CBenchVertex), VK_BUFFER_USAGE_VERTEX_BUFFER_BIT, VulkanHelpers::VULKAN_MEMORY_ACCESS_STATIC, frame.mVertexBuffer, frame.mVertexMemory);
+		assert(frame.mVertexBuffer);
+		app.mDeviceInfo.CreateImage(mTextureSize, mTextureSize, 1, 1, VK_FORMAT_R8G8B8A8_UNORM, VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT, 0, frame.mImage, frame.mImageMemory);
+		assert(frame.mImage);
+		frame.mImageView = app.mDeviceInfo.CreateImageView(frame.mImage, VK_FORMAT_R8G8B8A8_UNORM, VK_IMAGE_ASPECT_COLOR_BIT);
+		frame.mDescriptorSet = app.AllocateDescriptorSet(mDescriptorPool);
+		app.WriteDescriptorSet(frame.mDescriptorSet, frame.mImageView, mUniformBuffer);
+	}
+}
+
+// DeInitialize
+void CBenchSceneUploads::DeInitialize(CBenchApp& app)
+{
+	vkDestroyDescriptorPool(app.mDeviceInfo.mDevice, mDescriptorPool, VK_NULL_HANDLE);
+	for (auto& frame : mFrames)
+	{
+		vkDestroyImageView(app.mDeviceInfo.mDevice, frame.mImageView, VK_NULL_HANDLE);
+		vmaDestroyImage(app.mDeviceInfo.mAllocator, frame.mImage, frame.mImageMemory);
+		vmaDestroyBuffer(app.mDeviceInfo.mAllocator, frame.mVertexBuffer, frame.mVertexMemory);
+	}
+	mFrames.clear();
+	mVertices.clear();
+	mPixels.clear();
+	vmaDestroyBuffer(app.mDeviceInfo.mAllocator, mIndexBuffer, mIndexMemory);
+	DeInitObjects(app);
+}
+
+// Update
+void CBenchSceneUploads::Update(CBenchApp& app, uint32_t frameIndex, float time)
+{
+	WriteUniforms(app, frameIndex, time);
+
+	// jittered quads
+	for (size_t i = 0; i < mVertices.size(); i++)
+	{
+		mVertices[i] = quadVertices[i % 4];
+		mVertices[i].X += RandomFloat(mRandom, -0.25f, 0.25f);
+		mVertices[i].Y += RandomFloat(mRandom, -0.25f, 0.25f);
+	}
+
+	// upload geometry and new texture of frame
+	CBenchUploadFrame& frame = mFrames[frameIndex];
+	GenerateTexture(mRandom, mTextureSize, mPixels);
+	app.UploadBuffer(mVertices.data(), mVertices.size() * sizeof(CBenchVertex), frame.mVertexBuffer, frame.mVertexMemory);
+	app.UploadImage(mPixels.data(), mTextureSize, mTextureSize, frame.mImage);
+}
+
+// Record
+uint32_t CBenchSceneUploads::Record(CBenchApp& app, VkCommandBuffer commandBuffer, uint32_t frameIndex)
+{
+	CBenchUploadFrame& frame = mFrames[frameIndex];
+	VkDeviceSize offsets[] = { 0 };
+	vkCmdBindVertexBuffers(commandBuffer, 0, 1, &frame.mVertexBuffer, offsets);
+	vkCmdBindIndexBuffer(commandBuffer, mIndexBuffer, 0, VK_INDEX_TYPE_UINT32);
+	for (uint32_t i = 0; i < (uint32_t)mObjects.size(); i++)
+	{
+		uint32_t uniformOffset = GetUniformOffset(frameIndex, i);
+		vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, app.mPipelineInfo.mPipelineLayout, 0, 1, &frame.mDescriptorSet, 1, &uniformOffset);
+		vkCmdDrawIndexed(commandBuffer, 6, 1, i * 6, 0, 0);
+	}
+	return (uint32_t)mObjects.size();
+}
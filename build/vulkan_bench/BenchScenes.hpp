@@ -0,0 +1,141 @@
+#pragma once
+
+#include "BenchApp.hpp"
+
+// CBenchSceneObjects
+// base of scenes with randomly placed rotating objects, one dynamic uniform slot per object and frame in flight
+class CBenchSceneObjects : public CBenchScene
+{
+protected:
+	// CBenchObject
+	struct CBenchObject
+	{
+		DirectX::XMFLOAT3 mPosition{};
+		DirectX::XMFLOAT3 mAxis{};
+		float             mSpeed = 0.0f;
+		float             mScale = 1.0f;
+	};
+
+	// objects
+	std::vector<CBenchObject> mObjects{};
+
+	// uniforms (host visible, frame slots follow each other)
+	VkBuffer             mUniformBuffer = VK_NULL_HANDLE;
+	VmaAllocation        mUniformMemory = VK_NULL_HANDLE;
+	VkDeviceSize         mUniformSlotSize = 0;
+	std::vector<uint8_t> mUniformData{};
+
+	// Init/DeInit functions
+	void InitObjects(CBenchApp& app, std::mt19937& random, uint32_t objectCount);
+	void DeInitObjects(CBenchApp& app);
+
+	// WriteUniforms (object matrices of frame at given time)
+	void WriteUniforms(CBenchApp& app, uint32_t frameIndex, float time);
+	uint32_t GetUniformOffset(uint32_t frameIndex, uint32_t objectIndex) const;
+};
+
+// CBenchSceneQuads
+// N textured quads sharing one texture, vertex and index buffer
+class CBenchSceneQuads : public CBenchSceneObjects
+{
+private:
+	VkBuffer         mVertexBuffer = VK_NULL_HANDLE;
+	VmaAllocation    mVertexMemory = VK_NULL_HANDLE;
+	VkBuffer         mIndexBuffer = VK_NULL_HANDLE;
+	VmaAllocation    mIndexMemory = VK_NULL_HANDLE;
+	VkImage          mImage = VK_NULL_HANDLE;
+	VmaAllocation    mImageMemory = VK_NULL_HANDLE;
+	VkImageView      mImageView = VK_NULL_HANDLE;
+	VkDescriptorPool mDescriptorPool = VK_NULL_HANDLE;
+	VkDescriptorSet  mDescriptorSet = VK_NULL_HANDLE;
+public:
+	const char* GetName() const override { return "quads"; }
+	void Initialize(CBenchApp& app, std::mt19937& random, uint32_t objectCount) override;
+	void DeInitialize(CBenchApp& app) override;
+	void Update(CBenchApp& app, uint32_t frameIndex, float time) override;
+	uint32_t Record(CBenchApp& app, VkCommandBuffer commandBuffer, uint32_t frameIndex) override;
+};
+
+// CBenchSceneObj
+// N instances of mesh loaded from generated OBJ text (randomly displaced sphere)
+class CBenchSceneObj : public CBenchSceneObjects
+{
+private:
+	VkBuffer         mVertexBuffer = VK_NULL_HANDLE;
+	VmaAllocation    mVertexMemory = VK_NULL_HANDLE;
+	uint32_t         mVertexCount = 0;
+	VkImage          mImage = VK_NULL_HANDLE;
+	VmaAllocation    mImageMemory = VK_NULL_HANDLE;
+	VkImageView      mImageView = VK_NULL_HANDLE;
+	VkDescriptorPool mDescriptorPool = VK_NULL_HANDLE;
+	VkDescriptorSet  mDescriptorSet = VK_NULL_HANDLE;
+public:
+	// sphere tessellation
+	uint32_t mRings = 24;
+	uint32_t mSegments = 48;
+
+	const char* GetName() const override { return "obj_instances"; }
+	void Initialize(CBenchApp& app, std::mt19937& random, uint32_t objectCount) override;
+	void DeInitialize(CBenchApp& app) override;
+	void Update(CBenchApp& app, uint32_t frameIndex, float time) override;
+	uint32_t Record(CBenchApp& app, VkCommandBuffer commandBuffer, uint32_t frameIndex) override;
+};
+
+// CBenchSceneTextures
+// N quads with own texture and descriptor set each
+class CBenchSceneTextures : public CBenchSceneObjects
+{
+private:
+	VkBuffer                     mVertexBuffer = VK_NULL_HANDLE;
+	VmaAllocation                mVertexMemory = VK_NULL_HANDLE;
+	VkBuffer                     mIndexBuffer = VK_NULL_HANDLE;
+	VmaAllocation                mIndexMemory = VK_NULL_HANDLE;
+	std::vector<VkImage>         mImages{};
+	std::vector<VmaAllocation>   mImageMemories{};
+	std::vector<VkImageView>     mImageViews{};
+	VkDescriptorPool             mDescriptorPool = VK_NULL_HANDLE;
+	std::vector<VkDescriptorSet> mDescriptorSets{};
+public:
+	// texture size
+	uint32_t mTextureSize = 256;
+
+	const char* GetName() const override { return "texture_heavy"; }
+	void Initialize(CBenchApp& app, std::mt19937& random, uint32_t objectCount) override;
+	void DeInitialize(CBenchApp& app) override;
+	void Update(CBenchApp& app, uint32_t frameIndex, float time) override;
+	uint32_t Record(CBenchApp& app, VkCommandBuffer commandBuffer, uint32_t frameIndex) override;
+};
+
+// CBenchSceneUploads
+// N quads whose geometry and texture are generated and uploaded every frame (per frame in flight copies)
+class CBenchSceneUploads : public CBenchSceneObjects
+{
+private:
+	// frame resources
+	struct CBenchUploadFrame
+	{
+		VkBuffer        mVertexBuffer = VK_NULL_HANDLE;
+		VmaAllocation   mVertexMemory = VK_NULL_HANDLE;
+		VkImage         mImage = VK_NULL_HANDLE;
+		VmaAllocation   mImageMemory = VK_NULL_HANDLE;
+		VkImageView     mImageView = VK_NULL_HANDLE;
+		VkDescriptorSet mDescriptorSet = VK_NULL_HANDLE;
+	};
+
+	std::mt19937                   mRandom{};
+	std::vector<CBenchUploadFrame> mFrames{};
+	VkBuffer                       mIndexBuffer = VK_NULL_HANDLE;
+	VmaAllocation                  mIndexMemory = VK_NULL_HANDLE;
+	VkDescriptorPool               mDescriptorPool = VK_NULL_HANDLE;
+	std::vector<CBenchVertex>      mVertices{};
+	std::vector<uint8_t>           mPixels{};
+public:
+	// streamed texture size
+	uint32_t mTextureSize = 512;
+
+	const char* GetName() const override { return "upload_heavy"; }
+	void Initialize(CBenchApp& app, std::mt19937& random, uint32_t objectCount) override;
+	void DeInitialize(CBenchApp& app) override;
+	void Update(CBenchApp& app, uint32_t frameIndex, float time) override;
+	uint32_t Record(CBenchApp& app, VkCommandBuffer commandBuffer, uint32_t frameIndex) override;
+};